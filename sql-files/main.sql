@@ -963,6 +963,24 @@ CREATE TABLE IF NOT EXISTS `skillcooldown` (
   PRIMARY KEY (`char_id`, `skill`)
 );
 
+--
+-- Table structure for table `packet_stats`
+--
+
+CREATE TABLE IF NOT EXISTS `packet_stats` (
+  `server` varchar(32) NOT NULL,
+  `link` varchar(8) NOT NULL,
+  `packet_id` smallint(5) unsigned NOT NULL,
+  `recv_count` bigint(20) unsigned NOT NULL default '0',
+  `recv_bytes` bigint(20) unsigned NOT NULL default '0',
+  `parse_time` bigint(20) unsigned NOT NULL default '0',
+  `send_count` bigint(20) unsigned NOT NULL default '0',
+  `send_bytes` bigint(20) unsigned NOT NULL default '0',
+  `broadcasts` bigint(20) unsigned NOT NULL default '0',
+  `updated` datetime NOT NULL,
+  PRIMARY KEY (`server`, `link`, `packet_id`)
+);
+
 --
 -- Table structure for table `party`
 --
@@ -1034,6 +1052,20 @@ CREATE TABLE IF NOT EXISTS `quest` (
   PRIMARY KEY  (`char_id`,`quest_id`)
 );
 
+--
+-- Table structure for table `server_metrics`
+--
+
+CREATE TABLE IF NOT EXISTS `server_metrics` (
+  `server` varchar(32) NOT NULL,
+  `name` varchar(64) NOT NULL,
+  `type` varchar(8) NOT NULL,
+  `help` varchar(255) NOT NULL default '',
+  `value` bigint(20) NOT NULL default '0',
+  `updated` datetime NOT NULL,
+  PRIMARY KEY (`server`, `name`)
+);
+
 --
 -- Table structure for table `skill`
 --
@@ -4,6 +4,7 @@
 #pragma warning(disable:4800)
 #include "char.hpp"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -11,6 +12,8 @@
 #include <ctime>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <common/cbasetypes.hpp>
 #include <common/cli.hpp>
@@ -18,7 +21,9 @@
 #include <common/db.hpp>
 #include <common/malloc.hpp>
 #include <common/mapindex.hpp>
+#include <common/metrics.hpp>
 #include <common/mmo.hpp>
+#include <common/packet_stats.hpp>
 #include <common/random.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
@@ -81,6 +86,8 @@ std::unordered_map<uint32, std::shared_ptr<struct auth_node>> auth_db;
 std::unordered_map<uint32, std::shared_ptr<struct online_char_data>> online_char_db;
 // uint32 char_id -> struct mmo_charstatus*
 std::unordered_map<uint32, std::shared_ptr<struct mmo_charstatus>> char_db;
+// Characters whose cached status is still missing the memo points, friends and hotkeys
+static std::unordered_set<uint32> char_deferred;
 std::unordered_map<uint32, std::shared_ptr<struct auth_node>>& char_get_authdb() { return auth_db; }
 std::unordered_map<uint32, std::shared_ptr<struct online_char_data>>& char_get_onlinedb() { return online_char_db; }
 std::unordered_map<uint32, std::shared_ptr<struct mmo_charstatus>>& char_get_chardb() { return char_db; }
@@ -172,6 +179,7 @@ void char_set_char_offline(uint32 char_id, uint32 account_id){
 		inter_guild_CharOffline(char_id, cp?cp->guild_id:-1);
 		if (cp)
 			char_get_chardb().erase( char_id );
+		char_deferred.erase( char_id );
 
 		if( SQL_ERROR == Sql_Query(sql_handle, "UPDATE `%s` SET `online`='0' WHERE `char_id`='%d' LIMIT 1", schema_config.char_db, char_id) )
 			Sql_ShowDebug(sql_handle);
@@ -254,6 +262,8 @@ void char_set_all_offline_sql(void){
 		Sql_ShowDebug(sql_handle);
 }
 
+static void char_charselect_update( struct mmo_charstatus* p );
+
 int32 char_mmo_char_tosql(uint32 char_id, struct mmo_charstatus* p){
 	int32 i = 0;
 	int32 count = 0;
@@ -524,6 +534,9 @@ int32 char_mmo_char_tosql(uint32 char_id, struct mmo_charstatus* p){
 
 	if( !errors ){
 		memcpy( cp.get(), p, sizeof( struct mmo_charstatus ) );
+		char_charselect_update( p );
+	}else{
+		char_charselect_invalidate( p->account_id );
 	}
 
 	return 0;
@@ -893,21 +906,94 @@ int32 char_mmo_gender( const struct char_session_data *sd, const struct mmo_char
 
 int32 char_mmo_char_tobuf(uint8* buf, struct mmo_charstatus* p);
 
-//=====================================================================================================
-// Loads the basic character rooster for the given account. Returns total buffer used.
-int32 char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf, uint8* count ) {
+/// Character of the select screen, as it is sent to the client
+struct s_charselect_char {
+	uint32 char_id;
+	uint8 slot;
+	time_t unban_time;
+	uint32 character_moves;
+	int32 length;
+	uint8 buf[MAX_CHAR_BUF];
+};
+
+/// Characters of an account's select screen
+struct s_charselect_account {
+	t_tick expiration;
+	std::vector<s_charselect_char> chars;
+};
+
+// uint32 account_id -> select screen, kept for charselect_cache_ttl seconds after it was last used or saved
+static std::unordered_map<uint32, s_charselect_account> charselect_cache;
+
+static Metric metric_charselect_cache_hits( "rathena_charselect_cache_hits_total", "Character select screens that were sent from the cache", METRIC_COUNTER );
+static Metric metric_charselect_cache_misses( "rathena_charselect_cache_misses_total", "Character select screens that were loaded from the database", METRIC_COUNTER );
+
+/**
+ * Forgets the cached select screen of an account.
+ * Has to be called whenever one of its characters is changed outside of char_mmo_char_tosql.
+ * @param account_id: Account ID
+ */
+void char_charselect_invalidate( uint32 account_id ){
+	charselect_cache.erase( account_id );
+}
+
+/// Forgets all cached select screens
+void char_charselect_clear( void ){
+	charselect_cache.clear();
+}
+
+/**
+ * Updates a character on the cached select screen of its account after it was saved.
+ * @param p: Saved character
+ */
+static void char_charselect_update( struct mmo_charstatus* p ){
+	auto account = charselect_cache.find( p->account_id );
+
+	if( account == charselect_cache.end() ){
+		return;
+	}
+
+	for( s_charselect_char& entry : account->second.chars ){
+		if( entry.char_id == p->char_id ){
+			account->second.expiration = gettick() + charserv_config.charselect_cache_ttl * 1000;
+			entry.slot = p->slot;
+			entry.unban_time = p->unban_time;
+			entry.character_moves = p->character_moves;
+			entry.length = char_mmo_char_tobuf( entry.buf, p );
+			return;
+		}
+	}
+
+	// Not on the select screen yet
+	charselect_cache.erase( account );
+}
+
+/// Drops the select screens that expired
+static TIMER_FUNC(char_charselect_cache_cleanup){
+	for( auto it = charselect_cache.begin(); it != charselect_cache.end(); ){
+		if( DIFF_TICK( it->second.expiration, tick ) <= 0 ){
+			it = charselect_cache.erase( it );
+		}else{
+			it++;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Loads the characters of an account's select screen with a single query.
+ * @param sd: Session of the account
+ * @param account: Select screen
+ * @return false if the characters could not be loaded
+ */
+static bool char_charselect_fromsql( struct char_session_data* sd, s_charselect_account& account ){
 	SqlStmt stmt{ *sql_handle };
 	struct mmo_charstatus p;
-	int32 j = 0, i;
 	char sex[2];
 
 	memset(&p, 0, sizeof(p));
 
-	for( i = 0; i < MAX_CHARS; i++ ) {
-		sd->found_char[i] = -1;
-		sd->unban_time[i] = 0;
-	}
-
 	// read char data
 	if( SQL_ERROR == stmt.Prepare( "SELECT "
 		"`char_id`,`char_num`,`name`,`class`,`base_level`,`job_level`,`base_exp`,`job_exp`,`zeny`,"
@@ -983,23 +1069,73 @@ int32 char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf, uint8* co
 	)
 	{
 		SqlStmt_ShowDebug(stmt);
-		return 0;
+		return false;
 	}
 
-	for( i = 0; i < MAX_CHARS && SQL_SUCCESS == stmt.NextRow(); i++ )
+	for( int32 i = 0; i < MAX_CHARS && SQL_SUCCESS == stmt.NextRow(); i++ )
 	{
-		sd->found_char[p.slot] = p.char_id;
-		sd->unban_time[p.slot] = p.unban_time;
+		s_charselect_char entry;
+
 		p.sex = char_mmo_gender(sd, &p, sex[0]);
-		j += char_mmo_char_tobuf(WBUFP(buf, j), &p);
+		entry.char_id = p.char_id;
+		entry.slot = p.slot;
+		entry.unban_time = p.unban_time;
+		entry.character_moves = p.character_moves;
+		entry.length = char_mmo_char_tobuf( entry.buf, &p );
+		account.chars.push_back( entry );
+	}
+
+	return true;
+}
+
+//=====================================================================================================
+// Loads the basic character rooster for the given account. Returns total buffer used.
+int32 char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf, uint8* count ) {
+	int32 j = 0, i;
+
+	for( i = 0; i < MAX_CHARS; i++ ) {
+		sd->found_char[i] = -1;
+		sd->unban_time[i] = 0;
+	}
+
+	t_tick tick = gettick();
+	auto cached = charselect_cache.find( sd->account_id );
+	s_charselect_account loaded;
+	s_charselect_account* account;
+
+	if( cached != charselect_cache.end() && DIFF_TICK( cached->second.expiration, tick ) > 0 ){
+		account = &cached->second;
+		account->expiration = tick + charserv_config.charselect_cache_ttl * 1000;
+		metric_charselect_cache_hits.add();
+	}else{
+		if( !char_charselect_fromsql( sd, loaded ) ){
+			return 0;
+		}
+
+		metric_charselect_cache_misses.add();
+
+		if( charserv_config.charselect_cache_ttl > 0 ){
+			loaded.expiration = tick + charserv_config.charselect_cache_ttl * 1000;
+			account = &( charselect_cache[sd->account_id] = std::move( loaded ) );
+		}else{
+			charselect_cache.erase( sd->account_id );
+			account = &loaded;
+		}
+	}
+
+	for( const s_charselect_char& entry : account->chars ){
+		sd->found_char[entry.slot] = entry.char_id;
+		sd->unban_time[entry.slot] = entry.unban_time;
+		memcpy( WBUFP( buf, j ), entry.buf, entry.length );
+		j += entry.length;
 
 		// Addon System
 		// store the required info into the session
-		sd->char_moves[p.slot] = p.character_moves;
+		sd->char_moves[entry.slot] = entry.character_moves;
 	}
 
 	if( count != nullptr ){
-		*count = i;
+		*count = static_cast<uint8>( account->chars.size() );
 	}
 
 	memset(sd->new_name,0,sizeof(sd->new_name));
@@ -1007,18 +1143,90 @@ int32 char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf, uint8* co
 	return j;
 }
 
-//=====================================================================================================
-int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_everything) {
+/**
+ * Loads the parts of a character that are not needed to enter a map: memo points, friends and hotkeys.
+ * @param stmt: Statement to use
+ * @param char_id: Character ID
+ * @param p: Status that receives them
+ * @param msg_buf: Load message the loaded parts are appended to, can be nullptr
+ */
+static void char_mmo_char_fromsql_deferred( SqlStmt& stmt, uint32 char_id, struct mmo_charstatus* p, StringBuf* msg_buf ){
 	int32 i;
-	SqlStmt stmt{ *sql_handle };
 	struct s_point_str tmp_point;
-	struct s_skill tmp_skill;
-	uint16 skill_count = 0;
 	struct s_friend tmp_friend;
 #ifdef HOTKEY_SAVING
 	struct hotkey tmp_hotkey;
 	int32 hotkey_num;
 #endif
+
+	memset( p->memo_point, 0, sizeof( p->memo_point ) );
+	memset( p->friends, 0, sizeof( p->friends ) );
+#ifdef HOTKEY_SAVING
+	memset( p->hotkeys, 0, sizeof( p->hotkeys ) );
+#endif
+
+	//read memo data
+	//`memo` (`memo_id`,`char_id`,`map`,`x`,`y`)
+	if( SQL_ERROR == stmt.Prepare("SELECT `map`,`x`,`y` FROM `%s` WHERE `char_id`=? ORDER by `memo_id` LIMIT %d", schema_config.memo_db, MAX_MEMOPOINTS)
+	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
+	||	SQL_ERROR == stmt.Execute()
+	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_STRING, &tmp_point.map, sizeof(tmp_point.map), nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_INT16,  &tmp_point.x, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_INT16,  &tmp_point.y, 0, nullptr, nullptr) )
+		SqlStmt_ShowDebug(stmt);
+
+	for( i = 0; i < MAX_MEMOPOINTS && SQL_SUCCESS == stmt.NextRow(); ++i )
+	{
+		memcpy(&p->memo_point[i], &tmp_point, sizeof(tmp_point));
+	}
+	if( msg_buf != nullptr )
+		StringBuf_AppendStr(msg_buf, " memo");
+
+	//read friends
+	//`friends` (`char_id`, `friend_id`)
+	if( SQL_ERROR == stmt.Prepare("SELECT c.`account_id`, c.`char_id`, c.`name` FROM `%s` c LEFT JOIN `%s` f ON f.`friend_id` = c.`char_id` WHERE f.`char_id`=? LIMIT %d", schema_config.char_db, schema_config.friend_db, MAX_FRIENDS)
+	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
+	||	SQL_ERROR == stmt.Execute()
+	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_INT32,    &tmp_friend.account_id, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_INT32,    &tmp_friend.char_id, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_STRING, &tmp_friend.name, sizeof(tmp_friend.name), nullptr, nullptr) )
+		SqlStmt_ShowDebug(stmt);
+
+	for( i = 0; i < MAX_FRIENDS && SQL_SUCCESS == stmt.NextRow(); ++i )
+		memcpy(&p->friends[i], &tmp_friend, sizeof(tmp_friend));
+	if( msg_buf != nullptr )
+		StringBuf_AppendStr(msg_buf, " friends");
+
+#ifdef HOTKEY_SAVING
+	//read hotkeys
+	//`hotkey` (`char_id`, `hotkey`, `type`, `itemskill_id`, `skill_lvl`
+	if( SQL_ERROR == stmt.Prepare("SELECT `hotkey`, `type`, `itemskill_id`, `skill_lvl` FROM `%s` WHERE `char_id`=?", schema_config.hotkey_db)
+	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
+	||	SQL_ERROR == stmt.Execute()
+	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_INT32,    &hotkey_num, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_UCHAR,  &tmp_hotkey.type, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_UINT32,   &tmp_hotkey.id, 0, nullptr, nullptr)
+	||	SQL_ERROR == stmt.BindColumn(3, SQLDT_UINT16, &tmp_hotkey.lv, 0, nullptr, nullptr) )
+		SqlStmt_ShowDebug(stmt);
+
+	while( SQL_SUCCESS == stmt.NextRow() )
+	{
+		if( hotkey_num >= 0 && hotkey_num < MAX_HOTKEYS_DB )
+			memcpy(&p->hotkeys[hotkey_num], &tmp_hotkey, sizeof(tmp_hotkey));
+		else
+			ShowWarning("mmo_char_fromsql: ignoring invalid hotkey (hotkey=%d,type=%u,id=%u,lv=%u) of character %s (AID=%d,CID=%d)\n", hotkey_num, tmp_hotkey.type, tmp_hotkey.id, tmp_hotkey.lv, p->name, p->account_id, p->char_id);
+	}
+	if( msg_buf != nullptr )
+		StringBuf_AppendStr(msg_buf, " hotkeys");
+#endif
+}
+
+//=====================================================================================================
+int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_everything, bool defer) {
+	int32 i;
+	SqlStmt stmt{ *sql_handle };
+	struct s_skill tmp_skill;
+	uint16 skill_count = 0;
 	StringBuf msg_buf;
 	char sex[2];
 
@@ -1137,22 +1345,6 @@ int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_
 		return 1;
 	}
 
-	//read memo data
-	//`memo` (`memo_id`,`char_id`,`map`,`x`,`y`)
-	if( SQL_ERROR == stmt.Prepare("SELECT `map`,`x`,`y` FROM `%s` WHERE `char_id`=? ORDER by `memo_id` LIMIT %d", schema_config.memo_db, MAX_MEMOPOINTS)
-	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
-	||	SQL_ERROR == stmt.Execute()
-	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_STRING, &tmp_point.map, sizeof(tmp_point.map), nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_INT16,  &tmp_point.x, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_INT16,  &tmp_point.y, 0, nullptr, nullptr) )
-		SqlStmt_ShowDebug(stmt);
-
-	for( i = 0; i < MAX_MEMOPOINTS && SQL_SUCCESS == stmt.NextRow(); ++i )
-	{
-		memcpy(&p->memo_point[i], &tmp_point, sizeof(tmp_point));
-	}
-	StringBuf_AppendStr(&msg_buf, " memo");
-
 	//read skill
 	//`skill` (`char_id`, `id`, `lv`)
 	if( SQL_ERROR == stmt.Prepare("SELECT `id`, `lv`,`flag` FROM `%s` WHERE `char_id`=? LIMIT %d", schema_config.skill_db, MAX_SKILL)
@@ -1176,41 +1368,11 @@ int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_
 	}
 	StringBuf_Printf(&msg_buf, " %d skills", skill_count);
 
-	//read friends
-	//`friends` (`char_id`, `friend_id`)
-	if( SQL_ERROR == stmt.Prepare("SELECT c.`account_id`, c.`char_id`, c.`name` FROM `%s` c LEFT JOIN `%s` f ON f.`friend_id` = c.`char_id` WHERE f.`char_id`=? LIMIT %d", schema_config.char_db, schema_config.friend_db, MAX_FRIENDS)
-	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
-	||	SQL_ERROR == stmt.Execute()
-	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_INT32,    &tmp_friend.account_id, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_INT32,    &tmp_friend.char_id, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_STRING, &tmp_friend.name, sizeof(tmp_friend.name), nullptr, nullptr) )
-		SqlStmt_ShowDebug(stmt);
-
-	for( i = 0; i < MAX_FRIENDS && SQL_SUCCESS == stmt.NextRow(); ++i )
-		memcpy(&p->friends[i], &tmp_friend, sizeof(tmp_friend));
-	StringBuf_AppendStr(&msg_buf, " friends");
-
-#ifdef HOTKEY_SAVING
-	//read hotkeys
-	//`hotkey` (`char_id`, `hotkey`, `type`, `itemskill_id`, `skill_lvl`
-	if( SQL_ERROR == stmt.Prepare("SELECT `hotkey`, `type`, `itemskill_id`, `skill_lvl` FROM `%s` WHERE `char_id`=?", schema_config.hotkey_db)
-	||	SQL_ERROR == stmt.BindParam(0, SQLDT_INT32, &char_id, 0)
-	||	SQL_ERROR == stmt.Execute()
-	||	SQL_ERROR == stmt.BindColumn(0, SQLDT_INT32,    &hotkey_num, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(1, SQLDT_UCHAR,  &tmp_hotkey.type, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(2, SQLDT_UINT32,   &tmp_hotkey.id, 0, nullptr, nullptr)
-	||	SQL_ERROR == stmt.BindColumn(3, SQLDT_UINT16, &tmp_hotkey.lv, 0, nullptr, nullptr) )
-		SqlStmt_ShowDebug(stmt);
-
-	while( SQL_SUCCESS == stmt.NextRow() )
-	{
-		if( hotkey_num >= 0 && hotkey_num < MAX_HOTKEYS_DB )
-			memcpy(&p->hotkeys[hotkey_num], &tmp_hotkey, sizeof(tmp_hotkey));
-		else
-			ShowWarning("mmo_char_fromsql: ignoring invalid hotkey (hotkey=%d,type=%u,id=%u,lv=%u) of character %s (AID=%d,CID=%d)\n", hotkey_num, tmp_hotkey.type, tmp_hotkey.id, tmp_hotkey.lv, p->name, p->account_id, p->char_id);
+	if( defer ){
+		StringBuf_AppendStr(&msg_buf, " (memo, friends and hotkeys deferred)");
+	}else{
+		char_mmo_char_fromsql_deferred( stmt, char_id, p, &msg_buf );
 	}
-	StringBuf_AppendStr(&msg_buf, " hotkeys");
-#endif
 
 	/* Mercenary Owner DataBase */
 	mercenary_owner_fromsql(char_id, p);
@@ -1230,9 +1392,77 @@ int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_
 
 	memcpy( cp.get(), p, sizeof( struct mmo_charstatus ) );
 
+	if( defer ){
+		char_deferred.insert( char_id );
+	}else{
+		char_deferred.erase( char_id );
+	}
+
 	return 1;
 }
 
+/**
+ * Makes sure that the cached status of a character holds its memo points, friends and hotkeys.
+ * A character that is not cached yet is loaded completely.
+ * @param char_id: Character ID
+ * @return cached status or nullptr if the character does not exist
+ */
+std::shared_ptr<struct mmo_charstatus> char_mmo_char_load_deferred( uint32 char_id ){
+	std::shared_ptr<struct mmo_charstatus> cp = util::umap_find( char_get_chardb(), char_id );
+
+	if( cp == nullptr ){
+		struct mmo_charstatus char_dat;
+
+		if( !char_mmo_char_fromsql( char_id, &char_dat, true ) ){
+			return nullptr;
+		}
+
+		return util::umap_find( char_get_chardb(), char_id );
+	}
+
+	if( char_deferred.erase( char_id ) > 0 ){
+		SqlStmt stmt{ *sql_handle };
+
+		char_mmo_char_fromsql_deferred( stmt, char_id, cp.get(), nullptr );
+	}
+
+	return cp;
+}
+
+/**
+ * Checks if the memo points, friends and hotkeys of a cached character were not loaded yet.
+ * @param char_id: Character ID
+ * @return true if they still have to be loaded
+ */
+bool char_mmo_char_is_deferred( uint32 char_id ){
+	return char_deferred.find( char_id ) != char_deferred.end();
+}
+
+/**
+ * Takes over the memo points, friends and hotkeys of the cached status into a status
+ * that a map-server saved before it received them, so that saving it keeps them as they are.
+ * While the cache is missing them as well, both are empty and nothing is written.
+ * @param char_id: Character ID
+ * @param p: Status to save
+ */
+void char_mmo_char_keep_deferred( uint32 char_id, struct mmo_charstatus* p ){
+	std::shared_ptr<struct mmo_charstatus> cp = util::umap_find( char_get_chardb(), char_id );
+
+	if( cp == nullptr ){
+		cp = char_mmo_char_load_deferred( char_id );
+
+		if( cp == nullptr ){
+			return;
+		}
+	}
+
+	memcpy( p->memo_point, cp->memo_point, sizeof( p->memo_point ) );
+	memcpy( p->friends, cp->friends, sizeof( p->friends ) );
+#ifdef HOTKEY_SAVING
+	memcpy( p->hotkeys, cp->hotkeys, sizeof( p->hotkeys ) );
+#endif
+}
+
 //==========================================================================================================
 int32 char_mmo_sql_init(void) {
 	ShowStatus("Characters per Account: '%d'.\n", charserv_config.char_config.char_per_account);
@@ -1295,6 +1525,8 @@ int32 char_rename_char_sql(struct char_session_data *sd, uint32 char_id)
 		Sql_ShowDebug(sql_handle);
 		return 3;
 	}
+
+	char_charselect_invalidate( sd->account_id );
 	
 	// Update party and party members with the new player name
 	if( char_dat.party_id )
@@ -1500,6 +1732,8 @@ int32 char_make_new_char( struct char_session_data* sd, char* name_, int32 str,
 		return -2; //No, stop the procedure!
 	}
 
+	char_charselect_invalidate( sd->account_id );
+
 	//Retrieve the newly auto-generated char id
 	char_id = (int32)Sql_LastInsertId(sql_handle);
 	//Give the char the default items
@@ -1739,6 +1973,7 @@ enum e_char_del_response char_delete(struct char_session_data* sd, uint32 char_i
 
 	// refresh character list cache
 	sd->found_char[i] = -1;
+	char_charselect_invalidate( sd->account_id );
 
 	return CHAR_DELETE_OK;
 }
@@ -2221,6 +2456,30 @@ TIMER_FUNC(char_clan_member_cleanup){
 	return 0;
 }
 
+static Metric metric_online_users( "rathena_online_users", "Characters that are online", METRIC_GAUGE );
+
+/// Writes the metrics of the char-server for the web-server
+static TIMER_FUNC(char_metrics_timer){
+	char server[32];
+
+	metric_online_users.set( char_count_users() );
+
+	safesnprintf( server, sizeof( server ), "char-server:%hu", charserv_config.char_port );
+	metrics_save( sql_handle, server );
+
+	return 0;
+}
+
+/// Writes the packet statistics of the char-server for the web-server
+static TIMER_FUNC(char_packet_stats_timer){
+	char server[32];
+
+	safesnprintf( server, sizeof( server ), "char-server:%hu", charserv_config.char_port );
+	packet_stats_save( sql_handle, schema_config.packet_stats_table, server );
+
+	return 0;
+}
+
 //----------------------------------
 // Reading Lan Support configuration
 // Rewrote: Anvanced subnet check [LuzZza]
@@ -2651,6 +2910,12 @@ void char_sql_config_read(const char* cfgName) {
 			safestrncpy(schema_config.clan_alliance_table, w2, sizeof(schema_config.clan_alliance_table));
 		else if(!strcmpi(w1,"achievement_table"))
 			safestrncpy(schema_config.achievement_table, w2, sizeof(schema_config.achievement_table));
+		else if(!strcmpi(w1,"packet_stats_table"))
+			safestrncpy(schema_config.packet_stats_table, w2, sizeof(schema_config.packet_stats_table));
+		else if(!strcmpi(w1,"packet_stats_interval"))
+			charserv_config.packet_stats_interval = atoi(w2);
+		else if(metrics_config_read(w1, w2))
+			continue;
 		else if(!strcmpi(w1, "start_status_points"))
 			charserv_config.start_status_points = atoi(w2);
 		//support the import command, just like any other config
@@ -2704,6 +2969,7 @@ void char_set_default_sql(){
 	safestrncpy(schema_config.clan_table,"clan",sizeof(schema_config.clan_table));
 	safestrncpy(schema_config.clan_table,"clan_alliance",sizeof(schema_config.clan_alliance_table));
 	safestrncpy(schema_config.achievement_table,"achievement",sizeof(schema_config.achievement_table));
+	safestrncpy(schema_config.packet_stats_table,"packet_stats",sizeof(schema_config.packet_stats_table));
 }
 
 //set default config
@@ -2808,6 +3074,9 @@ void char_set_defaults(){
 #endif
 
 	charserv_config.clear_parties = 0;
+	charserv_config.deferred_char_load = false;
+	charserv_config.charselect_cache_ttl = 600;
+	charserv_config.packet_stats_interval = 0;
 }
 
 /**
@@ -2959,10 +3228,8 @@ bool char_config_read(const char* cfgName, bool normal){
 			msg_silent = atoi(w2);
 			if( msg_silent ) /* only bother if its actually enabled */
 				ShowInfo("Console Silent Setting: %d\n", atoi(w2));
-		} else if (strcmpi(w1, "console_msg_log") == 0) {
-			console_msg_log = atoi(w2);
-		} else if  (strcmpi(w1, "console_log_filepath") == 0) {
-			safestrncpy(console_log_filepath, w2, sizeof(console_log_filepath));
+		} else if (showmsg_config_read(w1, w2)) {
+			continue;
 		} else if(strcmpi(w1,"stdout_with_ansisequence")==0){
 			stdout_with_ansisequence = config_switch(w2);
 		} else if (strcmpi(w1, "char_maintenance") == 0) {
@@ -3092,6 +3359,10 @@ bool char_config_read(const char* cfgName, bool normal){
 			charserv_config.allowed_job_flag = atoi(w2);
 		} else if (strcmpi(w1, "clear_parties") == 0) {
 			charserv_config.clear_parties = config_switch(w2);
+		} else if (strcmpi(w1, "deferred_char_load") == 0) {
+			charserv_config.deferred_char_load = config_switch(w2) != 0;
+		} else if (strcmpi(w1, "charselect_cache_ttl") == 0) {
+			charserv_config.charselect_cache_ttl = std::max(0, atoi(w2));
 		} else if (strcmpi(w1, "import") == 0) {
 			char_config_read(w2, normal);
 		}
@@ -3142,6 +3413,8 @@ void CharacterServer::finalize(){
 	do_final_chlogif();
 
 	char_get_chardb().clear();
+	char_deferred.clear();
+	char_charselect_clear();
 	char_get_onlinedb().clear();
 	char_get_authdb().clear();
 
@@ -3225,6 +3498,9 @@ bool CharacterServer::initialize( int32 argc, char *argv[] ){
 	add_timer_func_list(char_online_data_cleanup, "online_data_cleanup");
 	add_timer_interval(gettick() + 1000, char_online_data_cleanup, 0, 0, 600 * 1000);
 
+	add_timer_func_list(char_charselect_cache_cleanup, "char_charselect_cache_cleanup");
+	add_timer_interval(gettick() + 60 * 1000, char_charselect_cache_cleanup, 0, 0, 60 * 1000); // every minute
+
 	// periodically remove players that have not logged in for a long time from clans
 	add_timer_func_list(char_clan_member_cleanup, "clan_member_cleanup");
 	add_timer_interval(gettick() + 1000, char_clan_member_cleanup, 0, 0, 60 * 60 * 1000); // every 60 minutes
@@ -3237,6 +3513,16 @@ bool CharacterServer::initialize( int32 argc, char *argv[] ){
 	add_timer_func_list(mail_delete_timer, "mail_delete_timer");
 	add_timer_interval(gettick() + 1000, mail_delete_timer, 0, 0, 1 * 60 * 1000); // every minute
 
+	// periodically write the packet statistics for the web-server
+	add_timer_func_list(char_packet_stats_timer, "char_packet_stats_timer");
+	if( charserv_config.packet_stats_interval > 0 )
+		add_timer_interval(gettick() + 1000, char_packet_stats_timer, 0, 0, charserv_config.packet_stats_interval * 1000);
+
+	// periodically write the metrics for the web-server
+	add_timer_func_list(char_metrics_timer, "char_metrics_timer");
+	if( metrics_interval > 0 )
+		add_timer_interval(gettick() + 1000, char_metrics_timer, 0, 0, metrics_interval * 1000);
+
 	//check db tables
 	if(charserv_config.char_check_db && char_checkdb() == 0){
 		ShowFatalError("char : A tables is missing in sql-server, please fix it, see (sql-files main.sql for structure) \n");
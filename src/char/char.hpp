@@ -105,6 +105,7 @@ struct Schema_Config {
 	char clan_table[DB_NAME_LEN];
 	char clan_alliance_table[DB_NAME_LEN];
 	char achievement_table[DB_NAME_LEN];
+	char packet_stats_table[DB_NAME_LEN];
 };
 extern struct Schema_Config schema_config;
 
@@ -207,6 +208,9 @@ struct CharServ_Config {
 
 	int32 allowed_job_flag;
 	int32 clear_parties;
+	bool deferred_char_load; // memo points, friends and hotkeys are loaded after the character entered the map
+	int32 charselect_cache_ttl; // seconds
+	int32 packet_stats_interval; // seconds
 };
 extern struct CharServ_Config charserv_config;
 
@@ -305,8 +309,13 @@ TIMER_FUNC(char_chardb_waiting_disconnect);
 int32 char_mmo_gender(const struct char_session_data *sd, const struct mmo_charstatus *p, char sex);
 int32 char_mmo_char_tobuf(uint8* buffer, struct mmo_charstatus* p);
 int32 char_mmo_char_tosql(uint32 char_id, struct mmo_charstatus* p);
-int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_everything);
+int32 char_mmo_char_fromsql(uint32 char_id, struct mmo_charstatus* p, bool load_everything, bool defer = false);
+std::shared_ptr<struct mmo_charstatus> char_mmo_char_load_deferred( uint32 char_id );
+bool char_mmo_char_is_deferred( uint32 char_id );
+void char_mmo_char_keep_deferred( uint32 char_id, struct mmo_charstatus* p );
 int32 char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf, uint8* count = nullptr);
+void char_charselect_invalidate( uint32 account_id );
+void char_charselect_clear( void );
 enum e_char_del_response char_delete(struct char_session_data* sd, uint32 char_id);
 int32 char_rename_char_sql(struct char_session_data *sd, uint32 char_id);
 int32 char_divorce_char_sql(int32 partner_id1, int32 partner_id2);
@@ -107,6 +107,8 @@ int32 chclif_parse_moveCharSlot( int32 fd, struct char_session_data* sd){
 		return 1;
 	}
 
+	char_charselect_invalidate( sd->account_id );
+
 	if( sd->found_char[to] > 0 ){
 		// We want to move to a used position
 		if( charserv_config.charmove_config.char_movetoused ){ // TODO: check if the target is in deletion process
@@ -611,6 +613,8 @@ int32 chclif_parse_char_delete2_req(int32 fd, struct char_session_data* sd) {
 			return 1;
 		}
 
+		char_charselect_invalidate( sd->account_id );
+
 		chclif_char_delete2_ack(fd, char_id, 1, delete_date);
 	}
 	return 1;
@@ -729,6 +733,8 @@ int32 chclif_parse_char_delete2_cancel(int32 fd, struct char_session_data* sd) {
 		return 1;
 	}
 
+	char_charselect_invalidate( sd->account_id );
+
 	chclif_char_delete2_cancel_ack(fd, char_id, 1);
 	return 1;
 }
@@ -763,6 +769,7 @@ int32 chclif_parse_maplogin(int32 fd){
 			map_server[i].maps = {};
 			session[fd]->func_parse = chmapif_parse;
 			session[fd]->flag.server = 1;
+			session[fd]->link = PACKET_LINK_MAP;
 			realloc_fifo(fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
 			chmapif_init(fd);
 		}
@@ -923,7 +930,7 @@ int32 chclif_parse_select_accessible_map( int32 fd, struct char_session_data* sd
 
 	struct mmo_charstatus char_dat;
 
-	if( !char_mmo_char_fromsql( char_id, &char_dat, true ) ) {
+	if( !char_mmo_char_fromsql( char_id, &char_dat, true, charserv_config.deferred_char_load ) ) {
 		/* failed? set it back offline */
 		char_set_char_offline( char_id, sd->account_id );
 		/* failed to load something. REJECT! */
@@ -1085,7 +1092,7 @@ int32 chclif_parse_charselect(int32 fd, struct char_session_data* sd,uint32 ipl)
 
 		/* set char as online prior to loading its data so 3rd party applications will realise the sql data is not reliable */
 		char_set_char_online(-2,char_id,sd->account_id);
-		if( !char_mmo_char_fromsql(char_id, &char_dat, true) ) { /* failed? set it back offline */
+		if( !char_mmo_char_fromsql(char_id, &char_dat, true, charserv_config.deferred_char_load) ) { /* failed? set it back offline */
 			char_set_char_offline(char_id, sd->account_id);
 			/* failed to load something. REJECT! */
 			chclif_reject(fd, 0); /* jump off this boat */
@@ -1448,6 +1455,7 @@ void chclif_block_character( int32 fd, struct char_session_data* sd){
 				sd->unban_time[i] = 0;
 				if( SQL_ERROR == Sql_Query(sql_handle, "UPDATE `%s` SET `unban_time`='0' WHERE `char_id`='%d' LIMIT 1", schema_config.char_db, sd->found_char[i]) )
 					Sql_ShowDebug(sql_handle);
+				char_charselect_invalidate( sd->account_id );
 			}
 			len+=24;
 			j++; //pkt list idx
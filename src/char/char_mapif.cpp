@@ -8,6 +8,7 @@
 #include <memory>
 
 #include <common/malloc.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/sql.hpp>
@@ -299,10 +300,7 @@ int32 chmapif_parse_askscdata(int32 fd){
 			int32 count;
 			char* data;
 
-			WFIFOHEAD(fd,14+50*sizeof(struct status_change_data));
-			WFIFOW(fd,0) = 0x2b1d;
-			WFIFOL(fd,4) = aid;
-			WFIFOL(fd,8) = cid;
+			WFIFOHEAD(fd,INTER_PACKET_SCDATA_HEADER+50*sizeof(struct status_change_data));
 			for( count = 0; count < 50 && SQL_SUCCESS == Sql_NextRow(sql_handle); ++count )
 			{
 				Sql_GetData(sql_handle, 0, &data, nullptr); scdata.type = atoi(data);
@@ -311,24 +309,15 @@ int32 chmapif_parse_askscdata(int32 fd){
 				Sql_GetData(sql_handle, 3, &data, nullptr); scdata.val2 = atoi(data);
 				Sql_GetData(sql_handle, 4, &data, nullptr); scdata.val3 = atoi(data);
 				Sql_GetData(sql_handle, 5, &data, nullptr); scdata.val4 = atoi(data);
-				memcpy(WFIFOP(fd, 14+count*sizeof(struct status_change_data)), &scdata, sizeof(struct status_change_data));
+				memcpy(WFIFOP(fd, INTER_PACKET_SCDATA_HEADER+count*sizeof(struct status_change_data)), &scdata, sizeof(struct status_change_data));
 			}
 			if (count >= 50)
 				ShowWarning("Too many status changes for %d:%d, some of them were not loaded.\n", aid, cid);
 			if (count > 0)
-			{
-				WFIFOW( fd, 2 ) = static_cast<int16>( 14 + count * sizeof( struct status_change_data ) );
-				WFIFOW(fd,12) = count;
-				WFIFOSET(fd,WFIFOW(fd,2));
-			}
+				WFIFOSET(fd, inter_packet_scdata_header(WFIFOP(fd, 0), aid, cid, count));
 		} else { // No Status Changes to load but still send a response
-			WFIFOHEAD(fd,14);
-			WFIFOW(fd,0) = 0x2b1d;
-			WFIFOW(fd,2) = 14;
-			WFIFOL(fd,4) = aid;
-			WFIFOL(fd,8) = cid;
-			WFIFOW(fd,12) = 0;
-			WFIFOSET(fd,WFIFOW(fd,2));
+			WFIFOHEAD(fd,INTER_PACKET_SCDATA_HEADER);
+			WFIFOSET(fd, inter_packet_scdata_header(WFIFOP(fd, 0), aid, cid, 0));
 		}
 		Sql_FreeResult(sql_handle);
 #endif
@@ -408,30 +397,29 @@ int32 chmapif_parse_regmapuser(int32 fd, int32 id){
 int32 chmapif_parse_reqsavechar(int32 fd, int32 id){
 	if (RFIFOREST(fd) < 4 || RFIFOREST(fd) < RFIFOW(fd,2))
 		return 0;
+	else if( inter_packet_reject( fd, RFIFOW( fd, 2 ) ) )
+		return 1;
 	else {
-		uint32 aid = RFIFOL( fd, 4 ), cid = RFIFOL( fd, 8 );
-		uint16 size = RFIFOW( fd, 2 );
-
-		if (size - 13 != sizeof(struct mmo_charstatus))
-		{
-			ShowError("parse_from_map (save-char): Size mismatch! %d != %" PRIuPTR "\n", size-13, sizeof(struct mmo_charstatus));
-			RFIFOSKIP(fd,size);
-			return 1;
-		}
+		struct PACKET_ZW_SAVE_CHAR* p = (struct PACKET_ZW_SAVE_CHAR*)RFIFOP( fd, 0 );
+		uint32 aid = p->account_id, cid = p->char_id;
 
 		std::shared_ptr<struct online_char_data> character = util::umap_find( char_get_onlinedb(), aid );
 
 		//Check account only if this ain't final save. Final-save goes through because of the char-map reconnect
-		if( RFIFOB( fd, 12 ) || RFIFOB( fd, 13 ) || ( character != nullptr && character->char_id == cid ) ){
-			struct mmo_charstatus char_dat;
-			memcpy(&char_dat, RFIFOP(fd,13), sizeof(struct mmo_charstatus));
-			char_mmo_char_tosql(cid, &char_dat);
+		if( p->quit || RFIFOB( fd, 13 ) || ( character != nullptr && character->char_id == cid ) ){
+			struct mmo_charstatus* status = (struct mmo_charstatus*)RFIFOP( fd, offsetof( struct PACKET_ZW_SAVE_CHAR, status ) );
+
+			if( p->deferred ){
+				char_mmo_char_keep_deferred( cid, status );
+			}
+
+			char_mmo_char_tosql( cid, status );
 		} else {	//This may be valid on char-server reconnection, when re-sending characters that already logged off.
 			ShowError("parse_from_map (save-char): Received data for non-existant/offline character (%d:%d).\n", aid, cid);
 			char_set_char_online(id, cid, aid);
 		}
 
-		if (RFIFOB(fd,12))
+		if (p->quit)
 		{	//Flag, set character offline after saving. [Skotlex]
 			char_set_char_offline(cid, aid);
 			WFIFOHEAD(fd,10);
@@ -440,7 +428,7 @@ int32 chmapif_parse_reqsavechar(int32 fd, int32 id){
 			WFIFOL(fd,6) = cid;
 			WFIFOSET(fd,10);
 		}
-		RFIFOSKIP(fd,size);
+		RFIFOSKIP(fd,p->packetLength);
 	}
 	return 1;
 }
@@ -1031,19 +1019,10 @@ int32 chmapif_parse_reqauth(int32 fd, int32 id){
 		}
 
 		if( global_core->is_running() && autotrade && cd ){
-			uint16 mmo_charstatus_len = sizeof(struct mmo_charstatus) + 25;
-
-			WFIFOHEAD(fd,mmo_charstatus_len);
-			WFIFOW(fd,0) = 0x2afd;
-			WFIFOW(fd,2) = mmo_charstatus_len;
-			WFIFOL(fd,4) = account_id;
-			WFIFOL(fd,8) = 0;
-			WFIFOL(fd,12) = 0;
-			WFIFOL(fd,16) = 0;
-			WFIFOL(fd,20) = 0;
-			WFIFOB(fd,24) = 0;
-			memcpy( WFIFOP( fd, 25 ), cd.get(), sizeof(struct mmo_charstatus));
-			WFIFOSET(fd, WFIFOW(fd,2));
+			WFIFOHEAD(fd,sizeof(struct PACKET_WZ_AUTH_OK));
+			struct PACKET_WZ_AUTH_OK* p = (struct PACKET_WZ_AUTH_OK*)WFIFOP( fd, 0 );
+			inter_packet_auth_ok( *p, account_id, 0, 0, 0, 0, false, char_mmo_char_is_deferred( char_id ), *cd );
+			WFIFOSET(fd, p->packetLength);
 
 			char_set_char_online(id, char_id, account_id);
 		} else if( global_core->is_running() &&
@@ -1058,19 +1037,11 @@ int32 chmapif_parse_reqauth(int32 fd, int32 id){
 #endif
 			)
 		{// auth ok
-			uint16 mmo_charstatus_len = sizeof(struct mmo_charstatus) + 25;
-
-			WFIFOHEAD(fd,mmo_charstatus_len);
-			WFIFOW(fd,0) = 0x2afd;
-			WFIFOW(fd,2) = mmo_charstatus_len;
-			WFIFOL(fd,4) = account_id;
-			WFIFOL(fd,8) = node->login_id1;
-			WFIFOL(fd,12) = node->login_id2;
-			WFIFOL(fd,16) = (uint32)node->expiration_time; // FIXME: will wrap to negative after "19-Jan-2038, 03:14:07 AM GMT"
-			WFIFOL(fd,20) = node->group_id;
-			WFIFOB(fd,24) = node->changing_mapservers;
-			memcpy( WFIFOP( fd, 25 ), cd.get(), sizeof( struct mmo_charstatus ) );
-			WFIFOSET(fd, WFIFOW(fd,2));
+			WFIFOHEAD(fd,sizeof(struct PACKET_WZ_AUTH_OK));
+			struct PACKET_WZ_AUTH_OK* p = (struct PACKET_WZ_AUTH_OK*)WFIFOP( fd, 0 );
+			// FIXME: expiration time will wrap to negative after "19-Jan-2038, 03:14:07 AM GMT"
+			inter_packet_auth_ok( *p, account_id, node->login_id1, node->login_id2, (uint32)node->expiration_time, node->group_id, node->changing_mapservers != 0, char_mmo_char_is_deferred( char_id ), *cd );
+			WFIFOSET(fd, p->packetLength);
 
 			// only use the auth once and mark user online
 			char_get_authdb().erase( account_id );
@@ -1231,6 +1202,8 @@ int32 chmapif_parse_reqcharban(int32 fd){
 				return 1;
 			}
 
+			char_charselect_invalidate( t_aid );
+
 			// condition applies; send to all map-servers to disconnect the player
 			if( unban_time > now ) {
 					unsigned char buf[11];
@@ -1260,7 +1233,47 @@ int32 chmapif_parse_reqcharunban(int32 fd){
 			Sql_ShowDebug(sql_handle);
 			return 1;
 		}
+
+		// The account is not known here
+		char_charselect_clear();
+	}
+	return 1;
+}
+
+/**
+ * ZW 0x2b2c
+ * <cmd>.W <char_id>.L
+ * WZ 0x2b29
+ * <cmd>.W <len>.W <char_id>.L <memo points>.?B <friends>.?B <hotkeys>.?B
+ * Sends the memo points, friends and hotkeys of a character that was authenticated without them
+ * @param fd
+ **/
+int32 chmapif_parse_req_deferred(int32 fd) {
+	if (RFIFOREST(fd) < 6)
+		return 0;
+
+	uint32 char_id = RFIFOL(fd,2);
+
+	RFIFOSKIP(fd,6);
+
+	std::shared_ptr<struct mmo_charstatus> cp = char_mmo_char_load_deferred( char_id );
+
+	if( cp == nullptr ){
+		return 1;
 	}
+
+	WFIFOHEAD(fd, sizeof(struct PACKET_WZ_CHAR_DEFERRED_DATA));
+	struct PACKET_WZ_CHAR_DEFERRED_DATA* p = (struct PACKET_WZ_CHAR_DEFERRED_DATA*)WFIFOP( fd, 0 );
+	p->packetType = HEADER_WZ_CHAR_DEFERRED_DATA;
+	p->packetLength = sizeof(struct PACKET_WZ_CHAR_DEFERRED_DATA);
+	p->char_id = char_id;
+	memcpy( WFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, memo_point ) ), cp->memo_point, sizeof( cp->memo_point ) );
+	memcpy( WFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, friends ) ), cp->friends, sizeof( cp->friends ) );
+#ifdef HOTKEY_SAVING
+	memcpy( WFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, hotkeys ) ), cp->hotkeys, sizeof( cp->hotkeys ) );
+#endif
+	WFIFOSET(fd, p->packetLength);
+
 	return 1;
 }
 
@@ -1415,6 +1428,14 @@ int32 chmapif_parse(int32 fd){
 
 	while(RFIFOREST(fd) >= 2){
 		int32 next=1;
+
+		// Compressed packets are expanded in place before they are parsed
+		switch( socket_compression_parse( fd ) ){
+			case 1: continue;
+			case 2: return 0;
+			case -1: set_eof( fd ); return 0;
+		}
+
 		switch(RFIFOW(fd,0)){
 			case 0x2afa: next=chmapif_parse_getmapname(fd,id); break;
 			case 0x2afc: next=chmapif_parse_askscdata(fd); break;
@@ -1441,7 +1462,7 @@ int32 chmapif_parse(int32 fd){
 			case 0x2b26: next=chmapif_parse_reqauth(fd,id); break;
 			case 0x2b28: next=chmapif_parse_reqcharban(fd); break; //charban
 			case 0x2b2a: next=chmapif_parse_reqcharunban(fd); break; //charunban
-			//case 0x2b2c: /*free*/; break;
+			case 0x2b2c: next=chmapif_parse_req_deferred(fd); break;
 			case 0x2b2d: next=chmapif_bonus_script_get(fd); break; //Load data
 			case 0x2b2e: next=chmapif_bonus_script_save(fd); break;//Save data
 			default:
@@ -1462,8 +1483,9 @@ int32 chmapif_parse(int32 fd){
 }
 
 
-// Initialization process (currently only initialization inter_mapif)
+// Initialization process
 int32 chmapif_init(int32 fd){
+	socket_compression_announce(fd);
 	return inter_mapif_init(fd);
 }
 
@@ -11,6 +11,7 @@
 #include <common/cbasetypes.hpp>
 #include <common/malloc.hpp>
 #include <common/mmo.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/strlib.hpp>
@@ -948,28 +949,33 @@ int32 mapif_guild_created( int32 fd, uint32 account_id, struct mmo_guild *g ){
 // Guild not found
 int32 mapif_guild_noinfo(int32 fd,int32 guild_id)
 {
-	unsigned char buf[12];
-	WBUFW(buf,0)=0x3831;
-	WBUFW(buf,2)=8;
+	unsigned char buf[INTER_PACKET_GUILD_INFO_EMPTY];
+	WBUFW(buf,0)=HEADER_IZ_GUILD_INFO;
+	WBUFW(buf,2)=INTER_PACKET_GUILD_INFO_EMPTY;
 	WBUFL(buf,4)=guild_id;
 	ShowWarning("int_guild: info not found %d\n",guild_id);
 	if(fd<0)
-		chmapif_sendall(buf,8);
+		chmapif_sendall(buf,INTER_PACKET_GUILD_INFO_EMPTY);
 	else
-		chmapif_send(fd,buf,8);
+		chmapif_send(fd,buf,INTER_PACKET_GUILD_INFO_EMPTY);
 	return 0;
 }
 
-// Send guild info
+// Send guild info, written straight into the send buffers instead of going through a copy
 int32 mapif_guild_info( int32 fd, const struct mmo_guild &g ){
-	unsigned char buf[8+sizeof(struct mmo_guild)];
-	WBUFW(buf,0)=0x3831;
-	WBUFW(buf,2)=4+sizeof(struct mmo_guild);
-	memcpy( buf + 4, &g, sizeof( struct mmo_guild ) );
-	if(fd<0)
-		chmapif_sendall(buf,WBUFW(buf,2));
-	else
-		chmapif_send(fd,buf,WBUFW(buf,2));
+	for( int32 i = 0; i < ARRAYLENGTH( map_server ); i++ ){
+		int32 map_fd = map_server[i].fd;
+
+		if( !session_isValid( map_fd ) || ( fd >= 0 && fd != map_fd ) )
+			continue;
+
+		WFIFOHEAD( map_fd, sizeof( struct PACKET_IZ_GUILD_INFO ) );
+		struct PACKET_IZ_GUILD_INFO* p = (struct PACKET_IZ_GUILD_INFO*)WFIFOP( map_fd, 0 );
+		p->packetType = HEADER_IZ_GUILD_INFO;
+		p->packetLength = sizeof( struct PACKET_IZ_GUILD_INFO );
+		p->guild = g;
+		WFIFOSET( map_fd, p->packetLength );
+	}
 	return 0;
 }
 
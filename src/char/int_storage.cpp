@@ -9,6 +9,7 @@
 
 #include <common/malloc.hpp>
 #include <common/mmo.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/sql.hpp>
@@ -199,24 +200,25 @@ bool mapif_load_guild_storage(int32 fd,uint32 account_id,int32 guild_id, char fl
 		Sql_ShowDebug(sql_handle);
 	else if( Sql_NumRows(sql_handle) > 0 )
 	{// guild exists
-		WFIFOHEAD(fd, sizeof(struct s_storage)+13);
-		WFIFOW(fd,0) = 0x3818;
-		WFIFOW(fd,2) = sizeof(struct s_storage)+13;
-		WFIFOL(fd,4) = account_id;
-		WFIFOL(fd,8) = guild_id;
-		WFIFOB(fd,12) = flag; //1 open storage, 0 don't open
-		guild_storage_fromsql(guild_id, (struct s_storage*)WFIFOP(fd,13));
-		WFIFOSET(fd, WFIFOW(fd,2));
+		WFIFOHEAD(fd, sizeof(struct PACKET_IZ_GUILD_STORAGE_DATA));
+		struct PACKET_IZ_GUILD_STORAGE_DATA* p = (struct PACKET_IZ_GUILD_STORAGE_DATA*)WFIFOP( fd, 0 );
+		p->packetType = HEADER_IZ_GUILD_STORAGE_DATA;
+		p->packetLength = sizeof(struct PACKET_IZ_GUILD_STORAGE_DATA);
+		p->account_id = account_id;
+		p->guild_id = guild_id;
+		p->open = flag; //1 open storage, 0 don't open
+		guild_storage_fromsql(guild_id, (struct s_storage*)WFIFOP( fd, offsetof( struct PACKET_IZ_GUILD_STORAGE_DATA, storage ) ));
+		WFIFOSET(fd, p->packetLength);
 		return true;
 	}
 	// guild does not exist
 	Sql_FreeResult(sql_handle);
-	WFIFOHEAD(fd, 12);
-	WFIFOW(fd,0) = 0x3818;
-	WFIFOW(fd,2) = 12;
+	WFIFOHEAD(fd, INTER_PACKET_GUILD_STORAGE_EMPTY);
+	WFIFOW(fd,0) = HEADER_IZ_GUILD_STORAGE_DATA;
+	WFIFOW(fd,2) = INTER_PACKET_GUILD_STORAGE_EMPTY;
 	WFIFOL(fd,4) = account_id;
 	WFIFOL(fd,8) = 0;
-	WFIFOSET(fd, 12);
+	WFIFOSET(fd, INTER_PACKET_GUILD_STORAGE_EMPTY);
 	return false;
 }
 
@@ -245,30 +247,20 @@ void mapif_parse_LoadGuildStorage(int32 fd)
  */
 bool mapif_parse_SaveGuildStorage(int32 fd)
 {
-	int32 guild_id;
-	int32 len;
+	struct PACKET_ZI_GUILD_STORAGE_SAVE* p = (struct PACKET_ZI_GUILD_STORAGE_SAVE*)RFIFOP( fd, 0 );
+	int32 guild_id = p->guild_id;
 
-	guild_id = RFIFOL(fd,8);
-	len = RFIFOW(fd,2);
-
-	if( sizeof(struct s_storage) != len - 12 )
-	{
-		ShowError("inter storage: data size error %" PRIuPTR " != %d\n", sizeof(struct s_storage), len - 12);
-	}
-	else
-	{
-		if( SQL_ERROR == Sql_Query(sql_handle, "SELECT `guild_id` FROM `%s` WHERE `guild_id`='%d'", schema_config.guild_db, guild_id) )
-			Sql_ShowDebug(sql_handle);
-		else if( Sql_NumRows(sql_handle) > 0 )
-		{// guild exists
-			Sql_FreeResult(sql_handle);
-			guild_storage_tosql(guild_id, (struct s_storage*)RFIFOP(fd,12));
-			mapif_save_guild_storage_ack(fd, RFIFOL(fd,4), guild_id, 0);
-			return false;
-		}
+	if( SQL_ERROR == Sql_Query(sql_handle, "SELECT `guild_id` FROM `%s` WHERE `guild_id`='%d'", schema_config.guild_db, guild_id) )
+		Sql_ShowDebug(sql_handle);
+	else if( Sql_NumRows(sql_handle) > 0 )
+	{// guild exists
 		Sql_FreeResult(sql_handle);
+		guild_storage_tosql(guild_id, (struct s_storage*)RFIFOP( fd, offsetof( struct PACKET_ZI_GUILD_STORAGE_SAVE, storage ) ));
+		mapif_save_guild_storage_ack(fd, p->account_id, guild_id, 0);
+		return false;
 	}
-	mapif_save_guild_storage_ack(fd, RFIFOL(fd,4), guild_id, 1);
+	Sql_FreeResult(sql_handle);
+	mapif_save_guild_storage_ack(fd, p->account_id, guild_id, 1);
 	return true;
 }
 
@@ -434,6 +426,8 @@ bool mapif_parse_itembound_retrieve(int32 fd)
 			mapif_itembound_ack(fd,account_id,guild_id);
 			return true;
 		}
+
+		char_charselect_invalidate( account_id );
 	}
 
 	char_unset_session_flag(account_id, 1);
@@ -446,25 +440,36 @@ bool mapif_parse_itembound_retrieve(int32 fd)
  *------------------------------------------*/
 
 /**
- * Sending inventory/cart/storage data to player
+ * Sending inventory/cart/storage data to player, it is loaded straight into the packet
  * IZ 0x388a <size>.W <type>.B <account_id>.L <result>.B <inventory>.?B
  * @param fd
  * @param account_id
+ * @param char_id
  * @param type
- * @param entries Inventory/cart/storage entries
- * @param result
+ * @param stor_id
+ * @param mode
  */
-void mapif_storage_data_loaded(int32 fd, uint32 account_id, char type, struct s_storage* entries, bool result) {
-	uint16 size = sizeof(struct s_storage) + 10;
-	
-	WFIFOHEAD(fd, size);
-	WFIFOW(fd, 0) = 0x388a;
-	WFIFOW(fd, 2) = size;
-	WFIFOB(fd, 4) = type;
-	WFIFOL(fd, 5) = account_id;
-	WFIFOB(fd, 9) = result;
-	memcpy(WFIFOP(fd, 10), entries, sizeof(struct s_storage));
-	WFIFOSET(fd, size);
+static void mapif_storage_data_load(int32 fd, uint32 account_id, uint32 char_id, char type, uint8 stor_id, uint8 mode) {
+	WFIFOHEAD(fd, sizeof(struct PACKET_IZ_STORAGE_DATA));
+	struct PACKET_IZ_STORAGE_DATA* p = (struct PACKET_IZ_STORAGE_DATA*)WFIFOP( fd, 0 );
+	struct s_storage* stor = (struct s_storage*)WFIFOP( fd, offsetof( struct PACKET_IZ_STORAGE_DATA, storage ) );
+
+	memset(stor, 0, sizeof(struct s_storage));
+	stor->stor_id = stor_id;
+
+	bool result = false;
+
+	switch (type) {
+		case TABLE_INVENTORY: result = inventory_fromsql(char_id, stor); break;
+		case TABLE_STORAGE:   result = storage_fromsql(account_id, stor); break;
+		case TABLE_CART:      result = cart_fromsql(char_id, stor);      break;
+	}
+
+	stor->state.put = (mode&STOR_MODE_PUT) ? 1 : 0;
+	stor->state.get = (mode&STOR_MODE_GET) ? 1 : 0;
+
+	inter_packet_storage_data(*p, type, account_id, result);
+	WFIFOSET(fd, p->packetLength);
 }
 
 /**
@@ -496,37 +501,28 @@ bool mapif_parse_StorageLoad(int32 fd) {
 	uint32 aid, cid;
 	int32 type;
 	uint8 stor_id, mode;
-	struct s_storage stor;
-	bool res = true;
 
 	type = RFIFOB(fd,2);
 	aid = RFIFOL(fd,3);
 	cid = RFIFOL(fd,7);
 	stor_id = RFIFOB(fd,11);
+	mode = RFIFOB(fd,12);
 
-	memset(&stor, 0, sizeof(struct s_storage));
-	stor.stor_id = stor_id;
-
-	//ShowInfo("Loading storage for AID=%d.\n", aid);
 	switch (type) {
-		case TABLE_INVENTORY: res = inventory_fromsql(cid, &stor); break;
+		case TABLE_INVENTORY:
+		case TABLE_CART:
+			break;
 		case TABLE_STORAGE:
 			if( !interServerDb.exists( stor_id ) ){
 				ShowError( "Invalid storage with id %d\n", stor_id );
 				return false;
 			}
-
-			res = storage_fromsql(aid, &stor);
 			break;
-		case TABLE_CART:      res = cart_fromsql(cid, &stor);      break;
 		default: return false;
 	}
 
-	mode = RFIFOB(fd, 12);
-	stor.state.put = (mode&STOR_MODE_PUT) ? 1 : 0;
-	stor.state.get = (mode&STOR_MODE_GET) ? 1 : 0;
-
-	mapif_storage_data_loaded(fd, aid, type, &stor, res);
+	//ShowInfo("Loading storage for AID=%d.\n", aid);
+	mapif_storage_data_load(fd, aid, cid, type, stor_id, mode);
 	return true;
 }
 
@@ -536,31 +532,29 @@ bool mapif_parse_StorageLoad(int32 fd) {
  * @param fd
  */
 bool mapif_parse_StorageSave(int32 fd) {
+	struct PACKET_ZI_STORAGE_SAVE* p = (struct PACKET_ZI_STORAGE_SAVE*)RFIFOP( fd, 0 );
 	int32 aid, cid, type;
-	struct s_storage stor;
+	struct s_storage* stor = (struct s_storage*)RFIFOP( fd, offsetof( struct PACKET_ZI_STORAGE_SAVE, storage ) );
 
-	type = RFIFOB(fd, 4);
-	aid = RFIFOL(fd, 5);
-	cid = RFIFOL(fd, 9);
-	
-	memset(&stor, 0, sizeof(struct s_storage));
-	memcpy(&stor, RFIFOP(fd, 13), sizeof(struct s_storage));
+	type = p->type;
+	aid = p->account_id;
+	cid = p->char_id;
 
 	//ShowInfo("Saving storage data for AID=%d.\n", aid);
 	switch(type){
-		case TABLE_INVENTORY:	inventory_tosql(cid, &stor); break;
+		case TABLE_INVENTORY:	inventory_tosql(cid, stor); break;
 		case TABLE_STORAGE:
-			if( !interServerDb.exists( stor.stor_id ) ){
-				ShowError( "Invalid storage with id %d\n", stor.stor_id );
+			if( !interServerDb.exists( stor->stor_id ) ){
+				ShowError( "Invalid storage with id %d\n", stor->stor_id );
 				return false;
 			}
 
-			storage_tosql(aid, &stor);
+			storage_tosql(aid, stor);
 			break;
-		case TABLE_CART:	cart_tosql(cid, &stor); break;
+		case TABLE_CART:	cart_tosql(cid, stor); break;
 		default: return false;
 	}
-	mapif_storage_saved(fd, aid, cid, true, type, stor.stor_id);
+	mapif_storage_saved(fd, aid, cid, true, type, stor->stor_id);
 	return false;
 }
 
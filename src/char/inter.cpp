@@ -15,6 +15,7 @@
 #include <common/cbasetypes.hpp>
 #include <common/database.hpp>
 #include <common/malloc.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/strlib.hpp>
@@ -677,14 +678,7 @@ int32 inter_accreg_fromsql(uint32 account_id, uint32 char_id, int32 fd, int32 ty
 	}
 
 	WFIFOHEAD(fd, 60000 + 300);
-	WFIFOW(fd, 0) = 0x3804;
-	// 0x2 = length, set prior to being sent
-	WFIFOL(fd, 4) = account_id;
-	WFIFOL(fd, 8) = char_id;
-	WFIFOB(fd, 12) = 0; // var type (only set when all vars have been sent, regardless of type)
-	WFIFOB(fd, 13) = 1; // is string type
-	WFIFOW(fd, 14) = 0; // count
-	plen = 16;
+	plen = inter_packet_registry_header(WFIFOP(fd, 0), account_id, char_id, true);
 
 	/**
 	 * Vessel!
@@ -724,14 +718,7 @@ int32 inter_accreg_fromsql(uint32 account_id, uint32 char_id, int32 fd, int32 ty
 
 			// prepare follow up
 			WFIFOHEAD(fd, 60000 + 300);
-			WFIFOW(fd, 0) = 0x3804;
-			// 0x2 = length, set prior to being sent
-			WFIFOL(fd, 4) = account_id;
-			WFIFOL(fd, 8) = char_id;
-			WFIFOB(fd, 12) = 0; // var type (only set when all vars have been sent, regardless of type)
-			WFIFOB(fd, 13) = 1; // is string type
-			WFIFOW(fd, 14) = 0; // count
-			plen = 16;
+			plen = inter_packet_registry_header(WFIFOP(fd, 0), account_id, char_id, true);
 		}
 	}
 
@@ -757,14 +744,7 @@ int32 inter_accreg_fromsql(uint32 account_id, uint32 char_id, int32 fd, int32 ty
 	}
 
 	WFIFOHEAD(fd, 60000 + 300);
-	WFIFOW(fd, 0) = 0x3804;
-	// 0x2 = length, set prior to being sent
-	WFIFOL(fd, 4) = account_id;
-	WFIFOL(fd, 8) = char_id;
-	WFIFOB(fd, 12) = 0; // var type (only set when all vars have been sent, regardless of type)
-	WFIFOB(fd, 13) = 0; // is int32 type
-	WFIFOW(fd, 14) = 0; // count
-	plen = 16;
+	plen = inter_packet_registry_header(WFIFOP(fd, 0), account_id, char_id, false);
 
 	/**
 	 * Vessel!
@@ -800,14 +780,7 @@ int32 inter_accreg_fromsql(uint32 account_id, uint32 char_id, int32 fd, int32 ty
 
 			/* prepare follow up */
 			WFIFOHEAD(fd, 60000 + 300);
-			WFIFOW(fd, 0) = 0x3804;
-			/* 0x2 = length, set prior to being sent */
-			WFIFOL(fd, 4) = account_id;
-			WFIFOL(fd, 8) = char_id;
-			WFIFOB(fd, 12) = 0;/* var type (only set when all vars have been sent, regardless of type) */
-			WFIFOB(fd, 13) = 0;/* is int32 type */
-			WFIFOW(fd, 14) = 0;/* count */
-			plen = 16;
+			plen = inter_packet_registry_header(WFIFOP(fd, 0), account_id, char_id, false);
 		}
 	}
 
@@ -1424,6 +1397,9 @@ int32 inter_parse_frommap(int32 fd)
 	if((len = inter_check_length(fd, inter_recv_packet_length[cmd - 0x3000])) == 0)
 		return 2;
 
+	if( inter_packet_reject( fd, len ) )
+		return 1;
+
 	switch(cmd) {
 	case 0x3000: mapif_parse_broadcast(fd); break;
 	case 0x3001: mapif_parse_WisRequest(fd); break;
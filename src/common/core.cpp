@@ -11,6 +11,7 @@
 #ifndef MINICORE
 #include "database.hpp"
 #include "ers.hpp"
+#include "profiler.hpp"
 #include "socket.hpp"
 #include "timer.hpp"
 #include "sql.hpp"
@@ -288,6 +289,14 @@ const char *get_git_hash (void) {
 	return GitHash;
 }
 
+#ifndef MINICORE
+/// Prints the collapsed console messages that were not followed by another message
+static TIMER_FUNC(showmsg_repeat_timer){
+	ShowRepeatedMessages();
+	return 0;
+}
+#endif
+
 /*======================================
  *	CORE : Display title
  *  ASCII By CalciumKid 1/12/2011
@@ -377,6 +386,14 @@ int32 Core::start( int32 argc, char **argv ){
 		return EXIT_FAILURE;
 	}
 
+#ifndef MINICORE
+	// The servers read console_msg_dedup during their initialization
+	if( console_msg_dedup ){
+		add_timer_func_list(showmsg_repeat_timer, "showmsg_repeat_timer");
+		add_timer_interval(gettick() + 1000, showmsg_repeat_timer, 0, 0, 1000);
+	}
+#endif
+
 	// If initialization did not trigger shutdown
 	if( this->m_status != e_core_status::STOPPING ){
 		this->set_status( e_core_status::SERVER_INITIALIZED );
@@ -389,6 +406,10 @@ int32 Core::start( int32 argc, char **argv ){
 				t_tick next = do_timer( gettick_nocache() );
 
 				this->handle_main( next );
+
+				if( profiler_enabled ){
+					profiler_tick_end();
+				}
 			}
 		}
 #endif
@@ -397,10 +418,12 @@ int32 Core::start( int32 argc, char **argv ){
 
 	this->set_status( e_core_status::SERVER_FINALIZING );
 	this->finalize();
+	ShowRepeatedMessages();
 	this->set_status( e_core_status::SERVER_FINALIZED );
 
 	this->set_status( e_core_status::CORE_FINALIZING );
 #ifndef MINICORE
+	profiler_final();
 	timer_final();
 	socket_final();
 	db_final();
@@ -408,6 +431,7 @@ int32 Core::start( int32 argc, char **argv ){
 #endif
 
 	malloc_final();
+	showmsg_final();
 	this->set_status( e_core_status::CORE_FINALIZED );
 
 #if defined(BUILDBOT)
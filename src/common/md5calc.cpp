@@ -20,8 +20,8 @@
 #define UINT_MAX 4294967295U
 #endif
 
-// Global variable
-static uint32 *pX;
+// Global variable, per thread since the login-server checks passwords on several threads
+static thread_local uint32 *pX;
 
 // String Table
 static const uint32 T[] = {
@@ -0,0 +1,93 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "metrics.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "showmsg.hpp"
+#include "sql.hpp"
+#include "strlib.hpp"
+
+int32 metrics_interval = 0; // seconds, 0 disables publishing
+char metrics_table[32] = "server_metrics";
+
+static std::vector<MetricsCollector> metrics_collectors;
+
+/**
+ * Registers a function that updates gauges which are too expensive to be kept up to date all the time.
+ * The collectors are called before the metrics are published.
+ * @param collector: Function to call
+ */
+void metrics_add_collector( MetricsCollector collector ){
+	metrics_collectors.push_back( collector );
+}
+
+/// Calls all collectors
+void metrics_collect(){
+	for( MetricsCollector collector : metrics_collectors ){
+		collector();
+	}
+}
+
+/**
+ * Reads the metrics settings of inter_athena.conf
+ * @param key: Setting name
+ * @param value: Setting value
+ * @return true if the setting belongs to the metrics
+ */
+bool metrics_config_read( const char* key, const char* value ){
+	if( strcmpi( key, "metrics_interval" ) == 0 ){
+		metrics_interval = atoi( value );
+		return true;
+	}
+
+	if( strcmpi( key, "metrics_table" ) == 0 ){
+		safestrncpy( metrics_table, value, sizeof( metrics_table ) );
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Writes the current value of all metrics of this server, so the web-server can expose them
+ * @param handle: SQL handle
+ * @param server: Name of this server, for example "map-server:5121"
+ * @return true on success
+ */
+bool metrics_save( Sql* handle, const char* server ){
+	const std::vector<Metric*>& metrics = metrics_registry();
+
+	if( metrics.empty() ){
+		return true;
+	}
+
+	metrics_collect();
+
+	char esc_server[2 * 32 + 1];
+	std::string query = "INSERT INTO `" + std::string( metrics_table ) + "` (`server`,`name`,`type`,`help`,`value`,`updated`) VALUES ";
+
+	Sql_EscapeStringLen( handle, esc_server, server, strnlen( server, 32 ) );
+
+	for( size_t i = 0; i < metrics.size(); i++ ){
+		const Metric* metric = metrics[i];
+		char esc_help[2 * 255 + 1];
+		char row[768];
+
+		Sql_EscapeStringLen( handle, esc_help, metric->getHelp(), strnlen( metric->getHelp(), 255 ) );
+		safesnprintf( row, sizeof( row ), "%s('%s','%s','%s','%s','%" PRId64 "',NOW())", ( i > 0 ? "," : "" ), esc_server, metric->getName(), metrics_type_name( metric->getType() ), esc_help, metric->value() );
+		query += row;
+	}
+
+	query += " ON DUPLICATE KEY UPDATE `type` = VALUES(`type`), `help` = VALUES(`help`), `value` = VALUES(`value`), `updated` = NOW()";
+
+	if( SQL_ERROR == Sql_QueryStr( handle, query.c_str() ) ){
+		Sql_ShowDebug( handle );
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "cbasetypes.hpp"
+
+struct Sql;
+
+// Amount of per-thread slots of a metric, additional threads share the slots
+#define METRICS_MAX_THREADS 16
+// Metrics that were not written for this many intervals belong to a server that stopped
+#define METRICS_STALE_INTERVALS 3
+
+enum e_metric_type : uint8 {
+	METRIC_COUNTER = 0,	// only increases
+	METRIC_GAUGE,		// current value, may go up and down
+};
+
+class Metric;
+
+/// Metrics are static objects of several translation units, so the registry has to exist before the first one is constructed
+inline std::vector<Metric*>& metrics_registry(){
+	static std::vector<Metric*> registry;
+
+	return registry;
+}
+
+/*
+ * Counter or gauge that is published to the web-server.
+ * Every thread adds to its own slot, so updates neither lock nor allocate.
+ * Metrics are meant to be defined as static objects, they are registered on construction.
+ */
+class Metric{
+private:
+	struct alignas(64) s_slot{
+		std::atomic<int64> value;
+	};
+
+	const char* name;
+	const char* help;
+	e_metric_type type;
+	s_slot slots[METRICS_MAX_THREADS];
+
+	/// Returns the slot of the calling thread, threads are assigned to the slots in the order of their first update
+	static size_t thread_slot(){
+		static std::atomic<size_t> next_slot{ 0 };
+		thread_local size_t slot = next_slot.fetch_add( 1, std::memory_order_relaxed ) % METRICS_MAX_THREADS;
+
+		return slot;
+	}
+
+public:
+	Metric( const char* name, const char* help, e_metric_type type ) : name( name ), help( help ), type( type ), slots{}{
+		metrics_registry().push_back( this );
+	}
+
+	Metric( const Metric& ) = delete;
+	Metric& operator=( const Metric& ) = delete;
+
+	void add( int64 value = 1 ){
+		this->slots[thread_slot()].value.fetch_add( value, std::memory_order_relaxed );
+	}
+
+	/**
+	 * Overwrites the value of a gauge.
+	 * Adds of other threads that happen at the same time may be lost, so a gauge that is set should have a single owner.
+	 * @param value: New value
+	 */
+	void set( int64 value ){
+		this->slots[0].value.store( value, std::memory_order_relaxed );
+
+		for( size_t i = 1; i < METRICS_MAX_THREADS; i++ ){
+			this->slots[i].value.store( 0, std::memory_order_relaxed );
+		}
+	}
+
+	/// Returns the sum of all threads
+	int64 value() const{
+		int64 value = 0;
+
+		for( const s_slot& slot : this->slots ){
+			value += slot.value.load( std::memory_order_relaxed );
+		}
+
+		return value;
+	}
+
+	const char* getName() const{
+		return this->name;
+	}
+
+	const char* getHelp() const{
+		return this->help;
+	}
+
+	e_metric_type getType() const{
+		return this->type;
+	}
+};
+
+inline const char* metrics_type_name( e_metric_type type ){
+	switch( type ){
+		case METRIC_COUNTER:
+			return "counter";
+		case METRIC_GAUGE:
+			return "gauge";
+		default:
+			return "untyped";
+	}
+}
+
+typedef void (*MetricsCollector)();
+
+extern int32 metrics_interval;
+extern char metrics_table[32];
+
+void metrics_add_collector( MetricsCollector collector );
+void metrics_collect();
+bool metrics_config_read( const char* key, const char* value );
+bool metrics_save( Sql* handle, const char* server );
+
+#endif /* METRICS_HPP */
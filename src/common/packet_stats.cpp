@@ -0,0 +1,167 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "packet_stats.hpp"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "profiler.hpp"
+#include "showmsg.hpp"
+#include "sql.hpp"
+#include "strlib.hpp"
+
+#define PACKET_STATS_SAVE_BATCH 500 // Maximum rows written by a single query
+
+/// Start of the current packet's parsing, set by do_sockets before a session's input is parsed, 0 otherwise
+uint64 packet_stats_parse_start = 0;
+
+// Allocated on first use, most servers only use two or three kinds of links
+static std::unique_ptr<s_packet_stats[]> packet_stats[PACKET_LINK_MAX];
+
+static const char* packet_stats_link_names[PACKET_LINK_MAX] = { "client", "login", "char", "map" };
+
+static inline s_packet_stats& packet_stats_entry( e_packet_link link, uint16 packet_id ){
+	if( packet_stats[link] == nullptr ){
+		packet_stats[link] = std::make_unique<s_packet_stats[]>( PACKET_STATS_MAX_ID );
+	}
+
+	return packet_stats[link][packet_id < PACKET_STATS_MAX_ID ? packet_id : PACKET_STATS_MAX_ID - 1];
+}
+
+/**
+ * Accounts a packet that was parsed.
+ * The parse time is the time since the previous packet of the session was skipped.
+ * @param link: Link the packet was received from
+ * @param packet_id: Packet id
+ * @param len: Packet length
+ */
+void packet_stats_recv( e_packet_link link, uint16 packet_id, size_t len ){
+	s_packet_stats& entry = packet_stats_entry( link, packet_id );
+
+	entry.recv_count++;
+	entry.recv_bytes += len;
+
+	if( packet_stats_parse_start != 0 ){
+		uint64 now = profiler_now();
+
+		entry.parse_time += now - packet_stats_parse_start;
+		packet_stats_parse_start = now;
+	}
+}
+
+/**
+ * Accounts a packet that was queued for sending
+ * @param link: Link the packet is sent to
+ * @param packet_id: Packet id
+ * @param len: Packet length
+ */
+void packet_stats_send( e_packet_link link, uint16 packet_id, size_t len ){
+	s_packet_stats& entry = packet_stats_entry( link, packet_id );
+
+	entry.send_count++;
+	entry.send_bytes += len;
+}
+
+/**
+ * Accounts a client packet that is sent to a group of sessions.
+ * Together with the send count this gives the average fan-out of the packet.
+ * @param packet_id: Packet id
+ */
+void packet_stats_broadcast( uint16 packet_id ){
+	packet_stats_entry( PACKET_LINK_CLIENT, packet_id ).broadcasts++;
+}
+
+/**
+ * Returns the statistics of a packet
+ * @param link: Link to look up
+ * @param packet_id: Packet id
+ * @return statistics or nullptr if nothing was accounted for the link yet
+ */
+const s_packet_stats* packet_stats_get( e_packet_link link, uint16 packet_id ){
+	if( packet_stats[link] == nullptr ){
+		return nullptr;
+	}
+
+	return &packet_stats[link][packet_id < PACKET_STATS_MAX_ID ? packet_id : PACKET_STATS_MAX_ID - 1];
+}
+
+/// Executes a multi-row upsert and clears it
+static bool packet_stats_save_batch( Sql* handle, std::string& query ){
+	bool success = true;
+
+	if( query.empty() ){
+		return true;
+	}
+
+	query += " ON DUPLICATE KEY UPDATE `recv_count` = VALUES(`recv_count`), `recv_bytes` = VALUES(`recv_bytes`), `parse_time` = VALUES(`parse_time`), "
+		"`send_count` = VALUES(`send_count`), `send_bytes` = VALUES(`send_bytes`), `broadcasts` = VALUES(`broadcasts`), `updated` = NOW()";
+
+	if( SQL_ERROR == Sql_QueryStr( handle, query.c_str() ) ){
+		Sql_ShowDebug( handle );
+		success = false;
+	}
+
+	query.clear();
+
+	return success;
+}
+
+/**
+ * Writes the statistics of all packets that were seen since the server started, so the web-server can show them
+ * @param handle: SQL handle
+ * @param table: Name of the packet statistics table
+ * @param server: Name of this server, for example "map-server:5121"
+ * @return true if all rows were written
+ */
+bool packet_stats_save( Sql* handle, const char* table, const char* server ){
+	char esc_server[2 * 32 + 1];
+	std::string query;
+	size_t rows = 0;
+	bool success = true;
+
+	Sql_EscapeStringLen( handle, esc_server, server, strnlen( server, 32 ) );
+
+	for( size_t link = 0; link < PACKET_LINK_MAX; link++ ){
+		if( packet_stats[link] == nullptr ){
+			continue;
+		}
+
+		for( uint16 packet_id = 0; packet_id < PACKET_STATS_MAX_ID; packet_id++ ){
+			const s_packet_stats& entry = packet_stats[link][packet_id];
+
+			if( entry.recv_count == 0 && entry.send_count == 0 ){
+				continue;
+			}
+
+			char row[256];
+
+			safesnprintf( row, sizeof( row ), "%s('%s','%s','%hu','%" PRIu64 "','%" PRIu64 "','%" PRIu64 "','%" PRIu64 "','%" PRIu64 "','%" PRIu64 "',NOW())",
+				( query.empty() ? "" : "," ), esc_server, packet_stats_link_names[link], packet_id,
+				entry.recv_count, entry.recv_bytes, entry.parse_time / 1000, entry.send_count, entry.send_bytes, entry.broadcasts );
+
+			if( query.empty() ){
+				query = "INSERT INTO `";
+				query += table;
+				query += "` (`server`,`link`,`packet_id`,`recv_count`,`recv_bytes`,`parse_time`,`send_count`,`send_bytes`,`broadcasts`,`updated`) VALUES ";
+			}
+
+			query += row;
+
+			if( ++rows % PACKET_STATS_SAVE_BATCH == 0 ){
+				success &= packet_stats_save_batch( handle, query );
+			}
+		}
+	}
+
+	success &= packet_stats_save_batch( handle, query );
+
+	return success;
+}
+
+void packet_stats_final(){
+	for( auto& stats : packet_stats ){
+		stats.reset();
+	}
+}
@@ -0,0 +1,41 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef PACKET_STATS_HPP
+#define PACKET_STATS_HPP
+
+#include "cbasetypes.hpp"
+
+struct Sql;
+
+/// Kind of connection a packet was received from or sent to
+enum e_packet_link : uint8 {
+	PACKET_LINK_CLIENT = 0,
+	PACKET_LINK_LOGIN,	// login-server link
+	PACKET_LINK_CHAR,	// char-server link
+	PACKET_LINK_MAP,	// map-server link
+	PACKET_LINK_MAX
+};
+
+// Packet ids above this limit share the last entry
+#define PACKET_STATS_MAX_ID 0x4000
+
+struct s_packet_stats {
+	uint64 recv_count;
+	uint64 recv_bytes;
+	uint64 parse_time; // nanoseconds
+	uint64 send_count;
+	uint64 send_bytes;
+	uint64 broadcasts; // sends that were fanned out to several sessions, see packet_stats_broadcast
+};
+
+extern uint64 packet_stats_parse_start;
+
+void packet_stats_recv(e_packet_link link, uint16 packet_id, size_t len);
+void packet_stats_send(e_packet_link link, uint16 packet_id, size_t len);
+void packet_stats_broadcast(uint16 packet_id);
+const s_packet_stats* packet_stats_get(e_packet_link link, uint16 packet_id);
+bool packet_stats_save(Sql* handle, const char* table, const char* server);
+void packet_stats_final();
+
+#endif /* PACKET_STATS_HPP */
@@ -0,0 +1,264 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef PACKETS_INTER_HPP
+#define PACKETS_INTER_HPP
+
+#include <common/cbasetypes.hpp>
+#include <common/mmo.hpp>
+#include <common/showmsg.hpp>
+#include <common/socket.hpp>
+
+/*
+ * Layouts of the large packets between the map-server and the char-server.
+ * Both sides read and write them in place in the socket buffers, so the structs they carry
+ * are not copied on the way. The sizes of the structs are the only source of the packet lengths,
+ * which inter_packet_check checks before a packet is handed to its parser.
+ */
+
+#define DEFINE_INTER_PACKET_HEADER( name, id ) const int16 HEADER_##name = id
+
+// NetBSD 5 and Solaris don't like pragma pack but accept the packed attribute
+#if !defined( sun ) && ( !defined( __NETBSD__ ) || __NetBSD_Version__ >= 600000000 )
+	#pragma pack( push, 1 )
+#endif
+
+/// Char-server -> map-server: authentication of a character was accepted
+struct PACKET_WZ_AUTH_OK{
+	int16 packetType;
+	uint16 packetLength;
+	uint32 account_id;
+	uint32 login_id1;
+	uint32 login_id2;
+	uint32 expiration_time;
+	uint32 group_id;
+	uint8 changing_mapservers;
+	uint8 deferred; // memo points, friends and hotkeys are missing and have to be requested
+	struct mmo_charstatus status;
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( WZ_AUTH_OK, 0x2afd );
+
+/// Map-server -> char-server: save a character
+struct PACKET_ZW_SAVE_CHAR{
+	int16 packetType;
+	uint16 packetLength;
+	uint32 account_id;
+	uint32 char_id;
+	uint8 quit;
+	struct mmo_charstatus status;
+	uint8 deferred; // memo points, friends and hotkeys were not received yet and must not be saved
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( ZW_SAVE_CHAR, 0x2b01 );
+
+/// Char-server -> map-server: deferred parts of a character
+struct PACKET_WZ_CHAR_DEFERRED_DATA{
+	int16 packetType;
+	uint16 packetLength;
+	uint32 char_id;
+	struct s_point_str memo_point[MAX_MEMOPOINTS];
+	struct s_friend friends[MAX_FRIENDS];
+#ifdef HOTKEY_SAVING
+	struct hotkey hotkeys[MAX_HOTKEYS_DB];
+#endif
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( WZ_CHAR_DEFERRED_DATA, 0x2b29 );
+
+/// Map-server -> inter-server: save a guild storage
+struct PACKET_ZI_GUILD_STORAGE_SAVE{
+	int16 packetType;
+	uint16 packetLength;
+	uint32 account_id;
+	uint32 guild_id;
+	struct s_storage storage;
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( ZI_GUILD_STORAGE_SAVE, 0x3019 );
+
+/// Map-server -> inter-server: save an inventory, cart or storage
+struct PACKET_ZI_STORAGE_SAVE{
+	int16 packetType;
+	uint16 packetLength;
+	uint8 type;
+	uint32 account_id;
+	uint32 char_id;
+	struct s_storage storage;
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( ZI_STORAGE_SAVE, 0x308b );
+
+/// Inter-server -> map-server: guild storage, without the storage if the guild does not exist
+struct PACKET_IZ_GUILD_STORAGE_DATA{
+	int16 packetType;
+	uint16 packetLength;
+	uint32 account_id;
+	uint32 guild_id;
+	uint8 open;
+	struct s_storage storage;
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( IZ_GUILD_STORAGE_DATA, 0x3818 );
+
+/// Inter-server -> map-server: guild information, without the guild if it does not exist
+struct PACKET_IZ_GUILD_INFO{
+	int16 packetType;
+	uint16 packetLength;
+	struct mmo_guild guild; // only the guild ID if the guild does not exist
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( IZ_GUILD_INFO, 0x3831 );
+
+/// Inter-server -> map-server: inventory, cart or storage
+struct PACKET_IZ_STORAGE_DATA{
+	int16 packetType;
+	uint16 packetLength;
+	uint8 type;
+	uint32 account_id;
+	uint8 result;
+	struct s_storage storage;
+} __attribute__((packed));
+DEFINE_INTER_PACKET_HEADER( IZ_STORAGE_DATA, 0x388a );
+
+#if !defined( sun ) && ( !defined( __NETBSD__ ) || __NetBSD_Version__ >= 600000000 )
+	#pragma pack( pop )
+#endif
+
+// Sizes of the short forms that leave out the trailing struct
+#define INTER_PACKET_GUILD_STORAGE_EMPTY 12
+#define INTER_PACKET_GUILD_INFO_EMPTY 8
+
+// Sizes of the headers of packets that are followed by a variable amount of entries
+#define INTER_PACKET_REGISTRY_HEADER 16
+#define INTER_PACKET_SCDATA_HEADER 14
+
+DEFINE_INTER_PACKET_HEADER( WZ_STATUS_CHANGE_DATA, 0x2b1d );
+DEFINE_INTER_PACKET_HEADER( IZ_REGISTRY, 0x3804 );
+
+/**
+ * Checks the length of a dynamic length inter-server packet that is sent with a fixed layout.
+ * @param cmd: Packet type
+ * @param length: Length the packet claims to have
+ * @return false if the packet does not have the layout's length, true otherwise or if the packet has no layout
+ */
+static inline bool inter_packet_check( int16 cmd, size_t length ){
+	switch( cmd ){
+		case HEADER_WZ_AUTH_OK:
+			return length == sizeof( struct PACKET_WZ_AUTH_OK );
+		case HEADER_ZW_SAVE_CHAR:
+			return length == sizeof( struct PACKET_ZW_SAVE_CHAR );
+		case HEADER_WZ_CHAR_DEFERRED_DATA:
+			return length == sizeof( struct PACKET_WZ_CHAR_DEFERRED_DATA );
+		case HEADER_ZI_GUILD_STORAGE_SAVE:
+			return length == sizeof( struct PACKET_ZI_GUILD_STORAGE_SAVE );
+		case HEADER_ZI_STORAGE_SAVE:
+			return length == sizeof( struct PACKET_ZI_STORAGE_SAVE );
+		case HEADER_IZ_GUILD_STORAGE_DATA:
+			return length == sizeof( struct PACKET_IZ_GUILD_STORAGE_DATA ) || length == INTER_PACKET_GUILD_STORAGE_EMPTY;
+		case HEADER_IZ_GUILD_INFO:
+			return length == sizeof( struct PACKET_IZ_GUILD_INFO ) || length == INTER_PACKET_GUILD_INFO_EMPTY;
+		case HEADER_IZ_STORAGE_DATA:
+			return length == sizeof( struct PACKET_IZ_STORAGE_DATA );
+		default:
+			return true;
+	}
+}
+
+/**
+ * Rejects an inter-server packet whose length does not match its layout.
+ * The packet is skipped, so the parser can continue with the next one.
+ * @param fd: Server link
+ * @param length: Length of the packet, which has to be in the receive buffer
+ * @return true if the packet was rejected
+ */
+static inline bool inter_packet_reject( int32 fd, size_t length ){
+	int16 cmd = RFIFOW( fd, 0 );
+
+	if( inter_packet_check( cmd, length ) ){
+		return false;
+	}
+
+	ShowError( "Rejected packet 0x%04x with invalid length %" PRIuPTR " from server connection #%d. Do both servers use the same version?\n", cmd, length, fd );
+	RFIFOSKIP( fd, length );
+
+	return true;
+}
+
+/**
+ * Fills in an accepted authentication.
+ * @param p: Packet
+ * @param account_id: Account of the character
+ * @param login_id1: First login id of the session
+ * @param login_id2: Second login id of the session
+ * @param expiration_time: Expiration time of the account
+ * @param group_id: Group of the account
+ * @param changing_mapservers: Whether the character comes from another map-server
+ * @param deferred: Whether the deferred parts of the character are sent separately
+ * @param status: Character
+ */
+static inline void inter_packet_auth_ok( struct PACKET_WZ_AUTH_OK& p, uint32 account_id, uint32 login_id1, uint32 login_id2, uint32 expiration_time, uint32 group_id, bool changing_mapservers, bool deferred, const struct mmo_charstatus& status ){
+	p.packetType = HEADER_WZ_AUTH_OK;
+	p.packetLength = sizeof( struct PACKET_WZ_AUTH_OK );
+	p.account_id = account_id;
+	p.login_id1 = login_id1;
+	p.login_id2 = login_id2;
+	p.expiration_time = expiration_time;
+	p.group_id = group_id;
+	p.changing_mapservers = changing_mapservers;
+	p.deferred = deferred;
+	p.status = status;
+}
+
+/**
+ * Fills in the head of an inventory, cart or storage, the storage itself is filled in by the caller.
+ * @param p: Packet
+ * @param type: Type of the storage
+ * @param account_id: Owner of the storage
+ * @param result: Whether the storage was loaded
+ */
+static inline void inter_packet_storage_data( struct PACKET_IZ_STORAGE_DATA& p, uint8 type, uint32 account_id, bool result ){
+	p.packetType = HEADER_IZ_STORAGE_DATA;
+	p.packetLength = sizeof( struct PACKET_IZ_STORAGE_DATA );
+	p.type = type;
+	p.account_id = account_id;
+	p.result = result;
+}
+
+/**
+ * Writes the header of a registry packet without entries.
+ * IZ 0x3804 <size>.W <account_id>.L <char_id>.L <type>.B <is string>.B <count>.W
+ * The type is only set on the last packet of a registry, the caller updates size and count while adding entries.
+ * @param buf: Packet buffer
+ * @param account_id: Account of the registry
+ * @param char_id: Character of the registry
+ * @param is_string: Whether the entries are strings
+ * @return size of the header
+ */
+static inline uint16 inter_packet_registry_header( uint8* buf, uint32 account_id, uint32 char_id, bool is_string ){
+	WBUFW( buf, 0 ) = HEADER_IZ_REGISTRY;
+	WBUFW( buf, 2 ) = INTER_PACKET_REGISTRY_HEADER;
+	WBUFL( buf, 4 ) = account_id;
+	WBUFL( buf, 8 ) = char_id;
+	WBUFB( buf, 12 ) = 0;
+	WBUFB( buf, 13 ) = is_string;
+	WBUFW( buf, 14 ) = 0;
+
+	return INTER_PACKET_REGISTRY_HEADER;
+}
+
+/**
+ * Writes the header of the saved status changes of a character, the entries follow the header.
+ * WZ 0x2b1d <size>.W <account_id>.L <char_id>.L <count>.W { <status_change_data> }*count
+ * @param buf: Packet buffer
+ * @param account_id: Account of the character
+ * @param char_id: Character
+ * @param count: Amount of status changes
+ * @return size of the packet
+ */
+static inline uint16 inter_packet_scdata_header( uint8* buf, uint32 account_id, uint32 char_id, uint16 count ){
+	uint16 length = static_cast<uint16>( INTER_PACKET_SCDATA_HEADER + count * sizeof( struct status_change_data ) );
+
+	WBUFW( buf, 0 ) = HEADER_WZ_STATUS_CHANGE_DATA;
+	WBUFW( buf, 2 ) = length;
+	WBUFL( buf, 4 ) = account_id;
+	WBUFL( buf, 8 ) = char_id;
+	WBUFW( buf, 12 ) = count;
+
+	return length;
+}
+
+#endif /* PACKETS_INTER_HPP */
@@ -0,0 +1,165 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+#include "showmsg.hpp"
+#include "strlib.hpp"
+
+bool profiler_enabled = false;
+t_tick profiler_slow_tick = 0; // milliseconds, 0 disables the slow tick trace
+
+static std::unordered_map<uintptr_t, s_profile_entry> profiler_entries[PROFILE_MAX];
+// Entries that were used during the current tick
+static std::vector<std::pair<e_profile_group, s_profile_entry*>> profiler_tick_entries;
+
+/// Returns a monotonic timestamp in nanoseconds
+uint64 profiler_now(){
+	return static_cast<uint64>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+/**
+ * Records a call that started at the given timestamp and ends now
+ * @param group: Group of the key
+ * @param key: Timer function or packet id
+ * @param start: Timestamp from profiler_now
+ */
+void profiler_record( e_profile_group group, uintptr_t key, uint64 start ){
+	uint64 elapsed = profiler_now() - start;
+	s_profile_entry& entry = profiler_entries[group][key];
+
+	entry.calls++;
+	entry.total += elapsed;
+	entry.max = std::max( entry.max, elapsed );
+
+	size_t bucket = 0;
+
+	for( uint64 limit = 10000; bucket < PROFILE_HISTOGRAM_BUCKETS - 1 && elapsed >= limit; limit *= 10 ){
+		bucket++;
+	}
+
+	entry.histogram[bucket]++;
+
+	if( entry.tick_calls == 0 ){
+		profiler_tick_entries.emplace_back( group, &entry );
+	}
+
+	entry.tick_calls++;
+	entry.tick_total += elapsed;
+}
+
+/// Returns a printable name for a profiled key
+static std::string profiler_name( e_profile_group group, uintptr_t key ){
+	char name[64];
+
+	switch( group ){
+		case PROFILE_TIMER:
+			return search_timer_func_list( reinterpret_cast<TimerFunc>( key ) );
+		case PROFILE_PACKET:
+			safesnprintf( name, sizeof( name ), "packet 0x%04x", static_cast<uint32>( key ) );
+			return name;
+		default:
+			return "unknown";
+	}
+}
+
+/// Returns the key of an entry, only used for reporting so a lookup is fine
+static uintptr_t profiler_key( e_profile_group group, const s_profile_entry* entry ){
+	for( const auto& it : profiler_entries[group] ){
+		if( &it.second == entry ){
+			return it.first;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Ends the current tick.
+ * If the time spent in profiled calls exceeds the slow tick threshold, the top offenders are reported.
+ */
+void profiler_tick_end(){
+	if( profiler_tick_entries.empty() ){
+		return;
+	}
+
+	uint64 total = 0;
+
+	for( const auto& it : profiler_tick_entries ){
+		total += it.second->tick_total;
+	}
+
+	if( profiler_slow_tick > 0 && total >= static_cast<uint64>( profiler_slow_tick ) * 1000000 ){
+		size_t count = std::min<size_t>( 5, profiler_tick_entries.size() );
+
+		std::partial_sort( profiler_tick_entries.begin(), profiler_tick_entries.begin() + count, profiler_tick_entries.end(), []( const auto& a, const auto& b ){
+			return a.second->tick_total > b.second->tick_total;
+		} );
+
+		std::string offenders;
+
+		for( size_t i = 0; i < count; i++ ){
+			const auto& it = profiler_tick_entries[i];
+			char buf[128];
+
+			safesnprintf( buf, sizeof( buf ), "%s%s: %.2fms/%" PRIu64, ( i > 0 ? ", " : "" ), profiler_name( it.first, profiler_key( it.first, it.second ) ).c_str(), it.second->tick_total / 1000000.0, it.second->tick_calls );
+			offenders += buf;
+		}
+
+		ShowWarning( "Slow tick: %.2fms spent in %" PRIuPTR " profiled functions (%s).\n", total / 1000000.0, profiler_tick_entries.size(), offenders.c_str() );
+	}
+
+	for( const auto& it : profiler_tick_entries ){
+		it.second->tick_calls = 0;
+		it.second->tick_total = 0;
+	}
+
+	profiler_tick_entries.clear();
+}
+
+/// Discards all collected data
+void profiler_reset(){
+	profiler_tick_entries.clear();
+
+	for( auto& entries : profiler_entries ){
+		entries.clear();
+	}
+}
+
+/**
+ * Builds a report of the entries of a group that took the most time
+ * @param group: Group to report
+ * @param count: Maximum amount of entries
+ * @param lines: Report lines are appended here
+ */
+void profiler_report( e_profile_group group, size_t count, std::vector<std::string>& lines ){
+	std::vector<std::pair<uintptr_t, const s_profile_entry*>> entries;
+
+	for( const auto& it : profiler_entries[group] ){
+		entries.emplace_back( it.first, &it.second );
+	}
+
+	count = std::min( count, entries.size() );
+
+	std::partial_sort( entries.begin(), entries.begin() + count, entries.end(), []( const auto& a, const auto& b ){
+		return a.second->total > b.second->total;
+	} );
+
+	for( size_t i = 0; i < count; i++ ){
+		const s_profile_entry* entry = entries[i].second;
+		char line[256];
+
+		safesnprintf( line, sizeof( line ), "%s: %" PRIu64 " calls, %.2fms total, %.1fus avg, %.2fms max [%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 "]",
+			profiler_name( group, entries[i].first ).c_str(), entry->calls, entry->total / 1000000.0, entry->total / 1000.0 / entry->calls, entry->max / 1000000.0,
+			entry->histogram[0], entry->histogram[1], entry->histogram[2], entry->histogram[3], entry->histogram[4], entry->histogram[5], entry->histogram[6] );
+		lines.push_back( line );
+	}
+}
+
+void profiler_final(){
+	profiler_reset();
+}
@@ -0,0 +1,43 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <vector>
+
+#include "cbasetypes.hpp"
+#include "timer.hpp"
+
+enum e_profile_group : uint8 {
+	PROFILE_TIMER = 0,	// timer functions, keyed by TimerFunc
+	PROFILE_PACKET,		// client packet handlers, keyed by packet id
+	PROFILE_MAX
+};
+
+// Histogram buckets: <10us, <100us, <1ms, <10ms, <100ms, <1s, >=1s
+#define PROFILE_HISTOGRAM_BUCKETS 7
+
+struct s_profile_entry {
+	uint64 calls;
+	uint64 total; // nanoseconds
+	uint64 max; // nanoseconds
+	uint64 histogram[PROFILE_HISTOGRAM_BUCKETS];
+
+	// Current tick, used by the slow tick trace
+	uint64 tick_calls;
+	uint64 tick_total;
+};
+
+extern bool profiler_enabled;
+extern t_tick profiler_slow_tick;
+
+uint64 profiler_now();
+void profiler_record(e_profile_group group, uintptr_t key, uint64 start);
+void profiler_tick_end();
+void profiler_reset();
+void profiler_report(e_profile_group group, size_t count, std::vector<std::string>& lines);
+void profiler_final();
+
+#endif /* PROFILER_HPP */
@@ -3,9 +3,43 @@
 
 #include "random.hpp"
 
-std::uniform_int_distribution<int32> int31_distribution = std::uniform_int_distribution<int32>(0, SINT32_MAX);
+/// Reseeds all streams from a single seed, each stream being a non-overlapping part of the same sequence
+void rnd_seed( uint64 seed ){
+	xoshiro256ss engine( seed );
+
+	for( xoshiro256ss& stream : rnd_streams ){
+		stream = engine;
+		engine.jump();
+	}
+}
 
 /// Generates a random number in the interval [0, SINT32_MAX]
-int32 rnd( void ){
-	return int31_distribution( generator );
+int32 rnd( e_random_stream stream ){
+	return static_cast<int32>( rnd_streams[stream]() >> 33 );
+}
+
+/// Generates an unbiased random number in the interval [0, bound)
+int32 rnd_bounded( int32 bound, e_random_stream stream ){
+	if( bound <= 0 ){
+		return 0;
+	}
+
+	return static_cast<int32>( rnd_range32( rnd_streams[stream], static_cast<uint32>( bound ) ) );
+}
+
+/// Fills a buffer with random numbers, two values per generator call
+void rnd_fill( uint32* buffer, size_t count, e_random_stream stream ){
+	xoshiro256ss& engine = rnd_streams[stream];
+	size_t i = 0;
+
+	for( ; i + 1 < count; i += 2 ){
+		uint64 value = engine();
+
+		buffer[i] = static_cast<uint32>( value );
+		buffer[i + 1] = static_cast<uint32>( value >> 32 );
+	}
+
+	if( i < count ){
+		buffer[i] = static_cast<uint32>( engine() >> 32 );
+	}
 }
@@ -5,28 +5,163 @@
 #define RANDOM_HPP
 
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <type_traits>
 #include <vector>
 
 #include "cbasetypes.hpp"
 
+/*
+ * xoshiro256** pseudo random number generator (Blackman/Vigna)
+ * Satisfies UniformRandomBitGenerator, so it can be used with the std distributions and algorithms.
+ */
+class xoshiro256ss {
+private:
+	uint64 s[4];
+
+	static inline uint64 rotl( uint64 x, int32 k ){
+		return ( x << k ) | ( x >> ( 64 - k ) );
+	}
+
+public:
+	using result_type = uint64;
+
+	static constexpr result_type min(){
+		return std::numeric_limits<result_type>::min();
+	}
+
+	static constexpr result_type max(){
+		return std::numeric_limits<result_type>::max();
+	}
+
+	xoshiro256ss( uint64 seed = 0 ){
+		this->seed( seed );
+	}
+
+	xoshiro256ss( uint64 s0, uint64 s1, uint64 s2, uint64 s3 ) : s{ s0, s1, s2, s3 }{
+	}
+
+	/// Expands a single 64bit seed into the full state using splitmix64
+	void seed( uint64 seed ){
+		for( uint64& word : this->s ){
+			uint64 z = ( seed += 0x9e3779b97f4a7c15ULL );
+
+			z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+			z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+			word = z ^ ( z >> 31 );
+		}
+	}
+
+	result_type operator()(){
+		const uint64 result = rotl( this->s[1] * 5, 7 ) * 9;
+		const uint64 t = this->s[1] << 17;
+
+		this->s[2] ^= this->s[0];
+		this->s[3] ^= this->s[1];
+		this->s[1] ^= this->s[2];
+		this->s[0] ^= this->s[3];
+		this->s[2] ^= t;
+		this->s[3] = rotl( this->s[3], 45 );
+
+		return result;
+	}
+
+	/// Advances the state by 2^128 calls, used to split the sequence into non-overlapping streams
+	void jump(){
+		static const uint64 JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+		uint64 t[4] = {};
+
+		for( uint64 word : JUMP ){
+			for( int32 b = 0; b < 64; b++ ){
+				if( word & ( 1ULL << b ) ){
+					for( size_t i = 0; i < 4; i++ ){
+						t[i] ^= this->s[i];
+					}
+				}
+				(*this)();
+			}
+		}
+
+		for( size_t i = 0; i < 4; i++ ){
+			this->s[i] = t[i];
+		}
+	}
+};
+
+/// Independent random streams, so that one subsystem's draws do not shift the sequence of another
+enum e_random_stream : uint8 {
+	RND_STREAM_DEFAULT = 0,
+	RND_STREAM_DROP,
+	RND_STREAM_SKILL,
+	RND_STREAM_AI,
+	RND_STREAM_MAX
+};
+
 inline std::random_device device;
-inline std::mt19937 generator = std::mt19937(device());
+inline xoshiro256ss rnd_streams[RND_STREAM_MAX] = {
+	xoshiro256ss( ( static_cast<uint64>( device() ) << 32 ) | device() ),
+	xoshiro256ss( ( static_cast<uint64>( device() ) << 32 ) | device() ),
+	xoshiro256ss( ( static_cast<uint64>( device() ) << 32 ) | device() ),
+	xoshiro256ss( ( static_cast<uint64>( device() ) << 32 ) | device() ),
+};
+inline xoshiro256ss& generator = rnd_streams[RND_STREAM_DEFAULT];
 
-int32 rnd(void);// [0, SINT32_MAX]
+void rnd_seed( uint64 seed );
+int32 rnd( e_random_stream stream = RND_STREAM_DEFAULT );// [0, SINT32_MAX]
+int32 rnd_bounded( int32 bound, e_random_stream stream = RND_STREAM_DEFAULT );// [0, bound)
+void rnd_fill( uint32* buffer, size_t count, e_random_stream stream = RND_STREAM_DEFAULT );
+
+/*
+ * Draws an unbiased random number in the interval [0, range)
+ * Uses Lemire's multiply-shift method, which only needs a division in the rare case of a rejection.
+ * @param range: size of the interval, 0 means the full 32bit range
+ * @return random number
+ */
+inline uint32 rnd_range32( xoshiro256ss& engine, uint32 range ){
+	uint32 x = static_cast<uint32>( engine() >> 32 );
+
+	if( range == 0 ){
+		return x;
+	}
+
+	uint64 m = static_cast<uint64>( x ) * range;
+	uint32 l = static_cast<uint32>( m );
+
+	if( l < range ){
+		uint32 threshold = ( 0u - range ) % range;
+
+		while( l < threshold ){
+			x = static_cast<uint32>( engine() >> 32 );
+			m = static_cast<uint64>( x ) * range;
+			l = static_cast<uint32>( m );
+		}
+	}
+
+	return static_cast<uint32>( m >> 32 );
+}
 
 /*
  * Generates a random number in the interval [min, max]
  * @return random number
  */
 template <typename T>
-typename std::enable_if<std::is_integral<T>::value, T>::type rnd_value(T min, T max) {
+typename std::enable_if<std::is_integral<T>::value, T>::type rnd_value(T min, T max, e_random_stream stream = RND_STREAM_DEFAULT) {
 	if (min > max) {
 		std::swap(min, max);
 	}
-	std::uniform_int_distribution<T> dist(min, max);
-	return dist(generator);
+
+	xoshiro256ss& engine = rnd_streams[stream];
+
+	if constexpr( sizeof( T ) <= sizeof( uint32 ) ){
+		// Wraps to 0 for the full 32bit range, which rnd_range32 treats as such
+		uint32 range = static_cast<uint32>( static_cast<uint64>( static_cast<int64>( max ) - static_cast<int64>( min ) ) + 1 );
+
+		return static_cast<T>( static_cast<int64>( min ) + rnd_range32( engine, range ) );
+	}else{
+		std::uniform_int_distribution<T> dist(min, max);
+		return dist(engine);
+	}
 }
 
 /*
@@ -34,8 +169,8 @@ typename std::enable_if<std::is_integral<T>::value, T>::type rnd_value(T min, T
  * @return true if succeeded / false if it didn't
  */
 template <typename T>
-typename std::enable_if<std::is_integral<T>::value, bool>::type rnd_chance(T chance, T base) {
-	return rnd_value<T>(1, base) <= chance;
+typename std::enable_if<std::is_integral<T>::value, bool>::type rnd_chance(T chance, T base, e_random_stream stream = RND_STREAM_DEFAULT) {
+	return rnd_value<T>(1, base, stream) <= chance;
 }
 
 /*
@@ -46,13 +181,13 @@ typename std::enable_if<std::is_integral<T>::value, bool>::type rnd_chance(T cha
  * @return true if succeeded / false if it didn't
  */
 template <typename T>
-typename std::enable_if<std::is_integral<T>::value, bool>::type rnd_chance_official(T chance, T base) {
-	return rnd_value<T>(0, 20000)%base < chance;
+typename std::enable_if<std::is_integral<T>::value, bool>::type rnd_chance_official(T chance, T base, e_random_stream stream = RND_STREAM_DEFAULT) {
+	return rnd_value<T>(0, 20000, stream)%base < chance;
 }
 
 template <typename T>
-void rnd_vector_order( std::vector<T>& vec ){
-	std::shuffle( std::begin( vec ), std::end( vec ), generator );
+void rnd_vector_order( std::vector<T>& vec, e_random_stream stream = RND_STREAM_DEFAULT ){
+	std::shuffle( std::begin( vec ), std::end( vec ), rnd_streams[stream] );
 }
 
 #endif /* RANDOM_HPP */
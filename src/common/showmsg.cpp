@@ -3,8 +3,15 @@
 
 #include "showmsg.hpp"
 
+#include <cstdio>
 #include <cstdlib> // atexit
+#include <condition_variable>
+#include <cstring>
 #include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #ifdef WIN32
 	#include "winapi.hpp"
@@ -50,6 +57,10 @@ int32 stdout_with_ansisequence = 0;
 int32 msg_silent = 0; //Specifies how silent the console is.
 int32 console_msg_log = 0;//[Ind] msg error logging
 char console_log_filepath[32] = "./log/unknown.log";
+int32 console_log_format = 0;
+int32 console_log_max_size = 0;
+int32 console_msg_dedup = 0;
+int32 console_msg_rate_limit = 0;
 
 ///////////////////////////////////////////////////////////////////////////////
 /// static/dynamic buffer for the messages
@@ -662,50 +673,217 @@ int32	FPRINTF(FILE *file, const char *fmt, ...)
 
 char timestamp_format[20] = ""; //For displaying Timestamps
 
-int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
-{
-	va_list apcopy;
+static const char* showmsg_type2name( enum msg_type flag ){
+	switch( flag ){
+		case MSG_STATUS: return "Status";
+		case MSG_SQL: return "SQL Error";
+		case MSG_INFORMATION: return "Info";
+		case MSG_NOTICE: return "Notice";
+		case MSG_WARNING: return "Warning";
+		case MSG_DEBUG: return "Debug";
+		case MSG_ERROR: return "Error";
+		case MSG_FATALERROR: return "Fatal Error";
+		default: return "Unknown";
+	}
+}
+
+/// Appends text as JSON string content, dropping color codes and trailing line breaks
+static void showmsg_json_escape( std::string& out, const char* text ){
+	size_t end = strlen( text );
+
+	while( end > 0 && ( text[end - 1] == '\r' || text[end - 1] == '\n' ) ){
+		end--;
+	}
+
+	if( end-- == 0 ){
+		return;
+	}
+
+	for( size_t i = 0; i <= end; i++ ){
+		char c = text[i];
+
+		if( c == '\033' && i + 1 <= end && text[i + 1] == '[' ){
+			// Skip the escape sequence up to its final letter
+			for( i += 2; i <= end && ( ISDIGIT( text[i] ) || text[i] == ';' ); i++ );
+			continue;
+		}
+
+		switch( c ){
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if( static_cast<unsigned char>( c ) < 0x20 ){
+					char buf[7];
+
+					snprintf( buf, sizeof( buf ), "\\u%04x", c );
+					out += buf;
+				}else{
+					out += c;
+				}
+				break;
+		}
+	}
+}
+
+/// A line for the console log file
+struct s_showmsg_log_line{
+	std::string path;
+	int32 max_size;
+	std::string text;
+};
+
+// The console log file is written by a thread, so a storm of warnings does not wait for the disk.
+// It is started with the first line and only uses the standard library.
+static std::thread showmsg_log_writer;
+static std::mutex showmsg_log_mutex;
+static std::condition_variable showmsg_log_wakeup; // lines were queued or the writer stops
+static std::deque<s_showmsg_log_line> showmsg_log_queue;
+static bool showmsg_log_stopping = false;
+static std::mutex showmsg_log_final_mutex; // held while the writer stops
+// Only used by the writer, or by the caller once the writer stopped
+static FILE* showmsg_log_fp = nullptr;
+static std::string showmsg_log_path;
+
+/// Appends a line to the console log file, keeping it open between lines
+/// and rotating it to "<path>.1" once it grows beyond the maximum size
+static void showmsg_log_write( const s_showmsg_log_line& line ){
+	if( showmsg_log_fp != nullptr && showmsg_log_path != line.path ){
+		fclose( showmsg_log_fp );
+		showmsg_log_fp = nullptr;
+	}
+
+	if( showmsg_log_fp != nullptr && line.max_size > 0 && ftell( showmsg_log_fp ) >= line.max_size * 1024L ){
+		std::string rotated = showmsg_log_path + ".1";
+
+		fclose( showmsg_log_fp );
+		showmsg_log_fp = nullptr;
+		remove( rotated.c_str() );
+		rename( showmsg_log_path.c_str(), rotated.c_str() );
+	}
+
+	if( showmsg_log_fp == nullptr ){
+		if( ( showmsg_log_fp = fopen( line.path.c_str(), "a" ) ) == nullptr ){
+			return;
+		}
+		showmsg_log_path = line.path;
+		fseek( showmsg_log_fp, 0, SEEK_END );
+	}
+
+	fputs( line.text.c_str(), showmsg_log_fp );
+}
+
+/// Main loop of the console log writer
+static void showmsg_log_writer_main( void ){
+	std::unique_lock<std::mutex> lock( showmsg_log_mutex );
+
+	while( true ){
+		showmsg_log_wakeup.wait( lock, [](){
+			return showmsg_log_stopping || !showmsg_log_queue.empty();
+		} );
+
+		if( showmsg_log_queue.empty() ){
+			break;
+		}
+
+		std::deque<s_showmsg_log_line> lines;
+
+		lines.swap( showmsg_log_queue );
+		lock.unlock();
+
+		for( const s_showmsg_log_line& line : lines ){
+			showmsg_log_write( line );
+		}
+
+		if( showmsg_log_fp != nullptr ){
+			fflush( showmsg_log_fp );
+		}
+
+		lock.lock();
+	}
+}
+
+/// Hands a line to the console log writer, starting it if needed
+static void showmsg_log_queue_line( s_showmsg_log_line&& line ){
+	{
+		std::lock_guard<std::mutex> lock( showmsg_log_mutex );
+
+		if( !showmsg_log_stopping ){
+			if( !showmsg_log_writer.joinable() ){
+				showmsg_log_writer = std::thread( showmsg_log_writer_main );
+				// Servers that exit() directly still write the queued lines
+				atexit( showmsg_final );
+			}
+
+			showmsg_log_queue.push_back( std::move( line ) );
+			showmsg_log_wakeup.notify_one();
+			return;
+		}
+	}
+
+	// Messages printed during shutdown are written directly, once the writer stopped
+	std::lock_guard<std::mutex> lock( showmsg_log_final_mutex );
+
+	showmsg_log_write( line );
+
+	if( showmsg_log_fp != nullptr ){
+		fclose( showmsg_log_fp );
+		showmsg_log_fp = nullptr;
+	}
+}
+
+/// Writes the queued console log lines, stops the writer and closes the console log file
+void showmsg_final( void ){
+	std::lock_guard<std::mutex> final_lock( showmsg_log_final_mutex );
+
+	{
+		std::lock_guard<std::mutex> lock( showmsg_log_mutex );
+
+		if( showmsg_log_stopping ){
+			return;
+		}
+
+		showmsg_log_stopping = true;
+	}
+
+	showmsg_log_wakeup.notify_one();
+
+	if( showmsg_log_writer.joinable() ){
+		showmsg_log_writer.join();
+	}
+
+	if( showmsg_log_fp != nullptr ){
+		fclose( showmsg_log_fp );
+		showmsg_log_fp = nullptr;
+	}
+}
+
+static void showmsg_output( enum msg_type flag, const char* text ){
 	char prefix[100];
 #if defined(DEBUGLOGMAP) || defined(DEBUGLOGCHAR) || defined(DEBUGLOGLOGIN)
 	FILE *fp;
 #endif
-	
-	if (!string || *string == '\0') {
-		ShowError("Empty string passed to _vShowMessage().\n");
-		return 1;
-	}
-	/**
-	 * For the buildbot, these result in a EXIT_FAILURE from core.cpp when done reading the params.
-	 **/
-#if defined(BUILDBOT)
-	if( flag == MSG_WARNING ||
-	    flag == MSG_ERROR ||
-	    flag == MSG_SQL ) {
-		buildbotflag = 1;
-	}
-#endif
+
 	if(
 		( flag == MSG_WARNING && console_msg_log&1 ) ||
 		( ( flag == MSG_ERROR || flag == MSG_SQL ) && console_msg_log&2 ) ||
 		( flag == MSG_DEBUG && console_msg_log&4 ) ) {//[Ind]
-		FILE *log = nullptr;
-		if( (log = fopen(console_log_filepath, "a+")) ) {
-			char timestring[255];
-			time_t curtime;
-			time(&curtime);
+		s_showmsg_log_line line = { console_log_filepath, console_log_max_size };
+		char timestring[255];
+		time_t curtime;
+		time(&curtime);
+		if( console_log_format == 1 ){
+			strftime(timestring, 254, "%Y-%m-%dT%H:%M:%S", localtime(&curtime));
+			line.text = "{\"time\":\"" + std::string( timestring ) + "\",\"type\":\"" + showmsg_type2name( flag ) + "\",\"message\":\"";
+			showmsg_json_escape( line.text, text );
+			line.text += "\"}\n";
+		}else{
 			strftime(timestring, 254, "%m/%d/%Y %H:%M:%S", localtime(&curtime));
-			fprintf(log,"(%s) [ %s ] : ",
-				timestring,
-				flag == MSG_WARNING ? "Warning" :
-				flag == MSG_ERROR ? "Error" :
-				flag == MSG_SQL ? "SQL Error" :
-				flag == MSG_DEBUG ? "Debug" :
-				"Unknown");
-			va_copy(apcopy, ap);
-			vfprintf(log,string,apcopy);
-			va_end(apcopy);
-			fclose(log);
+			line.text = "(" + std::string( timestring ) + ") [ " + showmsg_type2name( flag ) + " ] : " + text;
 		}
+		showmsg_log_queue_line( std::move( line ) );
 	}
 	if(
 	    (flag == MSG_INFORMATION && msg_silent&1) ||
@@ -716,7 +894,7 @@ int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
 	    (flag == MSG_SQL && msg_silent&16) ||
 	    (flag == MSG_DEBUG && msg_silent&32)
 	)
-		return 0; //Do not print it.
+		return; //Do not print it.
 
 	if (timestamp_format[0] && flag != MSG_NONE)
 	{	//Display time format. [Skotlex]
@@ -751,24 +929,17 @@ int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
 		case MSG_FATALERROR: //Bright Red (Fatal errors, abort(); if possible)
 			strcat(prefix,CL_RED "[Fatal Error]" CL_RESET ":" CL_CLL);
 			break;
-		default:
-			ShowError("In function _vShowMessage() -> Invalid flag passed.\n");
-			return 1;
 	}
 
 	if (flag == MSG_ERROR || flag == MSG_FATALERROR || flag == MSG_SQL)
 	{	//Send Errors to StdErr [Skotlex]
-		FPRINTF(STDERR, "%s ", prefix);
-		va_copy(apcopy, ap);
-		VFPRINTF(STDERR, string, apcopy);
-		va_end(apcopy);
+		FPRINTF(STDERR, "%s %s", prefix, text);
 		FFLUSH(STDERR);
 	} else {
 		if (flag != MSG_NONE)
-			FPRINTF(STDOUT, "%s ", prefix);
-		va_copy(apcopy, ap);
-		VFPRINTF(STDOUT, string, apcopy);
-		va_end(apcopy);
+			FPRINTF(STDOUT, "%s %s", prefix, text);
+		else
+			FPRINTF(STDOUT, "%s", text);
 		FFLUSH(STDOUT);
 	}
 
@@ -779,10 +950,7 @@ int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
 			FPRINTF(STDERR, CL_RED "[ERROR]" CL_RESET ": Could not open '" CL_WHITE "%s" CL_RESET "', access denied.\n", DEBUGLOGPATH);
 			FFLUSH(STDERR);
 		} else {
-			fprintf(fp,"%s ", prefix);
-			va_copy(apcopy, ap);
-			vfprintf(fp,string,apcopy);
-			va_end(apcopy);
+			fprintf(fp,"%s %s", prefix, text);
 			fclose(fp);
 		}
 	} else {
@@ -790,6 +958,143 @@ int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
 		FFLUSH(STDERR);
 	}
 #endif
+}
+
+/// Message types that are collapsed by console_msg_dedup and limited by console_msg_rate_limit
+static bool showmsg_is_throttled( enum msg_type flag ){
+	return flag == MSG_WARNING || flag == MSG_DEBUG || flag == MSG_ERROR || flag == MSG_SQL;
+}
+
+// State of console_msg_dedup and console_msg_rate_limit
+static enum msg_type showmsg_last_flag = MSG_NONE;
+static std::string showmsg_last_text;
+static int32 showmsg_last_repeat = 0;
+static time_t showmsg_rate_second = 0;
+static int32 showmsg_rate_count = 0, showmsg_rate_suppressed = 0;
+// The web-server prints from its worker threads
+static std::recursive_mutex showmsg_mutex;
+
+/// Prints how often the last message was repeated, if it was
+static void showmsg_flush_repeat( void ){
+	if( showmsg_last_repeat > 0 ){
+		char text[64];
+
+		snprintf( text, sizeof( text ), "Last message repeated %d times.\n", showmsg_last_repeat );
+		showmsg_last_repeat = 0;
+		showmsg_output( showmsg_last_flag, text );
+	}
+}
+
+void ShowRepeatedMessages( void ){
+	std::lock_guard<std::recursive_mutex> lock( showmsg_mutex );
+
+	showmsg_flush_repeat();
+}
+
+bool showmsg_config_read( const char* key, const char* value ){
+	if( strcmpi( key, "console_msg_log" ) == 0 )
+		console_msg_log = atoi( value );
+	else if( strcmpi( key, "console_log_filepath" ) == 0 )
+		safestrncpy( console_log_filepath, value, sizeof( console_log_filepath ) );
+	else if( strcmpi( key, "console_log_format" ) == 0 )
+		console_log_format = atoi( value );
+	else if( strcmpi( key, "console_log_max_size" ) == 0 )
+		console_log_max_size = atoi( value );
+	else if( strcmpi( key, "console_msg_dedup" ) == 0 )
+		console_msg_dedup = config_switch( value );
+	else if( strcmpi( key, "console_msg_rate_limit" ) == 0 )
+		console_msg_rate_limit = atoi( value );
+	else
+		return false;
+
+	return true;
+}
+
+int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap)
+{
+	if (!string || *string == '\0') {
+		ShowError("Empty string passed to _vShowMessage().\n");
+		return 1;
+	}
+	if( flag < MSG_NONE || flag > MSG_FATALERROR ){
+		ShowError("In function _vShowMessage() -> Invalid flag passed.\n");
+		return 1;
+	}
+	/**
+	 * For the buildbot, these result in a EXIT_FAILURE from core.cpp when done reading the params.
+	 **/
+#if defined(BUILDBOT)
+	if( flag == MSG_WARNING ||
+	    flag == MSG_ERROR ||
+	    flag == MSG_SQL ) {
+		buildbotflag = 1;
+	}
+#endif
+
+	// Format once, on the stack unless the message is unusually long
+	char buf[SBUF_SIZE];
+	std::string longbuf;
+	const char* text = buf;
+	va_list apcopy;
+
+	va_copy( apcopy, ap );
+	int32 len = vsnprintf( buf, sizeof( buf ), string, apcopy );
+	va_end( apcopy );
+
+	if( len < 0 ){
+		len = 0;
+		buf[0] = '\0';
+	}else if( len >= SBUF_SIZE ){
+		longbuf.resize( len );
+		vsnprintf( &longbuf[0], len + 1, string, ap );
+		text = longbuf.c_str();
+	}
+
+	std::lock_guard<std::recursive_mutex> lock( showmsg_mutex );
+
+	bool throttled = showmsg_is_throttled( flag );
+
+	if( console_msg_dedup ){
+		if( throttled && flag == showmsg_last_flag && showmsg_last_text.compare( 0, std::string::npos, text, len ) == 0 ){
+			showmsg_last_repeat++;
+			return 0;
+		}
+
+		showmsg_flush_repeat();
+
+		// Any other message ends the repetition
+		if( throttled ){
+			showmsg_last_flag = flag;
+			showmsg_last_text.assign( text, len );
+		}else{
+			showmsg_last_flag = MSG_NONE;
+			showmsg_last_text.clear();
+		}
+	}
+
+	if( console_msg_rate_limit > 0 && throttled ){
+		time_t now = time( nullptr );
+
+		if( now != showmsg_rate_second ){
+			showmsg_rate_second = now;
+			showmsg_rate_count = 0;
+
+			if( showmsg_rate_suppressed > 0 ){
+				char notice[96];
+
+				snprintf( notice, sizeof( notice ), "%d messages were suppressed by console_msg_rate_limit.\n", showmsg_rate_suppressed );
+				showmsg_rate_suppressed = 0;
+				showmsg_output( MSG_WARNING, notice );
+			}
+		}
+
+		if( ++showmsg_rate_count > console_msg_rate_limit ){
+			showmsg_rate_suppressed++;
+			return 0;
+		}
+	}
+
+	showmsg_output( flag, text );
 
 	return 0;
 }
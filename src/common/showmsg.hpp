@@ -73,6 +73,10 @@ extern int32 stdout_with_ansisequence; //If the color ansi sequences are to be u
 extern int32 msg_silent; //Specifies how silent the console is. [Skotlex]
 extern int32 console_msg_log; //Specifies what error messages to log. [Ind]
 extern char console_log_filepath[32]; ///< Filepath to save console_msg_log. [Cydh]
+extern int32 console_log_format; ///< Format of console_msg_log: 0 = text, 1 = JSON lines
+extern int32 console_log_max_size; ///< Size in KB after which the console_msg_log file is rotated, 0 = never
+extern int32 console_msg_dedup; ///< Collapse identical consecutive warnings and errors
+extern int32 console_msg_rate_limit; ///< Maximum warnings and errors printed per second, 0 = unlimited
 extern char timestamp_format[20]; //For displaying Timestamps [Skotlex]
 
 enum msg_type {
@@ -90,6 +94,13 @@ enum msg_type {
 extern void ClearScreen(void);
 extern int32 _vShowMessage(enum msg_type flag, const char *string, va_list ap);
 extern void ShowMessage(const char *, ...);
+/// Prints the "Last message repeated" line of console_msg_dedup, if messages were collapsed
+extern void ShowRepeatedMessages(void);
+/// Reads the console_msg_* and console_log_* settings shared by all servers
+/// @return true if key was one of them
+extern bool showmsg_config_read(const char* key, const char* value);
+/// Writes the queued console log lines and closes the console log file
+extern void showmsg_final(void);
 extern void ShowStatus(const char *, ...);
 extern void ShowSQL(const char *, ...);
 extern void ShowInfo(const char *, ...);
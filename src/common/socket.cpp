@@ -4,6 +4,7 @@
 #include "socket.hpp"
 
 #include <cstdlib>
+#include <vector>
 
 #ifdef WIN32
 	#include "winapi.hpp"
@@ -40,9 +41,13 @@
 	#endif
 #endif
 
+#include <zlib.h>
+
 #include "cbasetypes.hpp"
 #include "malloc.hpp"
+#include "metrics.hpp"
 #include "mmo.hpp"
+#include "profiler.hpp"
 #include "showmsg.hpp"
 #include "strlib.hpp"
 #include "timer.hpp"
@@ -245,6 +250,13 @@ static size_t socket_max_client_packet = 0x6000;
 static size_t socket_max_client_packet = USHRT_MAX;
 #endif
 
+// Packets on server links from this size on are compressed, if the peer accepts it (0 disables the compression)
+static size_t socket_compress_threshold = 0;
+
+static Metric metric_compressed_packets( "rathena_interserver_compressed_packets_total", "Packets that were compressed on server links", METRIC_COUNTER );
+static Metric metric_compressed_raw( "rathena_interserver_compressed_raw_bytes_total", "Size of the compressed packets before the compression", METRIC_COUNTER );
+static Metric metric_compressed_sent( "rathena_interserver_compressed_sent_bytes_total", "Size of the compressed packets after the compression", METRIC_COUNTER );
+
 #ifdef SHOW_SERVER_STATS
 // Data I/O statistics
 static size_t socket_data_i = 0, socket_data_ci = 0, socket_data_qi = 0;
@@ -723,6 +735,31 @@ int32 make_connection(uint32 ip, uint16 port, bool silent,int32 timeout) {
 	return fd;
 }
 
+/// Creates a session that is not backed by a socket.
+/// Everything written to it is handed to func_send, reads have to be filled in by the caller.
+/// Sessions are taken from the top of the table to stay clear of descriptors handed out by the OS.
+/// @return the new fd or -1 if the table is full
+int32 make_local_session(SendFunc func_send, ParseFunc func_parse)
+{
+	int32 fd;
+
+	for( fd = MAXCONN - 1; fd > 0; fd-- ){
+		if( session[fd] == nullptr ){
+			break;
+		}
+	}
+
+	if( fd <= 0 || fd < fd_max ){
+		ShowError("make_local_session: No free session available.\n");
+		return -1;
+	}
+
+	create_session(fd, null_recv, func_send, func_parse);
+	session[fd]->flag.local = 1;
+
+	return fd;
+}
+
 static int32 create_session(int32 fd, RecvFunc func_recv, SendFunc func_send, ParseFunc func_parse)
 {
 	CREATE(session[fd], struct socket_data, 1);
@@ -811,6 +848,9 @@ int32 RFIFOSKIP(int32 fd, size_t len)
 		len = RFIFOREST(fd);
 	}
 
+	if( len >= 2 )
+		packet_stats_recv(s->link, RFIFOW(fd,0), len);
+
 	s->rdata_pos = s->rdata_pos + len;
 #ifdef SHOW_SERVER_STATS
 	socket_data_qi -= len;
@@ -818,6 +858,115 @@ int32 RFIFOSKIP(int32 fd, size_t len)
 	return 0;
 }
 
+/**
+ * Replaces the packet that is about to be sent on a server link by its compressed form, if that is smaller.
+ * @param fd: Server link
+ * @param len: Length of the packet at the end of the write fifo
+ * @return length of the packet that is sent
+ */
+static size_t socket_compress_packet( int32 fd, size_t len ){
+	static std::vector<uint8> buffer;
+	uint8* packet = session[fd]->wdata + session[fd]->wdata_size;
+	uLongf size = compressBound( static_cast<uLong>( len ) );
+
+	buffer.resize( size );
+
+	if( compress2( buffer.data(), &size, packet, static_cast<uLong>( len ), Z_BEST_SPEED ) != Z_OK || size + 6 >= len ){
+		return len;
+	}
+
+	WBUFW( packet, 0 ) = HEADER_COMPRESSED_PACKET;
+	WBUFW( packet, 2 ) = static_cast<uint16>( size + 6 );
+	WBUFW( packet, 4 ) = static_cast<uint16>( len );
+	memcpy( WBUFP( packet, 6 ), buffer.data(), size );
+
+	metric_compressed_packets.add();
+	metric_compressed_raw.add( len );
+	metric_compressed_sent.add( size + 6 );
+
+	return size + 6;
+}
+
+/**
+ * Tells the peer of a server link that compressed packets are accepted, if the compression is enabled.
+ * @param fd: Server link
+ */
+void socket_compression_announce( int32 fd ){
+	if( socket_compress_threshold == 0 || !session_isValid( fd ) || session[fd]->flag.local ){
+		return;
+	}
+
+	WFIFOHEAD( fd, 2 );
+	WFIFOW( fd, 0 ) = HEADER_COMPRESSION_ACCEPT;
+	WFIFOSET( fd, 2 );
+}
+
+/**
+ * Handles a compression packet at the front of the read fifo of a server link.
+ * A compressed packet is replaced by the packet it contains, so the parser continues with that one.
+ * @param fd: Server link
+ * @return 0 if the packet is no compression packet, 1 if it was handled, 2 if more data is needed, -1 if it is malformed
+ */
+int32 socket_compression_parse( int32 fd ){
+	if( RFIFOREST( fd ) < 2 ){
+		return 2;
+	}
+
+	switch( RFIFOW( fd, 0 ) ){
+		case HEADER_COMPRESSION_ACCEPT:
+			if( socket_compress_threshold > 0 && session[fd]->flag.server ){
+				session[fd]->flag.compress = 1;
+			}
+
+			RFIFOSKIP( fd, 2 );
+			return 1;
+
+		case HEADER_COMPRESSED_PACKET: {
+			if( RFIFOREST( fd ) < 6 ){
+				return 2;
+			}
+
+			size_t len = RFIFOW( fd, 2 );
+			size_t raw_len = RFIFOW( fd, 4 );
+
+			if( len <= 6 || raw_len < 2 ){
+				ShowError( "socket_compression_parse: Invalid compressed packet (length=%" PRIuPTR ", original length=%" PRIuPTR ") on connection #%d.\n", len, raw_len, fd );
+				return -1;
+			}
+
+			if( RFIFOREST( fd ) < len ){
+				return 2;
+			}
+
+			static std::vector<uint8> buffer;
+			uLongf size = static_cast<uLongf>( raw_len );
+
+			buffer.resize( raw_len );
+
+			if( uncompress( buffer.data(), &size, RFIFOP( fd, 6 ), static_cast<uLong>( len - 6 ) ) != Z_OK || size != raw_len ){
+				ShowError( "socket_compression_parse: Failed to decompress packet on connection #%d.\n", fd );
+				return -1;
+			}
+
+			struct socket_data* s = session[fd];
+			size_t rdata_size = s->rdata_size - len + raw_len;
+
+			// The original packet is larger than its compressed form, make room in place of it
+			if( rdata_size > s->max_rdata ){
+				realloc_fifo( fd, static_cast<uint32>( rdata_size ), static_cast<uint32>( s->max_wdata ) );
+			}
+
+			memmove( s->rdata + s->rdata_pos + raw_len, s->rdata + s->rdata_pos + len, s->rdata_size - s->rdata_pos - len );
+			memcpy( s->rdata + s->rdata_pos, buffer.data(), raw_len );
+			s->rdata_size = rdata_size;
+			return 1;
+		}
+
+		default:
+			return 0;
+	}
+}
+
 /// advance the WFIFO cursor (marking 'len' bytes for sending)
 int32 WFIFOSET(int32 fd, size_t len)
 {
@@ -867,6 +1016,9 @@ int32 WFIFOSET(int32 fd, size_t len)
 		}
 
 	}
+	packet_stats_send(s->link, WFIFOW(fd,0), len);
+	if( s->flag.compress && len >= socket_compress_threshold )
+		len = socket_compress_packet(fd, len);
 	s->wdata_size += len;
 #ifdef SHOW_SERVER_STATS
 	socket_data_qo += len;
@@ -1023,7 +1175,9 @@ int32 do_sockets(t_tick next)
 			}
 		}
 
+		packet_stats_parse_start = profiler_now();
 		session[i]->func_parse(i);
+		packet_stats_parse_start = 0;
 
 		if(!session[i])
 			continue;
@@ -1359,6 +1513,8 @@ int32 socket_config_read(const char* cfgName)
 		}
 #endif
 #endif
+		else if (!strcmpi(w1, "interserver_compress_threshold"))
+			socket_compress_threshold = strtoul(w2, nullptr, 10);
 		else if (!strcmpi(w1, "import"))
 			socket_config_read(w2);
 		else
@@ -1402,6 +1558,8 @@ void socket_final(void)
 	aFree(session[0]);
 	session[0] = nullptr;
 
+	packet_stats_final();
+
 #ifdef WIN32
 	// Shut down windows networking
 	if( WSACleanup() != 0 ){
@@ -1428,6 +1586,11 @@ void do_close(int32 fd)
 
 	flush_fifo(fd); // Try to send what's left (although it might not succeed since it's a nonblocking socket)
 
+	if( session[fd] != nullptr && session[fd]->flag.local ){
+		delete_session(fd);
+		return;
+	}
+
 #ifndef SOCKET_EPOLL
 	// Select based Event Dispatcher
 	sFD_CLR(fd, &readfds);// this needs to be done before closing the socket
@@ -1529,6 +1692,32 @@ int32 socket_getips(uint32* ips, int32 max)
 	return num;
 }
 
+static Metric metric_sessions( "rathena_sessions", "Open connections", METRIC_GAUGE );
+static Metric metric_session_buffers( "rathena_session_buffer_bytes", "Memory allocated for the read and write buffers of all connections", METRIC_GAUGE );
+static Metric metric_session_pending( "rathena_session_pending_bytes", "Bytes waiting in the read and write buffers of all connections", METRIC_GAUGE );
+
+static void socket_collect_metrics(void)
+{
+	int64 sessions = 0, buffers = 0, pending = 0;
+
+	// Local sessions are allocated from the top, so all slots have to be checked
+	for( int32 fd = 1; fd < MAXCONN; fd++ )
+	{
+		struct socket_data* s = session[fd];
+
+		if( s == nullptr )
+			continue;
+
+		sessions++;
+		buffers += s->max_rdata + s->max_wdata;
+		pending += s->rdata_size - s->rdata_pos + s->wdata_size;
+	}
+
+	metric_sessions.set(sessions);
+	metric_session_buffers.set(buffers);
+	metric_session_pending.set(pending);
+}
+
 void socket_init(void)
 {
 	const char *SOCKET_CONF_FILENAME = "conf/packet_athena.conf";
@@ -1614,6 +1803,8 @@ void socket_init(void)
 	// should hold enough buffer (it is a vacuum so to speak) as it is never flushed. [Skotlex]
 	create_session(0, null_recv, null_send, null_parse); //FIXME this is causing leak
 
+	metrics_add_collector(socket_collect_metrics);
+
 #ifndef MINICORE
 	// Delete old connection history every 5 minutes
 	memset(connect_history, 0, sizeof(connect_history));
@@ -19,6 +19,7 @@
 
 #include "cbasetypes.hpp"
 #include "malloc.hpp"
+#include "packet_stats.hpp"
 #include "timer.hpp" // t_tick
 
 #ifndef MAXCONN
@@ -95,9 +96,12 @@ struct socket_data
 		unsigned char eof : 1;
 		unsigned char server : 1;
 		unsigned char ping : 2;
+		unsigned char local : 1; // not backed by a socket
+		unsigned char compress : 1; // peer of a server link accepts compressed packets
 	} flag;
 
 	uint32 client_addr; // remote client address
+	e_packet_link link; // kind of peer, used for the packet statistics
 
 	uint8 *rdata, *wdata;
 	size_t max_rdata, max_wdata;
@@ -133,6 +137,7 @@ extern bool session_isActive(int32 fd);
 
 int32 make_listen_bind(uint32 ip, uint16 port);
 int32 make_connection(uint32 ip, uint16 port, bool silent, int32 timeout);
+int32 make_local_session(SendFunc func_send, ParseFunc func_parse);
 #define realloc_fifo( fd, rfifo_size, wfifo_size ) _realloc_fifo( ( fd ), ( rfifo_size ), ( wfifo_size ), ALC_MARK )
 #define realloc_writefifo( fd, addition ) _realloc_writefifo( ( fd ), ( addition ), ALC_MARK )
 int32 _realloc_fifo( int32 fd, uint32 rfifo_size, uint32 wfifo_size, const char* file, int32 line, const char* func );
@@ -151,6 +156,15 @@ extern void set_nonblocking(int32 fd, unsigned long yes);
 
 void set_defaultparse(ParseFunc defaultparse);
 
+// Compression of large packets on server links
+// S 2c00 <packet len>.W <original len>.W <zlib data>.?B
+#define HEADER_COMPRESSED_PACKET 0x2c00
+// S 2c01 (the sender accepts compressed packets)
+#define HEADER_COMPRESSION_ACCEPT 0x2c01
+
+void socket_compression_announce(int32 fd);
+int32 socket_compression_parse(int32 fd);
+
 
 /// Server operation request
 enum chrif_req_op {
@@ -10,6 +10,8 @@
 #include "cbasetypes.hpp"
 #include "cli.hpp"
 #include "malloc.hpp"
+#include "metrics.hpp"
+#include "profiler.hpp"
 #include "showmsg.hpp"
 #include "timer.hpp"
 
@@ -69,6 +71,7 @@ uint32 Sql_GetError( Sql* self ){
 }
 
 static int32 Sql_P_Keepalive(Sql* self);
+static TIMER_FUNC(Sql_P_KeepaliveTimer);
 
 /**
  * Establishes a connection to schema
@@ -113,6 +116,28 @@ int32 Sql_Connect(Sql* self, const char* user, const char* passwd, const char* h
 
 
 
+/// Removes the keepalive timer of the connection.
+void Sql_DisableKeepalive(Sql* self)
+{
+	if( self && self->keepalive != INVALID_TIMER )
+	{
+		delete_timer(self->keepalive, Sql_P_KeepaliveTimer);
+		self->keepalive = INVALID_TIMER;
+	}
+}
+
+
+
+/// Retrieves the MySQL connection of the handle.
+MYSQL* Sql_GetHandle(Sql* self)
+{
+	if( self == nullptr )
+		return nullptr;
+	return &self->handle;
+}
+
+
+
 /// Retrieves the timeout of the connection.
 int32 Sql_GetTimeout(Sql* self, uint32* out_timeout)
 {
@@ -253,6 +278,16 @@ std::string Sql_GetEscapeString(Sql* self, std::string_view from) {
 }
 
 
+static Metric metric_sql_queries( "rathena_sql_queries_total", "SQL queries that were executed", METRIC_COUNTER );
+static Metric metric_sql_query_time( "rathena_sql_query_microseconds_total", "Time spent waiting for SQL queries", METRIC_COUNTER );
+
+/// Accounts a query that was sent at the given timestamp
+static void sql_query_done(uint64 start)
+{
+	metric_sql_queries.add();
+	metric_sql_query_time.add((profiler_now() - start) / 1000);
+}
+
 /// Executes a query.
 int32 Sql_Query(Sql* self, const char* query, ...)
 {
@@ -277,7 +312,12 @@ int32 Sql_QueryV(Sql* self, const char* query, va_list args)
 	Sql_FreeResult(self);
 	StringBuf_Clear(&self->buf);
 	StringBuf_Vprintf(&self->buf, query, args);
-	if( mysql_real_query(&self->handle, StringBuf_Value(&self->buf), (unsigned long)StringBuf_Length(&self->buf)) )
+	uint64 start = profiler_now();
+	bool failed = mysql_real_query(&self->handle, StringBuf_Value(&self->buf), (unsigned long)StringBuf_Length(&self->buf)) != 0;
+
+	sql_query_done(start);
+
+	if( failed )
 	{
 		ShowSQL("DB error - %s\n", mysql_error(&self->handle));
 		ra_mysql_error_handler(mysql_errno(&self->handle));
@@ -304,7 +344,12 @@ int32 Sql_QueryStr(Sql* self, const char* query)
 	Sql_FreeResult(self);
 	StringBuf_Clear(&self->buf);
 	StringBuf_AppendStr(&self->buf, query);
-	if( mysql_real_query(&self->handle, StringBuf_Value(&self->buf), (unsigned long)StringBuf_Length(&self->buf)) )
+	uint64 start = profiler_now();
+	bool failed = mysql_real_query(&self->handle, StringBuf_Value(&self->buf), (unsigned long)StringBuf_Length(&self->buf)) != 0;
+
+	sql_query_done(start);
+
+	if( failed )
 	{
 		ShowSQL("DB error - %s\n", mysql_error(&self->handle));
 		ra_mysql_error_handler(mysql_errno(&self->handle));
@@ -747,8 +792,12 @@ int32 SqlStmt::BindParam(size_t idx, enum SqlDataType buffer_type, void* buffer,
 int32 SqlStmt::Execute(){
 	this->FreeResult();
 
-	if( ( this->bind_params && mysql_stmt_bind_param( this->stmt, this->params ) ) ||
-		mysql_stmt_execute( this->stmt ) )
+	uint64 start = profiler_now();
+	bool failed = ( this->bind_params && mysql_stmt_bind_param( this->stmt, this->params ) ) || mysql_stmt_execute( this->stmt );
+
+	sql_query_done( start );
+
+	if( failed )
 	{
 		ShowSQL("DB error - %s\n", mysql_stmt_error(this->stmt));
 		ra_mysql_error_handler(mysql_stmt_errno(this->stmt));
@@ -1025,6 +1074,194 @@ void Sql_inter_server_read(const char* cfgName, bool first) {
 	return;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Connection Pool
+///////////////////////////////////////////////////////////////////////////////
+
+static Metric metric_sql_pool_waiting( "rathena_sql_pool_waiting", "Threads waiting for a pooled SQL connection", METRIC_GAUGE );
+static Metric metric_sql_pool_wait_time( "rathena_sql_pool_wait_microseconds_total", "Time spent waiting for pooled SQL connections", METRIC_COUNTER );
+static Metric metric_sql_pool_timeouts( "rathena_sql_pool_timeouts_total", "Requests for a pooled SQL connection that timed out", METRIC_COUNTER );
+
+
+
+SqlPool::~SqlPool(){
+	this->finalize();
+}
+
+
+
+/// Opens the connections of the pool.
+int32 SqlPool::initialize( size_t size, const char* user, const char* passwd, const char* host, uint16 port, const char* db, const char* encoding ){
+	uint32 timeout = 28800; // 8 hours
+
+	for( size_t i = 0; i < size; i++ ){
+		Sql* handle = Sql_Malloc();
+
+		if( SQL_ERROR == Sql_Connect( handle, user, passwd, host, port, db ) ){
+			Sql_ShowDebug( handle );
+			Sql_Free( handle );
+			return SQL_ERROR;
+		}
+
+		// The pool pings its idle connections itself, the timers would ping connections that are in use by other threads
+		Sql_DisableKeepalive( handle );
+
+		if( encoding != nullptr && encoding[0] != '\0' && SQL_ERROR == Sql_SetEncoding( handle, encoding ) ){
+			Sql_ShowDebug( handle );
+		}
+
+		if( i == 0 ){
+			Sql_GetTimeout( handle, &timeout );
+		}
+
+		this->handles.push_back( handle );
+		this->idle.push_back( { handle, std::chrono::steady_clock::now() } );
+	}
+
+	// Same reserve as the keepalive timer of a single connection
+	this->ping_interval = std::chrono::seconds( timeout < 60 ? 30 : timeout - 30 );
+
+	return SQL_SUCCESS;
+}
+
+
+
+/// Makes sure a connection that was idle for a while still works.
+/// MYSQL_OPT_RECONNECT lets the ping reconnect a connection that was closed by the server.
+///
+/// @return true if the connection can be used
+bool SqlPool::check( Sql* handle, std::chrono::steady_clock::time_point last_used ){
+	if( std::chrono::steady_clock::now() - last_used < this->ping_interval ){
+		return true;
+	}
+
+	if( SQL_SUCCESS == Sql_Ping( handle ) ){
+		return true;
+	}
+
+	ShowSQL( "Pooled %s DB connection is not reachable: %s\n", this->name.c_str(), mysql_error( &handle->handle ) );
+	return false;
+}
+
+
+
+/// Takes a connection out of the pool.
+Sql* SqlPool::acquire( uint32 timeout ){
+	std::unique_lock<std::mutex> lock( this->mutex );
+
+	if( this->idle.empty() ){
+		uint64 start = profiler_now();
+		bool available;
+
+		metric_sql_pool_waiting.add( 1 );
+		available = this->released.wait_for( lock, std::chrono::milliseconds( timeout ), [this]{ return !this->idle.empty(); } );
+		metric_sql_pool_waiting.add( -1 );
+		metric_sql_pool_wait_time.add( ( profiler_now() - start ) / 1000 );
+
+		if( !available ){
+			metric_sql_pool_timeouts.add();
+			ShowWarning( "All %" PRIuPTR " pooled %s DB connections are busy, gave up after %u ms.\n", this->handles.size(), this->name.c_str(), timeout );
+			return nullptr;
+		}
+	}
+
+	// The most recently used connection is the least likely to need a ping
+	s_idle_handle entry = this->idle.back();
+
+	this->idle.pop_back();
+	lock.unlock();
+
+	if( !this->check( entry.handle, entry.last_used ) ){
+		// Keep the old timestamp, so the next thread pings it again
+		lock.lock();
+		this->idle.insert( this->idle.begin(), entry );
+		lock.unlock();
+		this->released.notify_one();
+		return nullptr;
+	}
+
+	return entry.handle;
+}
+
+
+
+/// Returns a connection that was taken with acquire.
+void SqlPool::release( Sql* handle ){
+	if( handle == nullptr ){
+		return;
+	}
+
+	Sql_FreeResult( handle );
+
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+
+		this->idle.push_back( { handle, std::chrono::steady_clock::now() } );
+	}
+
+	this->released.notify_one();
+}
+
+
+
+/// Pings the idle connections that were not used for a while.
+void SqlPool::keepalive(){
+	std::vector<s_idle_handle> expired;
+	auto now = std::chrono::steady_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+
+		for( auto it = this->idle.begin(); it != this->idle.end(); ){
+			if( now - it->last_used >= this->ping_interval ){
+				expired.push_back( *it );
+				it = this->idle.erase( it );
+			}else{
+				it++;
+			}
+		}
+	}
+
+	if( expired.empty() ){
+		return;
+	}
+
+	for( s_idle_handle& entry : expired ){
+		if( SQL_SUCCESS == Sql_Ping( entry.handle ) ){
+			entry.last_used = std::chrono::steady_clock::now();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+
+		// Put them in front, they are the least recently used ones
+		this->idle.insert( this->idle.begin(), expired.begin(), expired.end() );
+	}
+
+	this->released.notify_all();
+}
+
+
+
+/// Closes all connections.
+void SqlPool::finalize(){
+	std::lock_guard<std::mutex> lock( this->mutex );
+
+	if( this->idle.size() != this->handles.size() ){
+		ShowWarning( "Closing the %s DB connection pool while %" PRIuPTR " connections are still in use.\n", this->name.c_str(), this->handles.size() - this->idle.size() );
+	}
+
+	for( Sql* handle : this->handles ){
+		Sql_Free( handle );
+	}
+
+	this->handles.clear();
+	this->idle.clear();
+}
+
+
+
 void Sql_Init(void) {
 	Sql_inter_server_read(INTER_CONF_NAME,true);
 }
@@ -4,10 +4,14 @@
 #ifndef SQL_HPP
 #define SQL_HPP
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>// va_list
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #ifdef WIN32
 #include "winapi.hpp"
@@ -85,6 +89,20 @@ int32 Sql_Connect(Sql* self, const char* user, const char* passwd, const char* h
 
 
 
+/// Removes the keepalive timer of the connection.
+/// Used for connections that are pinged by their owner instead, for example by a SqlPool.
+void Sql_DisableKeepalive(Sql* self);
+
+
+
+
+/// Retrieves the MySQL connection of the handle.
+/// Used by threads that talk to the client library directly, because the other functions allocate through the memory manager.
+MYSQL* Sql_GetHandle(Sql* self);
+
+
+
+
 /// Retrieves the timeout of the connection.
 ///
 /// @return SQL_SUCCESS or SQL_ERROR
@@ -342,6 +360,59 @@ public:
 #define SqlStmt_ShowDebug(self) (self).ShowDebug_( __FILE__, __LINE__ )
 #endif
 
+/// Pool of connections to the same database, for servers that query it from several threads.
+/// A handle belongs to one thread between acquire and release, so no further locking is needed.
+/// Connections are opened on the main thread during initialize, since Sql_Connect uses the timer system.
+class SqlPool{
+private:
+	struct s_idle_handle{
+		Sql* handle;
+		std::chrono::steady_clock::time_point last_used;
+	};
+
+	std::string name;
+	std::mutex mutex;
+	std::condition_variable released;
+	std::vector<Sql*> handles;
+	std::vector<s_idle_handle> idle;
+	std::chrono::seconds ping_interval;
+
+	bool check( Sql* handle, std::chrono::steady_clock::time_point last_used );
+
+public:
+	SqlPool( const char* name ) : name( name ), ping_interval( 60 ){}
+	~SqlPool();
+
+	SqlPool( const SqlPool& ) = delete;
+	SqlPool& operator=( const SqlPool& ) = delete;
+
+	/// Opens the connections of the pool.
+	///
+	/// @return SQL_SUCCESS or SQL_ERROR
+	int32 initialize( size_t size, const char* user, const char* passwd, const char* host, uint16 port, const char* db, const char* encoding );
+
+	/// Takes a connection out of the pool.
+	/// Waits at most timeout milliseconds for another thread to release one.
+	///
+	/// @return Connection or nullptr if none became available or the database is not reachable
+	Sql* acquire( uint32 timeout );
+
+	/// Returns a connection that was taken with acquire.
+	void release( Sql* handle );
+
+	/// Pings the idle connections that were not used for a while, replaces the keepalive timers of the connections.
+	/// Must be called from the main thread.
+	void keepalive();
+
+	/// Closes all connections.
+	/// No connection may be in use anymore.
+	void finalize();
+
+	size_t size() const{
+		return this->handles.size();
+	}
+};
+
 void Sql_Init(void);
 
 #endif /* SQL_HPP */
@@ -10,7 +10,9 @@
 #include "cbasetypes.hpp"
 #include "db.hpp"
 #include "malloc.hpp"
+#include "metrics.hpp"
 #include "nullpo.hpp"
+#include "profiler.hpp"
 #include "showmsg.hpp"
 #include "utils.hpp"
 #ifdef WIN32
@@ -143,9 +145,17 @@ static void rdtsc_calibrate(){
 
 #endif
 
+// virtual clock, which only advances on request (used for deterministic simulations)
+static bool tick_virtual = false;
+static t_tick tick_virtual_now = 0;
+
 /// platform-abstracted tick retrieval
 static t_tick tick(void)
 {
+	if( tick_virtual ){
+		return tick_virtual_now;
+	}
+
 #if defined(ENABLE_RDTSC)
 	// RDTSC: Returns the number of CPU cycles since reset. Unreliable if the CPU frequency is variable.
 	return static_cast<t_tick>( ( __rdtsc() - rdtsc_begintick ) / rdtsc_clock );
@@ -166,6 +176,22 @@ static t_tick tick(void)
 #endif
 }
 
+/// Switches to a virtual clock starting at the given tick.
+/// From now on time only passes through timer_virtual_advance.
+void timer_virtual_clock(t_tick start)
+{
+	tick_virtual = true;
+	tick_virtual_now = start;
+	gettick_nocache();
+}
+
+/// Advances the virtual clock by the given amount of milliseconds.
+void timer_virtual_advance(t_tick diff)
+{
+	tick_virtual_now += diff;
+	gettick_nocache();
+}
+
 //////////////////////////////////////////////////////////////////////////
 #if defined(TICK_CACHE) && TICK_CACHE > 1
 //////////////////////////////////////////////////////////////////////////
@@ -352,11 +378,21 @@ t_tick settick_timer(int32 tid, t_tick tick)
 	return tick;
 }
 
+static Metric metric_ticks( "rathena_ticks_total", "Server ticks, each tick runs all expired timers", METRIC_COUNTER );
+static Metric metric_tick_time( "rathena_tick_microseconds_total", "Time spent running timers", METRIC_COUNTER );
+static Metric metric_timers( "rathena_timers", "Timers that are waiting to expire", METRIC_GAUGE );
+
+static void timer_collect_metrics(void)
+{
+	metric_timers.set(BHEAP_LENGTH(timer_heap));
+}
+
 /// Executes all expired timers.
 /// Returns the value of the smallest non-expired timer (or 1 second if there aren't any).
 t_tick do_timer(t_tick tick)
 {
 	t_tick diff = TIMER_MAX_INTERVAL; // return value
+	uint64 tick_start = profiler_now();
 
 	// process all timers one by one
 	while( BHEAP_LENGTH(timer_heap) )
@@ -373,11 +409,17 @@ t_tick do_timer(t_tick tick)
 
 		if( timer_data[tid].func )
 		{
+			TimerFunc func = timer_data[tid].func;
+			uint64 start = profiler_enabled ? profiler_now() : 0;
+
 			if( diff < -1000 )
 				// timer was delayed for more than 1 second, use current tick instead
-				timer_data[tid].func(tid, tick, timer_data[tid].id, timer_data[tid].data);
+				func(tid, tick, timer_data[tid].id, timer_data[tid].data);
 			else
-				timer_data[tid].func(tid, timer_data[tid].tick, timer_data[tid].id, timer_data[tid].data);
+				func(tid, timer_data[tid].tick, timer_data[tid].id, timer_data[tid].data);
+
+			if( profiler_enabled )
+				profiler_record(PROFILE_TIMER, reinterpret_cast<uintptr_t>(func), start);
 		}
 
 		// in the case the function didn't change anything...
@@ -408,6 +450,9 @@ t_tick do_timer(t_tick tick)
 		}
 	}
 
+	metric_ticks.add();
+	metric_tick_time.add((profiler_now() - tick_start) / 1000);
+
 	return cap_value(diff, TIMER_MIN_INTERVAL, TIMER_MAX_INTERVAL);
 }
 
@@ -521,6 +566,8 @@ void timer_init(void)
 #endif
 
 	time(&start_time);
+
+	metrics_add_collector(timer_collect_metrics);
 }
 
 void timer_final(void)
@@ -50,6 +50,8 @@ struct TimerData {
 
 t_tick gettick(void);
 t_tick gettick_nocache(void);
+void timer_virtual_clock(t_tick start);
+void timer_virtual_advance(t_tick diff);
 
 int32 add_timer(t_tick tick, TimerFunc func, int32 id, intptr_t data);
 int32 add_timer_interval(t_tick tick, TimerFunc func, int32 id, intptr_t data, int32 interval);
@@ -60,6 +62,7 @@ t_tick addtick_timer(int32 tid, t_tick tick);
 t_tick settick_timer(int32 tid, t_tick tick);
 
 int32 add_timer_func_list(TimerFunc func, const char* name);
+const char* search_timer_func_list(TimerFunc func);
 
 unsigned long get_uptime(void);
 
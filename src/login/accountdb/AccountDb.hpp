@@ -82,6 +82,20 @@ public:
 	// Refreshes the web auth token for the given account
 	virtual bool refreshWebToken(MmoAccount& acc) = 0;
 
+	// Writes the metrics of the login-server to the login database, where the web-server reads them.
+	//
+	// @param server Name of the login-server
+	// @return true if successful
+	virtual bool saveMetrics(const char* server) = 0;
+
+	// Loads the numeric and string account registries with one query.
+	//
+	// @param account_id Target account id
+	// @param num_regs Receives the numeric registries
+	// @param str_regs Receives the string registries
+	// @return true if successful
+	virtual bool loadGlobalAccReg(uint32 account_id, std::vector<AccountRegVesselNum>& num_regs, std::vector<AccountRegVesselStr>& str_regs) = 0;
+
 	virtual std::vector<AccountRegVesselNum> loadGlobalAccRegNum(uint32 account_id) = 0;
 	virtual std::vector<AccountRegVesselStr> loadGlobalAccRegStr(uint32 account_id) = 0;
 	virtual void saveGlobalAccRegNum(uint32 account_id, std::string_view key, uint32 index, uint64 value) = 0;
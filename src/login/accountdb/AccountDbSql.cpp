@@ -1,6 +1,7 @@
 #include "AccountDbSql.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <charconv>
 #include <memory>
 #include <string>
@@ -8,6 +9,7 @@
 #include <config/core.hpp>
 
 #include <common/cbasetypes.hpp>
+#include <common/metrics.hpp>
 #include <common/mmo.hpp>
 #include <common/showmsg.hpp>
 #include <common/sql.hpp>
@@ -19,6 +21,74 @@
 constexpr std::string_view LOGIN_SERVER_PROPERTY_PREFIX = "login_server_";
 constexpr std::string_view LOGIN_PROPERTY_PREFIX = "login_";
 
+#ifdef VIP_ENABLE
+constexpr const char* ACCOUNT_COLUMNS =
+	"`account_id`,`userid`,`user_pass`,`sex`,`email`,`group_id`,`state`"
+	",`unban_time`,`expiration_time`,`logincount`,`lastlogin`,`last_ip`"
+	",`birthdate`,`character_slots`,`pincode`, `pincode_change`, "
+	"`vip_time`, `old_group`";
+#else
+constexpr const char* ACCOUNT_COLUMNS =
+	"`account_id`,`userid`,`user_pass`,`sex`,`email`,`group_id`,`state`"
+	",`unban_time`,`expiration_time`,`logincount`,`lastlogin`,`last_ip`"
+	",`birthdate`,`character_slots`,`pincode`, `pincode_change`";
+#endif
+
+// Reads one account from an executed statement that selected ACCOUNT_COLUMNS.
+// Fails if the statement did not return exactly one row.
+static bool account_fetch(SqlStmt& stmt, MmoAccount& acc, const char* source) {
+	char sex[2];
+	int64 unban_time, expiration_time, pincode_change;
+#ifdef VIP_ENABLE
+	int64 vip_time;
+#endif
+
+	if (SQL_SUCCESS != stmt.BindColumn(0, SQLDT_UINT32, &acc.account_id) ||
+		SQL_SUCCESS != stmt.BindColumn(1, SQLDT_STRING, acc.userid, sizeof(acc.userid)) ||
+		SQL_SUCCESS != stmt.BindColumn(2, SQLDT_STRING, acc.pass, sizeof(acc.pass)) ||
+		SQL_SUCCESS != stmt.BindColumn(3, SQLDT_ENUM, sex, sizeof(sex)) ||
+		SQL_SUCCESS != stmt.BindColumn(4, SQLDT_STRING, acc.email, sizeof(acc.email)) ||
+		SQL_SUCCESS != stmt.BindColumn(5, SQLDT_UINT32, &acc.group_id) ||
+		SQL_SUCCESS != stmt.BindColumn(6, SQLDT_UINT32, &acc.state) ||
+		SQL_SUCCESS != stmt.BindColumn(7, SQLDT_INT64, &unban_time) ||
+		SQL_SUCCESS != stmt.BindColumn(8, SQLDT_INT64, &expiration_time) ||
+		SQL_SUCCESS != stmt.BindColumn(9, SQLDT_UINT32, &acc.logincount) ||
+		SQL_SUCCESS != stmt.BindColumn(10, SQLDT_STRING, acc.lastlogin, sizeof(acc.lastlogin)) ||
+		SQL_SUCCESS != stmt.BindColumn(11, SQLDT_STRING, acc.last_ip, sizeof(acc.last_ip)) ||
+		SQL_SUCCESS != stmt.BindColumn(12, SQLDT_STRING, acc.birthdate, sizeof(acc.birthdate)) ||
+		SQL_SUCCESS != stmt.BindColumn(13, SQLDT_UINT8, &acc.char_slots) ||
+		SQL_SUCCESS != stmt.BindColumn(14, SQLDT_STRING, acc.pincode, sizeof(acc.pincode)) ||
+		SQL_SUCCESS != stmt.BindColumn(15, SQLDT_INT64, &pincode_change)
+#ifdef VIP_ENABLE
+		|| SQL_SUCCESS != stmt.BindColumn(16, SQLDT_INT64, &vip_time) ||
+		SQL_SUCCESS != stmt.BindColumn(17, SQLDT_INT32, &acc.old_group)
+#endif
+		) {
+		SqlStmt_ShowDebug(stmt);
+		return false;
+	}
+
+	if (stmt.NumRows() > 1) {
+		ShowError("account_fetch: multiple accounts found when retrieving data for account '%s'!\n", source);
+		return false;
+	}
+
+	if (SQL_SUCCESS != stmt.NextRow()) {
+		return false;
+	}
+
+	acc.sex = sex[0];
+	acc.unban_time = static_cast<time_t>(unban_time);
+	acc.expiration_time = static_cast<time_t>(expiration_time);
+	acc.pincode_change = static_cast<time_t>(pincode_change);
+#ifdef VIP_ENABLE
+	acc.vip_time = static_cast<time_t>(vip_time);
+#endif
+	acc.web_auth_token[0] = '\0';
+
+	return true;
+}
+
 AccountDbSql::~AccountDbSql() {
 	if (accounts_ == nullptr) {
 		return;
@@ -92,6 +162,13 @@ bool AccountDbSql::setProperty(std::string_view key, std::string_view value) {
 		}
 		else if (key == "case_sensitive") {
 			case_sensitive_ = config_switch(value.data());
+			cache_.clear();
+			cache_userids_.clear();
+		}
+		else if (key == "account_cache_ttl") {
+			std::from_chars(value.data(), value.data() + value.size(), cache_ttl_);
+			cache_.clear();
+			cache_userids_.clear();
 		}
 		else {
 			return false;
@@ -156,6 +233,8 @@ bool AccountDbSql::remove(const uint32 account_id) {
 
 	result &= (SQL_SUCCESS == Sql_QueryStr(accounts_, (result == true) ? "COMMIT" : "ROLLBACK"));
 
+	cacheRemove(account_id);
+
 	return result;
 }
 
@@ -194,6 +273,10 @@ bool AccountDbSql::removeAllWebTokens() {
 	return true;
 }
 
+bool AccountDbSql::saveMetrics(const char* server) {
+	return metrics_save(accounts_, server);
+}
+
 bool AccountDbSql::refreshWebToken(MmoAccount& acc) {
 	static bool initialized = false;
 	static const char* query;
@@ -258,85 +341,98 @@ bool AccountDbSql::save(const MmoAccount& acc) {
 }
 
 bool AccountDbSql::loadFromAccountId(MmoAccount& acc, const uint32 account_id) {
-	return load(acc, account_id);
+	if (cacheGet(acc, account_id)) {
+		return true;
+	}
+
+	if (!load(acc, account_id)) {
+		return false;
+	}
+
+	cachePut(acc);
+	return true;
 }
 
 bool AccountDbSql::loadFromUsername(MmoAccount& acc, const char* userid) {
-	if (SQL_SUCCESS != Sql_Query(accounts_,
-								 "SELECT `account_id` FROM `%s` WHERE `userid` = %s '%s'",
-								 account_table_.c_str(),
-								 case_sensitive_ ? "BINARY" : "",
-								 userid)) {
-		Sql_ShowDebug(accounts_);
-		return false;
+	if (cache_ttl_ > 0) {
+		auto it = cache_userids_.find(cacheKey(userid));
+
+		if (it != cache_userids_.end() && cacheGet(acc, it->second)) {
+			return true;
+		}
 	}
-	if (Sql_NumRows(accounts_) > 1) {
-		ShowError("account_db_sql_load_str: multiple accounts found when retrieving data for account '%s'!\n", userid);
-		Sql_FreeResult(accounts_);
+
+	SqlStmt stmt{*accounts_};
+
+	if (SQL_SUCCESS != stmt.Prepare("SELECT %s FROM `%s` WHERE `userid` = %s ?",
+									ACCOUNT_COLUMNS,
+									account_table_.c_str(),
+									case_sensitive_ ? "BINARY" : "") ||
+		SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, (void*)userid, strlen(userid)) ||
+		SQL_SUCCESS != stmt.Execute()) {
+		SqlStmt_ShowDebug(stmt);
 		return false;
 	}
-	if (SQL_SUCCESS != Sql_NextRow(accounts_)) {
-		Sql_FreeResult(accounts_);
+
+	if (!account_fetch(stmt, acc, userid)) {
 		return false;
 	}
-	char* data;
-	Sql_GetData(accounts_, 0, &data, nullptr);
-	return load(acc, atoi(data));
+
+	cachePut(acc);
+	return true;
 }
 
-std::vector<AccountRegVesselStr> AccountDbSql::loadGlobalAccRegStr(uint32 account_id) {
-	if (SQL_SUCCESS != Sql_Query(accounts_,
-								 "SELECT `key`, `index`, `value` FROM `%s` WHERE `account_id` = %d",
-								 global_acc_reg_num_table_.c_str(),
-								 account_id)) {
-		Sql_ShowDebug(accounts_);
-		return {};
+bool AccountDbSql::loadGlobalAccReg(uint32 account_id, std::vector<AccountRegVesselNum>& num_regs, std::vector<AccountRegVesselStr>& str_regs) {
+	SqlStmt stmt{*accounts_};
+	uint8 is_string;
+	char key[32 + 1];
+	uint32 index;
+	char str_value[254 + 1];
+	int64 num_value;
+
+	// One round trip for both tables, the column that does not belong to a row's type is empty
+	if (SQL_SUCCESS != stmt.Prepare("SELECT 1, `key`, `index`, `value`, 0 FROM `%s` WHERE `account_id` = ? "
+									"UNION ALL SELECT 0, `key`, `index`, '', `value` FROM `%s` WHERE `account_id` = ?",
+									global_acc_reg_str_table_.c_str(),
+									global_acc_reg_num_table_.c_str()) ||
+		SQL_SUCCESS != stmt.BindParam(0, SQLDT_UINT32, &account_id, sizeof(account_id)) ||
+		SQL_SUCCESS != stmt.BindParam(1, SQLDT_UINT32, &account_id, sizeof(account_id)) ||
+		SQL_SUCCESS != stmt.Execute() ||
+		SQL_SUCCESS != stmt.BindColumn(0, SQLDT_UINT8, &is_string) ||
+		SQL_SUCCESS != stmt.BindColumn(1, SQLDT_STRING, key, sizeof(key)) ||
+		SQL_SUCCESS != stmt.BindColumn(2, SQLDT_UINT32, &index) ||
+		SQL_SUCCESS != stmt.BindColumn(3, SQLDT_STRING, str_value, sizeof(str_value)) ||
+		SQL_SUCCESS != stmt.BindColumn(4, SQLDT_INT64, &num_value)) {
+		SqlStmt_ShowDebug(stmt);
+		return false;
 	}
 
-	std::vector<AccountRegVesselStr> regs;
-
-	while (SQL_SUCCESS == Sql_NextRow(accounts_)) {
-		AccountRegVesselStr reg;
-		char* data;
-
-		Sql_GetData(accounts_, 0, &data, nullptr);
-		reg.key = data;
-		Sql_GetData(accounts_, 1, &data, nullptr);
-		reg.index = atoi(data);
-		Sql_GetData(accounts_, 2, &data, nullptr);
-		reg.value = data;
-		regs.push_back(reg);
+	while (SQL_SUCCESS == stmt.NextRow()) {
+		if (is_string) {
+			str_regs.push_back({key, index, str_value});
+		}
+		else {
+			num_regs.push_back({key, index, static_cast<uint64>(num_value)});
+		}
 	}
-	Sql_FreeResult(accounts_);
-	return regs;
-}
 
-std::vector<AccountRegVesselNum> AccountDbSql::loadGlobalAccRegNum(uint32 account_id) {
-	if (SQL_SUCCESS != Sql_Query(accounts_,
-								 "SELECT `key`, `index`, `value` FROM `%s` WHERE `account_id` = %d",
-								 global_acc_reg_num_table_.c_str(),
-								 account_id)) {
-		Sql_ShowDebug(accounts_);
-		return {};
-	}
+	return true;
+}
 
-	std::vector<AccountRegVesselNum> regs;
+std::vector<AccountRegVesselStr> AccountDbSql::loadGlobalAccRegStr(uint32 account_id) {
+	std::vector<AccountRegVesselNum> num_regs;
+	std::vector<AccountRegVesselStr> str_regs;
 
-	while (SQL_SUCCESS == Sql_NextRow(accounts_)) {
-		AccountRegVesselNum reg;
-		char* data;
+	loadGlobalAccReg(account_id, num_regs, str_regs);
+	return str_regs;
+}
 
-		Sql_GetData(accounts_, 0, &data, nullptr);
-		reg.key = data;
-		Sql_GetData(accounts_, 1, &data, nullptr);
-		reg.index = atoi(data);
-		Sql_GetData(accounts_, 2, &data, nullptr);
-		reg.value = atoi(data);
-		regs.push_back(reg);
-	}
+std::vector<AccountRegVesselNum> AccountDbSql::loadGlobalAccRegNum(uint32 account_id) {
+	std::vector<AccountRegVesselNum> num_regs;
+	std::vector<AccountRegVesselStr> str_regs;
 
-	Sql_FreeResult(accounts_);
-	return regs;
+	loadGlobalAccReg(account_id, num_regs, str_regs);
+	return num_regs;
 }
 
 void AccountDbSql::saveGlobalAccRegNum(uint32 account_id, std::string_view key, uint32 index, uint64 value) {
@@ -425,74 +521,16 @@ void AccountDbSql::deleteGlobalAccRegStr(uint32 account_id, std::string_view key
 }
 
 bool AccountDbSql::load(MmoAccount& acc, uint32 account_id) {
-	if (SQL_ERROR == Sql_Query(accounts_,
-#ifdef VIP_ENABLE
-							   "SELECT "
-							   "`account_id`,`userid`,`user_pass`,`sex`,`email`,`group_id`,`state`"
-							   ",`unban_time`,`expiration_time`,`logincount`,`lastlogin`,`last_ip`"
-							   ",`birthdate`,`character_slots`,`pincode`, `pincode_change`, "
-							   "`vip_time`, `old_group` FROM `%s` WHERE `account_id` = %" PRIu32,
-#else
-							   "SELECT "
-							   "`account_id`,`userid`,`user_pass`,`sex`,`email`,`group_id`,`state`"
-							   ",`unban_time`,`expiration_time`,`logincount`,`lastlogin`,`last_ip`"
-							   ",`birthdate`,`character_slots`,`pincode`, `pincode_change` FROM "
-							   "`%s` WHERE `account_id` = %" PRIu32,
-#endif
-							   account_table_.c_str(),
-							   account_id)) {
-		Sql_ShowDebug(accounts_);
-		return false;
-	}
+	SqlStmt stmt{*accounts_};
 
-	if (SQL_SUCCESS != Sql_NextRow(accounts_)) {
-		Sql_FreeResult(accounts_);
+	if (SQL_SUCCESS != stmt.Prepare("SELECT %s FROM `%s` WHERE `account_id` = ?", ACCOUNT_COLUMNS, account_table_.c_str()) ||
+		SQL_SUCCESS != stmt.BindParam(0, SQLDT_UINT32, &account_id, sizeof(account_id)) ||
+		SQL_SUCCESS != stmt.Execute()) {
+		SqlStmt_ShowDebug(stmt);
 		return false;
 	}
 
-	char* data;
-	Sql_GetData(accounts_, 0, &data, nullptr);
-	acc.account_id = atoi(data);
-	Sql_GetData(accounts_, 1, &data, nullptr);
-	safestrncpy(acc.userid, data, sizeof(acc.userid));
-	Sql_GetData(accounts_, 2, &data, nullptr);
-	safestrncpy(acc.pass, data, sizeof(acc.pass));
-	Sql_GetData(accounts_, 3, &data, nullptr);
-	acc.sex = data[0];
-	Sql_GetData(accounts_, 4, &data, nullptr);
-	safestrncpy(acc.email, data, sizeof(acc.email));
-	Sql_GetData(accounts_, 5, &data, nullptr);
-	acc.group_id = strtoul(data, nullptr, 10);
-	Sql_GetData(accounts_, 6, &data, nullptr);
-	acc.state = strtoul(data, nullptr, 10);
-	Sql_GetData(accounts_, 7, &data, nullptr);
-	acc.unban_time = strtoull(data, nullptr, 10);
-	Sql_GetData(accounts_, 8, &data, nullptr);
-	acc.expiration_time = strtoull(data, nullptr, 10);
-	Sql_GetData(accounts_, 9, &data, nullptr);
-	acc.logincount = strtoul(data, nullptr, 10);
-	Sql_GetData(accounts_, 10, &data, nullptr);
-	safestrncpy(acc.lastlogin, data ? data : "", sizeof(acc.lastlogin));
-	Sql_GetData(accounts_, 11, &data, nullptr);
-	safestrncpy(acc.last_ip, data, sizeof(acc.last_ip));
-	Sql_GetData(accounts_, 12, &data, nullptr);
-	safestrncpy(acc.birthdate, data ? data : "", sizeof(acc.birthdate));
-	Sql_GetData(accounts_, 13, &data, nullptr);
-	acc.char_slots = atoi(data);
-	Sql_GetData(accounts_, 14, &data, nullptr);
-	safestrncpy(acc.pincode, data, sizeof(acc.pincode));
-	Sql_GetData(accounts_, 15, &data, nullptr);
-	acc.pincode_change = strtoull(data, nullptr, 10);
-#ifdef VIP_ENABLE
-	Sql_GetData(accounts_, 16, &data, nullptr);
-	acc.vip_time = strtoull(data, nullptr, 10);
-	Sql_GetData(accounts_, 17, &data, nullptr);
-	acc.old_group = atoi(data);
-#endif
-	Sql_FreeResult(accounts_);
-	acc.web_auth_token[0] = '\0';
-
-	return true;
+	return account_fetch(stmt, acc, std::to_string(account_id).c_str());
 }
 
 bool AccountDbSql::save(const MmoAccount& acc, bool is_new) {
@@ -587,5 +625,83 @@ bool AccountDbSql::save(const MmoAccount& acc, bool is_new) {
 		}
 	}
 
+	cachePut(acc);
+	return true;
+}
+
+std::string AccountDbSql::cacheKey(const char* userid) const {
+	std::string key = userid;
+
+	// The table's collation compares userids case-insensitively
+	if (!case_sensitive_) {
+		std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	}
+
+	return key;
+}
+
+bool AccountDbSql::cacheGet(MmoAccount& acc, uint32 account_id) {
+	if (cache_ttl_ == 0) {
+		return false;
+	}
+
+	auto it = cache_.find(account_id);
+
+	if (it == cache_.end()) {
+		return false;
+	}
+
+	if (DIFF_TICK(gettick(), it->second.expires) >= 0) {
+		cacheRemove(account_id);
+		return false;
+	}
+
+	acc = it->second.account;
 	return true;
 }
+
+void AccountDbSql::cachePut(const MmoAccount& acc) {
+	if (cache_ttl_ == 0) {
+		return;
+	}
+
+	t_tick now = gettick();
+
+	// Drop the expired accounts once per period, so accounts that are not loaded again do not stay forever
+	if (DIFF_TICK(now, cache_sweep_) >= 0) {
+		for (auto it = cache_.begin(); it != cache_.end();) {
+			if (DIFF_TICK(now, it->second.expires) >= 0) {
+				cache_userids_.erase(cacheKey(it->second.account.userid));
+				it = cache_.erase(it);
+			}
+			else {
+				it++;
+			}
+		}
+
+		cache_sweep_ = now + cache_ttl_ * 1000;
+	}
+
+	CachedAccount& entry = cache_[acc.account_id];
+
+	// The userid might have changed
+	if (entry.expires != 0 && strcmp(entry.account.userid, acc.userid) != 0) {
+		cache_userids_.erase(cacheKey(entry.account.userid));
+	}
+
+	entry.account = acc;
+	entry.account.web_auth_token[0] = '\0';
+	entry.expires = now + cache_ttl_ * 1000;
+	cache_userids_[cacheKey(acc.userid)] = acc.account_id;
+}
+
+void AccountDbSql::cacheRemove(uint32 account_id) {
+	auto it = cache_.find(account_id);
+
+	if (it == cache_.end()) {
+		return;
+	}
+
+	cache_userids_.erase(cacheKey(it->second.account.userid));
+	cache_.erase(it);
+}
@@ -2,11 +2,13 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include <config/core.hpp>
 
 #include <common/cbasetypes.hpp>
 #include <common/sql.hpp>
+#include <common/timer.hpp>
 
 #include "AccountDb.hpp"
 #include "MmoAccount.hpp"
@@ -71,6 +73,9 @@ public:
 
 	bool refreshWebToken(MmoAccount& acc) override;
 
+	bool saveMetrics(const char* server) override;
+
+	bool loadGlobalAccReg(uint32 account_id, std::vector<AccountRegVesselNum>& num_regs, std::vector<AccountRegVesselStr>& str_regs) override;
 	std::vector<AccountRegVesselNum> loadGlobalAccRegNum(uint32 account_id) override;
 	std::vector<AccountRegVesselStr> loadGlobalAccRegStr(uint32 account_id) override;
 	void saveGlobalAccRegNum(uint32 account_id, std::string_view key, uint32 index, uint64 value) override;
@@ -93,6 +98,23 @@ private:
 	std::string global_acc_reg_num_table_{"global_acc_reg_num"};
 	std::string global_acc_reg_str_table_{"global_acc_reg_str"};
 
+	// Accounts that were recently loaded or saved.
+	// Everything the login-server saves goes through the cache, changes of other tools
+	// to the account table are seen once the entry expired.
+	struct CachedAccount {
+		MmoAccount account;
+		t_tick expires;
+	};
+	uint32 cache_ttl_{0}; // seconds, 0 disables the cache
+	std::unordered_map<uint32, CachedAccount> cache_;
+	std::unordered_map<std::string, uint32> cache_userids_; // account id by userid, lowercase unless the userids are case sensitive
+	t_tick cache_sweep_{0};
+
+	std::string cacheKey(const char* userid) const;
+	bool cacheGet(MmoAccount& acc, uint32 account_id);
+	void cachePut(const MmoAccount& acc);
+	void cacheRemove(uint32 account_id);
+
 	bool load(MmoAccount& acc, uint32 account_id);
 	bool save(const MmoAccount& acc, bool is_new);
 };
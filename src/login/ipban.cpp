@@ -5,6 +5,8 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <unordered_map>
 
 #include <common/cbasetypes.hpp>
 #include <common/showmsg.hpp>
@@ -12,6 +14,7 @@
 #include <common/strlib.hpp>
 #include <common/timer.hpp>
 
+#include "ipbanfailures.hpp"
 #include "login.hpp"
 #include "loginlog.hpp"
 
@@ -27,10 +30,103 @@ std::string ipban_table = "ipbanlist";
 // globals
 static Sql* sql_handle = nullptr;
 static int32 cleanup_timer_id = INVALID_TIMER;
+static int32 refresh_timer_id = INVALID_TIMER;
 static bool ipban_inited = false;
 
+/// Number of octets a ban entry matches ('a.*.*.*' = 1 ... 'a.b.c.d' = 4)
+#define IPBAN_MASK_LEVELS 4
+
+/// Active bans by masked address and expiration time, one table per mask level
+static std::unordered_map<uint32, time_t> ipban_masks[IPBAN_MASK_LEVELS];
+/// Recent password failures per address
+static IpbanFailures ipban_failures;
+
 //early declaration
 TIMER_FUNC(ipban_cleanup);
+TIMER_FUNC(ipban_refresh);
+
+/**
+ * Mask an ip down to the octets that a ban entry of the given level matches.
+ * @param ip: ipv4 ip
+ * @param level: mask level, 0 = 'a.*.*.*' ... 3 = 'a.b.c.d'
+ * @return masked ip
+ */
+static uint32 ipban_mask(uint32 ip, int32 level) {
+	return ip & ( 0xFFFFFFFFu << ( 8 * ( IPBAN_MASK_LEVELS - 1 - level ) ) );
+}
+
+/**
+ * Add a ban entry to in-memory tables.
+ * @param masks: tables to add the entry to
+ * @param list: ban mask as stored in the `list` column
+ * @param rtime: expiration time of the ban
+ */
+static void ipban_add(std::unordered_map<uint32, time_t>* masks, const char* list, time_t rtime) {
+	uint32 octets[IPBAN_MASK_LEVELS] = {};
+	uint32 ip = 0;
+	int32 level = -1;
+	const char* p = list;
+
+	for( int32 i = 0; i < IPBAN_MASK_LEVELS; i++ ){
+		if( *p == '*' )
+			break;
+		if( !ISDIGIT(*p) )
+			return;// malformed entry
+		octets[i] = (uint32)strtoul(p, (char**)&p, 10);
+		if( octets[i] > 255 )
+			return;
+		level = i;
+		if( *p != '.' )
+			break;
+		p++;
+	}
+
+	if( level < 0 )
+		return;
+
+	for( int32 i = 0; i < IPBAN_MASK_LEVELS; i++ )
+		ip = ( ip << 8 ) | octets[i];
+
+	time_t& expiration = masks[level][ip];
+
+	expiration = i64max( expiration, rtime );
+}
+
+/**
+ * Load the active bans from the database, replacing the ones in memory.
+ * All active bans are loaded, since bans can be added with any ban time and removed by other tools.
+ */
+static void ipban_load(void) {
+	char* data;
+
+	if( SQL_ERROR == Sql_Query(sql_handle, "SELECT `list`, UNIX_TIMESTAMP(`rtime`) FROM `%s` WHERE `rtime` > NOW()", ipban_table.c_str()) )
+	{
+		Sql_ShowDebug(sql_handle);
+		return;// keep what we have
+	}
+
+	std::unordered_map<uint32, time_t> masks[IPBAN_MASK_LEVELS];
+
+	while( SQL_SUCCESS == Sql_NextRow(sql_handle) ){
+		char list[16];
+
+		Sql_GetData(sql_handle, 0, &data, nullptr); safestrncpy(list, data, sizeof(list));
+		Sql_GetData(sql_handle, 1, &data, nullptr);
+		ipban_add(masks, list, (time_t)strtoll(data, nullptr, 10));
+	}
+
+	Sql_FreeResult(sql_handle);
+
+	for( int32 level = 0; level < IPBAN_MASK_LEVELS; level++ )
+		ipban_masks[level].swap(masks[level]);
+}
+
+/**
+ * Forget password failures that are too old to count towards a dynamic ban.
+ */
+static void ipban_prune_failures(void) {
+	ipban_failures.prune(time(nullptr), (time_t)login_config.dynamic_pass_failure_ban_interval * 60);
+}
 
 /**
  * Check if ip is in the active bans list.
@@ -38,29 +134,24 @@ TIMER_FUNC(ipban_cleanup);
  * @return true if found or error, false if not in list
  */
 bool ipban_check(uint32 ip) {
-	uint8* p = (uint8*)&ip;
-	char* data = nullptr;
-	int32 matches;
-
 	if( !login_config.ipban )
 		return false;// ipban disabled
 
-	if( SQL_ERROR == Sql_Query(sql_handle, "SELECT count(*) FROM `%s` WHERE `rtime` > NOW() AND (`list` = '%u.*.*.*' OR `list` = '%u.%u.*.*' OR `list` = '%u.%u.%u.*' OR `list` = '%u.%u.%u.%u')",
-		ipban_table.c_str(), p[3], p[3], p[2], p[3], p[2], p[1], p[3], p[2], p[1], p[0]) )
-	{
-		Sql_ShowDebug(sql_handle);
-		// close connection because we can't verify their connectivity.
-		return true;
-	}
+	time_t now = time(nullptr);
 
-	if( SQL_ERROR == Sql_NextRow(sql_handle) )
-		return true;// Shouldn't happen, but just in case...
+	for( int32 level = 0; level < IPBAN_MASK_LEVELS; level++ ){
+		auto it = ipban_masks[level].find(ipban_mask(ip, level));
 
-	Sql_GetData(sql_handle, 0, &data, nullptr);
-	matches = atoi(data);
-	Sql_FreeResult(sql_handle);
+		if( it == ipban_masks[level].end() )
+			continue;
+
+		if( it->second > now )
+			return true;
 
-	return( matches > 0 );
+		ipban_masks[level].erase(it);// expired
+	}
+
+	return false;
 }
 
 /**
@@ -69,27 +160,35 @@ bool ipban_check(uint32 ip) {
  * @param ip: ipv4 ip to record the failure
  */
 void ipban_log(uint32 ip) {
-	unsigned long failures;
-
 	if( !login_config.ipban )
 		return;// ipban disabled
 
-	failures = loginlog_failedattempts(ip, login_config.dynamic_pass_failure_ban_interval);// how many times failed account? in one ip.
+	time_t now = time(nullptr);
+
+	// how many times failed account? in one ip.
+	size_t attempts = ipban_failures.add(ip, now, (time_t)login_config.dynamic_pass_failure_ban_interval * 60);
 
 	// if over the limit, add a temporary ban entry
-	if( failures >= login_config.dynamic_pass_failure_ban_limit )
+	if( attempts >= login_config.dynamic_pass_failure_ban_limit )
 	{
 		uint8* p = (uint8*)&ip;
-		if( SQL_ERROR == Sql_Query(sql_handle, "INSERT INTO `%s`(`list`,`btime`,`rtime`,`reason`) VALUES ('%u.%u.%u.*', NOW() , NOW() +  INTERVAL %d MINUTE ,'Password error ban')",
-			ipban_table.c_str(), p[3], p[2], p[1], login_config.dynamic_pass_failure_ban_duration) )
+		char list[16];
+
+		safesnprintf(list, sizeof(list), "%u.%u.%u.*", p[3], p[2], p[1]);
+		ipban_add(ipban_masks, list, now + (time_t)login_config.dynamic_pass_failure_ban_duration * 60);
+		ipban_failures.forget(ip);
+
+		if( SQL_ERROR == Sql_Query(sql_handle, "INSERT INTO `%s`(`list`,`btime`,`rtime`,`reason`) VALUES ('%s', NOW() , NOW() +  INTERVAL %d MINUTE ,'Password error ban')",
+			ipban_table.c_str(), list, login_config.dynamic_pass_failure_ban_duration) )
 			Sql_ShowDebug(sql_handle);
 	}
 }
 
 /**
  * Timered function to remove expired bans.
- *  Request all characters to update their registered ip and transmit their new ip.
- *  Performed each ip_sync_interval.
+ *  Also forgets old password failures and, without a refresh timer, reloads the ban list,
+ *  so that bans removed from the database are lifted.
+ *  Performed each ipban_cleanup_interval.
  * @param tid: timer id
  * @param tick: tick of execution
  * @param id: unused
@@ -103,6 +202,31 @@ TIMER_FUNC(ipban_cleanup){
 	if( SQL_ERROR == Sql_Query(sql_handle, "DELETE FROM `%s` WHERE `rtime` <= NOW()", ipban_table.c_str()) )
 		Sql_ShowDebug(sql_handle);
 
+	ipban_prune_failures();
+
+	if( login_config.ipban_refresh_interval == 0 )
+		ipban_load();
+
+	return 0;
+}
+
+/**
+ * Timered function to load bans that were added to or removed from the database by others.
+ *  Also forgets old password failures.
+ *  Performed each ipban_refresh_interval.
+ * @param tid: timer id
+ * @param tick: tick of execution
+ * @param id: unused
+ * @param data: unused
+ * @return 0
+ */
+TIMER_FUNC(ipban_refresh){
+	if( !login_config.ipban )
+		return 0;// ipban disabled
+
+	ipban_load();
+	ipban_prune_failures();
+
 	return 0;
 }
 
@@ -158,13 +282,16 @@ bool ipban_config_read(const char* key, const char* value) {
 			login_config.dynamic_pass_failure_ban = (config_switch(value) != 0);
 		else
 		if( strcmpi(key, "dynamic_pass_failure_ban_interval") == 0 )
-			login_config.dynamic_pass_failure_ban_interval = atoi(value);
+			login_config.dynamic_pass_failure_ban_interval = (uint32)i32max(atoi(value), 1);
 		else
 		if( strcmpi(key, "dynamic_pass_failure_ban_limit") == 0 )
 			login_config.dynamic_pass_failure_ban_limit = atoi(value);
 		else
 		if( strcmpi(key, "dynamic_pass_failure_ban_duration") == 0 )
 			login_config.dynamic_pass_failure_ban_duration = atoi(value);
+		else
+		if( strcmpi(key, "refresh_interval") == 0 )
+			login_config.ipban_refresh_interval = (uint32)atoi(value);
 		else
 			return false;// not found
 		return true;
@@ -202,12 +329,20 @@ void ipban_init(void) {
 	if( !ipban_codepage.empty() && SQL_ERROR == Sql_SetEncoding(sql_handle, ipban_codepage.c_str()) )
 		Sql_ShowDebug(sql_handle);
 
+	ipban_load();
+
 	if( login_config.ipban_cleanup_interval > 0 )
 	{ // set up periodic cleanup of connection history and active bans
 		add_timer_func_list(ipban_cleanup, "ipban_cleanup");
 		cleanup_timer_id = add_timer_interval(gettick()+10, ipban_cleanup, 0, 0, login_config.ipban_cleanup_interval*1000);
 	} else // make sure it gets cleaned up on login-server start regardless of interval-based cleanups
 		ipban_cleanup(0,0,0,0);
+
+	if( login_config.ipban_refresh_interval > 0 )
+	{ // pick up bans added by other tools
+		add_timer_func_list(ipban_refresh, "ipban_refresh");
+		refresh_timer_id = add_timer_interval(gettick()+login_config.ipban_refresh_interval*1000, ipban_refresh, 0, 0, login_config.ipban_refresh_interval*1000);
+	}
 }
 
 /**
@@ -222,9 +357,18 @@ void ipban_final(void) {
 		// release data
 		delete_timer(cleanup_timer_id, ipban_cleanup);
 
-	ipban_cleanup(0,0,0,0); // always clean up on login-server stop
+	if( login_config.ipban_refresh_interval > 0 )
+		delete_timer(refresh_timer_id, ipban_refresh);
+
+	// always clean up on login-server stop
+	if( SQL_ERROR == Sql_Query(sql_handle, "DELETE FROM `%s` WHERE `rtime` <= NOW()", ipban_table.c_str()) )
+		Sql_ShowDebug(sql_handle);
 
 	// close connections
 	Sql_Free(sql_handle);
 	sql_handle = nullptr;
+
+	for( auto& masks : ipban_masks )
+		masks.clear();
+	ipban_failures.clear();
 }
@@ -0,0 +1,77 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef IPBANFAILURES_HPP
+#define IPBANFAILURES_HPP
+
+#include <ctime>
+#include <deque>
+#include <unordered_map>
+
+#include <common/cbasetypes.hpp>
+
+/// Times of recent password failures per address, counted within a sliding window
+class IpbanFailures{
+private:
+	std::unordered_map<uint32, std::deque<time_t>> failures;
+
+public:
+	/**
+	 * Records a password failure.
+	 * @param ip: ipv4 ip that failed
+	 * @param now: time of the failure
+	 * @param window: how far back failures are counted in seconds
+	 * @return number of failures of the address within the window, including this one
+	 */
+	size_t add( uint32 ip, time_t now, time_t window ){
+		std::deque<time_t>& attempts = this->failures[ip];
+
+		attempts.push_back( now );
+
+		while( !attempts.empty() && attempts.front() <= now - window ){
+			attempts.pop_front();
+		}
+
+		size_t count = attempts.size();
+
+		if( count == 0 ){
+			this->failures.erase( ip );
+		}
+
+		return count;
+	}
+
+	/**
+	 * Forgets the failures of an address, once it was banned.
+	 * @param ip: ipv4 ip
+	 */
+	void forget( uint32 ip ){
+		this->failures.erase( ip );
+	}
+
+	/**
+	 * Forgets the addresses whose failures all left the window.
+	 * @param now: current time
+	 * @param window: how far back failures are counted in seconds
+	 */
+	void prune( time_t now, time_t window ){
+		for( auto it = this->failures.begin(); it != this->failures.end(); ){
+			if( it->second.empty() || it->second.back() <= now - window ){
+				it = this->failures.erase( it );
+			}else{
+				++it;
+			}
+		}
+	}
+
+	/// Number of addresses with recent failures
+	size_t size() const{
+		return this->failures.size();
+	}
+
+	void clear(){
+		this->failures.clear();
+	}
+};
+
+#endif /* IPBANFAILURES_HPP */
@@ -13,6 +13,7 @@
 #include <common/core.hpp>
 #include <common/malloc.hpp>
 #include <common/md5calc.hpp>
+#include <common/metrics.hpp>
 #include <common/mmo.hpp>
 #include <common/msg_conf.hpp>
 #include <common/random.hpp>
@@ -25,6 +26,7 @@
 #include <config/core.hpp>
 
 #include "ipban.hpp"
+#include "loginauth.hpp"
 #include "loginchrif.hpp"
 #include "loginclif.hpp"
 #include "logincnslif.hpp"
@@ -54,7 +56,6 @@ int32 subnet_count = 0; //number of subnet config
 int32 login_fd; // login server file descriptor socket
 
 //early declaration
-bool login_check_password(struct login_session_data& sd, MmoAccount& acc);
 TIMER_FUNC(login_vip_timeout_timer);
 
 
@@ -295,6 +296,20 @@ static TIMER_FUNC(login_online_data_cleanup){
 	return 0;
 }
 
+static Metric metric_online_users( "rathena_online_users", "Accounts that are logged in", METRIC_GAUGE );
+
+/// Writes the metrics of the login-server for the web-server
+static TIMER_FUNC(login_metrics_timer){
+	char server[32];
+
+	metric_online_users.set( online_db.size() );
+
+	safesnprintf( server, sizeof( server ), "login-server:%hu", login_config.login_port );
+	getAccountDb()->saveMetrics( server );
+
+	return 0;
+}
+
 /**
  * Create a new account and save it in db/sql.
  * @param userid: string for user login
@@ -381,6 +396,25 @@ int32 login_mmo_auth_new(const char* userid, const char* pass, const char sex, c
  */
 int32 login_mmo_auth(struct login_session_data* sd, bool isServer) {
 	MmoAccount acc;
+	int32 result = login_mmo_auth_prepare( *sd, isServer, acc );
+
+	if( result != -1 ){
+		return result;
+	}
+
+	return login_mmo_auth_finish( *sd, isServer, acc, login_check_password( *sd, acc ) );
+}
+
+/**
+ * First part of the authentication, up to the password check.
+ * Loads the account of the session and creates it if the userid asks for it.
+ * @param sd: login session
+ * @param isServer: whether a char-server logs in
+ * @param acc: receives the account
+ * @return -1 if the password has to be checked next, otherwise the result of login_mmo_auth
+ */
+int32 login_mmo_auth_prepare( struct login_session_data& session_data, bool isServer, MmoAccount& acc ){
+	struct login_session_data* sd = &session_data;
 
 	char ip[16];
 	ip2str(session[sd->fd]->client_addr, ip);
@@ -438,7 +472,25 @@ int32 login_mmo_auth(struct login_session_data* sd, bool isServer) {
 		return 0; // 0 = Unregistered ID
 	}
 
-	if( !login_check_password( *sd, acc ) ) {
+	return -1;
+}
+
+/**
+ * Second part of the authentication, after the password was checked.
+ * Checks the state of the account and updates it and the session if the login succeeded.
+ * @param sd: login session
+ * @param isServer: whether a char-server logs in
+ * @param acc: account of the session, has to be up to date since it is saved on success
+ * @param password_ok: result of login_check_password
+ * @return result of login_mmo_auth
+ */
+int32 login_mmo_auth_finish( struct login_session_data& session_data, bool isServer, MmoAccount& acc, bool password_ok ){
+	struct login_session_data* sd = &session_data;
+
+	char ip[16];
+	ip2str(session[sd->fd]->client_addr, ip);
+
+	if( !password_ok ) {
 		ShowNotice("Invalid password (account: '%s', ip: %s)\n", sd->userid, ip);
 		return 1; // 1 = Incorrect Password
 	}
@@ -715,10 +767,8 @@ bool login_config_read(const char* cfgName, bool normal) {
 			if( msg_silent ) /* only bother if we actually have this enabled */
 				ShowInfo("Console Silent Setting: %d\n", atoi(w2));
 		}
-		else if (strcmpi(w1, "console_msg_log") == 0)
-			console_msg_log = atoi(w2);
-		else if  (strcmpi(w1, "console_log_filepath") == 0)
-			safestrncpy(console_log_filepath, w2, sizeof(console_log_filepath));
+		else if (showmsg_config_read(w1, w2))
+			continue;
 		else if(!strcmpi(w1, "log_login"))
 			login_config.log_login = (bool)config_switch(w2);
 		else if(!strcmpi(w1, "new_account"))
@@ -731,6 +781,8 @@ bool login_config_read(const char* cfgName, bool normal) {
 			login_config.start_limited_time = atoi(w2);
 		else if(!strcmpi(w1, "use_MD5_passwords"))
 			login_config.use_md5_passwds = (bool)config_switch(w2);
+		else if(!strcmpi(w1, "auth_threads"))
+			login_config.auth_threads = cap_value(atoi(w2), 0, 32);
 		else if(!strcmpi(w1, "group_id_to_connect"))
 			login_config.group_id_to_connect = atoi(w2);
 		else if(!strcmpi(w1, "min_group_id_to_connect"))
@@ -821,6 +873,8 @@ bool login_config_read(const char* cfgName, bool normal) {
 				continue;
 			if (getAccountDb() && getAccountDb()->setProperty(w1, w2))
 				continue;
+			if (metrics_config_read(w1, w2))
+				continue;
 			// try others
 			ipban_config_read(w1, w2);
 			loginlog_config_read(w1, w2);
@@ -838,6 +892,7 @@ void login_set_defaults() {
 	login_config.login_ip = INADDR_ANY;
 	login_config.login_port = 6900;
 	login_config.ipban_cleanup_interval = 60;
+	login_config.ipban_refresh_interval = 10;
 	login_config.ip_sync_interval = 0;
 	login_config.log_login = true;
 	safestrncpy(login_config.date_format, "%Y-%m-%d %H:%M:%S", sizeof(login_config.date_format));
@@ -851,6 +906,7 @@ void login_set_defaults() {
 	login_config.password_min_length = 4;
 #endif
 	login_config.use_md5_passwds = false;
+	login_config.auth_threads = 0;
 	login_config.group_id_to_connect = -1;
 	login_config.min_group_id_to_connect = -1;
 
@@ -906,6 +962,7 @@ void LoginServer::finalize(){
 
 	do_final_msg();
 	ipban_final();
+	do_final_loginauth();
 	do_final_loginclif();
 	do_final_logincnslif();
 
@@ -951,6 +1008,7 @@ bool LoginServer::initialize( int32 argc, char* argv[] ){
 
 	do_init_loginclif();
 	do_init_loginchrif();
+	do_init_loginauth();
 
 	// initialize logging
 	if( login_config.log_login )
@@ -972,6 +1030,11 @@ bool LoginServer::initialize( int32 argc, char* argv[] ){
 #endif // VIP_ENABLE
 	add_timer_interval(gettick() + 600*1000, login_online_data_cleanup, 0, 0, 600*1000);
 
+	// periodically write the metrics for the web-server
+	add_timer_func_list(login_metrics_timer, "login_metrics_timer");
+	if( metrics_interval > 0 )
+		add_timer_interval(gettick() + 1000, login_metrics_timer, 0, 0, metrics_interval * 1000);
+
 	// Account database init
 	if (accountDb_ == nullptr) {
 		ShowFatalError("do_init: account engine not found.\n");
@@ -60,6 +60,7 @@ struct login_session_data {
 	int32 fd;				///socket of client
 
 	char web_auth_token[WEB_AUTH_TOKEN_LENGTH]; /// web authentication token
+	uint32 auth_request;	/// password check that is running on an auth thread, 0 if none
 };
 
 #define MAX_SERVERS 5 //max number of mapserv that could be attach
@@ -85,6 +86,7 @@ struct Login_Config {
 	uint32 login_ip;                                /// the address to bind to
 	uint16 login_port;                              /// the port to bind to
 	uint32 ipban_cleanup_interval;                  /// interval (in seconds) to clean up expired IP bans
+	uint32 ipban_refresh_interval;                  /// interval (in seconds) to reload the active IP bans
 	uint32 ip_sync_interval;                        /// interval (in minutes) to execute a DNS/IP update (for dynamic IPs)
 	bool log_login;                                 /// whether to log login server actions or not
 	char date_format[32];                           /// date format used in messages
@@ -99,7 +101,7 @@ struct Login_Config {
 
 	bool ipban;                                     /// perform IP blocking (via contents of `ipbanlist`) ?
 	bool dynamic_pass_failure_ban;                  /// automatic IP blocking due to failed login attempts ?
-	uint32 dynamic_pass_failure_ban_interval;       /// how far to scan the loginlog for password failures in minutes
+	uint32 dynamic_pass_failure_ban_interval;       /// how far back password failures are counted in minutes
 	uint32 dynamic_pass_failure_ban_limit;          /// number of failures needed to trigger the ipban
 	uint32 dynamic_pass_failure_ban_duration;       /// duration of the ipban in minutes
 	bool use_dnsbl;                                 /// dns blacklist blocking ?
@@ -125,6 +127,7 @@ struct Login_Config {
 #endif
 	bool use_web_auth_token;						/// Enable web authentication token system
 	int32 disable_webtoken_delay;						/// delay disabling web token after char logs off in milliseconds
+	uint16 auth_threads;							/// threads that check passwords, 0 checks them on the main thread
 };
 extern struct Login_Config login_config;
 
@@ -240,6 +243,9 @@ int32 login_mmo_auth_new(const char* userid, const char* pass, const char sex, c
  *	x: acc state (TODO document me deeper)
  */
 int32 login_mmo_auth(struct login_session_data* sd, bool isServer);
+int32 login_mmo_auth_prepare(struct login_session_data& sd, bool isServer, MmoAccount& acc);
+int32 login_mmo_auth_finish(struct login_session_data& sd, bool isServer, MmoAccount& acc, bool password_ok);
+bool login_check_password(struct login_session_data& sd, MmoAccount& acc);
 
 int32 login_get_usercount( int32 users );
 
@@ -0,0 +1,195 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "loginauth.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <common/showmsg.hpp>
+#include <common/socket.hpp>
+#include <common/timer.hpp>
+
+#include "accountdb/MmoAccount.hpp"
+#include "login.hpp"
+
+// How often the main thread picks up checked passwords, in milliseconds
+#define LOGIN_AUTH_POLL_INTERVAL 5
+
+/// Password check that is handed to an auth thread
+struct s_login_auth_job {
+	uint32 request;
+	int32 fd;
+	struct login_session_data sd; // copy, the session itself belongs to the main thread
+	MmoAccount acc;
+	LoginAuthCallback callback;
+	bool password_ok;
+};
+
+static std::vector<std::thread> login_auth_threads;
+static std::mutex login_auth_mutex;
+static std::condition_variable login_auth_wakeup;
+static std::deque<s_login_auth_job> login_auth_queue; // waiting for an auth thread
+static std::deque<s_login_auth_job> login_auth_results; // waiting for the main thread
+static bool login_auth_stopping = false;
+
+// Only used by the main thread
+static uint32 login_auth_next_request = 0;
+static size_t login_auth_pending = 0;
+static int32 login_auth_poll_tid = INVALID_TIMER;
+
+/// Checks the passwords of the queued jobs until the server shuts down
+static void login_auth_worker(){
+	std::unique_lock<std::mutex> lock( login_auth_mutex );
+
+	while( true ){
+		login_auth_wakeup.wait( lock, [](){
+			return login_auth_stopping || !login_auth_queue.empty();
+		} );
+
+		if( login_auth_stopping ){
+			return;
+		}
+
+		s_login_auth_job job = login_auth_queue.front();
+
+		login_auth_queue.pop_front();
+		lock.unlock();
+
+		job.password_ok = login_check_password( job.sd, job.acc );
+
+		lock.lock();
+		login_auth_results.push_back( job );
+	}
+}
+
+/// Finishes the authentications whose passwords were checked
+static TIMER_FUNC(login_auth_poll_timer){
+	std::deque<s_login_auth_job> results;
+
+	{
+		std::lock_guard<std::mutex> lock( login_auth_mutex );
+
+		results.swap( login_auth_results );
+	}
+
+	for( s_login_auth_job& job : results ){
+		login_auth_pending--;
+
+		if( !session_isActive( job.fd ) ){
+			continue;
+		}
+
+		struct login_session_data* sd = (struct login_session_data*)session[job.fd]->session_data;
+
+		// The client disconnected, the socket was reused or the client sent another request
+		if( sd == nullptr || sd->auth_request != job.request ){
+			continue;
+		}
+
+		sd->auth_request = 0;
+
+		// The copy is stale, the account might have been banned or logged in again while the password was checked
+		if( job.password_ok && !getAccountDb()->loadFromAccountId( job.acc, job.acc.account_id ) ){
+			job.callback( *sd, 0 ); // 0 = Unregistered ID
+			continue;
+		}
+
+		job.callback( *sd, login_mmo_auth_finish( *sd, false, job.acc, job.password_ok ) );
+	}
+
+	if( login_auth_pending > 0 ){
+		login_auth_poll_tid = add_timer( tick + LOGIN_AUTH_POLL_INTERVAL, login_auth_poll_timer, 0, 0 );
+	}else{
+		login_auth_poll_tid = INVALID_TIMER;
+	}
+
+	return 0;
+}
+
+void login_auth_request( struct login_session_data& sd, LoginAuthCallback callback ){
+	MmoAccount acc;
+	int32 result = login_mmo_auth_prepare( sd, false, acc );
+
+	// Replaces the request that might still be running
+	sd.auth_request = 0;
+
+	if( result != -1 ){
+		callback( sd, result );
+		return;
+	}
+
+	if( login_auth_threads.empty() ){
+		callback( sd, login_mmo_auth_finish( sd, false, acc, login_check_password( sd, acc ) ) );
+		return;
+	}
+
+	// 0 marks a session without a request
+	if( ++login_auth_next_request == 0 ){
+		login_auth_next_request = 1;
+	}
+
+	sd.auth_request = login_auth_next_request;
+
+	s_login_auth_job job = {};
+
+	job.request = sd.auth_request;
+	job.fd = sd.fd;
+	job.sd = sd;
+	job.acc = acc;
+	job.callback = callback;
+
+	{
+		std::lock_guard<std::mutex> lock( login_auth_mutex );
+
+		login_auth_queue.push_back( job );
+	}
+
+	login_auth_wakeup.notify_one();
+	login_auth_pending++;
+
+	if( login_auth_poll_tid == INVALID_TIMER ){
+		login_auth_poll_tid = add_timer( gettick() + LOGIN_AUTH_POLL_INTERVAL, login_auth_poll_timer, 0, 0 );
+	}
+}
+
+void do_init_loginauth( void ){
+	add_timer_func_list( login_auth_poll_timer, "login_auth_poll_timer" );
+
+	login_auth_stopping = false;
+
+	for( uint16 i = 0; i < login_config.auth_threads; i++ ){
+		login_auth_threads.emplace_back( login_auth_worker );
+	}
+
+	if( !login_auth_threads.empty() ){
+		ShowStatus( "Checking passwords on %" PRIuPTR " threads.\n", login_auth_threads.size() );
+	}
+}
+
+void do_final_loginauth( void ){
+	{
+		std::lock_guard<std::mutex> lock( login_auth_mutex );
+
+		login_auth_stopping = true;
+	}
+
+	login_auth_wakeup.notify_all();
+
+	for( std::thread& thread : login_auth_threads ){
+		thread.join();
+	}
+
+	login_auth_threads.clear();
+	login_auth_queue.clear();
+	login_auth_results.clear();
+	login_auth_pending = 0;
+
+	if( login_auth_poll_tid != INVALID_TIMER ){
+		delete_timer( login_auth_poll_tid, login_auth_poll_timer );
+		login_auth_poll_tid = INVALID_TIMER;
+	}
+}
@@ -0,0 +1,31 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef LOGINAUTH_HPP
+#define LOGINAUTH_HPP
+
+#include <common/cbasetypes.hpp>
+
+struct login_session_data;
+
+/**
+ * Receives the result of an authentication on the main thread.
+ * @param sd: login session
+ * @param result: result of login_mmo_auth
+ */
+typedef void (*LoginAuthCallback)( struct login_session_data& sd, int32 result );
+
+/**
+ * Authenticates a client.
+ * The password is checked on one of the auth threads, unless there are none.
+ * The callback is called on the main thread, right away or once the password was checked,
+ * it is not called if the client disconnected or sent another login request in the meantime.
+ * @param sd: login session
+ * @param callback: receives the result
+ */
+void login_auth_request( struct login_session_data& sd, LoginAuthCallback callback );
+
+void do_init_loginauth( void );
+void do_final_loginauth( void );
+
+#endif /* LOGINAUTH_HPP */
@@ -597,7 +597,12 @@ int32 logchrif_parse_req_global_accreg(int32 fd){
 	size_t plen = 16;
 	RFIFOSKIP(fd,10);
 
-	auto string_regs = accountDb->loadGlobalAccRegStr(account_id);
+	std::vector<AccountRegVesselNum> num_regs;
+	std::vector<AccountRegVesselStr> string_regs;
+
+	// Both types are loaded at once, the packets are still sent one type after the other
+	accountDb->loadGlobalAccReg(account_id, num_regs, string_regs);
+
 	WFIFOHEAD(fd, 60000 + 300);
 	WFIFOW(fd, 0) = 0x2726;
 	WFIFOL(fd, 4) = account_id;
@@ -640,7 +645,6 @@ int32 logchrif_parse_req_global_accreg(int32 fd){
 	WFIFOB(fd, 12) = 1; // mark as last
 	WFIFOSET(fd, plen);
 
-	auto num_regs = accountDb->loadGlobalAccRegNum(account_id);
 	WFIFOHEAD(fd, 60000 + 300);
 	WFIFOW(fd, 0) = 0x2726;
 	WFIFOL(fd, 4) = account_id;
@@ -18,6 +18,7 @@
 
 #include "ipban.hpp" //ipban_check
 #include "login.hpp"
+#include "loginauth.hpp"
 #include "loginchrif.hpp"
 #include "loginlog.hpp"
 #include "accountdb/MmoAccount.hpp"
@@ -236,6 +237,19 @@ static void logclif_auth_failed(struct login_session_data* sd, int32 result) {
 	}
 }
 
+/**
+ * Sends the result of an authentication to the client.
+ * @param sd: player session
+ * @param result: result of login_mmo_auth
+ */
+static void logclif_auth_result( struct login_session_data& sd, int32 result ){
+	if( result == -1 ){
+		logclif_auth_ok( &sd );
+	}else{
+		logclif_auth_failed( &sd, result );
+	}
+}
+
 /**
  * Received a keepalive packet to maintain connection.
  * 0x200 <account.userid>.24B.
@@ -282,13 +296,7 @@ static bool logclif_parse_reqauth_raw( int32 fd, login_session_data& sd ){
 
 	sd.passwdenc = 0;
 
-	int32 result = login_mmo_auth( &sd, false );
-
-	if( result == -1 ){
-		logclif_auth_ok( &sd );
-	}else{
-		logclif_auth_failed( &sd, result );
-	}
+	login_auth_request( sd, logclif_auth_result );
 
 	return true;
 }
@@ -314,13 +322,7 @@ static bool logclif_parse_reqauth_md5( int32 fd, login_session_data& sd ){
 		return false;
 	}
 
-	int32 result = login_mmo_auth( &sd, false );
-
-	if( result == -1 ){
-		logclif_auth_ok( &sd );
-	}else{
-		logclif_auth_failed( &sd, result );
-	}
+	login_auth_request( sd, logclif_auth_result );
 
 	return true;
 }
@@ -348,13 +350,7 @@ static bool logclif_parse_reqauth_sso( int32 fd, login_session_data& sd ){
 
 	sd.passwdenc = 0;
 
-	int32 result = login_mmo_auth( &sd, false );
-
-	if( result == -1 ){
-		logclif_auth_ok( &sd );
-	}else{
-		logclif_auth_failed( &sd, result );
-	}
+	login_auth_request( sd, logclif_auth_result );
 
 	return true;
 }
@@ -440,6 +436,7 @@ static int32 logclif_parse_reqcharconnec(int32 fd, struct login_session_data *sd
 
 			session[fd]->func_parse = logchrif_parse;
 			session[fd]->flag.server = 1;
+			session[fd]->link = PACKET_LINK_CHAR;
 			realloc_fifo(fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
 
 			// send connection success
@@ -14,6 +14,7 @@
 #include <common/malloc.hpp>
 #include <common/mmo.hpp>
 #include <common/nullpo.hpp>
+#include <common/profiler.hpp>
 #include <common/random.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
@@ -4448,6 +4449,13 @@ ACMD_FUNC(reloadbattleconf){
 	{	// Exp or Drop rates changed.
 		mob_reload(); //Needed as well so rate changes take effect.
 	}
+
+	// Only a changed setting overrides the state set with @profiler
+	if( prev_config.tick_profiler != battle_config.tick_profiler )
+		profiler_enabled = battle_config.tick_profiler != 0;
+	if( prev_config.tick_profiler_interval != battle_config.tick_profiler_interval )
+		map_profiler_schedule();
+
 	clif_displaymessage(fd, msg_txt(sd,255)); // Battle configuration has been reloaded.
 
 	return 0;
@@ -4537,6 +4545,8 @@ ACMD_FUNC(reloadbarterdb){
 ACMD_FUNC(reloadlogconf){
 	nullpo_retr(-1, sd);
 
+	// Write everything that was buffered with the old settings
+	log_flush();
 	log_config_read(LOG_CONF_NAME);
 	clif_displaymessage(fd, msg_txt(sd,1536)); // Log configuration has been reloaded.
 
@@ -11304,6 +11314,68 @@ ACMD_FUNC(setcard)
 	return 0;
 }
 
+/**
+ * Controls the tick profiler and displays the timer functions or packet handlers that took the most time
+ * Usage: @profiler <on|off|reset|timers|packets> {<count>}
+ */
+ACMD_FUNC(profiler){
+	char action[16];
+	int32 count = 10;
+
+	nullpo_retr( -1, sd );
+
+	memset( action, '\0', sizeof( action ) );
+
+	if( !message || !*message || sscanf( message, "%15s %11d", action, &count ) < 1 ){
+		clif_displaymessage( fd, msg_txt( sd, 1539 ) ); // Usage: @profiler <on|off|reset|timers|packets> {<count>}
+		return -1;
+	}
+
+	if( strcmpi( action, "on" ) == 0 ){
+		profiler_enabled = true;
+		clif_displaymessage( fd, msg_txt( sd, 1540 ) ); // Tick profiler has been enabled.
+		return 0;
+	}
+
+	if( strcmpi( action, "off" ) == 0 ){
+		profiler_enabled = false;
+		clif_displaymessage( fd, msg_txt( sd, 1541 ) ); // Tick profiler has been disabled.
+		return 0;
+	}
+
+	if( strcmpi( action, "reset" ) == 0 ){
+		profiler_reset();
+		clif_displaymessage( fd, msg_txt( sd, 1542 ) ); // Tick profiler data has been reset.
+		return 0;
+	}
+
+	e_profile_group group;
+
+	if( strcmpi( action, "timers" ) == 0 ){
+		group = PROFILE_TIMER;
+	}else if( strcmpi( action, "packets" ) == 0 ){
+		group = PROFILE_PACKET;
+	}else{
+		clif_displaymessage( fd, msg_txt( sd, 1539 ) ); // Usage: @profiler <on|off|reset|timers|packets> {<count>}
+		return -1;
+	}
+
+	std::vector<std::string> lines;
+
+	profiler_report( group, cap_value( count, 1, 50 ), lines );
+
+	if( lines.empty() ){
+		clif_displaymessage( fd, msg_txt( sd, 1543 ) ); // No profiling data has been collected yet.
+		return 0;
+	}
+
+	for( const std::string& line : lines ){
+		clif_displaymessage( fd, line.c_str() );
+	}
+
+	return 0;
+}
+
 int32 atcommand_macrochecker_sub( block_list* bl, va_list ap ){
 	uint32 reporter_aid = va_arg( ap, uint32 );
 	uint32 reporter_gmlv = va_arg( ap, uint32 );
@@ -11705,6 +11777,7 @@ void atcommand_basecommands(void) {
 		ACMD_DEFR(roulette, ATCMD_NOCONSOLE|ATCMD_NOAUTOTRADE),
 		ACMD_DEF(setcard),
 		ACMD_DEF(macrochecker),
+		ACMD_DEF(profiler),
 	};
 	AtCommandInfo* atcommand;
 	int32 i;
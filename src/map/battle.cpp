@@ -5,11 +5,13 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <initializer_list>
 
 #include <common/cbasetypes.hpp>
 #include <common/ers.hpp>
 #include <common/malloc.hpp>
 #include <common/nullpo.hpp>
+#include <common/profiler.hpp>
 #include <common/random.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
@@ -751,36 +753,30 @@ static int32 battle_calc_cardfix_debuff( status_change& tsc, int32 rh_ele ){
 }
 
 /**
- * Calculates card bonuses damage adjustments.
+ * Collects the card bonus damage adjustments of an attack.
+ * The adjustments do not depend on the damage, so they can be applied to all damage components of a hit.
+ * @param fix Receives the adjustments
  * @param attack_type @see enum e_battle_flag
  * @param src Attacker
  * @param target Target
  * @param nk Skill's nk @see enum e_skill_nk [NK_IGNOREATKCARD|NK_IGNOREELEMENT|NK_IGNOREDEFCARD]
  * @param rh_ele Right-hand weapon element
  * @param lh_ele Left-hand weapon element (BF_MAGIC and BF_MISC ignore this value)
- * @param damage Original damage
  * @param left Left hand flag (BF_MISC and BF_MAGIC ignore flag value)
  *         3: Calculates attacker bonuses in both hands.
  *         2: Calculates attacker bonuses in right-hand only.
  *         0 or 1: Only calculates target bonuses.
  * @param flag Misc value of skill & damage flags
- * @return damage Damage diff between original damage and after calculation
  */
-int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 rh_ele, int32 lh_ele, int64 damage, int32 left, int32 flag){
+void battle_calc_cardfix_prepare(s_cardfix& fix, int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 rh_ele, int32 lh_ele, int32 left, int32 flag){
 	map_session_data *sd, ///< Attacker session data if BL_PC
 		*tsd; ///< Target session data if BL_PC
 	int32 cardfix = 1000;
 	int32 s_class, ///< Attacker class
 		t_class; ///< Target class
-	std::vector<e_race2> s_race2, /// Attacker Race2
-		t_race2; ///< Target Race2
 	enum e_element s_defele; ///< Attacker Element (not a weapon or skill element!)
-	int64 original_damage;
-
-	if( !damage )
-		return 0;
 
-	original_damage = damage;
+	fix.count = 0;
 
 	sd = BL_CAST(BL_PC, src);
 	tsd = BL_CAST(BL_PC, target);
@@ -791,8 +787,8 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 	///< Target status data
 	status_data* tstatus = status_get_status_data(*target);
 	status_change *tsc = status_get_sc(target);
-	s_race2 = status_get_race2(src);
-	t_race2 = status_get_race2(target);
+	const std::vector<e_race2>& s_race2 = status_get_race2(src); ///< Attacker Race2
+	const std::vector<e_race2>& t_race2 = status_get_race2(target); ///< Target Race2
 	s_defele = (tsd) ? (enum e_element)status_get_element(src) : ELE_NONE;
 
 	// When the attacker is a monster, then all bonuses on BF_WEAPON will work and no bonuses on BF_MAGIC
@@ -803,7 +799,7 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 	}
 
 //Official servers apply the cardfix value on a base of 1000 and round down the reduction/increase
-#define APPLY_CARDFIX(damage, fix) { (damage) = (damage) - (int64)(((damage) * (1000 - max(0, fix))) / 1000); }
+#define APPLY_CARDFIX(fix, rate) (fix).add( 1000, (rate) )
 
 	switch( attack_type ) {
 		case BF_MAGIC:
@@ -813,10 +809,10 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 #ifdef RENEWAL
 
 // Simplified formula to round down the damage
-#define APPLY_CARDFIX_RE(damage, fix) { (damage) = (damage) - (int64)(((damage) * (100 - max(0, 100+(fix)))) / 100); }
+#define APPLY_CARDFIX_RE(fix, rate) (fix).add( 100, 100 + (rate) )
 				// On (at least) BF_MAGIC, damages are calculated consecutively and rounded down in the following order to match official damage :
 				// size, race2, ele, atk_ele, race, class
-				APPLY_CARDFIX_RE( damage, sd->indexed_bonus.magic_addsize[tstatus->size] + sd->indexed_bonus.magic_addsize[SZ_ALL] );
+				APPLY_CARDFIX_RE( fix, sd->indexed_bonus.magic_addsize[tstatus->size] + sd->indexed_bonus.magic_addsize[SZ_ALL] );
 
 				// race2 is the same as the bonus per class ID
 				for (const auto &raceit : t_race2)
@@ -827,23 +823,23 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 						break;
 					}
 				}
-				APPLY_CARDFIX_RE( damage, race2_val );
+				APPLY_CARDFIX_RE( fix, race2_val );
 
 				if( !nk[NK_IGNOREELEMENT] ) { // Affected by Element modifier bonuses
-					APPLY_CARDFIX_RE( damage, sd->indexed_bonus.magic_addele[tstatus->def_ele] + sd->indexed_bonus.magic_addele[ELE_ALL] +
+					APPLY_CARDFIX_RE( fix, sd->indexed_bonus.magic_addele[tstatus->def_ele] + sd->indexed_bonus.magic_addele[ELE_ALL] +
 						sd->indexed_bonus.magic_addele_script[tstatus->def_ele] + sd->indexed_bonus.magic_addele_script[ELE_ALL] );
 				}
 			}
 			// Statuses that affect the target's element and should be calculated right after magic_addele, independently of it
 			if (tsc != nullptr && !nk[NK_IGNOREDEFCARD] && !nk[NK_IGNOREELEMENT]) {
-				APPLY_CARDFIX_RE( damage, battle_calc_cardfix_debuff( *tsc, rh_ele ) );
+				APPLY_CARDFIX_RE( fix, battle_calc_cardfix_debuff( *tsc, rh_ele ) );
 			}
 			if( sd && !nk[NK_IGNOREATKCARD] ) {
 				if( !nk[NK_IGNOREELEMENT] ) {
-					APPLY_CARDFIX_RE( damage, sd->indexed_bonus.magic_atk_ele[rh_ele] + sd->indexed_bonus.magic_atk_ele[ELE_ALL] );
+					APPLY_CARDFIX_RE( fix, sd->indexed_bonus.magic_atk_ele[rh_ele] + sd->indexed_bonus.magic_atk_ele[ELE_ALL] );
 				}
-				APPLY_CARDFIX_RE( damage, sd->indexed_bonus.magic_addrace[tstatus->race] + sd->indexed_bonus.magic_addrace[RC_ALL] );
-				APPLY_CARDFIX_RE( damage, sd->indexed_bonus.magic_addclass[tstatus->class_] + sd->indexed_bonus.magic_addclass[CLASS_ALL] );
+				APPLY_CARDFIX_RE( fix, sd->indexed_bonus.magic_addrace[tstatus->race] + sd->indexed_bonus.magic_addrace[RC_ALL] );
+				APPLY_CARDFIX_RE( fix, sd->indexed_bonus.magic_addclass[tstatus->class_] + sd->indexed_bonus.magic_addclass[CLASS_ALL] );
 #undef APPLY_CARDFIX_RE
 
 // Pre-renewal / old renewal behaviour
@@ -864,7 +860,7 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 						break;
 					}
 				}
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 #endif
 			}
 
@@ -931,7 +927,7 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 
 				if( tsc->getSCE(SC_MDEF_RATE) )
 					cardfix = cardfix * (100 - tsc->getSCE(SC_MDEF_RATE)->val1) / 100;
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 			}
 			break;
 
@@ -1080,9 +1076,9 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 					cardfix = cardfix * (100 + sd->bonus.long_attack_atk_rate) / 100;
 #endif
 				if (left&1) {
-					APPLY_CARDFIX(damage, cardfix_);
+					APPLY_CARDFIX(fix, cardfix_);
 				} else {
-					APPLY_CARDFIX(damage, cardfix);
+					APPLY_CARDFIX(fix, cardfix);
 				}
 			}
 			// Affected by target DEF bonuses
@@ -1150,13 +1146,13 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 					cardfix = cardfix * (100 - tsd->bonus.long_attack_def_rate) / 100;
 				if( tsc->getSCE(SC_DEF_RATE) )
 					cardfix = cardfix * (100 - tsc->getSCE(SC_DEF_RATE)->val1) / 100;
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 			}
 			// Custom on BF_WEAPON to follow SC_ debuff BF_MAGIC renewal behavior
 			if (tsc != nullptr && !nk[NK_IGNOREDEFCARD] && !nk[NK_IGNOREELEMENT]) {
 				cardfix = 1000;
 				cardfix = cardfix * (100 + battle_calc_cardfix_debuff( *tsc, rh_ele )) / 100;
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 			}
 			break;
 
@@ -1201,22 +1197,89 @@ int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target
 					cardfix = cardfix * (100 - tsd->bonus.near_attack_def_rate) / 100;
 				else if (!nk[NK_IGNORELONGCARD])	// BF_LONG (there's no other choice)
 					cardfix = cardfix * (100 - tsd->bonus.long_attack_def_rate) / 100;
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 			}
 			// Custom on BF_MISC to follow SC_ debuff BF_MAGIC renewal behavior
 			if (tsc != nullptr && !nk[NK_IGNOREDEFCARD] && !nk[NK_IGNOREELEMENT]) {
 				cardfix = 1000;
 				cardfix = cardfix * (100 + battle_calc_cardfix_debuff( *tsc, rh_ele )) / 100;
-				APPLY_CARDFIX(damage, cardfix);
+				APPLY_CARDFIX(fix, cardfix);
 			}
 			break;
 	}
 
 #undef APPLY_CARDFIX
+}
+
+/**
+ * Applies card bonus damage adjustments to a damage.
+ * @param fix Adjustments of battle_calc_cardfix_prepare
+ * @param damage Original damage
+ * @return damage Damage diff between original damage and after calculation
+ */
+int32 battle_apply_cardfix(const s_cardfix& fix, int64 damage){
+	if( !damage )
+		return 0;
+
+	int64 original_damage = damage;
+
+	// Each adjustment is rounded down on its own
+	for( uint8 i = 0; i < fix.count; i++ ){
+		damage = damage - (int64)((damage * (fix.steps[i].base - max(0, fix.steps[i].rate))) / fix.steps[i].base);
+	}
 
 	return (int32)cap_value(damage - original_damage, INT_MIN, INT_MAX);
 }
 
+/**
+ * Calculates card bonuses damage adjustments.
+ * @see battle_calc_cardfix_prepare for the parameters
+ * @param damage Original damage
+ * @return damage Damage diff between original damage and after calculation
+ */
+int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 rh_ele, int32 lh_ele, int64 damage, int32 left, int32 flag){
+	if( !damage )
+		return 0;
+
+	s_cardfix fix;
+
+	battle_calc_cardfix_prepare( fix, attack_type, src, target, nk, rh_ele, lh_ele, left, flag );
+
+	return battle_apply_cardfix( fix, damage );
+}
+
+/**
+ * Applies the card bonus damage adjustments of one attack to several damage components.
+ * The adjustments are only collected once, instead of once per component.
+ * @see battle_calc_cardfix_prepare for the parameters
+ * @param damages Damage components, which receive the adjusted damage
+ */
+static void battle_calc_cardfix_batch(int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 rh_ele, int32 lh_ele, int32 left, int32 flag, std::initializer_list<int64*> damages){
+	s_cardfix fix;
+	bool prepared = false;
+
+	for( int64* damage : damages ){
+		if( !*damage )
+			continue;
+
+		if( !prepared ){
+			battle_calc_cardfix_prepare( fix, attack_type, src, target, nk, rh_ele, lh_ele, left, flag );
+			prepared = true;
+		}
+
+		int32 diff = battle_apply_cardfix( fix, *damage );
+
+#ifdef DEBUG
+		// The adjustments must not depend on the damage they are applied to
+		if( diff != battle_calc_cardfix( attack_type, src, target, nk, rh_ele, lh_ele, *damage, left, flag ) ){
+			ShowDebug( "battle_calc_cardfix_batch: Batched card fix of %" PRId64 " damage differs from battle_calc_cardfix (type %d, left %d).\n", *damage, attack_type, left );
+		}
+#endif
+
+		*damage += diff;
+	}
+}
+
 /**
 * Absorb damage based on criteria
 * @param bl
@@ -7893,12 +7956,9 @@ static struct Damage battle_calc_weapon_attack(block_list *src, block_list *targ
 		// In Renewal we only cardfix to the weapon and equip ATK
 		//Card Fix for attacker (sd), 2 is added to the "left" flag meaning "attacker cards only"
 		if (sd) {
-			wd.weaponAtk += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.weaponAtk, 2, wd.flag);
-			wd.equipAtk += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.equipAtk, 2, wd.flag);
-			if (is_attack_left_handed(src, skill_id)) {
-				wd.weaponAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.weaponAtk2, 3, wd.flag);
-				wd.equipAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.equipAtk2, 3, wd.flag);
-			}
+			battle_calc_cardfix_batch(BF_WEAPON, src, target, nk, right_element, left_element, 2, wd.flag, { &wd.weaponAtk, &wd.equipAtk });
+			if (is_attack_left_handed(src, skill_id))
+				battle_calc_cardfix_batch(BF_WEAPON, src, target, nk, right_element, left_element, 3, wd.flag, { &wd.weaponAtk2, &wd.equipAtk2 });
 		}
 
 		//Card Fix for target (tsd), 2 is not added to the "left" flag meaning "target cards only"
@@ -7906,15 +7966,11 @@ static struct Damage battle_calc_weapon_attack(block_list *src, block_list *targ
 			std::bitset<NK_MAX> ignoreele_nk = nk;
 
 			ignoreele_nk.set(NK_IGNOREELEMENT);
-			wd.statusAtk += battle_calc_cardfix(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, wd.statusAtk, 0, wd.flag);
-			wd.weaponAtk += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.weaponAtk, 0, wd.flag);
-			wd.equipAtk += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.equipAtk, 0, wd.flag);
-			wd.masteryAtk += battle_calc_cardfix(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, wd.masteryAtk, 0, wd.flag);
+			battle_calc_cardfix_batch(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, 0, wd.flag, { &wd.statusAtk, &wd.masteryAtk });
+			battle_calc_cardfix_batch(BF_WEAPON, src, target, nk, right_element, left_element, 0, wd.flag, { &wd.weaponAtk, &wd.equipAtk });
 			if (is_attack_left_handed(src, skill_id)) {
-				wd.statusAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, wd.statusAtk2, 1, wd.flag);
-				wd.weaponAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.weaponAtk2, 1, wd.flag);
-				wd.equipAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, nk, right_element, left_element, wd.equipAtk2, 1, wd.flag);
-				wd.masteryAtk2 += battle_calc_cardfix(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, wd.masteryAtk2, 1, wd.flag);
+				battle_calc_cardfix_batch(BF_WEAPON, src, target, ignoreele_nk, right_element, left_element, 1, wd.flag, { &wd.statusAtk2, &wd.masteryAtk2 });
+				battle_calc_cardfix_batch(BF_WEAPON, src, target, nk, right_element, left_element, 1, wd.flag, { &wd.weaponAtk2, &wd.equipAtk2 });
 			}
 		}
 
@@ -9539,7 +9595,7 @@ struct Damage battle_calc_magic_attack(block_list *src,block_list *target,uint16
 				i += sd->indexed_bonus.ignore_mdef_by_race[tstatus->race] + sd->indexed_bonus.ignore_mdef_by_race[RC_ALL] +
 					sd->indexed_bonus.ignore_mdef_by_class[tstatus->class_] + sd->indexed_bonus.ignore_mdef_by_class[CLASS_ALL];
 
-				std::vector<e_race2> race2 = status_get_race2(target);
+				const std::vector<e_race2>& race2 = status_get_race2(target);
 
 				for (const auto &raceit : race2)
 					i += sd->indexed_bonus.ignore_mdef_by_race2[raceit];
@@ -12335,6 +12391,10 @@ static const struct _battle_data {
 	{ "mob_unlock_time",                    &battle_config.mob_unlock_time,                 2000,   0,      INT_MAX,        },
 	{ "map_edge_size",                      &battle_config.map_edge_size,                   15,     1,      40,             },
 	{ "randomize_center_cell",              &battle_config.randomize_center_cell,           1,      0,      1,              },
+	{ "area_packet_stats_interval",         &battle_config.area_packet_stats_interval,      0,      0,      99999999,       },
+	{ "tick_profiler",                      &battle_config.tick_profiler,                   0,      0,      1,              },
+	{ "tick_profiler_interval",             &battle_config.tick_profiler_interval,          0,      0,      99999999,       },
+	{ "slow_tick_threshold",                &battle_config.slow_tick_threshold,             0,      0,      99999999,       },
 
 	{ "feature.stylist",                    &battle_config.feature_stylist,                 1,      0,      1,              },
 	{ "feature.banking_state_enforce",      &battle_config.feature_banking_state_enforce,   0,      0,      1,              },
@@ -12601,6 +12661,8 @@ void battle_adjust_conf()
 #ifdef MAP_GENERATOR
 	battle_config.dynamic_mobs = 1;
 #endif
+
+	profiler_slow_tick = battle_config.slow_tick_threshold;
 }
 
 /*=====================================
@@ -8,6 +8,7 @@
 
 #include <common/cbasetypes.hpp>
 #include <common/mmo.hpp>
+#include <common/showmsg.hpp>
 #include <config/core.hpp>
 
 #include "map.hpp" //ELE_MAX
@@ -115,6 +116,30 @@ int64 battle_calc_return_damage(block_list *bl, block_list *src, int64 *, int32
 void battle_drain(map_session_data *sd, block_list *tbl, int64 rdamage, int64 ldamage, int32 race, int32 class_);
 
 int64 battle_attr_fix(block_list* src, block_list* target, int64 damage, int32 atk_elem, int32 def_type, int32 def_lv, int32 flag = 0);
+/// Maximum number of adjustments battle_calc_cardfix_prepare adds for one attack.
+/// Renewal magic attacks need the most: six attacker bonuses, the debuffs and the resistances of the target.
+#define MAX_CARDFIX_STEPS 8
+
+/// Card bonus damage adjustments of an attack, see battle_calc_cardfix_prepare
+struct s_cardfix {
+	struct s_step {
+		int32 base; ///< 1000, or 100 for the consecutive renewal magic adjustments
+		int32 rate; ///< Damage rate on the base
+	} steps[MAX_CARDFIX_STEPS];
+	uint8 count;
+
+	void add( int32 base, int32 rate ){
+		if( count >= MAX_CARDFIX_STEPS ){
+			ShowError( "s_cardfix::add: More than %d adjustments, increase MAX_CARDFIX_STEPS.\n", MAX_CARDFIX_STEPS );
+			return;
+		}
+
+		steps[count++] = { base, rate };
+	}
+};
+
+void battle_calc_cardfix_prepare(s_cardfix& fix, int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 s_ele, int32 s_ele_, int32 left, int32 flag);
+int32 battle_apply_cardfix(const s_cardfix& fix, int64 damage);
 int32 battle_calc_cardfix(int32 attack_type, block_list *src, block_list *target, std::bitset<NK_MAX> nk, int32 s_ele, int32 s_ele_, int64 damage, int32 left, int32 flag);
 
 // Final calculation Damage
@@ -766,6 +791,10 @@ struct Battle_Config
 	int32 mob_unlock_time;
 	int32 map_edge_size;
 	int32 randomize_center_cell;
+	int32 area_packet_stats_interval;
+	int32 tick_profiler;
+	int32 tick_profiler_interval;
+	int32 slow_tick_threshold;
 
 	int32 feature_stylist;
 	int32 feature_banking_state_enforce;
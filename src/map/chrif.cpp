@@ -10,6 +10,7 @@
 #include <common/ers.hpp>
 #include <common/malloc.hpp>
 #include <common/nullpo.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/strlib.hpp>
@@ -46,7 +47,7 @@ static const int32 packet_len_table[0x3d] = { // U - used, F - free
 	11,10,10, 0,11, -1, 0,10,	// 2b10-2b17: U->2b10, U->2b11, U->2b12, F->2b13, U->2b14, U->2b15, F->2b16, U->2b17
 	 2,10, 2,-1,-1,-1, 2, 7,	// 2b18-2b1f: U->2b18, U->2b19, U->2b1a, U->2b1b, U->2b1c, U->2b1d, U->2b1e, U->2b1f
 	-1,10, 8, 2, 2,14,19,19,	// 2b20-2b27: U->2b20, U->2b21, U->2b22, U->2b23, U->2b24, U->2b25, U->2b26, U->2b27
-	-1, 0, 6,15, 0, 6,-1,-1,	// 2b28-2b2f: U->2b28, F->2b29, U->2b2a, U->2b2b, F->2b2c, U->2b2d, U->2b2e, U->2b2f
+	-1,-1, 6,15, 6, 6,-1,-1,	// 2b28-2b2f: U->2b28, U->2b29, U->2b2a, U->2b2b, U->2b2c, U->2b2d, U->2b2e, U->2b2f
  };
 
 //Used Packets:
@@ -98,10 +99,10 @@ static const int32 packet_len_table[0x3d] = { // U - used, F - free
 //2b26: Outgoing, chrif_authreq -> 'client authentication request'
 //2b27: Incoming, chrif_authfail -> 'client authentication failed'
 //2b28: Outgoing, chrif_req_charban -> 'ban a specific char '
-//2b29: FREE
+//2b29: Incoming, chrif_deferred_received -> received memo points, friends and hotkeys of player.
 //2b2a: Outgoing, chrif_req_charunban -> 'unban a specific char '
 //2b2b: Incoming, chrif_parse_ack_vipActive -> vip info result
-//2b2c: FREE
+//2b2c: Outgoing, chrif_deferred_request -> request memo points, friends and hotkeys for pc_authok'ed char.
 //2b2d: Outgoing, chrif_bsdata_request -> request bonus_script for pc_authok'ed char.
 //2b2e: Outgoing, chrif_bsdata_save -> Send bonus_script of player for saving.
 //2b2f: Incoming, chrif_bsdata_received -> received bonus_script of player for loading.
@@ -263,6 +264,22 @@ int32 chrif_isconnected(void) {
 	return (session_isValid(char_fd) && chrif_state == 2);
 }
 
+/**
+ * Uses a local session as fully connected char-server link.
+ * The owner of the session answers the requests itself by feeding replies to chrif_parse.
+ * @param fd: Local session
+ */
+void chrif_local_link(int32 fd) {
+	char_fd = fd;
+	session[fd]->func_parse = chrif_parse;
+	session[fd]->flag.server = 1;
+	session[fd]->link = PACKET_LINK_CHAR;
+	realloc_fifo(fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
+
+	chrif_state = 2;
+	chrif_connected = 1;
+}
+
 /**
  * Saves character data.
  * @param sd: Player data
@@ -275,8 +292,6 @@ int32 chrif_isconnected(void) {
  *  CSAVE_CART: Character changed cart data
  */
 int32 chrif_save(map_session_data *sd, int32 flag) {
-	uint16 mmo_charstatus_len = 0;
-
 	nullpo_retr(-1, sd);
 
 	pc_makesavestatus(sd);
@@ -314,18 +329,16 @@ int32 chrif_save(map_session_data *sd, int32 flag) {
 	if (sd->vars_dirty)
 		intif_saveregistry(sd);
 
-	mmo_charstatus_len = sizeof(sd->status) + 13;
-	WFIFOHEAD(char_fd, mmo_charstatus_len);
-	WFIFOW(char_fd,0) = 0x2b01;
-	WFIFOW(char_fd,2) = mmo_charstatus_len;
-	WFIFOL(char_fd,4) = sd->status.account_id;
-	WFIFOL(char_fd,8) = sd->status.char_id;
-	WFIFOB(char_fd,12) = (flag&CSAVE_QUIT) ? 1 : 0; //Flag to tell char-server this character is quitting.
-
-	// Copy the whole status into the packet
-	memcpy( WFIFOP( char_fd, 13 ), &sd->status, sizeof( struct mmo_charstatus ) );
-
-	WFIFOSET(char_fd, WFIFOW(char_fd,2));
+	WFIFOHEAD(char_fd, sizeof(struct PACKET_ZW_SAVE_CHAR));
+	struct PACKET_ZW_SAVE_CHAR* p = (struct PACKET_ZW_SAVE_CHAR*)WFIFOP( char_fd, 0 );
+	p->packetType = HEADER_ZW_SAVE_CHAR;
+	p->packetLength = sizeof(struct PACKET_ZW_SAVE_CHAR);
+	p->account_id = sd->status.account_id;
+	p->char_id = sd->status.char_id;
+	p->quit = (flag&CSAVE_QUIT) ? 1 : 0; //Flag to tell char-server this character is quitting.
+	p->status = sd->status;
+	p->deferred = sd->state.deferred_load;
+	WFIFOSET(char_fd, p->packetLength);
 
 	if( sd->status.pet_id > 0 && sd->pd )
 		intif_save_petdata(sd->status.account_id,&sd->pd->pet);
@@ -489,6 +502,7 @@ int32 chrif_connectack(int32 fd) {
 	chrif_state = 1;
 	chrif_connected = 1;
 
+	socket_compression_announce(fd);
 	chrif_sendmap(fd);
 
 	npc_event_runall(script_config.inter_init_event_name);
@@ -648,6 +662,7 @@ void chrif_authreq(map_session_data *sd, bool autotrade) {
  * Auth confirmation ack
  *------------------------------------------*/
 void chrif_authok(int32 fd) {
+	struct PACKET_WZ_AUTH_OK* p = (struct PACKET_WZ_AUTH_OK*)RFIFOP( fd, 0 );
 	uint32 account_id, group_id, char_id;
 	uint32 login_id1,login_id2;
 	time_t expiration_time;
@@ -656,19 +671,13 @@ void chrif_authok(int32 fd) {
 	bool changing_mapservers;
 	TBL_PC* sd;
 
-	//Check if both servers agree on the struct's size
-	if( RFIFOW(fd,2) - 25 != sizeof(struct mmo_charstatus) ) {
-		ShowError("chrif_authok: Data size mismatch! %d != %" PRIuPTR "\n", RFIFOW(fd,2) - 25, sizeof(struct mmo_charstatus));
-		return;
-	}
-
-	account_id = RFIFOL(fd,4);
-	login_id1 = RFIFOL(fd,8);
-	login_id2 = RFIFOL(fd,12);
-	expiration_time = (time_t)(int32)RFIFOL(fd,16);
-	group_id = RFIFOL(fd,20);
-	changing_mapservers = (RFIFOB(fd,24)) > 0;
-	status = (struct mmo_charstatus*)RFIFOP(fd,25);
+	account_id = p->account_id;
+	login_id1 = p->login_id1;
+	login_id2 = p->login_id2;
+	expiration_time = (time_t)(int32)p->expiration_time;
+	group_id = p->group_id;
+	changing_mapservers = p->changing_mapservers > 0;
+	status = (struct mmo_charstatus*)RFIFOP( fd, offsetof( struct PACKET_WZ_AUTH_OK, status ) );
 	char_id = status->char_id;
 
 	//Check if we don't already have player data in our server
@@ -699,6 +708,8 @@ void chrif_authok(int32 fd) {
 		node->char_id == char_id &&
 		node->login_id1 == login_id1 )
 	{ //Auth Ok
+		sd->state.deferred_load = p->deferred;
+
 		if (pc_authok(sd, login_id2, expiration_time, group_id, status, changing_mapservers))
 			return;
 	} else { //Auth Failed
@@ -1589,6 +1600,61 @@ void chrif_parse_ack_vipActive(int32 fd) {
 }
 
 
+/**
+ * ZW 0x2b2c
+ * <cmd>.W <char_id>.L
+ * Requests the memo points, friends and hotkeys of a character that was authenticated without them
+ * @param char_id
+ **/
+int32 chrif_deferred_request(uint32 char_id) {
+	chrif_check(-1);
+	WFIFOHEAD(char_fd,6);
+	WFIFOW(char_fd,0) = 0x2b2c;
+	WFIFOL(char_fd,2) = char_id;
+	WFIFOSET(char_fd,6);
+	return 0;
+}
+
+/**
+ * WZ 0x2b29
+ * <cmd>.W <len>.W <char_id>.L <memo points>.?B <friends>.?B <hotkeys>.?B
+ * Memo points, friends and hotkeys received, set to player
+ * @param fd
+ **/
+int32 chrif_deferred_received(int32 fd) {
+	struct PACKET_WZ_CHAR_DEFERRED_DATA* p = (struct PACKET_WZ_CHAR_DEFERRED_DATA*)RFIFOP( fd, 0 );
+	map_session_data* sd = map_charid2sd( p->char_id );
+
+	// Logged out in the meantime
+	if( sd == nullptr || !sd->state.deferred_load ){
+		return 0;
+	}
+
+	memcpy( sd->status.memo_point, RFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, memo_point ) ), sizeof( sd->status.memo_point ) );
+	memcpy( sd->status.friends, RFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, friends ) ), sizeof( sd->status.friends ) );
+#ifdef HOTKEY_SAVING
+	memcpy( sd->status.hotkeys, RFIFOP( fd, offsetof( struct PACKET_WZ_CHAR_DEFERRED_DATA, hotkeys ) ), sizeof( sd->status.hotkeys ) );
+#endif
+	sd->state.deferred_load = 0;
+
+	clif_friendslist_send( *sd );
+
+	// Otherwise clif_parse_LoadEndAck still sends them
+	if( sd->state.pc_loaded && !sd->state.connect_new ){
+		clif_hotkeys_send( sd, 0 );
+#if PACKETVER_MAIN_NUM >= 20190522 || PACKETVER_RE_NUM >= 20190508 || PACKETVER_ZERO_NUM >= 20190605
+		clif_hotkeys_send( sd, 1 );
+#endif
+
+		// Without automatic friends the others' lists were enough
+		if( battle_config.friend_auto_add ){
+			clif_friendslist_login( *sd );
+		}
+	}
+
+	return 0;
+}
+
 /**
  * ZA 0x2b2d
  * <cmd>.W <char_id>.L
@@ -1742,6 +1808,13 @@ int32 chrif_parse(int32 fd) {
 	}
 
 	while ( RFIFOREST(fd) >= 2 ) {
+		// Compressed packets are expanded in place before they are parsed
+		switch( socket_compression_parse( fd ) ){
+			case 1: continue;
+			case 2: return 0;
+			case -1: set_eof( fd ); return 0;
+		}
+
 		int32 cmd = RFIFOW(fd,0);
 		if (cmd < 0x2af8 || cmd >= 0x2af8 + ARRAYLENGTH(packet_len_table) || packet_len_table[cmd-0x2af8] == 0) {
 			int32 r = intif_parse(fd); // Passed on to the intif
@@ -1763,6 +1836,9 @@ int32 chrif_parse(int32 fd) {
 		if ((int32)RFIFOREST(fd) < packet_len)
 			return 0;
 
+		if( inter_packet_reject( fd, packet_len ) )
+			continue;
+
 		//ShowDebug("Received packet 0x%4x (%d bytes) from char-server (connection %d)\n", RFIFOW(fd,0), packet_len, fd);
 
 		switch(cmd) {
@@ -1789,6 +1865,7 @@ int32 chrif_parse(int32 fd) {
 			case 0x2b24: chrif_keepalive_ack(fd); break;
 			case 0x2b25: chrif_deadopt(RFIFOL(fd,2), RFIFOL(fd,6), RFIFOL(fd,10)); break;
 			case 0x2b27: chrif_authfail(fd); break;
+			case 0x2b29: chrif_deferred_received(fd); break;
 			case 0x2b2b: chrif_parse_ack_vipActive(fd); break;
 			case 0x2b2f: chrif_bsdata_received(fd); break;
 			default:
@@ -1867,6 +1944,7 @@ static TIMER_FUNC(check_connect_char_server){
 
 		session[char_fd]->func_parse = chrif_parse;
 		session[char_fd]->flag.server = 1;
+		session[char_fd]->link = PACKET_LINK_CHAR;
 		realloc_fifo(char_fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
 
 		chrif_connect(char_fd);
@@ -43,6 +43,8 @@ int32 chrif_setip(const char* ip);
 void chrif_setport(uint16 port);
 
 int32 chrif_isconnected(void);
+void chrif_local_link(int32 fd);
+int32 chrif_parse(int32 fd);
 
 extern int32 chrif_connected;
 extern int32 other_mapserver_count;
@@ -85,6 +87,7 @@ void chrif_parse_ack_vipActive(int32 fd);
 int32 chrif_req_charban(int32 aid, const char* character_name, int32 timediff);
 int32 chrif_req_charunban(int32 aid, const char* character_name);
 
+int32 chrif_deferred_request(uint32 char_id);
 int32 chrif_bsdata_request(uint32 char_id);
 int32 chrif_bsdata_save(map_session_data *sd, bool quit);
 
@@ -17,6 +17,8 @@
 #include <common/grfio.hpp>
 #include <common/malloc.hpp>
 #include <common/nullpo.hpp>
+#include <common/packet_stats.hpp>
+#include <common/profiler.hpp>
 #include <common/random.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
@@ -78,6 +80,14 @@ static inline int32 client_exp(t_exp exp) {
 /* for clif_clearunit_delayed */
 static struct eri *delay_clearunit_ers;
 
+/// Counters for units shown to and removed from clients, see area_packet_stats_interval
+static struct s_clif_area_stats{
+	uint64 spawn;
+	uint64 spawn_skipped;
+	uint64 vanish;
+	uint64 packets; ///< Packets delivered to clients by area broadcasts
+} clif_area_stats;
+
 struct s_packet_db packet_db[MAX_PACKET_DB + 1];
 unsigned long color_table[COLOR_MAX];
 
@@ -467,6 +477,14 @@ static int32 clif_send_sub(block_list *bl, va_list ap)
 	memcpy(WFIFOP(fd,0), buf, len);
 	WFIFOSET(fd,len);
 
+	clif_area_stats.packets++;
+
+	// The client removes the unit, so it has to be spawned again when it comes back into sight
+	if( RBUFW( buf, 0 ) == HEADER_ZC_NOTIFY_VANISH ){
+		sd->area_known.erase( reinterpret_cast<PACKET_ZC_NOTIFY_VANISH*>( buf )->gid );
+		clif_area_stats.vanish++;
+	}
+
 	return 0;
 }
 
@@ -486,6 +504,11 @@ int32 clif_send(const void* buf, int32 len, block_list* bl, enum send_target typ
 	if( type != ALL_CLIENT )
 		nullpo_ret(bl);
 
+	// Every target but SELF can reach several sessions
+	if( type != SELF ){
+		packet_stats_broadcast( RBUFW( buf, 0 ) );
+	}
+
 	sd = BL_CAST(BL_PC, bl);
 
 	switch(type) {
@@ -957,6 +980,9 @@ void clif_clearunit_single( uint32 GID, clr_type type, map_session_data& tsd ){
 	packet.type = static_cast<decltype(packet.type)>(type);
 
 	clif_send( &packet, sizeof( packet ), &tsd, SELF );
+
+	tsd.area_known.erase( GID );
+	clif_area_stats.vanish++;
 }
 
 /// Makes a unit (char, npc, mob, homun) disappear to all clients in area.
@@ -2142,6 +2168,9 @@ void clif_changemap( map_session_data& sd, int16 m, uint16 x, uint16 y ){
 	packet.yPos = y;
 
 	clif_send( &packet, sizeof( packet ), &sd, SELF );
+
+	// The client drops all units when changing the map
+	sd.area_known.clear();
 }
 
 
@@ -2167,6 +2196,8 @@ void clif_changemapserver( map_session_data& sd, const char* map, uint16 x, uint
 #endif
 
 	clif_send( &packet, sizeof( packet ), &sd, SELF );
+
+	sd.area_known.clear();
 }
 
 
@@ -3520,8 +3551,12 @@ static int32 clif_hpmeter(map_session_data *sd)
 void clif_update_hp(map_session_data &sd) {
 	if (map_getmapdata(sd.m)->hpmeter_visible)
 		clif_hpmeter(&sd);
-	if (!battle_config.party_hp_mode && sd.status.party_id)
-		clif_party_hp( sd );
+	if (sd.status.party_id) {
+		if (!battle_config.party_hp_mode)
+			clif_party_hp( sd );
+		else
+			party_send_xy_mark( sd );
+	}
 	if (sd.bg_id)
 		clif_bg_hp(&sd);
 }
@@ -4342,6 +4377,26 @@ void clif_misceffect( block_list& bl, e_notify_effect type ){
 }
 
 
+/// Forgets that the client has been shown the given unit
+static int32 clif_area_forget_sub( block_list* bl, va_list ap ){
+	map_session_data* sd = reinterpret_cast<map_session_data*>( bl );
+	int32 id = va_arg( ap, int32 );
+
+	sd->area_known.erase( id );
+
+	return 0;
+}
+
+/**
+ * Forgets a unit in the known units of all clients around it.
+ * Used when the visibility of the unit changes without a vanish packet, for example when it hides
+ * or cloaks, so the next clif_insight spawns it again.
+ * @param bl: Unit whose visibility changed
+ */
+static void clif_area_forget( block_list& bl ){
+	map_foreachinallarea( clif_area_forget_sub, bl.m, bl.x - AREA_SIZE, bl.y - AREA_SIZE, bl.x + AREA_SIZE, bl.y + AREA_SIZE, BL_PC, bl.id );
+}
+
 /// Notifies clients in the area of a state change.
 /// 0119 <id>.L <body state>.W <health state>.W <effect state>.W <pk mode>.B (ZC_STATE_CHANGE)
 /// 0229 <id>.L <body state>.W <health state>.W <effect state>.L <pk mode>.B (ZC_STATE_CHANGE3)
@@ -4367,6 +4422,8 @@ void clif_changeoption_target( block_list* bl, block_list* target ){
 	p.isPKModeON = sd ? sd->status.karma : false;
 
 	if( target == nullptr ){
+		clif_area_forget( *bl );
+
 		if( disguised( bl ) ){
 			clif_send( &p, sizeof( p ), bl, AREA_WOS );
 			p.AID = disguised_bl_id( p.AID );
@@ -4386,6 +4443,12 @@ void clif_changeoption_target( block_list* bl, block_list* target ){
 			clif_status_change( bl, status_db.getIcon(SC_PROVOKE), 1, ( !td ? INFINITE_TICK : DIFF_TICK( td->tick, gettick() ) ), 0, 0, 0 );
 		}
 	}else{
+		map_session_data* tsd = BL_CAST( BL_PC, target );
+
+		if( tsd != nullptr ){
+			tsd->area_known.erase( bl->id );
+		}
+
 		if( disguised( bl ) ){
 			p.AID = disguised_bl_id( p.AID );
 			clif_send( &p, sizeof( p ), target, SELF );
@@ -4414,6 +4477,8 @@ void clif_changeoption2( block_list& bl ){
 	packet.level = clif_setlevel(&bl);
 	packet.showEFST = sc->opt3;
 
+	clif_area_forget( bl );
+
 	if (disguised(&bl)) {
 		clif_send( &packet, sizeof( packet ), &bl, AREA_WOS );
 		
@@ -5017,6 +5082,9 @@ void clif_getareachar_unit( map_session_data* sd,block_list *bl ){
 		return;
 	}
 
+	sd->area_known.insert( bl->id );
+	clif_area_stats.spawn++;
+
 	ud = unit_bl2ud(bl);
 
 	if( ud && ud->walktimer != INVALID_TIMER ){
@@ -5639,12 +5707,21 @@ int32 clif_insight(block_list *bl,va_list ap)
 			skill_getareachar_skillunit_visibilty_single((TBL_SKILL*)bl, tsd);
 			break;
 		default:
+			// The client still shows the unit, so there is nothing to resend
+			if( tsd->area_known.find( bl->id ) != tsd->area_known.end() ){
+				clif_area_stats.spawn_skipped++;
+				break;
+			}
 			clif_getareachar_unit(tsd,bl);
 			break;
 		}
 	}
 	if (clif_session_isValid(sd)) { //Tell sd that tbl walked into his view
-		clif_getareachar_unit(sd,tbl);
+		if( sd->area_known.find( tbl->id ) != sd->area_known.end() ){
+			clif_area_stats.spawn_skipped++;
+		}else{
+			clif_getareachar_unit(sd,tbl);
+		}
 	}
 	return 0;
 }
@@ -10891,36 +10968,7 @@ void clif_parse_LoadEndAck(int32 fd,map_session_data *sd)
 		}
 
 		// Notify everyone that this char logged in.
-		if( battle_config.friend_auto_add ){
-			for( const s_friend& my_friend : sd->status.friends ){
-				// Cancel early
-				if( my_friend.char_id == 0 ){
-					break;
-				}
-
-				if( map_session_data* tsd = map_charid2sd( my_friend.char_id ); tsd != nullptr ){
-					for( const s_friend& their_friend : tsd->status.friends ){
-						// Cancel early
-						if( their_friend.char_id == 0 ){
-							break;
-						}
-
-						if( their_friend.account_id != sd->status.account_id ){
-							continue;
-						}
-
-						if( their_friend.char_id != sd->status.char_id ){
-							continue;
-						}
-
-						clif_friendslist_toggle( *tsd, their_friend, true );
-						break;
-					}
-				}
-			}
-		}else{
-			map_foreachpc( clif_friendslist_toggle_sub, sd->status.account_id, sd->status.char_id, static_cast<int32>( true ) );
-		}
+		clif_friendslist_login( *sd );
 
 		if (!sd->state.autotrade) { // Don't trigger NPC event or opening vending/buyingstore will be failed
 			npc_script_event( *sd, NPCE_LOGIN );
@@ -15333,6 +15381,41 @@ void clif_friendslist_send( map_session_data& sd ){
 }
 
 
+/// Notifies the characters that have a character in their friends list that it is online now.
+void clif_friendslist_login( map_session_data& sd ){
+	if( battle_config.friend_auto_add ){
+		for( const s_friend& my_friend : sd.status.friends ){
+			// Cancel early
+			if( my_friend.char_id == 0 ){
+				break;
+			}
+
+			if( map_session_data* tsd = map_charid2sd( my_friend.char_id ); tsd != nullptr ){
+				for( const s_friend& their_friend : tsd->status.friends ){
+					// Cancel early
+					if( their_friend.char_id == 0 ){
+						break;
+					}
+
+					if( their_friend.account_id != sd.status.account_id ){
+						continue;
+					}
+
+					if( their_friend.char_id != sd.status.char_id ){
+						continue;
+					}
+
+					clif_friendslist_toggle( *tsd, their_friend, true );
+					break;
+				}
+			}
+		}
+	}else{
+		map_foreachpc( clif_friendslist_toggle_sub, sd.status.account_id, sd.status.char_id, static_cast<int32>( true ) );
+	}
+}
+
+
 /// Notification about the result of a friend add request (ZC_ADD_FRIENDS_LIST).
 /// 0209 <result>.W <account id>.L <char id>.L <name>.24B
 /// result:
@@ -22446,6 +22529,18 @@ TIMER_FUNC( clif_ping_timer ){
 	return 0;
 }
 
+/// Prints and resets the area visibility counters
+static TIMER_FUNC( clif_area_stats_timer ){
+	double seconds = battle_config.area_packet_stats_interval;
+
+	ShowInfo( "Area visibility in the last %d seconds: " CL_WHITE "%.1f" CL_RESET " area packets/sec, " CL_WHITE "%.1f" CL_RESET " units shown/sec, " CL_WHITE "%.1f" CL_RESET " redundant spawns skipped/sec, " CL_WHITE "%.1f" CL_RESET " units removed/sec.\n",
+		battle_config.area_packet_stats_interval, clif_area_stats.packets / seconds, clif_area_stats.spawn / seconds, clif_area_stats.spawn_skipped / seconds, clif_area_stats.vanish / seconds );
+
+	clif_area_stats = {};
+
+	return 0;
+}
+
 /**
  * Opens the refine UI on the designated client.
  * 0aa0
@@ -25704,7 +25799,12 @@ static int32 clif_parse(int32 fd)
 		else
 		if( sd && sd->prev == nullptr && packet_db[cmd].func != clif_parse_LoadEndAck )
 			; //Only valid packet when player is not on a map
-		else
+		else if( profiler_enabled ){
+			uint64 start = profiler_now();
+
+			packet_db[cmd].func(fd, sd);
+			profiler_record(PROFILE_PACKET, cmd, start);
+		}else
 			packet_db[cmd].func(fd, sd);
 	}
 #ifdef DUMP_UNKNOWN_PACKET
@@ -25787,10 +25887,12 @@ void do_init_clif(void) {
 	packetdb_readdb();
 
 	set_defaultparse(clif_parse);
+#ifndef MAP_SIMULATOR
 	if( make_listen_bind(bind_ip,map_port) == -1 ) {
 		ShowFatalError("Failed to bind to port '" CL_WHITE "%d" CL_RESET "'\n",map_port);
 		exit(EXIT_FAILURE);
 	}
+#endif
 
 	add_timer_func_list(clif_clearunit_delayed_sub, "clif_clearunit_delayed_sub");
 	add_timer_func_list(clif_delayquit, "clif_delayquit");
@@ -25803,6 +25905,12 @@ void do_init_clif(void) {
 	}
 #endif
 
+	add_timer_func_list( clif_area_stats_timer, "clif_area_stats_timer" );
+
+	if( battle_config.area_packet_stats_interval > 0 ){
+		add_timer_interval( gettick() + battle_config.area_packet_stats_interval * 1000, clif_area_stats_timer, 0, 0, battle_config.area_packet_stats_interval * 1000 );
+	}
+
 	delay_clearunit_ers = ers_new(sizeof(block_list),"clif.cpp::delay_clearunit_ers",ERS_OPT_CLEAR);
 }
 
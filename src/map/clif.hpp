@@ -1168,6 +1168,7 @@ void clif_pet_autofeed_status(map_session_data* sd, bool force);
 void clif_friendslist_toggle( map_session_data& sd, const s_friend& f, bool online );
 int32 clif_friendslist_toggle_sub( map_session_data* tsd, va_list ap );
 void clif_friendslist_send( map_session_data& sd );
+void clif_friendslist_login( map_session_data& sd );
 void clif_friendslist_reqack(map_session_data *sd, map_session_data *f_sd, int32 type);
 
 void clif_weather(int16 m); // [Valaris]
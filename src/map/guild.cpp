@@ -5,6 +5,7 @@
 
 #include <cstdlib>
 #include <memory>
+#include <unordered_set>
 
 #include <common/cbasetypes.hpp>
 #include <common/database.hpp>
@@ -194,6 +195,7 @@ GuildSkillTreeDatabase guild_skill_tree_db;
 
 TIMER_FUNC(guild_payexp_timer);
 static TIMER_FUNC(guild_send_xy_timer);
+static std::unordered_set<uint32> guild_xy_dirty; // account ids of members to check on the next guild_send_xy_timer
 
 /* guild flags cache */
 npc_data **guild_flags;
@@ -650,32 +652,31 @@ TIMER_FUNC(guild_payexp_timer){
 }
 
 /**
- * Send xy coords to a guild
- * @param g Reference to a guild
+ * Queue a guild member for the next position update.
+ * Called whenever the member moved.
+ * @param sd: Guild member
  */
-int32 guild_send_xy_timer_sub(const struct mmo_guild& g) {
-	if (g.connect_member <= 0) {
-		// no members connected to this guild so do not iterate
-		return 0;
+void guild_send_xy_mark( map_session_data& sd ){
+	if( sd.status.guild_id != 0 ){
+		guild_xy_dirty.insert( sd.status.account_id );
 	}
+}
+
+//Code from party_send_xy_timer [Skotlex]
+static TIMER_FUNC(guild_send_xy_timer){
+	// for each member that moved since the last update
+	for( uint32 account_id : guild_xy_dirty ){
+		map_session_data* sd = map_id2sd( account_id );
 
-	for (int32 i = 0; i < g.max_member; i++) {
-		map_session_data* sd = g.member[i].sd;
-		if( sd != nullptr && sd->fd && (sd->guild_x != sd->x || sd->guild_y != sd->y) && !sd->bg_id ) {
+		if( sd != nullptr && sd->guild != nullptr && sd->fd && (sd->guild_x != sd->x || sd->guild_y != sd->y) && !sd->bg_id ) {
 			clif_guild_xy( *sd );
 			sd->guild_x = sd->x;
 			sd->guild_y = sd->y;
 		}
 	}
-	return 0;
-}
 
-//Code from party_send_xy_timer [Skotlex]
-static TIMER_FUNC(guild_send_xy_timer){
-	for (const auto &it : guild_db) {
-		if (it.second)
-			guild_send_xy_timer_sub(it.second->guild);
-	}
+	guild_xy_dirty.clear();
+
 	return 0;
 }
 
@@ -874,6 +875,7 @@ int32 guild_recv_info(const struct mmo_guild &sg) {
 		if( sd->guild == nullptr || sd->guild != g ){
 			sd->guild = g;
 			clif_name_area(sd);
+			guild_send_xy_mark( *sd );
 		}
 		if(channel_config.ally_tmpl.name[0] && (channel_config.ally_tmpl.opt&CHAN_OPT_AUTOJOIN)) {
 			channel_gjoin(sd,3); //make all member join guildchan+allieschan
@@ -1092,6 +1094,7 @@ void guild_member_joined(map_session_data *sd) {
 		g->guild.member[i].sd = sd;
 		sd->guild = g;
 		clif_name_area(sd);
+		guild_send_xy_mark( *sd );
 
 		if( channel_config.ally_tmpl.name[0] && (channel_config.ally_tmpl.opt&CHAN_OPT_AUTOJOIN) ) {
 			channel_gjoin(sd,3);
@@ -1131,6 +1134,7 @@ int32 guild_member_added(int32 guild_id,uint32 account_id,uint32 char_id,int32 f
 	sd->status.guild_id = g->guild.guild_id;
 	sd->guild_emblem_id = g->guild.emblem_id;
 	sd->guild = g;
+	guild_send_xy_mark( *sd );
 	//Packets which were sent in the previous 'guild_sent' implementation.
 	clif_guild_belonginfo( *sd );
 	clif_guild_notice( *sd );
@@ -92,6 +92,7 @@ int32 guild_emblem_changed(int32 len,int32 guild_id,int32 emblem_id,const char *
 int32 guild_send_message(map_session_data *sd, const char *mes, size_t len);
 int32 guild_recv_message( int32 guild_id, uint32 account_id, const char *mes, size_t len );
 int32 guild_send_dot_remove(map_session_data *sd);
+void guild_send_xy_mark( map_session_data& sd );
 int32 guild_skillupack(int32 guild_id,uint16 skill_id,uint32 account_id);
 int32 guild_break( map_session_data& sd, const char* name );
 int32 guild_broken(int32 guild_id,int32 flag);
@@ -8,6 +8,7 @@
 #include <common/malloc.hpp>
 #include <common/mmo.hpp>
 #include <common/nullpo.hpp>
+#include <common/packets_inter.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp>
 #include <common/strlib.hpp>
@@ -568,13 +569,14 @@ bool intif_send_guild_storage(uint32 account_id, struct s_storage *gstor)
 {
 	if (CheckForCharServer())
 		return false;
-	WFIFOHEAD(inter_fd,sizeof(struct s_storage)+12);
-	WFIFOW(inter_fd,0) = 0x3019;
-	WFIFOW(inter_fd,2) = (uint16)sizeof(struct s_storage)+12;
-	WFIFOL(inter_fd,4) = account_id;
-	WFIFOL(inter_fd,8) = gstor->id;
-	memcpy( WFIFOP(inter_fd,12),gstor, sizeof(struct s_storage) );
-	WFIFOSET(inter_fd,WFIFOW(inter_fd,2));
+	WFIFOHEAD(inter_fd,sizeof(struct PACKET_ZI_GUILD_STORAGE_SAVE));
+	struct PACKET_ZI_GUILD_STORAGE_SAVE* p = (struct PACKET_ZI_GUILD_STORAGE_SAVE*)WFIFOP( inter_fd, 0 );
+	p->packetType = HEADER_ZI_GUILD_STORAGE_SAVE;
+	p->packetLength = sizeof(struct PACKET_ZI_GUILD_STORAGE_SAVE);
+	p->account_id = account_id;
+	p->guild_id = gstor->id;
+	p->storage = *gstor;
+	WFIFOSET(inter_fd,p->packetLength);
 	return true;
 }
 
@@ -1489,19 +1491,20 @@ void intif_parse_Registers(int32 fd)
  */
 int32 intif_parse_LoadGuildStorage(int32 fd)
 {
+	const struct PACKET_IZ_GUILD_STORAGE_DATA* p = (struct PACKET_IZ_GUILD_STORAGE_DATA*)RFIFOP( fd, 0 );
 	struct s_storage *gstor;
 	map_session_data *sd;
 	int32 guild_id, flag;
 
-	guild_id = RFIFOL(fd,8);
-	flag = RFIFOL(fd,12);
+	guild_id = p->guild_id;
 	if (guild_id <= 0)
 		return 0;
 
-	sd = map_id2sd( RFIFOL(fd,4) );
+	flag = p->open;
+	sd = map_id2sd( p->account_id );
 	if (flag){ //If flag != 0, we attach a player and open the storage
 		if(sd == nullptr){
-			ShowError("intif_parse_LoadGuildStorage: user not found (AID: %d)\n",RFIFOL(fd,4));
+			ShowError("intif_parse_LoadGuildStorage: user not found (AID: %d)\n",p->account_id);
 			return 0;
 		}
 	}
@@ -1518,13 +1521,8 @@ int32 intif_parse_LoadGuildStorage(int32 fd)
 		ShowWarning("intif_parse_LoadGuildStorage: received storage for an already modified non-saved storage! (User %d:%d)\n", flag?sd->status.account_id:1, flag?sd->status.char_id:1);
 		return 0;
 	}
-	if (RFIFOW(fd,2)-13 != sizeof(struct s_storage)) {
-		ShowError("intif_parse_LoadGuildStorage: data size error %d %" PRIuPTR "\n",RFIFOW(fd,2)-13 , sizeof(struct s_storage));
-		gstor->status = false;
-		return 0;
-	}
 
-	memcpy(gstor,RFIFOP(fd,13),sizeof(struct s_storage));
+	*gstor = p->storage;
 	if( flag )
 		storage_guild_storageopen(sd);
 
@@ -1662,14 +1660,14 @@ int32 intif_parse_GuildCreated(int32 fd)
  */
 int32 intif_parse_GuildInfo(int32 fd)
 {
-	if(RFIFOW(fd,2) == 8) {
-		ShowWarning("intif: guild noinfo %d\n",RFIFOL(fd,4));
-		guild_recv_noinfo(RFIFOL(fd,4));
+	const struct PACKET_IZ_GUILD_INFO* p = (struct PACKET_IZ_GUILD_INFO*)RFIFOP( fd, 0 );
+
+	if( p->packetLength == INTER_PACKET_GUILD_INFO_EMPTY ){
+		ShowWarning("intif: guild noinfo %d\n",p->guild.guild_id);
+		guild_recv_noinfo(p->guild.guild_id);
 		return 0;
 	}
-	if( RFIFOW(fd,2)!=sizeof(struct mmo_guild)+4 )
-		ShowError("intif: guild info : data size error Gid: %d recv size: %d Expected size: %" PRIuPTR "\n",RFIFOL(fd,4),RFIFOW(fd,2),sizeof(struct mmo_guild)+4);
-	guild_recv_info(*(struct mmo_guild *)RFIFOP(fd,4));
+	guild_recv_info(*(struct mmo_guild*)RFIFOP( fd, offsetof( struct PACKET_IZ_GUILD_INFO, guild ) ));
 	return 1;
 }
 
@@ -3424,24 +3422,23 @@ void intif_parse_itembound_store2gstorage(int32 fd) {
  */
 static bool intif_parse_StorageReceived(int32 fd)
 {
-	char type =  RFIFOB(fd,4);
-	uint32 account_id = RFIFOL(fd, 5);
+	const struct PACKET_IZ_STORAGE_DATA* packet = (struct PACKET_IZ_STORAGE_DATA*)RFIFOP( fd, 0 );
+	char type = packet->type;
+	uint32 account_id = packet->account_id;
 	map_session_data *sd = map_id2sd(account_id);
-	struct s_storage *stor, *p; //storage
-	size_t sz_stor = sizeof(struct s_storage);
+	struct s_storage *stor;
+	const struct s_storage *p = (struct s_storage*)RFIFOP( fd, offsetof( struct PACKET_IZ_STORAGE_DATA, storage ) );
 
 	if (!sd) {
 		ShowError("intif_parse_StorageReceived: No player online for receiving inventory/cart/storage data (AID: %d)\n", account_id);
 		return false;
 	}
 
-	if (!RFIFOB(fd, 9)) {
+	if (!packet->result) {
 		ShowError("intif_parse_StorageReceived: Failed to load! (AID: %d, type: %d)\n", account_id, type);
 		return false;
 	}
 
-	p = (struct s_storage *)RFIFOP(fd,10);
-
 	switch (type) { 
 		case TABLE_INVENTORY:
 			stor = &sd->inventory;
@@ -3469,13 +3466,8 @@ static bool intif_parse_StorageReceived(int32 fd)
 			return false;
 		}
 	}
-	if (RFIFOW(fd,2)-10 != sz_stor) {
-		ShowError("intif_parse_StorageReceived: data size error %d %" PRIuPTR "\n",RFIFOW(fd,2)-10 , sz_stor);
-		stor->status = false;
-		return false;
-	}
 
-	memcpy(stor, p, sz_stor); //copy the items data to correct destination
+	*stor = *p; //copy the items data to correct destination
 
 	switch (type) {
 		case TABLE_INVENTORY: {
@@ -3651,22 +3643,21 @@ bool intif_storage_request(map_session_data *sd, enum storage_type type, uint8 s
  */
 bool intif_storage_save(map_session_data *sd, struct s_storage *stor)
 {
-	int32 stor_size = sizeof(struct s_storage);
-
 	nullpo_retr(false, sd);
 	nullpo_retr(false, stor);
 
 	if (CheckForCharServer())
 		return false;
 
-	WFIFOHEAD(inter_fd, stor_size+13);
-	WFIFOW(inter_fd, 0) = 0x308b;
-	WFIFOW(inter_fd, 2) = stor_size+13;
-	WFIFOB(inter_fd, 4) = stor->type;
-	WFIFOL(inter_fd, 5) = sd->status.account_id;
-	WFIFOL(inter_fd, 9) = sd->status.char_id;
-	memcpy(WFIFOP(inter_fd, 13), stor, stor_size);
-	WFIFOSET(inter_fd, stor_size+13);
+	WFIFOHEAD(inter_fd, sizeof(struct PACKET_ZI_STORAGE_SAVE));
+	struct PACKET_ZI_STORAGE_SAVE* p = (struct PACKET_ZI_STORAGE_SAVE*)WFIFOP( inter_fd, 0 );
+	p->packetType = HEADER_ZI_STORAGE_SAVE;
+	p->packetLength = sizeof(struct PACKET_ZI_STORAGE_SAVE);
+	p->type = stor->type;
+	p->account_id = sd->status.account_id;
+	p->char_id = sd->status.char_id;
+	p->storage = *stor;
+	WFIFOSET(inter_fd, p->packetLength);
 	return true;
 }
 
@@ -3780,6 +3771,9 @@ int32 intif_parse(int32 fd)
 	if((int32)RFIFOREST(fd)<packet_len){
 		return 2;
 	}
+	if( inter_packet_reject( fd, packet_len ) ){
+		return 1;
+	}
 	// Processing branch
 	switch(cmd){
 	case 0x3800:
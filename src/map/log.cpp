@@ -3,13 +3,25 @@
 
 #include "log.hpp"
 
+#include <cerrno>
+#include <condition_variable>
+#include <cstdarg>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <common/cbasetypes.hpp>
 #include <common/nullpo.hpp>
 #include <common/showmsg.hpp>
 #include <common/sql.hpp> // SQL_INNODB
 #include <common/strlib.hpp>
+#include <common/timer.hpp>
 
 #include "battle.hpp"
 #include "homunculus.hpp"
@@ -169,6 +181,378 @@ static bool should_log_item(t_itemid nameid, int32 amount, int32 refine)
 }
 
 
+// A prepared statement takes at most this many parameters
+#define LOG_STMT_PARAMS_MAX 65535
+
+/// Row of a log table
+struct s_log_row{
+	std::string values; ///< Values of the row, with a ? for each string that is bound as parameter
+	std::vector<std::string> params;
+};
+
+/// Rows of one table that are written together with a single multi-row INSERT
+struct s_log_sql_batch{
+	std::string table;
+	std::string columns;
+	std::vector<s_log_row> rows;
+};
+
+/// Lines of one log file that are appended together
+struct s_log_file_batch{
+	std::string filename;
+	std::string lines;
+	size_t count;
+};
+
+static std::unordered_map<std::string, s_log_sql_batch> log_sql_batches;
+static std::unordered_map<std::string, s_log_file_batch> log_file_batches;
+/// Number of rows and lines waiting in all batches
+static size_t log_buffered = 0;
+static int32 log_flush_tid = INVALID_TIMER;
+
+// The batches are written by a thread, so the main thread does not wait for the database or the disk.
+// It only uses the MySQL client library and the standard library, which are thread-safe, and its own connection.
+static std::thread log_writer;
+static std::mutex log_writer_mutex;
+static std::condition_variable log_writer_wakeup; // batches were queued or the server shuts down
+static std::deque<s_log_sql_batch> log_writer_sql;
+static std::deque<s_log_file_batch> log_writer_files;
+static size_t log_writer_pending = 0; // rows and lines queued or being written
+static bool log_writer_stopping = false;
+static uint64 log_dropped = 0; // rows and lines that could not be written
+static std::string log_writer_error; // last error of the writer
+// Only used by the main thread
+static uint64 log_dropped_reported = 0;
+
+/// printf into a std::string
+static std::string log_vformat( const char* format, va_list ap ){
+	va_list apcopy;
+
+	va_copy( apcopy, ap );
+	int32 len = vsnprintf( nullptr, 0, format, apcopy );
+	va_end( apcopy );
+
+	if( len <= 0 ){
+		return {};
+	}
+
+	std::string result( len, '\0' );
+
+	vsnprintf( &result[0], len + 1, format, ap );
+
+	return result;
+}
+
+/// Counts rows or lines that could not be written, called by the writer
+static void log_writer_drop( size_t count, const char* error ){
+	std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+	log_dropped += count;
+	log_writer_error = error;
+}
+
+/// Inserts a range of rows of a batch with a single prepared statement, called by the writer
+/// @return true if the rows were written
+static bool log_writer_insert( MYSQL* mysql, const s_log_sql_batch& batch, size_t first, size_t last, bool report ){
+	std::string query = LOG_QUERY " INTO `" + batch.table + "` (" + batch.columns + ") VALUES ";
+	std::vector<MYSQL_BIND> params;
+
+	for( size_t i = first; i < last; i++ ){
+		if( i > first ){
+			query += ',';
+		}
+
+		query += '(' + batch.rows[i].values + ')';
+
+		for( const std::string& param : batch.rows[i].params ){
+			MYSQL_BIND bind = {};
+
+			bind.buffer_type = MYSQL_TYPE_STRING;
+			bind.buffer = const_cast<char*>( param.data() );
+			bind.buffer_length = static_cast<unsigned long>( param.size() );
+
+			params.push_back( bind );
+		}
+	}
+
+	MYSQL_STMT* stmt = mysql_stmt_init( mysql );
+	bool written = stmt != nullptr
+		&& mysql_stmt_prepare( stmt, query.data(), static_cast<unsigned long>( query.size() ) ) == 0
+		&& ( params.empty() || !mysql_stmt_bind_param( stmt, params.data() ) )
+		&& mysql_stmt_execute( stmt ) == 0;
+
+	if( !written && report ){
+		log_writer_drop( last - first, stmt != nullptr ? mysql_stmt_error( stmt ) : mysql_error( mysql ) );
+	}
+
+	if( stmt != nullptr ){
+		mysql_stmt_close( stmt );
+	}
+
+	return written;
+}
+
+/// Writes all rows of a batch, called by the writer
+static void log_writer_write_sql( MYSQL* mysql, const s_log_sql_batch& batch ){
+	if( mysql == nullptr ){
+		log_writer_drop( batch.rows.size(), "no connection to the log database" );
+		return;
+	}
+
+	for( size_t first = 0, last; first < batch.rows.size(); first = last ){
+		size_t params = 0;
+
+		for( last = first; last < batch.rows.size() && ( last == first || params + batch.rows[last].params.size() <= LOG_STMT_PARAMS_MAX ); last++ ){
+			params += batch.rows[last].params.size();
+		}
+
+		if( last - first == 1 ){
+			log_writer_insert( mysql, batch, first, last, true );
+		}else if( !log_writer_insert( mysql, batch, first, last, false ) ){
+			// Insert the rows one by one, so a single bad row does not take the others with it
+			for( size_t i = first; i < last; i++ ){
+				log_writer_insert( mysql, batch, i, i + 1, true );
+			}
+		}
+	}
+}
+
+/// Appends all lines of a batch to its log file, called by the writer
+static void log_writer_write_file( const s_log_file_batch& batch ){
+	FILE* logfp = fopen( batch.filename.c_str(), "a" );
+
+	if( logfp == nullptr ){
+		log_writer_drop( batch.count, strerror( errno ) );
+		return;
+	}
+
+	if( fwrite( batch.lines.data(), 1, batch.lines.size(), logfp ) != batch.lines.size() ){
+		log_writer_drop( batch.count, strerror( errno ) );
+	}
+
+	fclose( logfp );
+}
+
+/// Writes the queued batches until the server shuts down
+static void log_writer_main( MYSQL* mysql ){
+	mysql_thread_init();
+
+	std::unique_lock<std::mutex> lock( log_writer_mutex );
+
+	while( true ){
+		log_writer_wakeup.wait( lock, [](){
+			return log_writer_stopping || !log_writer_sql.empty() || !log_writer_files.empty();
+		} );
+
+		if( log_writer_sql.empty() && log_writer_files.empty() ){
+			// Stopping and everything was written
+			break;
+		}
+
+		size_t count;
+
+		if( !log_writer_sql.empty() ){
+			s_log_sql_batch batch = std::move( log_writer_sql.front() );
+
+			log_writer_sql.pop_front();
+			lock.unlock();
+			log_writer_write_sql( mysql, batch );
+			count = batch.rows.size();
+		}else{
+			s_log_file_batch batch = std::move( log_writer_files.front() );
+
+			log_writer_files.pop_front();
+			lock.unlock();
+			log_writer_write_file( batch );
+			count = batch.count;
+		}
+
+		lock.lock();
+		log_writer_pending -= count;
+	}
+
+	lock.unlock();
+	mysql_thread_end();
+}
+
+/// Hands all buffered rows of a table to the writer
+static void log_flush_sql( s_log_sql_batch& batch ){
+	if( batch.rows.empty() ){
+		return;
+	}
+
+	size_t count = batch.rows.size();
+
+	{
+		std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+		log_writer_pending += count;
+		log_writer_sql.push_back( std::move( batch ) );
+	}
+
+	log_writer_wakeup.notify_one();
+	log_buffered -= count;
+	batch.rows.clear();
+}
+
+/// Hands all buffered lines of a log file to the writer
+static void log_flush_file( s_log_file_batch& batch ){
+	if( batch.count == 0 ){
+		return;
+	}
+
+	size_t count = batch.count;
+
+	{
+		std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+		log_writer_pending += count;
+		log_writer_files.push_back( std::move( batch ) );
+	}
+
+	log_writer_wakeup.notify_one();
+	log_buffered -= count;
+	batch.lines.clear();
+	batch.count = 0;
+}
+
+/// Reports the entries the writer could not write since the last report
+static void log_report_dropped( void ){
+	std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+	if( log_dropped != log_dropped_reported ){
+		ShowWarning( "log_flush: %" PRIu64 " log entries could not be written (%" PRIu64 " in total), last error: %s\n", log_dropped - log_dropped_reported, log_dropped, log_writer_error.c_str() );
+		log_dropped_reported = log_dropped;
+	}
+}
+
+/// Hands all buffered batches to the writer
+static void log_flush_batches( void ){
+	for( auto& pair : log_sql_batches ){
+		log_flush_sql( pair.second );
+	}
+
+	for( auto& pair : log_file_batches ){
+		log_flush_file( pair.second );
+	}
+}
+
+/// Hands everything that is buffered to the writer
+void log_flush( void ){
+	log_flush_batches();
+	log_report_dropped();
+}
+
+/// Drops a new entry once log_buffer_max entries are buffered or still being written
+/// The main thread never waits for the writer, the dropped entries are reported with the next flush.
+/// @return true if the entry has to be dropped
+static bool log_buffer_full( void ){
+	{
+		std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+		if( log_buffered + log_writer_pending < log_config.buffer_max ){
+			return false;
+		}
+
+		log_dropped++;
+		log_writer_error = "log_buffer_max reached";
+	}
+
+	// Let the writer start on everything that is still buffered
+	log_flush_batches();
+
+	return true;
+}
+
+/// Checks if the batch of the caller reached the configured limits
+/// @param rows: number of entries buffered for the same table or file
+/// @return true if the batch of the caller has to be written now
+static bool log_should_flush( size_t rows ){
+	return log_config.flush_interval == 0 || rows >= log_config.batch_rows;
+}
+
+/// Queues a row for the given table
+/// @param table: table name
+/// @param columns: column list, the first one receives the current time
+/// @param params: strings that are bound to the ? in the values
+/// @param format: values of the remaining columns
+static void log_sql_insert( const char* table, const char* columns, std::vector<std::string>&& params, const char* format, ... ){
+	if( log_buffer_full() ){
+		return;
+	}
+
+	s_log_sql_batch& batch = log_sql_batches[std::string( table ) + ":" + columns];
+
+	if( batch.rows.empty() ){
+		batch.table = table;
+		batch.columns = columns;
+	}
+
+	s_log_row row;
+	va_list ap;
+
+	va_start( ap, format );
+	row.values = "FROM_UNIXTIME(" + std::to_string( time( nullptr ) ) + ")," + log_vformat( format, ap );
+	va_end( ap );
+	row.params = std::move( params );
+
+	batch.rows.push_back( std::move( row ) );
+	log_buffered++;
+
+	if( log_should_flush( batch.rows.size() ) ){
+		log_flush_sql( batch );
+	}
+}
+
+/// Queues a line for the given log file, prefixed with the current time
+static void log_file_write( const char* filename, const char* format, ... ){
+	if( log_buffer_full() ){
+		return;
+	}
+
+	s_log_file_batch& batch = log_file_batches[filename];
+	char timestring[255];
+	time_t curtime;
+
+	if( batch.count == 0 ){
+		batch.filename = filename;
+	}
+
+	time( &curtime );
+	strftime( timestring, sizeof( timestring ), log_timestamp_format, localtime( &curtime ) );
+
+	va_list ap;
+
+	va_start( ap, format );
+	batch.lines += std::string( timestring ) + " - " + log_vformat( format, ap );
+	va_end( ap );
+
+	batch.count++;
+	log_buffered++;
+
+	if( log_should_flush( batch.count ) ){
+		log_flush_file( batch );
+	}
+}
+
+static TIMER_FUNC( log_flush_timer ){
+	log_flush();
+
+	return 0;
+}
+
+/// Starts the flush timer with the current log_flush_interval
+static void log_flush_timer_start( void ){
+	if( log_flush_tid != INVALID_TIMER ){
+		delete_timer( log_flush_tid, log_flush_timer );
+		log_flush_tid = INVALID_TIMER;
+	}
+
+	if( log_config.flush_interval > 0 ){
+		log_flush_tid = add_timer_interval( gettick() + log_config.flush_interval, log_flush_timer, 0, 0, log_config.flush_interval );
+	}
+}
+
 /// logs items, that summon monsters
 void log_branch(map_session_data* sd)
 {
@@ -178,28 +562,12 @@ void log_branch(map_session_data* sd)
 		return;
 
 	if( log_config.sql_logs ) {
-		SqlStmt stmt{ *logmysql_handle };
-
-		if( SQL_SUCCESS != stmt.Prepare(LOG_QUERY " INTO `%s` (`branch_date`, `account_id`, `char_id`, `char_name`, `map`) VALUES (NOW(), '%d', '%d', ?, '%s')", log_config.log_branch, sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex) )
-		||  SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, sd->status.name, strnlen(sd->status.name, NAME_LENGTH))
-		||  SQL_SUCCESS != stmt.Execute() )
-		{
-			SqlStmt_ShowDebug(stmt);
-			return;
-		}
+		log_sql_insert(log_config.log_branch, "`branch_date`, `account_id`, `char_id`, `char_name`, `map`", { std::string(sd->status.name, strnlen(sd->status.name, NAME_LENGTH)) }, "'%d', '%d', ?, '%s'",
+			sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_branch, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp,"%s - %s[%d:%d]\t%s\n", timestring, sd->status.name, sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex));
-		fclose(logfp);
+		log_file_write(log_config.log_branch, "%s[%d:%d]\t%s\n", sd->status.name, sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex));
 	}
 }
 
@@ -217,43 +585,32 @@ void log_pick(int32 id, int16 m, e_log_pick_type type, int32 amount, struct item
 
 	if( log_config.sql_logs )
 	{
+		static std::string columns;
+		std::string slots;
 		int32 i;
-		SqlStmt stmt{ *logmysql_handle };
-		StringBuf buf;
-		StringBuf_Init(&buf);
-
-		StringBuf_Printf(&buf, "%s INTO `%s` (`time`, `char_id`, `type`, `nameid`, `amount`, `refine`, `map`, `unique_id`, `bound`, `enchantgrade`", LOG_QUERY, log_config.log_pick);
-		for (i = 0; i < MAX_SLOTS; ++i)
-			StringBuf_Printf(&buf, ", `card%d`", i);
-		for (i = 0; i < MAX_ITEM_RDM_OPT; ++i) {
-			StringBuf_Printf(&buf, ", `option_id%d`", i);
-			StringBuf_Printf(&buf, ", `option_val%d`", i);
-			StringBuf_Printf(&buf, ", `option_parm%d`", i);
+
+		if( columns.empty() ){
+			columns = "`time`, `char_id`, `type`, `nameid`, `amount`, `refine`, `map`, `unique_id`, `bound`, `enchantgrade`";
+			for (i = 0; i < MAX_SLOTS; ++i)
+				columns += ", `card" + std::to_string(i) + "`";
+			for (i = 0; i < MAX_ITEM_RDM_OPT; ++i) {
+				columns += ", `option_id" + std::to_string(i) + "`";
+				columns += ", `option_val" + std::to_string(i) + "`";
+				columns += ", `option_parm" + std::to_string(i) + "`";
+			}
 		}
-		StringBuf_Printf(&buf, ") VALUES(NOW(),'%u','%c','%u','%d','%d','%s','%" PRIu64 "','%d','%d'",
-			id, log_picktype2char(type), itm->nameid, amount, itm->refine, map_getmapdata(m)->name[0] ? map_getmapdata(m)->name : "", itm->unique_id, itm->bound, itm->enchantgrade);
 
 		for (i = 0; i < MAX_SLOTS; i++)
-			StringBuf_Printf(&buf, ",'%u'", itm->card[i]);
+			slots += ",'" + std::to_string(itm->card[i]) + "'";
 		for (i = 0; i < MAX_ITEM_RDM_OPT; i++)
-			StringBuf_Printf(&buf, ",'%d','%d','%d'", itm->option[i].id, itm->option[i].value, itm->option[i].param);
-		StringBuf_Printf(&buf, ")");
+			slots += ",'" + std::to_string(itm->option[i].id) + "','" + std::to_string(itm->option[i].value) + "','" + std::to_string(itm->option[i].param) + "'";
 
-		if (SQL_SUCCESS != stmt.PrepareStr(StringBuf_Value(&buf)) || SQL_SUCCESS != stmt.Execute())
-			SqlStmt_ShowDebug(stmt);
+		log_sql_insert(log_config.log_pick, columns.c_str(), {}, "'%u','%c','%u','%d','%d','%s','%" PRIu64 "','%d','%d'%s",
+			id, log_picktype2char(type), itm->nameid, amount, itm->refine, map_getmapdata(m)->name[0] ? map_getmapdata(m)->name : "", itm->unique_id, itm->bound, itm->enchantgrade, slots.c_str());
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_pick, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp,"%s - %d\t%c\t%u,%d,%d,%u,%u,%u,%u,%s,'%" PRIu64 "',%d,%d\n", timestring, id, log_picktype2char(type), itm->nameid, amount, itm->refine, itm->card[0], itm->card[1], itm->card[2], itm->card[3], map_getmapdata(m)->name[0]?map_getmapdata(m)->name:"", itm->unique_id, itm->bound, itm->enchantgrade);
-		fclose(logfp);
+		log_file_write(log_config.log_pick, "%d\t%c\t%u,%d,%d,%u,%u,%u,%u,%s,'%" PRIu64 "',%d,%d\n", id, log_picktype2char(type), itm->nameid, amount, itm->refine, itm->card[0], itm->card[1], itm->card[2], itm->card[3], map_getmapdata(m)->name[0]?map_getmapdata(m)->name:"", itm->unique_id, itm->bound, itm->enchantgrade);
 	}
 }
 
@@ -281,25 +638,12 @@ void log_zeny(const map_session_data &target_sd, e_log_pick_type type, uint32 sr
 
 	if( log_config.sql_logs )
 	{
-		if (SQL_ERROR == Sql_Query(logmysql_handle, LOG_QUERY " INTO `%s` (`time`, `char_id`, `src_id`, `type`, `amount`, `map`) VALUES (NOW(), '%d', '%d', '%c', '%d', '%s')",
-			log_config.log_zeny, target_sd.status.char_id, src_id, log_picktype2char(type), amount, mapindex_id2name(target_sd.mapindex)))
-		{
-			Sql_ShowDebug(logmysql_handle);
-			return;
-		}
+		log_sql_insert(log_config.log_zeny, "`time`, `char_id`, `src_id`, `type`, `amount`, `map`", {}, "'%d', '%d', '%c', '%d', '%s'",
+			target_sd.status.char_id, src_id, log_picktype2char(type), amount, mapindex_id2name(target_sd.mapindex));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_zeny, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - [%d] ->\t%s[%d]\t%d\t\n", timestring, src_id, target_sd.status.name, target_sd.status.char_id, amount);
-		fclose(logfp);
+		log_file_write(log_config.log_zeny, "[%d] ->\t%s[%d]\t%d\t\n", src_id, target_sd.status.name, target_sd.status.char_id, amount);
 	}
 }
 
@@ -314,25 +658,12 @@ void log_mvpdrop(map_session_data* sd, int32 monster_id, t_itemid nameid, t_exp
 
 	if( log_config.sql_logs )
 	{
-		if( SQL_ERROR == Sql_Query(logmysql_handle, LOG_QUERY " INTO `%s` (`mvp_date`, `kill_char_id`, `monster_id`, `prize`, `mvpexp`, `map`) VALUES (NOW(), '%d', '%d', '%u', '%" PRIu64 "', '%s') ",
-			log_config.log_mvpdrop, sd->status.char_id, monster_id, nameid, exp, mapindex_id2name(sd->mapindex)) )
-		{
-			Sql_ShowDebug(logmysql_handle);
-			return;
-		}
+		log_sql_insert(log_config.log_mvpdrop, "`mvp_date`, `kill_char_id`, `monster_id`, `prize`, `mvpexp`, `map`", {}, "'%d', '%d', '%u', '%" PRIu64 "', '%s'",
+			sd->status.char_id, monster_id, nameid, exp, mapindex_id2name(sd->mapindex));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_mvpdrop,"a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp,"%s - %s[%d:%d]\t%d\t%u,%" PRIu64 "\n", timestring, sd->status.name, sd->status.account_id, sd->status.char_id, monster_id, nameid, exp);
-		fclose(logfp);
+		log_file_write(log_config.log_mvpdrop, "%s[%d:%d]\t%d\t%u,%" PRIu64 "\n", sd->status.name, sd->status.account_id, sd->status.char_id, monster_id, nameid, exp);
 	}
 }
 
@@ -348,29 +679,13 @@ void log_atcommand(map_session_data* sd, const char* message)
 
 	if( log_config.sql_logs )
 	{
-		SqlStmt stmt{ *logmysql_handle };
-
-		if( SQL_SUCCESS != stmt.Prepare(LOG_QUERY " INTO `%s` (`atcommand_date`, `account_id`, `char_id`, `char_name`, `map`, `command`) VALUES (NOW(), '%d', '%d', ?, '%s', ?)", log_config.log_gm, sd->status.account_id, sd->status.char_id, sd->mapindex == 0 ? "" : mapindex_id2name(sd->mapindex))
-		||  SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, sd->status.name, strnlen(sd->status.name, NAME_LENGTH))
-		||  SQL_SUCCESS != stmt.BindParam(1, SQLDT_STRING, (char*)message, safestrnlen(message, 255))
-		||  SQL_SUCCESS != stmt.Execute() )
-		{
-			SqlStmt_ShowDebug(stmt);
-			return;
-		}
+		log_sql_insert(log_config.log_gm, "`atcommand_date`, `account_id`, `char_id`, `char_name`, `map`, `command`",
+			{ std::string(sd->status.name, strnlen(sd->status.name, NAME_LENGTH)), std::string(message, safestrnlen(message, 255)) }, "'%d', '%d', ?, '%s', ?",
+			sd->status.account_id, sd->status.char_id, sd->mapindex == 0 ? "" : mapindex_id2name(sd->mapindex));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_gm, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - %s[%d]: %s\n", timestring, sd->status.name, sd->status.account_id, message);
-		fclose(logfp);
+		log_file_write(log_config.log_gm, "%s[%d]: %s\n", sd->status.name, sd->status.account_id, message);
 	}
 }
 
@@ -383,29 +698,13 @@ void log_npc( npc_data* nd, const char* message ){
 
 	if( log_config.sql_logs )
 	{
-		SqlStmt stmt{ *logmysql_handle };
-
-		if( SQL_SUCCESS != stmt.Prepare(LOG_QUERY " INTO `%s` (`npc_date`, `char_name`, `map`, `mes`) VALUES (NOW(), ?, '%s', ?)", log_config.log_npc, map_mapid2mapname(nd->m) )
-		||  SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, nd->name, strnlen(nd->name, NAME_LENGTH))
-		||  SQL_SUCCESS != stmt.BindParam(1, SQLDT_STRING, (char*)message, safestrnlen(message, 255))
-		||  SQL_SUCCESS != stmt.Execute() )
-		{
-			SqlStmt_ShowDebug(stmt);
-			return;
-		}
+		log_sql_insert(log_config.log_npc, "`npc_date`, `char_name`, `map`, `mes`",
+			{ std::string(nd->name, strnlen(nd->name, NAME_LENGTH)), std::string(message, safestrnlen(message, 255)) }, "?, '%s', ?",
+			map_mapid2mapname(nd->m));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_npc, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - %s: %s\n", timestring, nd->name, message);
-		fclose(logfp);
+		log_file_write(log_config.log_npc, "%s: %s\n", nd->name, message);
 	}
 }
 
@@ -419,29 +718,13 @@ void log_npc(map_session_data* sd, const char* message)
 
 	if( log_config.sql_logs )
 	{
-		SqlStmt stmt{ *logmysql_handle };
-
-		if( SQL_SUCCESS != stmt.Prepare(LOG_QUERY " INTO `%s` (`npc_date`, `account_id`, `char_id`, `char_name`, `map`, `mes`) VALUES (NOW(), '%d', '%d', ?, '%s', ?)", log_config.log_npc, sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex) )
-		||  SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, sd->status.name, strnlen(sd->status.name, NAME_LENGTH))
-		||  SQL_SUCCESS != stmt.BindParam(1, SQLDT_STRING, (char*)message, safestrnlen(message, 255))
-		||  SQL_SUCCESS != stmt.Execute() )
-		{
-			SqlStmt_ShowDebug(stmt);
-			return;
-		}
+		log_sql_insert(log_config.log_npc, "`npc_date`, `account_id`, `char_id`, `char_name`, `map`, `mes`",
+			{ std::string(sd->status.name, strnlen(sd->status.name, NAME_LENGTH)), std::string(message, safestrnlen(message, 255)) }, "'%d', '%d', ?, '%s', ?",
+			sd->status.account_id, sd->status.char_id, mapindex_id2name(sd->mapindex));
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_npc, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - %s[%d]: %s\n", timestring, sd->status.name, sd->status.account_id, message);
-		fclose(logfp);
+		log_file_write(log_config.log_npc, "%s[%d]: %s\n", sd->status.name, sd->status.account_id, message);
 	}
 }
 
@@ -464,29 +747,13 @@ void log_chat(e_log_chat_type type, int32 type_id, int32 src_charid, int32 src_a
 	}
 
 	if( log_config.sql_logs ) {
-		SqlStmt stmt{ *logmysql_handle };
-
-		if( SQL_SUCCESS != stmt.Prepare(LOG_QUERY " INTO `%s` (`time`, `type`, `type_id`, `src_charid`, `src_accountid`, `src_map`, `src_map_x`, `src_map_y`, `dst_charname`, `message`) VALUES (NOW(), '%c', '%d', '%d', '%d', '%s', '%d', '%d', ?, ?)", log_config.log_chat, log_chattype2char(type), type_id, src_charid, src_accid, mapname, x, y)
-		||  SQL_SUCCESS != stmt.BindParam(0, SQLDT_STRING, (char*)dst_charname, safestrnlen(dst_charname, NAME_LENGTH))
-		||  SQL_SUCCESS != stmt.BindParam(1, SQLDT_STRING, (char*)message, safestrnlen(message, CHAT_SIZE_MAX))
-		||  SQL_SUCCESS != stmt.Execute() )
-		{
-			SqlStmt_ShowDebug(stmt);
-			return;
-		}
+		log_sql_insert(log_config.log_chat, "`time`, `type`, `type_id`, `src_charid`, `src_accountid`, `src_map`, `src_map_x`, `src_map_y`, `dst_charname`, `message`",
+			{ std::string(dst_charname, safestrnlen(dst_charname, NAME_LENGTH)), std::string(message, safestrnlen(message, CHAT_SIZE_MAX)) }, "'%c', '%d', '%d', '%d', '%s', '%d', '%d', ?, ?",
+			log_chattype2char(type), type_id, src_charid, src_accid, mapname, x, y);
 	}
 	else
 	{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen(log_config.log_chat, "a") ) == nullptr )
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - %c,%d,%d,%d,%s,%d,%d,%s,%s\n", timestring, log_chattype2char(type), type_id, src_charid, src_accid, mapname, x, y, dst_charname, message);
-		fclose(logfp);
+		log_file_write(log_config.log_chat, "%c,%d,%d,%d,%s,%d,%d,%s,%s\n", log_chattype2char(type), type_id, src_charid, src_accid, mapname, x, y, dst_charname, message);
 	}
 }
 
@@ -498,23 +765,10 @@ void log_cash( map_session_data* sd, e_log_pick_type type, e_log_cash_type cash_
 		return;
 
 	if( log_config.sql_logs ){
-		if( SQL_ERROR == Sql_Query( logmysql_handle, LOG_QUERY " INTO `%s` ( `time`, `char_id`, `type`, `cash_type`, `amount`, `map` ) VALUES ( NOW(), '%d', '%c', '%c', '%d', '%s' )",
-			log_config.log_cash, sd->status.char_id, log_picktype2char( type ), log_cashtype2char( cash_type ), amount, mapindex_id2name( sd->mapindex ) ) )
-		{
-			Sql_ShowDebug( logmysql_handle );
-			return;
-		}
+		log_sql_insert( log_config.log_cash, "`time`, `char_id`, `type`, `cash_type`, `amount`, `map`", {}, "'%d', '%c', '%c', '%d', '%s'",
+			sd->status.char_id, log_picktype2char( type ), log_cashtype2char( cash_type ), amount, mapindex_id2name( sd->mapindex ) );
 	}else{
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if( ( logfp = fopen( log_config.log_cash, "a" ) ) == nullptr )
-			return;
-		time( &curtime );
-		strftime( timestring, sizeof( timestring ), log_timestamp_format, localtime( &curtime ) );
-		fprintf( logfp, "%s - %s[%d]\t%d(%c)\t\n", timestring, sd->status.name, sd->status.account_id, amount, log_cashtype2char( cash_type ) );
-		fclose( logfp );
+		log_file_write( log_config.log_cash, "%s[%d]\t%d(%c)\t\n", sd->status.name, sd->status.account_id, amount, log_cashtype2char( cash_type ) );
 	}
 }
 
@@ -551,23 +805,10 @@ void log_feeding(map_session_data *sd, e_log_feeding_type type, t_itemid nameid)
 	}
 
 	if (log_config.sql_logs) {
-		if (SQL_ERROR == Sql_Query(logmysql_handle, LOG_QUERY " INTO `%s` (`time`, `char_id`, `target_id`, `target_class`, `type`, `intimacy`, `item_id`, `map`, `x`, `y`) VALUES ( NOW(), '%" PRIu32 "', '%" PRIu32 "', '%hu', '%c', '%" PRIu32 "', '%u', '%s', '%hu', '%hu' )",
-			log_config.log_feeding, sd->status.char_id, target_id, target_class, log_feedingtype2char(type), intimacy, nameid, mapindex_id2name(sd->mapindex), sd->x, sd->y))
-		{
-			Sql_ShowDebug(logmysql_handle);
-			return;
-		}
+		log_sql_insert(log_config.log_feeding, "`time`, `char_id`, `target_id`, `target_class`, `type`, `intimacy`, `item_id`, `map`, `x`, `y`", {}, "'%" PRIu32 "', '%" PRIu32 "', '%hu', '%c', '%" PRIu32 "', '%u', '%s', '%hu', '%hu'",
+			sd->status.char_id, target_id, target_class, log_feedingtype2char(type), intimacy, nameid, mapindex_id2name(sd->mapindex), sd->x, sd->y);
 	} else {
-		char timestring[255];
-		time_t curtime;
-		FILE* logfp;
-
-		if ((logfp = fopen(log_config.log_feeding, "a")) == nullptr)
-			return;
-		time(&curtime);
-		strftime(timestring, sizeof(timestring), log_timestamp_format, localtime(&curtime));
-		fprintf(logfp, "%s - %s[%d]\t%d\t%d(%c)\t%d\t%u\t%s\t%hu,%hu\n", timestring, sd->status.name, sd->status.char_id, target_id, target_class, log_feedingtype2char(type), intimacy, nameid, mapindex_id2name(sd->mapindex), sd->x, sd->y);
-		fclose(logfp);
+		log_file_write(log_config.log_feeding, "%s[%d]\t%d\t%d(%c)\t%d\t%u\t%s\t%hu,%hu\n", sd->status.name, sd->status.char_id, target_id, target_class, log_feedingtype2char(type), intimacy, nameid, mapindex_id2name(sd->mapindex), sd->x, sd->y);
 	}
 }
 
@@ -581,6 +822,10 @@ void log_set_defaults(void)
 	log_config.price_items_log  = 1000; // 1000z
 	log_config.amount_items_log = 100;
 
+	log_config.flush_interval = 1000;
+	log_config.batch_rows = 100;
+	log_config.buffer_max = 10000;
+
 	safestrncpy(log_timestamp_format, "%m/%d/%Y %H:%M:%S", sizeof(log_timestamp_format));
 }
 
@@ -611,6 +856,12 @@ int32 log_config_read(const char* cfgName)
 				log_config.enable_logs = (e_log_pick_type)config_switch(w2);
 			else if( strcmpi(w1, "sql_logs") == 0 )
 				log_config.sql_logs = config_switch(w2) > 0;
+			else if( strcmpi(w1, "log_flush_interval") == 0 )
+				log_config.flush_interval = max(atoi(w2), 0);
+			else if( strcmpi(w1, "log_batch_rows") == 0 )
+				log_config.batch_rows = max(atoi(w2), 1);
+			else if( strcmpi(w1, "log_buffer_max") == 0 )
+				log_config.buffer_max = max(atoi(w2), 1);
 //start of common filter settings
 			else if( strcmpi(w1, "rare_items_log") == 0 )
 				log_config.rare_items_log = atoi(w2);
@@ -710,7 +961,45 @@ int32 log_config_read(const char* cfgName)
 		if( log_config.feeding ){
 			ShowInfo( "Logging Feeding items to %s '%s'.\n", target, log_config.log_feeding );
 		}
+
+		// Reloads change the interval
+		log_flush_timer_start();
 	}
 
 	return 0;
 }
+
+void do_init_log( void ){
+	add_timer_func_list( log_flush_timer, "log_flush_timer" );
+
+	log_writer_stopping = false;
+	log_writer = std::thread( log_writer_main, Sql_GetHandle( logwriter_handle ) );
+
+	log_flush_timer_start();
+}
+
+void do_final_log( void ){
+	log_flush();
+
+	{
+		std::lock_guard<std::mutex> lock( log_writer_mutex );
+
+		log_writer_stopping = true;
+	}
+
+	// The writer finishes the queued batches before it stops
+	log_writer_wakeup.notify_all();
+
+	if( log_writer.joinable() ){
+		log_writer.join();
+	}
+
+	log_report_dropped();
+	log_sql_batches.clear();
+	log_file_batches.clear();
+
+	if( log_flush_tid != INVALID_TIMER ){
+		delete_timer( log_flush_tid, log_flush_timer );
+		log_flush_tid = INVALID_TIMER;
+	}
+}
@@ -93,6 +93,10 @@ void log_mvpdrop(map_session_data* sd, int32 monster_id, t_itemid nameid, t_exp
 
 int32 log_config_read(const char* cfgName);
 
+void log_flush(void);
+void do_init_log(void);
+void do_final_log(void);
+
 extern struct Log_Config
 {
 	e_log_pick_type enable_logs;
@@ -101,6 +105,9 @@ extern struct Log_Config
 	bool log_chat_woe_disable;
 	bool cash;
 	int32 rare_items_log,refine_items_log,price_items_log,amount_items_log; //for filter
+	uint32 flush_interval; ///< Milliseconds between writes of buffered entries, 0 writes every entry immediately
+	size_t batch_rows; ///< Entries per table/file that force a write
+	size_t buffer_max; ///< Entries buffered in total, new entries are dropped beyond it
 	int32 branch, mvpdrop, zeny, commands, npc, chat;
 	unsigned feeding : 2;
 	char log_branch[64], log_pick[64], log_zeny[64], log_mvpdrop[64], log_gm[64], log_npc[64], log_chat[64], log_cash[64];
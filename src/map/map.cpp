@@ -14,7 +14,10 @@
 #include <common/ers.hpp>
 #include <common/grfio.hpp>
 #include <common/malloc.hpp>
+#include <common/metrics.hpp>
 #include <common/nullpo.hpp>
+#include <common/packet_stats.hpp>
+#include <common/profiler.hpp>
 #include <common/random.hpp>
 #include <common/showmsg.hpp>
 #include <common/socket.hpp> // WFIFO*()
@@ -50,6 +53,7 @@
 #include "pc.hpp"
 #include "pet.hpp"
 #include "quest.hpp"
+#include "simulator.hpp"
 #include "storage.hpp"
 #include "trade.hpp"
 
@@ -65,6 +69,7 @@ std::string map_server_pw = "";
 std::string map_server_db = "ragnarok";
 Sql* mmysql_handle;
 Sql* qsmysql_handle; /// For query_sql
+Sql* mapregwriter_handle; ///< Connection of the thread that writes the permanent server variables
 
 int32 db_use_sqldbs = 0;
 char barter_table[32] = "barter";
@@ -92,6 +97,7 @@ char market_table[32] = "market";
 char partybookings_table[32] = "party_bookings";
 char roulette_table[32] = "db_roulette";
 char guild_storage_log_table[32] = "guild_storage_log";
+char packet_stats_table[32] = "packet_stats";
 
 // log database
 std::string log_db_ip = "127.0.0.1";
@@ -100,6 +106,7 @@ std::string log_db_id = "ragnarok";
 std::string log_db_pw = "";
 std::string log_db_db = "log";
 Sql* logmysql_handle;
+Sql* logwriter_handle; ///< Connection of the thread that writes the logs
 
 // inter config
 struct inter_conf inter_config {};
@@ -117,7 +124,6 @@ static DBMap* map_msg_db=nullptr;
 
 static int32 map_users=0;
 
-#define BLOCK_SIZE 8
 #define block_free_max 1048576
 block_list *block_free[block_free_max];
 static int32 block_free_count = 0, block_free_lock = 0;
@@ -345,6 +351,69 @@ TIMER_FUNC(map_freeblock_timer){
 	return 0;
 }
 
+static int32 map_profiler_tid = INVALID_TIMER;
+
+/// Prints the timer functions and packet handlers that took the most time so far
+static TIMER_FUNC(map_profiler_timer){
+	if( !profiler_enabled ){
+		return 0;
+	}
+
+	for( e_profile_group group : { PROFILE_TIMER, PROFILE_PACKET } ){
+		std::vector<std::string> lines;
+
+		profiler_report( group, 10, lines );
+
+		if( lines.empty() ){
+			continue;
+		}
+
+		ShowInfo( "Tick profiler, top %s:\n", ( group == PROFILE_TIMER ? "timer functions" : "packet handlers" ) );
+
+		for( const std::string& line : lines ){
+			ShowMessage( "\t%s\n", line.c_str() );
+		}
+	}
+
+	return 0;
+}
+
+/// Restarts the report timer of the tick profiler with the configured interval
+void map_profiler_schedule(void){
+	if( map_profiler_tid != INVALID_TIMER ){
+		delete_timer( map_profiler_tid, map_profiler_timer );
+		map_profiler_tid = INVALID_TIMER;
+	}
+
+	if( battle_config.tick_profiler_interval > 0 ){
+		map_profiler_tid = add_timer_interval( gettick() + battle_config.tick_profiler_interval * 1000, map_profiler_timer, 0, 0, battle_config.tick_profiler_interval * 1000 );
+	}
+}
+
+static Metric metric_online_users( "rathena_online_users", "Players that are online", METRIC_GAUGE );
+
+/// Writes the metrics of the map-server for the web-server
+static TIMER_FUNC(map_metrics_timer){
+	char server[32];
+
+	metric_online_users.set( map_usercount() );
+
+	safesnprintf( server, sizeof( server ), "map-server:%hu", clif_getport() );
+	metrics_save( mmysql_handle, server );
+
+	return 0;
+}
+
+/// Writes the packet statistics of the map-server for the web-server
+static TIMER_FUNC(map_packet_stats_timer){
+	char server[32];
+
+	safesnprintf( server, sizeof( server ), "map-server:%hu", clif_getport() );
+	packet_stats_save( mmysql_handle, packet_stats_table, server );
+
+	return 0;
+}
+
 FreeBlockLock::FreeBlockLock(bool startLocked) {
 	if (startLocked) {
 		lock();
@@ -465,6 +534,11 @@ int32 map_addblock(block_list* bl)
 	map_addblcell(bl);
 #endif
 
+	if (bl->type == BL_PC) {
+		party_send_xy_mark(*(TBL_PC*)bl);
+		guild_send_xy_mark(*(TBL_PC*)bl);
+	}
+
 	return 0;
 }
 
@@ -577,6 +651,11 @@ int32 map_moveblock(block_list *bl, int32 x1, int32 y1, t_tick tick)
 	else map_addblcell(bl);
 #endif
 
+	if (bl->type == BL_PC) {
+		party_send_xy_mark(*(TBL_PC*)bl);
+		guild_send_xy_mark(*(TBL_PC*)bl);
+	}
+
 	if (bl->type&BL_CHAR) {
 
 		skill_unit_move(bl,tick,3);
@@ -2876,6 +2955,7 @@ int32 map_addinstancemap(int32 src_m, int32 instance_id, bool no_mapflag)
 	dst_map->npc_num = 0;
 	dst_map->npc_num_area = 0;
 	dst_map->npc_num_warp = 0;
+	dst_map->npc_touch.clear();
 
 	// Reallocate cells
 	size_t num_cell = dst_map->xs * dst_map->ys;
@@ -2982,6 +3062,7 @@ int32 map_delinstancemap(int32 m)
 	mapdata->damage_adjust = {};
 	mapdata->initMapFlags();
 	mapdata->skill_damage.clear();
+	mapdata->npc_touch.clear();
 	mapdata->instance_id = 0;
 
 	mapindex_removemap(mapdata->index);
@@ -4209,10 +4290,8 @@ int32 map_config_read(const char *cfgName)
 			enable_spy = config_switch(w2);
 		else if (strcmpi(w1, "use_grf") == 0)
 			enable_grf = config_switch(w2);
-		else if (strcmpi(w1, "console_msg_log") == 0)
-			console_msg_log = atoi(w2);//[Ind]
-		else if (strcmpi(w1, "console_log_filepath") == 0)
-			safestrncpy(console_log_filepath, w2, sizeof(console_log_filepath));
+		else if (showmsg_config_read(w1, w2))
+			continue;
 		else if (strcmpi(w1, "import") == 0)
 			map_config_read(w2);
 		else
@@ -4338,6 +4417,8 @@ int32 inter_config_read(const char *cfgName)
 			safestrncpy(sales_table, w2, sizeof(sales_table));
 		else if (strcmpi(w1, "guild_storage_log") == 0)
 			safestrncpy(guild_storage_log_table, w2, sizeof(guild_storage_log_table));
+		else if (strcmpi(w1, "packet_stats_table") == 0)
+			safestrncpy(packet_stats_table, w2, sizeof(packet_stats_table));
 		else
 		//Map Server SQL DB
 		if(strcmpi(w1,"map_server_ip")==0)
@@ -4388,8 +4469,13 @@ int32 inter_config_read(const char *cfgName)
 			val = cap_value(val, 0, 100);
 			inter_config.emblem_transparency_limit = val;
 		}
+		else
+		if(strcmpi(w1,"packet_stats_interval")==0)
+			inter_config.packet_stats_interval = atoi(w2);
 		if( mapreg_config_read(w1,w2) )
 			continue;
+		if( metrics_config_read(w1,w2) )
+			continue;
 		//support the import command, just like any other config
 		else
 		if(strcmpi(w1,"import")==0)
@@ -4408,10 +4494,12 @@ int32 map_sql_init(void)
 	// main db connection
 	mmysql_handle = Sql_Malloc();
 	qsmysql_handle = Sql_Malloc();
+	mapregwriter_handle = Sql_Malloc();
 
 	ShowInfo("Connecting to the Map DB Server....\n");
 	if( SQL_ERROR == Sql_Connect(mmysql_handle, map_server_id.c_str(), map_server_pw.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str()) ||
-		SQL_ERROR == Sql_Connect(qsmysql_handle, map_server_id.c_str(), map_server_pw.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str()) )
+		SQL_ERROR == Sql_Connect(qsmysql_handle, map_server_id.c_str(), map_server_pw.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str()) ||
+		SQL_ERROR == Sql_Connect(mapregwriter_handle, map_server_id.c_str(), map_server_pw.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str()) )
 	{
 		ShowError("Couldn't connect with uname='%s',host='%s',port='%d',database='%s'\n",
 			map_server_id.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str());
@@ -4419,15 +4507,22 @@ int32 map_sql_init(void)
 		Sql_Free(mmysql_handle);
 		Sql_ShowDebug(qsmysql_handle);
 		Sql_Free(qsmysql_handle);
+		Sql_ShowDebug(mapregwriter_handle);
+		Sql_Free(mapregwriter_handle);
 		exit(EXIT_FAILURE);
 	}
 	ShowStatus("Connect success! (Map Server Connection)\n");
 
+	// connection of the mapreg writer thread, which reconnects by itself, the keepalive timer runs on the main thread
+	Sql_DisableKeepalive(mapregwriter_handle);
+
 	if( !default_codepage.empty() ) {
 		if ( SQL_ERROR == Sql_SetEncoding(mmysql_handle, default_codepage.c_str()) )
 			Sql_ShowDebug(mmysql_handle);
 		if ( SQL_ERROR == Sql_SetEncoding(qsmysql_handle, default_codepage.c_str()) )
 			Sql_ShowDebug(qsmysql_handle);
+		if ( SQL_ERROR == Sql_SetEncoding(mapregwriter_handle, default_codepage.c_str()) )
+			Sql_ShowDebug(mapregwriter_handle);
 	}
 	return 0;
 }
@@ -4437,37 +4532,55 @@ int32 map_sql_close(void)
 	ShowStatus("Close Map DB Connection....\n");
 	Sql_Free(mmysql_handle);
 	Sql_Free(qsmysql_handle);
+	Sql_Free(mapregwriter_handle);
 	mmysql_handle = nullptr;
 	qsmysql_handle = nullptr;
+	mapregwriter_handle = nullptr;
 
 	if (log_config.sql_logs)
 	{
 		ShowStatus("Close Log DB Connection....\n");
 		Sql_Free(logmysql_handle);
+		Sql_Free(logwriter_handle);
 		logmysql_handle = nullptr;
+		logwriter_handle = nullptr;
 	}
 
 	return 0;
 }
 
-int32 log_sql_init(void)
+/// Opens a connection to the log database, exits the server if it fails
+static Sql* log_sql_connect(void)
 {
-	// log db connection
-	logmysql_handle = Sql_Malloc();
+	Sql* handle = Sql_Malloc();
 
-	ShowInfo("" CL_WHITE "[SQL]" CL_RESET ": Connecting to the Log Database " CL_WHITE "%s" CL_RESET " At " CL_WHITE "%s" CL_RESET "...\n",log_db_db.c_str(), log_db_ip.c_str());
-	if ( SQL_ERROR == Sql_Connect(logmysql_handle, log_db_id.c_str(), log_db_pw.c_str(), log_db_ip.c_str(), log_db_port, log_db_db.c_str()) ){
+	if ( SQL_ERROR == Sql_Connect(handle, log_db_id.c_str(), log_db_pw.c_str(), log_db_ip.c_str(), log_db_port, log_db_db.c_str()) ){
 		ShowError("Couldn't connect with uname='%s',host='%s',port='%hu',database='%s'\n",
 			log_db_id.c_str(), log_db_ip.c_str(), log_db_port, log_db_db.c_str());
-		Sql_ShowDebug(logmysql_handle);
-		Sql_Free(logmysql_handle);
+		Sql_ShowDebug(handle);
+		Sql_Free(handle);
 		exit(EXIT_FAILURE);
 	}
-	ShowStatus("" CL_WHITE "[SQL]" CL_RESET ": Successfully '" CL_GREEN "connected" CL_RESET "' to Database '" CL_WHITE "%s" CL_RESET "'.\n", log_db_db.c_str());
 
 	if( !default_codepage.empty() )
-		if ( SQL_ERROR == Sql_SetEncoding(logmysql_handle, default_codepage.c_str()) )
-			Sql_ShowDebug(logmysql_handle);
+		if ( SQL_ERROR == Sql_SetEncoding(handle, default_codepage.c_str()) )
+			Sql_ShowDebug(handle);
+
+	return handle;
+}
+
+int32 log_sql_init(void)
+{
+	ShowInfo("" CL_WHITE "[SQL]" CL_RESET ": Connecting to the Log Database " CL_WHITE "%s" CL_RESET " At " CL_WHITE "%s" CL_RESET "...\n",log_db_db.c_str(), log_db_ip.c_str());
+
+	// log db connection, used by the main thread for example by query_logsql
+	logmysql_handle = log_sql_connect();
+
+	// connection of the log writer thread, which reconnects by itself, the keepalive timer runs on the main thread
+	logwriter_handle = log_sql_connect();
+	Sql_DisableKeepalive(logwriter_handle);
+
+	ShowStatus("" CL_WHITE "[SQL]" CL_RESET ": Successfully '" CL_GREEN "connected" CL_RESET "' to Database '" CL_WHITE "%s" CL_RESET "'.\n", log_db_db.c_str());
 
 	return 0;
 }
@@ -5113,6 +5226,7 @@ void MapServer::finalize(){
 	iwall_db->destroy(iwall_db, nullptr);
 	regen_db->destroy(regen_db, nullptr);
 
+	do_final_log();
 	map_sql_close();
 
 	ShowStatus("Finished.\n");
@@ -5358,9 +5472,13 @@ bool MapServer::initialize( int32 argc, char *argv[] ){
 	inter_config.start_status_points = 48;
 	inter_config.emblem_woe_change = true;
 	inter_config.emblem_transparency_limit = 80;
+	inter_config.packet_stats_interval = 0;
 
 #ifdef MAP_GENERATOR
 	mapgenerator_get_options(argc, argv);
+#endif
+#ifdef MAP_SIMULATOR
+	simulator_get_options(argc, argv);
 #endif
 	cli_get_options(argc,argv);
 
@@ -5413,6 +5531,7 @@ bool MapServer::initialize( int32 argc, char *argv[] ){
 	map_sql_init();
 	if (log_config.sql_logs)
 		log_sql_init();
+	do_init_log();
 
 	mapindex_init();
 	if(enable_grf)
@@ -5424,6 +5543,21 @@ bool MapServer::initialize( int32 argc, char *argv[] ){
 	add_timer_func_list(map_clearflooritem_timer, "map_clearflooritem_timer");
 	add_timer_func_list(map_removemobs_timer, "map_removemobs_timer");
 	add_timer_interval(gettick()+1000, map_freeblock_timer, 0, 0, 60*1000);
+	add_timer_func_list(map_profiler_timer, "map_profiler_timer");
+	profiler_enabled = battle_config.tick_profiler != 0;
+	map_profiler_schedule();
+
+	add_timer_func_list(map_packet_stats_timer, "map_packet_stats_timer");
+
+	if( inter_config.packet_stats_interval > 0 ){
+		add_timer_interval( gettick() + 1000, map_packet_stats_timer, 0, 0, inter_config.packet_stats_interval * 1000 );
+	}
+
+	add_timer_func_list(map_metrics_timer, "map_metrics_timer");
+
+	if( metrics_interval > 0 ){
+		add_timer_interval( gettick() + 1000, map_metrics_timer, 0, 0, metrics_interval * 1000 );
+	}
 	
 	map_do_init_msg();
 	do_init_path();
@@ -5464,9 +5598,7 @@ bool MapServer::initialize( int32 argc, char *argv[] ){
 	if (battle_config.pk_mode)
 		ShowNotice("Server is running on '" CL_WHITE "PK Mode" CL_RESET "'.\n");
 
-#ifndef MAP_GENERATOR
-	ShowStatus("Server is '" CL_GREEN "ready" CL_RESET "' and listening on port '" CL_WHITE "%d" CL_RESET "'.\n\n", map_port);
-#else
+#if defined(MAP_GENERATOR)
 	// depending on gen_options, generate the correct things
 	if (gen_options.navi)
 		navi_create_lists();
@@ -5475,6 +5607,11 @@ bool MapServer::initialize( int32 argc, char *argv[] ){
 	if (gen_options.reputation)
 		pc_reputation_generate();
 	this->signal_shutdown();
+#elif defined(MAP_SIMULATOR)
+	simulator_run();
+	this->signal_shutdown();
+#else
+	ShowStatus("Server is '" CL_GREEN "ready" CL_RESET "' and listening on port '" CL_WHITE "%d" CL_RESET "'.\n\n", map_port);
 #endif
 
 	if( console ){ //start listening
@@ -63,6 +63,7 @@ void map_do_final_msg(void);
 void map_msg_reload(void);
 
 #define MAX_NPC_PER_MAP 512
+#define BLOCK_SIZE 8 // size of the blocks a map is divided into, in cells
 #define AREA_SIZE battle_config.area_size
 #ifndef DAMAGELOG_SIZE 
 	#define DAMAGELOG_SIZE 20
@@ -840,6 +841,7 @@ struct map_data {
 	std::unordered_map<uint16, int32> skill_duration;
 
 	npc_data *npc[MAX_NPC_PER_MAP];
+	std::unordered_map<int32, std::vector<npc_data*>> npc_touch; // npc with a trigger area by the blocks it covers, warps first
 	struct spawn_data *moblist[MAX_MOB_LIST_PER_MAP]; // [Wizputer]
 	int32 mob_delete_timer;	// Timer ID for map_removemobs_timer [Skotlex]
 	t_tick last_macrocheck;
@@ -899,6 +901,7 @@ struct inter_conf {
 	uint32 start_status_points;
 	bool emblem_woe_change;
 	uint32 emblem_transparency_limit;
+	int32 packet_stats_interval; // seconds
 };
 
 extern struct inter_conf inter_config;
@@ -1173,6 +1176,7 @@ bool map_addnpc(int16 m,npc_data *);
 // map item
 TIMER_FUNC(map_clearflooritem_timer);
 TIMER_FUNC(map_removemobs_timer);
+void map_profiler_schedule(void);
 void map_clearflooritem(block_list* bl);
 int32 map_addflooritem(struct item *item, int32 amount, int16 m, int16 x, int16 y, int32 first_charid, int32 second_charid, int32 third_charid, int32 flags, uint16 mob_id, bool canShowEffect = false, enum directions dir = DIR_MAX, int32 type = BL_NUL);
 
@@ -1319,7 +1323,9 @@ extern int32 db_use_sqldbs;
 
 extern Sql* mmysql_handle;
 extern Sql* qsmysql_handle;
+extern Sql* mapregwriter_handle;
 extern Sql* logmysql_handle;
+extern Sql* logwriter_handle;
 #endif
 
 extern char barter_table[32];
@@ -1337,6 +1343,7 @@ extern char market_table[32];
 extern char partybookings_table[32];
 extern char roulette_table[32];
 extern char guild_storage_log_table[32];
+extern char packet_stats_table[32];
 
 void do_shutdown(void);
 
@@ -3,7 +3,14 @@
 
 #include "mapreg.hpp"
 
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include <common/cbasetypes.hpp>
 #include <common/db.hpp>
@@ -14,7 +21,7 @@
 #include <common/strlib.hpp>
 #include <common/timer.hpp>
 
-#include "map.hpp" // mmysql_handle
+#include "map.hpp" // mmysql_handle, mapregwriter_handle
 #include "script.hpp"
 
 static struct eri *mapreg_ers;
@@ -22,10 +29,162 @@ static struct eri *mapreg_ers;
 bool skip_insert = false;
 
 static char mapreg_table[32] = "mapreg";
-static bool mapreg_dirty = false; // Whether there are modified regs to be saved
+static std::unordered_set<int64> mapreg_dirty; // UIDs of modified regs to be saved
 struct reg_db regs;
 
 #define MAPREG_AUTOSAVE_INTERVAL (300*1000)
+#define MAPREG_SAVE_BATCH 500 // Maximum rows written by a single query
+
+/// Statements for the mapreg writer
+struct s_mapreg_job {
+	std::vector<std::string> queries; ///< Run in a single transaction if there are several
+	std::vector<int64> uids; ///< Written variables, they are marked as modified again if the job fails
+};
+
+// The permanent variables are written by a thread with its own connection, so the main thread does not wait for the database.
+// Inserts, deletes and saves share one queue, so they reach the database in the order they were made.
+// The writer only uses the MySQL client library and the standard library.
+static std::thread mapreg_writer;
+static std::mutex mapreg_writer_mutex;
+static std::condition_variable mapreg_writer_wakeup; // jobs were queued or the server shuts down
+static std::condition_variable mapreg_writer_idle; // all queued jobs were written
+static std::deque<s_mapreg_job> mapreg_writer_jobs;
+static bool mapreg_writer_busy = false;
+static bool mapreg_writer_stopping = false;
+static std::vector<int64> mapreg_writer_failed; // variables of failed jobs
+static size_t mapreg_writer_errors = 0; // failed jobs since the last report
+static std::string mapreg_writer_error; // last error of the writer
+
+/// Runs the queries of a job, called by the writer
+/// @return true if all queries succeeded
+static bool mapreg_writer_run( MYSQL* mysql, const s_mapreg_job& job, std::string& error ){
+	if( mysql == nullptr ){
+		error = "no connection to the map database";
+		return false;
+	}
+
+	bool transaction = job.queries.size() > 1;
+
+	// Without a transaction a failed batch would leave the others written, keep everything for the next save instead
+	if( transaction && mysql_query( mysql, "START TRANSACTION" ) != 0 ){
+		error = mysql_error( mysql );
+		return false;
+	}
+
+	for( const std::string& query : job.queries ){
+		if( mysql_real_query( mysql, query.data(), static_cast<unsigned long>( query.size() ) ) != 0 ){
+			error = mysql_error( mysql );
+
+			if( transaction ){
+				mysql_query( mysql, "ROLLBACK" );
+			}
+
+			return false;
+		}
+	}
+
+	if( transaction && mysql_query( mysql, "COMMIT" ) != 0 ){
+		error = mysql_error( mysql );
+		mysql_query( mysql, "ROLLBACK" );
+		return false;
+	}
+
+	return true;
+}
+
+/// Writes the queued jobs until the server shuts down
+static void mapreg_writer_main( MYSQL* mysql ){
+	mysql_thread_init();
+
+	std::unique_lock<std::mutex> lock( mapreg_writer_mutex );
+
+	while( true ){
+		mapreg_writer_wakeup.wait( lock, [](){
+			return mapreg_writer_stopping || !mapreg_writer_jobs.empty();
+		} );
+
+		if( mapreg_writer_jobs.empty() ){
+			// Stopping and everything was written
+			break;
+		}
+
+		s_mapreg_job job = std::move( mapreg_writer_jobs.front() );
+		std::string error;
+
+		mapreg_writer_jobs.pop_front();
+		mapreg_writer_busy = true;
+		lock.unlock();
+
+		bool written = mapreg_writer_run( mysql, job, error );
+
+		lock.lock();
+		mapreg_writer_busy = false;
+
+		if( !written ){
+			mapreg_writer_errors++;
+			mapreg_writer_error = error;
+			mapreg_writer_failed.insert( mapreg_writer_failed.end(), job.uids.begin(), job.uids.end() );
+		}
+
+		if( mapreg_writer_jobs.empty() ){
+			mapreg_writer_idle.notify_all();
+		}
+	}
+
+	lock.unlock();
+	mysql_thread_end();
+}
+
+/// Hands a job to the writer
+static void mapreg_writer_queue( s_mapreg_job&& job ){
+	{
+		std::lock_guard<std::mutex> lock( mapreg_writer_mutex );
+
+		mapreg_writer_jobs.push_back( std::move( job ) );
+	}
+
+	mapreg_writer_wakeup.notify_one();
+}
+
+/// Hands a single statement for a variable to the writer
+/// @param uid: variable to save again if the statement fails, 0 for none
+static void mapreg_writer_queue( std::string&& query, int64 uid ){
+	s_mapreg_job job;
+
+	job.queries.push_back( std::move( query ) );
+
+	if( uid != 0 ){
+		job.uids.push_back( uid );
+	}
+
+	mapreg_writer_queue( std::move( job ) );
+}
+
+/// Marks the variables of failed jobs as modified again, so the next save retries them, and reports the failures
+static void mapreg_writer_collect( void ){
+	std::lock_guard<std::mutex> lock( mapreg_writer_mutex );
+
+	for( int64 uid : mapreg_writer_failed ){
+		// Deleted variables are skipped by the save
+		mapreg_dirty.insert( uid );
+	}
+
+	if( mapreg_writer_errors > 0 ){
+		ShowError( "mapreg: %" PRIuPTR " writes of permanent server variables failed, retrying %" PRIuPTR " variables on the next save. Last error: %s\n", mapreg_writer_errors, mapreg_writer_failed.size(), mapreg_writer_error.c_str() );
+		mapreg_writer_errors = 0;
+	}
+
+	mapreg_writer_failed.clear();
+}
+
+/// Waits until the writer wrote everything that was queued
+static void mapreg_writer_wait( void ){
+	std::unique_lock<std::mutex> lock( mapreg_writer_mutex );
+
+	mapreg_writer_idle.wait( lock, [](){
+		return mapreg_writer_jobs.empty() && !mapreg_writer_busy;
+	} );
+}
 
 
 /**
@@ -69,10 +228,8 @@ bool mapreg_setreg(int64 uid, int64 val)
 	if (val != 0) {
 		if ((m = static_cast<mapreg_save *>(i64db_get(regs.vars, uid)))) {
 			m->u.i = val;
-			if (name[1] != '@') {
-				m->save = true;
-				mapreg_dirty = true;
-			}
+			if (name[1] != '@')
+				mapreg_dirty.insert(uid);
 		} else {
 			if (i)
 				script_array_update(&regs, uid, false);
@@ -81,14 +238,12 @@ bool mapreg_setreg(int64 uid, int64 val)
 
 			m->u.i = val;
 			m->uid = uid;
-			m->save = false;
 			m->is_string = false;
 
 			if (name[1] != '@' && !skip_insert) {// write new variable to database
 				char esc_name[32 * 2 + 1];
 				Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
-				if (SQL_ERROR == Sql_Query(mmysql_handle, "INSERT INTO `%s`(`varname`,`index`,`value`) VALUES ('%s','%" PRIu32 "','%" PRId64 "')", mapreg_table, esc_name, i, val))
-					Sql_ShowDebug(mmysql_handle);
+				mapreg_writer_queue("INSERT INTO `" + std::string(mapreg_table) + "`(`varname`,`index`,`value`) VALUES ('" + esc_name + "','" + std::to_string(i) + "','" + std::to_string(val) + "')", uid);
 			}
 			i64db_put(regs.vars, uid, m);
 		}
@@ -99,12 +254,12 @@ bool mapreg_setreg(int64 uid, int64 val)
 			ers_free(mapreg_ers, m);
 		}
 		i64db_remove(regs.vars, uid);
+		mapreg_dirty.erase(uid);
 
 		if (name[1] != '@') {// Remove from database because it is unused.
 			char esc_name[32 * 2 + 1];
 			Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
-			if (SQL_ERROR == Sql_Query(mmysql_handle, "DELETE FROM `%s` WHERE `varname`='%s' AND `index`='%" PRIu32 "'", mapreg_table, esc_name, i))
-				Sql_ShowDebug(mmysql_handle);
+			mapreg_writer_queue("DELETE FROM `" + std::string(mapreg_table) + "` WHERE `varname`='" + esc_name + "' AND `index`='" + std::to_string(i) + "'", 0);
 		}
 	}
 
@@ -131,8 +286,7 @@ bool mapreg_setregstr(int64 uid, const char* str)
 		if (name[1] != '@') {
 			char esc_name[32 * 2 + 1];
 			Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
-			if (SQL_ERROR == Sql_Query(mmysql_handle, "DELETE FROM `%s` WHERE `varname`='%s' AND `index`='%" PRIu32 "'", mapreg_table, esc_name, i))
-				Sql_ShowDebug(mmysql_handle);
+			mapreg_writer_queue("DELETE FROM `" + std::string(mapreg_table) + "` WHERE `varname`='" + esc_name + "' AND `index`='" + std::to_string(i) + "'", 0);
 		}
 		if ((m = static_cast<mapreg_save *>(i64db_get(regs.vars, uid)))) {
 			if (m->u.str != nullptr)
@@ -140,15 +294,14 @@ bool mapreg_setregstr(int64 uid, const char* str)
 			ers_free(mapreg_ers, m);
 		}
 		i64db_remove(regs.vars, uid);
+		mapreg_dirty.erase(uid);
 	} else {
 		if ((m = static_cast<mapreg_save *>(i64db_get(regs.vars, uid)))) {
 			if (m->u.str != nullptr)
 				aFree(m->u.str);
 			m->u.str = aStrdup(str);
-			if (name[1] != '@') {
-				mapreg_dirty = true;
-				m->save = true;
-			}
+			if (name[1] != '@')
+				mapreg_dirty.insert(uid);
 		} else {
 			if (i)
 				script_array_update(&regs, uid, false);
@@ -157,7 +310,6 @@ bool mapreg_setregstr(int64 uid, const char* str)
 
 			m->uid = uid;
 			m->u.str = aStrdup(str);
-			m->save = false;
 			m->is_string = true;
 
 			if (name[1] != '@' && !skip_insert) { //put returned null, so we must insert.
@@ -165,8 +317,7 @@ bool mapreg_setregstr(int64 uid, const char* str)
 				char esc_str[255 * 2 + 1];
 				Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
 				Sql_EscapeStringLen(mmysql_handle, esc_str, str, strnlen(str, 255));
-				if (SQL_ERROR == Sql_Query(mmysql_handle, "INSERT INTO `%s`(`varname`,`index`,`value`) VALUES ('%s','%" PRIu32 "','%s')", mapreg_table, esc_name, i, esc_str))
-					Sql_ShowDebug(mmysql_handle);
+				mapreg_writer_queue("INSERT INTO `" + std::string(mapreg_table) + "`(`varname`,`index`,`value`) VALUES ('" + esc_name + "','" + std::to_string(i) + "','" + esc_str + "')", uid);
 			}
 			i64db_put(regs.vars, uid, m);
 		}
@@ -221,41 +372,66 @@ static void script_load_mapreg(void)
 	}
 
 	skip_insert = false;
-	mapreg_dirty = false;
+	mapreg_dirty.clear();
 }
 
 /**
  * Saves permanent variables to database.
+ * Only the variables modified since the last save are handed to the writer,
+ * in batches of MAPREG_SAVE_BATCH rows within a single transaction.
+ * If the transaction fails, the variables are saved again by the next save.
  */
 static void script_save_mapreg(void)
 {
-	if (mapreg_dirty) {
-		DBIterator *iter = db_iterator(regs.vars);
-		struct mapreg_save *m;
-		for (m = static_cast<mapreg_save *>(dbi_first(iter)); dbi_exists(iter); m = static_cast<mapreg_save *>(dbi_next(iter))) {
-			if (m->save) {
-				int32 num = script_getvarid(m->uid);
-				uint32 i = script_getvaridx(m->uid);
-				const char* name = get_str(num);
-				if (!m->is_string) {
-					char esc_name[32 * 2 + 1];
-					Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
-					if (SQL_ERROR == Sql_Query(mmysql_handle, "UPDATE `%s` SET `value`='%" PRId64 "' WHERE `varname`='%s' AND `index`='%" PRIu32 "' LIMIT 1", mapreg_table, m->u.i, esc_name, i))
-						Sql_ShowDebug(mmysql_handle);
-				} else {
-					char esc_str[2 * 255 + 1];
-					char esc_name[32 * 2 + 1];
-					Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
-					Sql_EscapeStringLen(mmysql_handle, esc_str, m->u.str, safestrnlen(m->u.str, 255));
-					if (SQL_ERROR == Sql_Query(mmysql_handle, "UPDATE `%s` SET `value`='%s' WHERE `varname`='%s' AND `index`='%" PRIu32 "' LIMIT 1", mapreg_table, esc_str, esc_name, i))
-						Sql_ShowDebug(mmysql_handle);
-				}
-				m->save = false;
-			}
+	mapreg_writer_collect();
+
+	if (mapreg_dirty.empty())
+		return;
+
+	s_mapreg_job job;
+	std::string query;
+	size_t rows = 0;
+
+	for (int64 uid : mapreg_dirty) {
+		struct mapreg_save *m = (struct mapreg_save *)i64db_get(regs.vars, uid);
+
+		if (m == nullptr)
+			continue;
+
+		const char* name = get_str(script_getvarid(uid));
+		char esc_name[32 * 2 + 1];
+		char esc_str[2 * 255 + 1];
+
+		Sql_EscapeStringLen(mmysql_handle, esc_name, name, strnlen(name, 32));
+		if (m->is_string)
+			Sql_EscapeStringLen(mmysql_handle, esc_str, m->u.str, safestrnlen(m->u.str, 255));
+		else
+			safesnprintf(esc_str, sizeof(esc_str), "%" PRId64, m->u.i);
+
+		if (query.empty())
+			query = "INSERT INTO `" + std::string(mapreg_table) + "`(`varname`,`index`,`value`) VALUES ";
+		else
+			query += ',';
+		query += "('" + std::string(esc_name) + "','" + std::to_string(script_getvaridx(uid)) + "','" + esc_str + "')";
+		job.uids.push_back(uid);
+
+		if (++rows == MAPREG_SAVE_BATCH) {
+			job.queries.push_back(query + " ON DUPLICATE KEY UPDATE `value`=VALUES(`value`)");
+			query.clear();
+			rows = 0;
 		}
-		dbi_destroy(iter);
-		mapreg_dirty = false;
 	}
+
+	if (!query.empty())
+		job.queries.push_back(query + " ON DUPLICATE KEY UPDATE `value`=VALUES(`value`)");
+
+	mapreg_dirty.clear();
+
+	if (job.uids.empty())
+		return;
+
+	ShowDebug("Saving " CL_WHITE "%" PRIuPTR CL_RESET " permanent server variables.\n", job.uids.size());
+	mapreg_writer_queue(std::move(job));
 }
 
 /**
@@ -298,8 +474,12 @@ int32 mapreg_destroyreg(DBKey key, DBData *data, va_list ap)
 void mapreg_reload(void)
 {
 	script_save_mapreg();
+	// The variables are read back from the database
+	mapreg_writer_wait();
+	mapreg_writer_collect();
 
 	regs.vars->clear(regs.vars, mapreg_destroyreg);
+	mapreg_dirty.clear();
 
 	if (regs.arrays) {
 		regs.arrays->destroy(regs.arrays, script_free_array_db);
@@ -316,6 +496,23 @@ void mapreg_final(void)
 {
 	script_save_mapreg();
 
+	{
+		std::lock_guard<std::mutex> lock( mapreg_writer_mutex );
+
+		mapreg_writer_stopping = true;
+	}
+
+	// The writer finishes the queued jobs before it stops
+	mapreg_writer_wakeup.notify_all();
+
+	if( mapreg_writer.joinable() ){
+		mapreg_writer.join();
+	}
+
+	// Nothing retries them anymore, only report them
+	mapreg_writer_collect();
+	mapreg_dirty.clear();
+
 	regs.vars->destroy(regs.vars, mapreg_destroyreg);
 
 	ers_destroy(mapreg_ers);
@@ -337,6 +534,9 @@ void mapreg_init(void)
 
 	script_load_mapreg();
 
+	mapreg_writer_stopping = false;
+	mapreg_writer = std::thread( mapreg_writer_main, Sql_GetHandle( mapregwriter_handle ) );
+
 	add_timer_func_list(script_autosave_mapreg, "script_autosave_mapreg");
 	add_timer_interval(gettick() + MAPREG_AUTOSAVE_INTERVAL, script_autosave_mapreg, 0, 0, MAPREG_AUTOSAVE_INTERVAL);
 }
@@ -1693,8 +1693,8 @@ int32 mob_randomwalk(mob_data *md,t_tick tick)
 	md->ud.state.attack_continue = 0;
 	md->ud.target_to = 0;
 
-	r=rnd();
-	rdir=rnd()%4; // Randomize direction in which we iterate to prevent monster cluttering up in one corner
+	r=rnd(RND_STREAM_AI);
+	rdir=rnd_bounded(4, RND_STREAM_AI); // Randomize direction in which we iterate to prevent monster cluttering up in one corner
 	dx=r%(d*2+1)-d;
 	dy=r/(d*2+1)%(d*2+1)-d;
 	max=(d*2+1)*(d*2+1);
@@ -3284,7 +3284,7 @@ int32 mob_dead(mob_data *md, block_list *src, int32 type)
 						//it's positive, then it goes as it is
 						drop_rate = it.rate;
 
-					if (rnd()%10000 >= drop_rate)
+					if (rnd_bounded(10000, RND_STREAM_DROP) >= drop_rate)
 						continue;
 
 					std::shared_ptr<s_mob_drop> mobdrop = std::make_shared<s_mob_drop>();
@@ -3327,7 +3327,7 @@ int32 mob_dead(mob_data *md, block_list *src, int32 type)
 			drop_rate = mob_getdroprate(src, md->db, entry->rate, drop_modifier, md);
 
 			// attempt to drop the item
-			if (rnd() % 10000 >= drop_rate)
+			if (rnd_bounded(10000, RND_STREAM_DROP) >= drop_rate)
 				continue;
 
 			if (first_sd != nullptr && it->type == IT_PETEGG) {
@@ -3385,7 +3385,7 @@ int32 mob_dead(mob_data *md, block_list *src, int32 type)
 					final_rate = it.second->rate;
 				}
 
-				if( rnd_chance( final_rate, 100000u ) ){
+				if( rnd_chance( final_rate, 100000u, RND_STREAM_DROP ) ){
 					// 'Cheat' for autoloot command: rate is changed from n/100000 to n/10000
 					int32 map_drops_rate = max(1, (final_rate / 10));
 					std::shared_ptr<s_item_drop> ditem = mob_setdropitem( it.second, 1, md->mob_id );
@@ -3406,7 +3406,7 @@ int32 mob_dead(mob_data *md, block_list *src, int32 type)
 						final_rate = it.second->rate;
 					}
 
-					if( rnd_chance( final_rate, 100000u ) ){
+					if( rnd_chance( final_rate, 100000u, RND_STREAM_DROP ) ){
 						// 'Cheat' for autoloot command: rate is changed from n/100000 to n/10000
 						int32 map_drops_rate = max(1, (final_rate / 10));
 						std::shared_ptr<s_item_drop> ditem = mob_setdropitem( it.second, 1, md->mob_id );
@@ -3492,7 +3492,7 @@ int32 mob_dead(mob_data *md, block_list *src, int32 type)
 				if (temp != 10000) {
 					if(temp <= 0 && !battle_config.drop_rate0item)
 						temp = 1;
-					if(rnd()%10000 >= temp) //if ==0, then it doesn't drop
+					if(rnd_bounded(10000, RND_STREAM_DROP) >= temp) //if ==0, then it doesn't drop
 						continue;
 				}
 
@@ -1848,6 +1848,138 @@ int32 npc_touch_areanpc_sub(block_list *bl, va_list ap)
 	return 1;
 }
 
+/**
+ * Returns the trigger area of a NPC
+ * @param nd: NPC
+ * @param xs: Horizontal range of the area
+ * @param ys: Vertical range of the area
+ * @return false if the NPC has no trigger area
+ */
+static bool npc_touch_range( const npc_data& nd, int16& xs, int16& ys ){
+	switch( nd.subtype ){
+		case NPCTYPE_WARP:
+			xs = nd.u.warp.xs;
+			ys = nd.u.warp.ys;
+			break;
+		case NPCTYPE_SCRIPT:
+			xs = nd.u.scr.xs;
+			ys = nd.u.scr.ys;
+			break;
+		default:
+			return false;
+	}
+
+	return xs >= 0 && ys >= 0;
+}
+
+/**
+ * Calls a function for every block of the trigger index that overlaps an area
+ * @param mapdata: Map of the area
+ * @param x0, y0, x1, y1: Corners of the area, they are capped to the map
+ * @param func: Function that receives the block index, returns false to stop
+ */
+template <typename F> static void npc_touch_foreachblock( const map_data& mapdata, int32 x0, int32 y0, int32 x1, int32 y1, F func ){
+	x0 = cap_value( x0, 0, mapdata.xs - 1 ) / BLOCK_SIZE;
+	y0 = cap_value( y0, 0, mapdata.ys - 1 ) / BLOCK_SIZE;
+	x1 = cap_value( x1, 0, mapdata.xs - 1 ) / BLOCK_SIZE;
+	y1 = cap_value( y1, 0, mapdata.ys - 1 ) / BLOCK_SIZE;
+
+	for( int32 by = y0; by <= y1; by++ ){
+		for( int32 bx = x0; bx <= x1; bx++ ){
+			if( !func( bx + by * mapdata.bxs ) ){
+				return;
+			}
+		}
+	}
+}
+
+/**
+ * Adds a NPC to the trigger index of its map, for every block its trigger area overlaps.
+ * Warps are kept in front of the other NPC, because they take precedence.
+ * @param nd: NPC
+ */
+static void npc_touch_index_add( npc_data& nd ){
+	int16 xs, ys;
+
+	if( nd.m < 0 || !npc_touch_range( nd, xs, ys ) ){
+		return;
+	}
+
+	map_data& mapdata = *map_getmapdata( nd.m );
+
+	npc_touch_foreachblock( mapdata, nd.x - xs, nd.y - ys, nd.x + xs, nd.y + ys, [&nd, &mapdata]( int32 block ){
+		std::vector<npc_data*>& list = mapdata.npc_touch[block];
+
+		if( util::vector_exists( list, &nd ) ){
+			return true;
+		}
+
+		if( nd.subtype == NPCTYPE_WARP ){
+			auto it = std::find_if( list.begin(), list.end(), []( const npc_data* other ){
+				return other->subtype != NPCTYPE_WARP;
+			} );
+
+			list.insert( it, &nd );
+		}else{
+			list.push_back( &nd );
+		}
+
+		return true;
+	} );
+}
+
+/**
+ * Removes a NPC from the trigger index of its map
+ * @param nd: NPC
+ */
+static void npc_touch_index_remove( npc_data& nd ){
+	int16 xs, ys;
+
+	if( nd.m < 0 || !npc_touch_range( nd, xs, ys ) ){
+		return;
+	}
+
+	map_data& mapdata = *map_getmapdata( nd.m );
+
+	npc_touch_foreachblock( mapdata, nd.x - xs, nd.y - ys, nd.x + xs, nd.y + ys, [&nd, &mapdata]( int32 block ){
+		auto it = mapdata.npc_touch.find( block );
+
+		if( it != mapdata.npc_touch.end() ){
+			util::vector_erase_if_exists( it->second, &nd );
+
+			if( it->second.empty() ){
+				mapdata.npc_touch.erase( it );
+			}
+		}
+
+		return true;
+	} );
+}
+
+/**
+ * Returns the IDs of the NPC whose trigger area might contain a cell, warps first.
+ * IDs are returned instead of the NPC, because an OnTouch event may unload or move them.
+ * @param mapdata: Map of the cell
+ * @param x: X coordinate
+ * @param y: Y coordinate
+ * @param ids: Receives the IDs
+ */
+static void npc_touch_candidates( map_data& mapdata, int16 x, int16 y, std::vector<int32>& ids ){
+	if( x < 0 || y < 0 || x >= mapdata.xs || y >= mapdata.ys ){
+		return;
+	}
+
+	auto it = mapdata.npc_touch.find( x / BLOCK_SIZE + ( y / BLOCK_SIZE ) * mapdata.bxs );
+
+	if( it == mapdata.npc_touch.end() ){
+		return;
+	}
+
+	for( const npc_data* nd : it->second ){
+		ids.push_back( nd->id );
+	}
+}
+
 /*==========================================
  * Chk if sd is still touching his assigned npc.
  * If not, it unsets it and searches for another player in range.
@@ -1957,21 +2089,28 @@ int32 npc_touch_area_allnpc(map_session_data* sd, int16 m, int16 x, int16 y)
 	nullpo_retr(1, sd);
 
 	// Remove NPCs that are no longer within the OnTouch area
-	for (size_t i = 0; i < sd->areanpc.size(); i++) {
-		npc_data *nd = map_id2nd(sd->areanpc[i]);
+	sd->areanpc.erase(std::remove_if(sd->areanpc.begin(), sd->areanpc.end(), [m, x, y] (const int32 &id) {
+		npc_data *nd = map_id2nd(id);
 
-		if (!nd || nd->subtype != NPCTYPE_SCRIPT || !(nd->m == m && x >= nd->x - nd->u.scr.xs && x <= nd->x + nd->u.scr.xs && y >= nd->y - nd->u.scr.ys && y <= nd->y + nd->u.scr.ys))
-			util::erase_at(sd->areanpc, i);
-	}
+		return !nd || nd->subtype != NPCTYPE_SCRIPT || !(nd->m == m && x >= nd->x - nd->u.scr.xs && x <= nd->x + nd->u.scr.xs && y >= nd->y - nd->u.scr.ys && y <= nd->y + nd->u.scr.ys);
+	}), sd->areanpc.end());
 
 	if (sd->state.block_action & PCBLOCK_NPCCLICK)
 		return 0;
 
 	struct map_data *mapdata = map_getmapdata(m);
+	std::vector<int32> candidates;
 	int32 f = 1;
 
-	for (int32 i = 0; i < mapdata->npc_num_area; i++) {
-		switch( npc_touch_areanpc(sd, m, x, y, mapdata->npc[i]) ) {
+	npc_touch_candidates(*mapdata, x, y, candidates);
+
+	for (int32 id : candidates) {
+		npc_data *nd = map_id2nd(id);
+
+		if (nd == nullptr || nd->m != m)
+			continue;
+
+		switch( npc_touch_areanpc(sd, m, x, y, nd) ) {
 		case 0:
 			break;
 		case 1:
@@ -1993,59 +2132,55 @@ int32 npc_touch_area_allnpc(map_session_data* sd, int16 m, int16 x, int16 y)
 // Return 1 if Warped
 int32 npc_touch_areanpc2(mob_data *md)
 {
-	int32 i, x = md->x, y = md->y, id;
+	int32 x = md->x, y = md->y, id;
 	char eventname[EVENT_NAME_LENGTH];
 	struct event_data* ev;
-	int32 xs, ys;
+	int16 xs, ys;
 	struct map_data *mapdata = map_getmapdata(md->m);
+	std::vector<int32> candidates;
+
+	npc_touch_candidates(*mapdata, x, y, candidates);
 
-	for( i = 0; i < mapdata->npc_num_area; i++ )
+	for( int32 npc_id : candidates )
 	{
-		if( mapdata->npc[i]->is_invisible || mapdata->npc[i]->sc.option&OPTION_CLOAK )
+		npc_data *nd = map_id2nd(npc_id);
+
+		if( nd == nullptr || nd->m != md->m )
 			continue;
 
-		if( mapdata->npc[i]->dynamicnpc.owner_char_id != 0 ){
+		if( nd->is_invisible || nd->sc.option&OPTION_CLOAK )
 			continue;
-		}
 
-		switch( mapdata->npc[i]->subtype )
-		{
-			case NPCTYPE_WARP:
-				if( !( battle_config.mob_warp&1 ) )
-					continue;
-				xs = mapdata->npc[i]->u.warp.xs;
-				ys = mapdata->npc[i]->u.warp.ys;
-				break;
-			case NPCTYPE_SCRIPT:
-				xs = mapdata->npc[i]->u.scr.xs;
-				ys = mapdata->npc[i]->u.scr.ys;
-				break;
-			default:
-				continue; // Keep Searching
+		if( nd->dynamicnpc.owner_char_id != 0 ){
+			continue;
 		}
-		if (xs < 0 || ys < 0)
+
+		if( !npc_touch_range(*nd, xs, ys) )
 			continue;
 
-		if( x >= mapdata->npc[i]->x-xs && x <= mapdata->npc[i]->x+xs && y >= mapdata->npc[i]->y-ys && y <= mapdata->npc[i]->y+ys )
+		if( nd->subtype == NPCTYPE_WARP && !( battle_config.mob_warp&1 ) )
+			continue;
+
+		if( x >= nd->x-xs && x <= nd->x+xs && y >= nd->y-ys && y <= nd->y+ys )
 		{ // In the npc touch area
-			switch( mapdata->npc[i]->subtype )
+			switch( nd->subtype )
 			{
 				case NPCTYPE_WARP: {
-					int16 warp_m = map_mapindex2mapid(mapdata->npc[i]->u.warp.mapindex);
+					int16 warp_m = map_mapindex2mapid(nd->u.warp.mapindex);
 
 					if( warp_m < 0 )
 						break; // Cannot Warp between map servers
-					if( unit_warp(md, warp_m, mapdata->npc[i]->u.warp.x, mapdata->npc[i]->u.warp.y, CLR_OUTSIGHT) == 0 )
+					if( unit_warp(md, warp_m, nd->u.warp.x, nd->u.warp.y, CLR_OUTSIGHT) == 0 )
 						return 1; // Warped
 				}
 					break;
 				case NPCTYPE_SCRIPT:
-					if( mapdata->npc[i]->id == md->areanpc_id )
+					if( nd->id == md->areanpc_id )
 						break; // Already touch this NPC
-					safesnprintf(eventname, ARRAYLENGTH(eventname), "%s::%s", mapdata->npc[i]->exname, script_config.ontouchnpc_event_name);
+					safesnprintf(eventname, ARRAYLENGTH(eventname), "%s::%s", nd->exname, script_config.ontouchnpc_event_name);
 					if( (ev = (struct event_data*)strdb_get(ev_db, eventname)) == nullptr || ev->nd == nullptr )
 						break; // No OnTouchNPC Event
-					md->areanpc_id = mapdata->npc[i]->id;
+					md->areanpc_id = nd->id;
 					id = md->id; // Stores Unique ID
 					run_script(ev->nd->u.scr.script, ev->pos, md->id, ev->nd->id);
 					if( map_id2md(id) == nullptr ) return 1; // Not Warped, but killed
@@ -2096,41 +2231,42 @@ int32 npc_check_areanpc(int32 flag, int16 m, int16 x, int16 y, int16 range)
 	if (!i) return 0; //No NPC_CELLs.
 
 	//Now check for the actual NPC on said range.
-	for (i = 0; i < mapdata->npc_num_area; i++)
-	{
-		if (mapdata->npc[i]->is_invisible)
-			continue;
+	int32 found = 0;
 
-		if( mapdata->npc[i]->dynamicnpc.owner_char_id != 0 ){
-			continue;
-		}
+	npc_touch_foreachblock(*mapdata, x0, y0, x1, y1, [&](int32 block) {
+		auto it = mapdata->npc_touch.find(block);
 
-		switch(mapdata->npc[i]->subtype)
-		{
-		case NPCTYPE_WARP:
-			if (!(flag&1))
+		if (it == mapdata->npc_touch.end())
+			return true;
+
+		for (npc_data* nd : it->second) {
+			if (nd->is_invisible)
 				continue;
-			xs=mapdata->npc[i]->u.warp.xs;
-			ys=mapdata->npc[i]->u.warp.ys;
-			break;
-		case NPCTYPE_SCRIPT:
-			if (!(flag&2))
+
+			if( nd->dynamicnpc.owner_char_id != 0 ){
 				continue;
-			xs=mapdata->npc[i]->u.scr.xs;
-			ys=mapdata->npc[i]->u.scr.ys;
-			break;
-		default:
-			continue;
+			}
+
+			if (nd->subtype == NPCTYPE_WARP && !(flag&1))
+				continue;
+			if (nd->subtype == NPCTYPE_SCRIPT && !(flag&2))
+				continue;
+			int16 area_xs, area_ys;
+
+			if (!npc_touch_range(*nd, area_xs, area_ys))
+				continue;
+
+			if( x1 >= nd->x-area_xs && x0 <= nd->x+area_xs
+			&&  y1 >= nd->y-area_ys && y0 <= nd->y+area_ys ) {
+				found = nd->id; // found a npc
+				return false;
+			}
 		}
 
-		if( x1 >= mapdata->npc[i]->x-xs && x0 <= mapdata->npc[i]->x+xs
-		&&  y1 >= mapdata->npc[i]->y-ys && y0 <= mapdata->npc[i]->y+ys )
-			break; // found a npc
-	}
-	if (i == mapdata->npc_num_area)
-		return 0;
+		return true;
+	});
 
-	return (mapdata->npc[i]->id);
+	return found;
 }
 
 /*==========================================
@@ -4988,6 +5124,8 @@ void npc_setcells(npc_data* nd)
 	if (m < 0 || xs < 0 || ys < 0) //invalid range or map
 		return;
 
+	npc_touch_index_add(*nd);
+
 	for (i = y-ys; i <= y+ys; i++) {
 		for (j = x-xs; j <= x+xs; j++) {
 			if (map_getcell(m, j, i, CELL_CHKNOPASS))
@@ -5031,6 +5169,8 @@ void npc_unsetcells(npc_data* nd)
 	for(y0 = y-ys; y0 > 0 && map_getcell(m, x, y0, CELL_CHKNPC); y0--);
 	for(y1 = y+ys; y1 < mapdata->ys-1 && map_getcell(m, x, y1, CELL_CHKNPC); y1++);
 
+	npc_touch_index_remove(*nd);
+
 	//Erase this npc's cells
 	for (i = y-ys; i <= y+ys; i++)
 		for (j = x-xs; j <= x+xs; j++)
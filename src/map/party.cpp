@@ -4,6 +4,7 @@
 #include "party.hpp"
 
 #include <cstdlib>
+#include <unordered_set>
 
 #include <common/cbasetypes.hpp>
 #include <common/malloc.hpp>
@@ -35,6 +36,7 @@ static unsigned long party_booking_nextid = 1;
 
 TIMER_FUNC(party_send_xy_timer);
 int32 party_create_byscript;
+static std::unordered_set<uint32> party_xy_dirty; // account ids of members to check on the next party_send_xy_timer
 
 /*==========================================
  * Fills the given party_member structure according to the sd provided.
@@ -341,6 +343,9 @@ int32 party_recv_info(struct party* sp, uint32 char_id)
 		if ( member->char_id == 0 )
 			continue;// empty
 		p->data[member_id].sd = party_sd_check(sp->party_id, member->account_id, member->char_id);
+		// the stored positions were reset, resend them
+		if( p->data[member_id].sd != nullptr )
+			party_send_xy_mark( *p->data[member_id].sd );
 	}
 
 	party_check_state(p);
@@ -633,6 +638,7 @@ void party_member_joined( map_session_data& sd ){
 
 	if (i < MAX_PARTY) {
 		p->data[i].sd = &sd;
+		party_send_xy_mark( sd );
 	} else
 		sd.status.party_id = 0; //He does not belongs to the party really?
 }
@@ -1032,6 +1038,8 @@ int32 party_recv_movemap( int32 party_id, uint32 account_id, uint32 char_id, int
 	m->lv = lv;
 	//Check if they still exist on this map server
 	p->data[i].sd = party_sd_check(party_id, account_id, char_id);
+	if( p->data[i].sd != nullptr )
+		party_send_xy_mark( *p->data[i].sd );
 
 	clif_party_info( *p );
 
@@ -1174,38 +1182,43 @@ int32 party_skill_check(map_session_data *sd, int32 party_id, uint16 skill_id, u
 	return 0;
 }
 
-TIMER_FUNC(party_send_xy_timer){
-	struct party_data* p;
-
-	DBIterator *iter = db_iterator(party_db);
+/**
+ * Queue a party member for the next position and HP update.
+ * Called whenever the member moved or its HP changed.
+ * @param sd: Party member
+ */
+void party_send_xy_mark( map_session_data& sd ){
+	if( sd.status.party_id != 0 ){
+		party_xy_dirty.insert( sd.status.account_id );
+	}
+}
 
-	// for each existing party
-	for( p = (struct party_data*)dbi_first(iter); dbi_exists(iter); p = (struct party_data*)dbi_next(iter) ) {
+TIMER_FUNC(party_send_xy_timer){
+	// for each member that moved or changed HP since the last update
+	for( uint32 account_id : party_xy_dirty ){
+		map_session_data* sd = map_id2sd( account_id );
+		struct party_data* p;
 		int32 i;
 
-		if( !p->party.count ) // no online party members so do not iterate
+		if( sd == nullptr || ( p = party_search( sd->status.party_id ) ) == nullptr )
 			continue;
 
-		// for each member of this party
-		for( i = 0; i < MAX_PARTY; i++ ) {
-			map_session_data* sd = p->data[i].sd;
-
-			if( !sd )
-				continue;
+		if( ( i = party_getmemberid( p, sd ) ) < 0 || p->data[i].sd != sd )
+			continue;
 
-			if( p->data[i].x != sd->x || p->data[i].y != sd->y ) { // perform position update
-				clif_party_xy( *sd );
-				p->data[i].x = sd->x;
-				p->data[i].y = sd->y;
-			}
+		if( p->data[i].x != sd->x || p->data[i].y != sd->y ) { // perform position update
+			clif_party_xy( *sd );
+			p->data[i].x = sd->x;
+			p->data[i].y = sd->y;
+		}
 
-			if (battle_config.party_hp_mode && p->data[i].hp != sd->battle_status.hp) { // perform hp update
-				clif_party_hp( *sd );
-				p->data[i].hp = sd->battle_status.hp;
-			}
+		if (battle_config.party_hp_mode && p->data[i].hp != sd->battle_status.hp) { // perform hp update
+			clif_party_hp( *sd );
+			p->data[i].hp = sd->battle_status.hp;
 		}
 	}
-	dbi_destroy(iter);
+
+	party_xy_dirty.clear();
 
 	return 0;
 }
@@ -1223,6 +1236,7 @@ int32 party_send_xy_clear(struct party_data *p)
 		p->data[i].hp = 0;
 		p->data[i].x = 0;
 		p->data[i].y = 0;
+		party_send_xy_mark( *p->data[i].sd );
 	}
 	return 0;
 }
@@ -2247,8 +2247,10 @@ bool pc_authok(map_session_data *sd, uint32 login_id2, time_t expiration_time, i
 	         " Group '" CL_WHITE "%d" CL_RESET "').\n",
 	         sd->status.name, sd->status.account_id, sd->status.char_id,
 	         CONVIP(ip), sd->group_id);
-	// Send friends list
-	clif_friendslist_send( *sd );
+	// Send friends list, unless it is still loading
+	if( !sd->state.deferred_load ){
+		clif_friendslist_send( *sd );
+	}
 
 	if( !changing_mapservers ) {
 
@@ -2472,6 +2474,9 @@ void pc_reg_received(map_session_data *sd)
 
 	chrif_skillcooldown_request(sd->status.account_id, sd->status.char_id);
 	chrif_bsdata_request(sd->status.char_id);
+	if( sd->state.deferred_load ){
+		chrif_deferred_request( sd->status.char_id );
+	}
 #ifdef VIP_ENABLE
 	sd->vip.time = 0;
 	sd->vip.enabled = 0;
@@ -14952,7 +14957,7 @@ void pc_bonus_script(map_session_data *sd) {
 			}
 
 			if (entry->script)
-				run_script(entry->script, 0, sd->id, 0);
+				run_bonus_script(entry->script, sd);
 			else
 				ShowError("pc_bonus_script: The script has been removed somewhere. \"%s\"\n", StringBuf_Value(entry->script_buf));
 		}
@@ -14980,7 +14985,7 @@ struct s_bonus_script_entry *pc_bonus_script_add(map_session_data *sd, const cha
 	if (!sd)
 		return nullptr;
 	
-	if (!(script = parse_script(script_str, "bonus_script", 0, SCRIPT_IGNORE_EXTERNAL_BRACKETS))) {
+	if (!(script = parse_script(script_str, "bonus_script", 0, SCRIPT_IGNORE_EXTERNAL_BRACKETS|SCRIPT_BONUS))) {
 		ShowError("pc_bonus_script_add: Failed to parse script '%s' (CID:%d).\n", script_str, sd->status.char_id);
 		return nullptr;
 	}
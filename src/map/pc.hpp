@@ -6,6 +6,7 @@
 
 #include <bitset>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include <common/cbasetypes.hpp>
@@ -394,6 +395,7 @@ public:
 		uint32 dead_sit : 2;
 		e_lr_flag lr_flag;
 		uint32 connect_new : 1;
+		uint32 deferred_load : 1; // memo points, friends and hotkeys were not received from the char-server yet
 		uint32 arrow_atk : 1;
 		uint32 gangsterparadise : 1;
 		uint32 rest : 1;
@@ -501,6 +503,7 @@ public:
 	int32 npc_id,npc_shopid; //for script follow scriptoid;   ,npcid
 	std::vector<int32> npc_id_dynamic;
 	std::vector<int32> areanpc, npc_ontouch_;	///< Array of OnTouch and OnTouch_ NPC ID
+	std::unordered_set<int32> area_known; ///< IDs of units this client was shown with clif_getareachar_unit and has not been told to remove yet
 	int32 npc_item_flag; //Marks the npc_id with which you can use items during interactions with said npc (see script command enable_itemuse)
 	int32 npc_menu; // internal variable, used in npc menu handling
 	int32 npc_amount;
@@ -383,7 +383,7 @@ uint64 PetDatabase::parseBodyNode( const ryml::NodeRef& node ){
 			pet->pet_bonus_script = nullptr;
 		}
 
-		pet->pet_bonus_script = parse_script( script.c_str(), this->getCurrentFile().c_str(), this->getLineNumber(node["Script"]), SCRIPT_IGNORE_EXTERNAL_BRACKETS );
+		pet->pet_bonus_script = parse_script( script.c_str(), this->getCurrentFile().c_str(), this->getLineNumber(node["Script"]), SCRIPT_IGNORE_EXTERNAL_BRACKETS|SCRIPT_BONUS );
 	}else{
 		if( !exists ){
 			pet->pet_bonus_script = nullptr;
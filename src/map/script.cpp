@@ -258,6 +258,7 @@ struct Script_Config script_config = {
 	1, // warn_func_mismatch_argtypes
 	1, 65535, 2048, //warn_func_mismatch_paramnum/check_cmdcount/check_gotocount
 	0, INT_MAX, // input_min_value/input_max_value
+	0, // verify_bonus_scripts
 	// NOTE: None of these event labels should be longer than <EVENT_NAME_LENGTH> characters
 	// PC related
 	"OnPCDieEvent", //die_event_name
@@ -2469,6 +2470,83 @@ void script_warning(const char* src, const char* file, int32 start_line, const c
 	ShowWarning("%s", StringBuf_Value(&buf));
 }
 
+int32 buildin_bonus(struct script_state* st);
+
+/**
+ * Checks if a script consists only of bonus calls with constant arguments,
+ * for example "bonus bStr,5; bonus2 bAddRace,RC_All,10;"
+ * @param code: Parsed script
+ * @return List of the bonus calls in order of appearance or nullptr if the script needs the VM
+ */
+static std::unique_ptr<std::vector<s_script_bonus>> script_compile_bonus( const script_code& code ){
+	std::vector<s_script_bonus> bonuses;
+	unsigned char* buf = code.script_buf;
+	int32 pos = 0;
+
+	while( pos < code.script_size ){
+		c_op op = get_com( buf, &pos );
+
+		if( op == C_NOP ){
+			break;
+		}
+
+		if( op == C_EOL ){
+			continue;
+		}
+
+		// Function reference
+		if( op != C_NAME ){
+			return nullptr;
+		}
+
+		int32 func = GETVALUE( buf, pos );
+
+		pos += 3;
+
+		if( func >= str_num || str_data[func].type != C_FUNC || str_data[func].func != buildin_bonus ){
+			return nullptr;
+		}
+
+		if( get_com( buf, &pos ) != C_ARG ){
+			return nullptr;
+		}
+
+		// Only literals and constants, optionally negated
+		std::vector<int64> args;
+
+		while( ( op = get_com( buf, &pos ) ) != C_FUNC ){
+			if( op == C_INT ){
+				args.push_back( get_num( buf, &pos ) );
+			}else if( op == C_NEG && !args.empty() ){
+				args.back() = -args.back();
+			}else{
+				return nullptr;
+			}
+		}
+
+		if( args.empty() || args.size() > ARRAYLENGTH( s_script_bonus::val ) + 1 ){
+			return nullptr;
+		}
+
+		s_script_bonus bonus = {};
+
+		bonus.type = static_cast<int32>( args[0] );
+		bonus.count = static_cast<uint8>( args.size() - 1 );
+
+		for( uint8 i = 0; i < bonus.count; i++ ){
+			bonus.val[i] = static_cast<int32>( args[i + 1] );
+		}
+
+		bonuses.push_back( bonus );
+	}
+
+	if( bonuses.empty() ){
+		return nullptr;
+	}
+
+	return std::make_unique<std::vector<s_script_bonus>>( std::move( bonuses ) );
+}
+
 /*==========================================
  * Analysis of the script
  *------------------------------------------*/
@@ -2653,10 +2731,14 @@ struct script_code* parse_script_( const char *src, const char *file, int32 line
 #endif
 
 	CREATE2( code, struct script_code, 1, src_file, src_line, src_func );
+	new( code ) script_code();
 	code->script_buf  = script_buf;
 	code->script_size = script_size;
 	code->local.vars = nullptr;
 	code->local.arrays = nullptr;
+	if( options&SCRIPT_BONUS ){
+		code->bonus = script_compile_bonus( *code );
+	}
 	return code;
 }
 
@@ -3612,6 +3694,7 @@ void script_free_code(struct script_code* code)
 	if (code->local.arrays)
 		code->local.arrays->destroy(code->local.arrays, script_free_array_db);
 	aFree(code->script_buf);
+	code->~script_code();
 	aFree(code);
 }
 
@@ -4373,6 +4456,130 @@ void script_attach_state(struct script_state* st){
 /*==========================================
  * The main part of the script execution
  *------------------------------------------*/
+/**
+ * Checks if the first value of a bonus type is a skill
+ * @param type: Bonus type
+ * @return True if the bonus supports skill names
+ */
+static bool script_bonus_has_skill( int32 type ){
+	switch( type ){
+		case SP_AUTOSPELL:
+		case SP_AUTOSPELL_WHENHIT:
+		case SP_AUTOSPELL_ONSKILL:
+		case SP_SKILL_ATK:
+		case SP_SKILL_HEAL:
+		case SP_SKILL_HEAL2:
+		case SP_ADD_SKILL_BLOW:
+		case SP_CASTRATE:
+		case SP_ADDEFF_ONSKILL:
+		case SP_SKILL_USE_SP_RATE:
+		case SP_SKILL_COOLDOWN:
+		case SP_SKILL_FIXEDCAST:
+		case SP_SKILL_VARIABLECAST:
+		case SP_VARCASTRATE:
+		case SP_FIXCASTRATE:
+		case SP_SKILL_DELAY:
+		case SP_SKILL_USE_SP:
+		case SP_SUB_SKILL:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// Bonus calls of the VM are collected here instead of being applied while a script is verified
+static std::vector<s_script_bonus>* script_bonus_recording = nullptr;
+
+/**
+ * Applies a bonus call, shared by buildin_bonus and the precompiled bonus scripts
+ * @param sd: Player the bonus is applied to
+ * @param bonus: Bonus call
+ */
+static void script_apply_bonus( map_session_data* sd, const s_script_bonus& bonus ){
+	if( script_bonus_recording != nullptr ){
+		script_bonus_recording->push_back( bonus );
+		return;
+	}
+
+	switch( bonus.count ){
+		case 0:
+		case 1:
+			pc_bonus(sd, bonus.type, bonus.val[0]);
+			break;
+		case 2:
+			pc_bonus2(sd, bonus.type, bonus.val[0], bonus.val[1]);
+			break;
+		case 3:
+			pc_bonus3(sd, bonus.type, bonus.val[0], bonus.val[1], bonus.val[2]);
+			break;
+		case 4:
+			pc_bonus4(sd, bonus.type, bonus.val[0], bonus.val[1], bonus.val[2], bonus.val[3]);
+			break;
+		case 5:
+			pc_bonus5(sd, bonus.type, bonus.val[0], bonus.val[1], bonus.val[2], bonus.val[3], bonus.val[4]);
+			break;
+	}
+}
+
+/**
+ * Runs a precompiled script in the VM and checks that the VM makes the same bonus calls, see verify_bonus_scripts
+ * @param rootscript: Precompiled script
+ * @param sd: Player the script is run for, no bonus is applied
+ */
+static void script_verify_bonus( struct script_code* rootscript, map_session_data* sd ){
+	std::vector<s_script_bonus> calls;
+
+	script_bonus_recording = &calls;
+	run_script( rootscript, 0, sd->id, 0 );
+	script_bonus_recording = nullptr;
+
+	const std::vector<s_script_bonus>& bonuses = *rootscript->bonus;
+	bool equal = calls.size() == bonuses.size();
+
+	for( size_t i = 0; equal && i < calls.size(); i++ ){
+		equal = calls[i].type == bonuses[i].type && calls[i].count == bonuses[i].count
+			&& std::equal( calls[i].val, calls[i].val + calls[i].count, bonuses[i].val );
+	}
+
+	if( !equal ){
+		ShowWarning( "run_bonus_script: The VM made %" PRIuPTR " bonus calls, the precompiled script has %" PRIuPTR ". Their values differ.\n", calls.size(), bonuses.size() );
+	}
+}
+
+/**
+ * Runs a script that gives bonuses during status calculation.
+ * Scripts that only consist of constant bonus calls are applied without the VM.
+ * @param rootscript: Script to run
+ * @param sd: Player the bonuses are applied to
+ */
+void run_bonus_script(struct script_code* rootscript, map_session_data* sd)
+{
+	if( rootscript == nullptr )
+		return;
+
+	if( rootscript->bonus == nullptr ){
+		run_script(rootscript, 0, sd->id, 0);
+		return;
+	}
+
+	for( const s_script_bonus& bonus : *rootscript->bonus ){
+		// buildin_bonus rejects invalid skill IDs for bonus2, bonus3, bonus4 and bonus5,
+		// the VM reports such errors with the source of the script
+		if( bonus.count > 1 && script_bonus_has_skill( bonus.type ) && !skill_get_index( bonus.val[0] ) ){
+			run_script(rootscript, 0, sd->id, 0);
+			return;
+		}
+	}
+
+	if( script_config.verify_bonus_scripts ){
+		script_verify_bonus( rootscript, sd );
+	}
+
+	for( const s_script_bonus& bonus : *rootscript->bonus ){
+		script_apply_bonus( sd, bonus );
+	}
+}
+
 void run_script_main(struct script_state *st)
 {
 	int32 cmdcount = script_config.check_cmdcount;
@@ -4561,6 +4768,9 @@ int32 script_config_read(const char *cfgName)
 		else if(strcmpi(w1,"warn_func_mismatch_argtypes")==0) {
 			script_config.warn_func_mismatch_argtypes = config_switch(w2);
 		}
+		else if(strcmpi(w1,"verify_bonus_scripts")==0) {
+			script_config.verify_bonus_scripts = config_switch(w2);
+		}
 		else if(strcmpi(w1,"import")==0){
 			script_config_read(w2);
 		}
@@ -10032,61 +10242,38 @@ BUILDIN_FUNC(bonus)
 		return SCRIPT_CMD_SUCCESS; // no player attached
 
 	type = script_getnum(st,2);
-	switch( type ) {
-		case SP_AUTOSPELL:
-		case SP_AUTOSPELL_WHENHIT:
-		case SP_AUTOSPELL_ONSKILL:
-		case SP_SKILL_ATK:
-		case SP_SKILL_HEAL:
-		case SP_SKILL_HEAL2:
-		case SP_ADD_SKILL_BLOW:
-		case SP_CASTRATE:
-		case SP_ADDEFF_ONSKILL:
-		case SP_SKILL_USE_SP_RATE:
-		case SP_SKILL_COOLDOWN:
-		case SP_SKILL_FIXEDCAST:
-		case SP_SKILL_VARIABLECAST:
-		case SP_VARCASTRATE:
-		case SP_FIXCASTRATE:
-		case SP_SKILL_DELAY:
-		case SP_SKILL_USE_SP:
-		case SP_SUB_SKILL:
-			// these bonuses support skill names
-			if (script_isstring(st, 3)) {
-				const char *name = script_getstr(st, 3);
+	if( script_bonus_has_skill( type ) ) {
+		// these bonuses support skill names
+		if (script_isstring(st, 3)) {
+			const char *name = script_getstr(st, 3);
 
-				if (!(val1 = skill_name2id(name))) {
-					ShowError("buildin_bonus: Invalid skill name %s passed to item bonus. Skipping.\n", name);
-					return SCRIPT_CMD_FAILURE;
-				}
-			} else {
-				val1 = script_getnum(st, 3);
+			if (!(val1 = skill_name2id(name))) {
+				ShowError("buildin_bonus: Invalid skill name %s passed to item bonus. Skipping.\n", name);
+				return SCRIPT_CMD_FAILURE;
+			}
+		} else {
+			val1 = script_getnum(st, 3);
 
-				if (strcmpi(script_getfuncname(st), "bonus") && !skill_get_index(val1)) { // Only check skill ID for bonus2, bonus3, bonus4, or bonus5
-					ShowError("buildin_bonus: Invalid skill ID %d passed to item bonus. Skipping.\n", val1);
-					return SCRIPT_CMD_FAILURE;
-				}
+			if (strcmpi(script_getfuncname(st), "bonus") && !skill_get_index(val1)) { // Only check skill ID for bonus2, bonus3, bonus4, or bonus5
+				ShowError("buildin_bonus: Invalid skill ID %d passed to item bonus. Skipping.\n", val1);
+				return SCRIPT_CMD_FAILURE;
 			}
-			break;
-		default:
-			if (script_hasdata(st, 3))
-				val1 = script_getnum(st, 3);
-			break;
-	}
+		}
+	} else if (script_hasdata(st, 3))
+		val1 = script_getnum(st, 3);
+
+	s_script_bonus bonus = {};
 
 	switch( script_lastdata(st)-2 ) {
 		case 0:
 		case 1:
-			pc_bonus(sd, type, val1);
 			break;
 		case 2:
 			val2 = script_getnum(st,4);
-			pc_bonus2(sd, type, val1, val2);
 			break;
 		case 3:
 			val2 = script_getnum(st,4);
 			val3 = script_getnum(st,5);
-			pc_bonus3(sd, type, val1, val2, val3);
 			break;
 		case 4:
 			if( type == SP_AUTOSPELL_ONSKILL && script_isstring(st, 4) )
@@ -10096,7 +10283,6 @@ BUILDIN_FUNC(bonus)
 
 			val3 = script_getnum(st,5);
 			val4 = script_getnum(st,6);
-			pc_bonus4(sd, type, val1, val2, val3, val4);
 			break;
 		case 5:
 			if( type == SP_AUTOSPELL_ONSKILL && script_isstring(st, 4) )
@@ -10107,13 +10293,22 @@ BUILDIN_FUNC(bonus)
 			val3 = script_getnum(st,5);
 			val4 = script_getnum(st,6);
 			val5 = script_getnum(st,7);
-			pc_bonus5(sd, type, val1, val2, val3, val4, val5);
 			break;
 		default:
 			ShowDebug("buildin_bonus: unexpected number of arguments (%d)\n", (script_lastdata(st) - 1));
-			break;
+			return SCRIPT_CMD_SUCCESS;
 	}
 
+	bonus.type = type;
+	bonus.count = static_cast<uint8>( script_lastdata(st) - 2 );
+	bonus.val[0] = val1;
+	bonus.val[1] = val2;
+	bonus.val[2] = val3;
+	bonus.val[3] = val4;
+	bonus.val[4] = val5;
+
+	script_apply_bonus( sd, bonus );
+
 	return SCRIPT_CMD_SUCCESS;
 }
 
@@ -18486,7 +18681,7 @@ BUILDIN_FUNC(setitemscript)
 	if(*dstscript)
 		script_free_code(*dstscript);
 
-	*dstscript = script[0] ? parse_script(script, "script_setitemscript", 0, 0) : nullptr;
+	*dstscript = script[0] ? parse_script(script, "script_setitemscript", 0, dstscript == &i_data->script ? SCRIPT_BONUS : 0) : nullptr;
 	script_pushint(st,1);
 	return SCRIPT_CMD_SUCCESS;
 }
@@ -4,6 +4,9 @@
 #ifndef SCRIPT_HPP
 #define SCRIPT_HPP
 
+#include <memory>
+#include <vector>
+
 #include <ryml_std.hpp>
 #include <ryml.hpp>
 
@@ -157,6 +160,7 @@ struct Script_Config {
 	int32 check_gotocount;
 	int32 input_min_value;
 	int32 input_max_value;
+	unsigned verify_bonus_scripts : 1;
 
 	// PC related
 	const char *die_event_name;
@@ -290,6 +294,13 @@ struct script_data {
 	struct reg_db *ref;
 };
 
+/// Bonus call with constant arguments, applied without the VM during status calculation
+struct s_script_bonus {
+	int32 type;
+	int32 val[5];
+	uint8 count; ///< Number of values passed after the bonus type
+};
+
 // Moved defsp from script_state to script_stack since
 // it must be saved when script state is RERUNLINE. [Eoe / jA 1094]
 struct script_code {
@@ -297,6 +308,7 @@ struct script_code {
 	unsigned char* script_buf;
 	struct reg_db local;
 	uint16 instances;
+	std::unique_ptr<std::vector<s_script_bonus>> bonus; ///< Precompiled bonus calls, only for SCRIPT_BONUS scripts that do not need the VM
 };
 
 struct script_stack {
@@ -354,7 +366,8 @@ struct script_array {
 enum script_parse_options {
 	SCRIPT_USE_LABEL_DB = 0x1,// records labels in scriptlabel_db
 	SCRIPT_IGNORE_EXTERNAL_BRACKETS = 0x2,// ignores the check for {} brackets around the script
-	SCRIPT_RETURN_EMPTY_SCRIPT = 0x4// returns the script object instead of nullptr for empty scripts
+	SCRIPT_RETURN_EMPTY_SCRIPT = 0x4,// returns the script object instead of nullptr for empty scripts
+	SCRIPT_BONUS = 0x8// precompiles constant bonus calls, for scripts run by run_bonus_script
 };
 
 enum e_monsterinfo_types : uint8 {
@@ -2277,6 +2290,7 @@ bool is_number(const char *p);
 struct script_code* parse_script_( const char *src, const char *file, int32 line, int32 options, const char* src_file, int32 src_line, const char* src_func );
 #define parse_script( src, file, line, options ) parse_script_( ( src ), ( file ), ( line ), ( options ), ALC_MARK )
 void run_script(struct script_code *rootscript,int32 pos,int32 rid,int32 oid);
+void run_bonus_script(struct script_code* rootscript, map_session_data* sd);
 
 bool set_reg_num(struct script_state* st, map_session_data* sd, int64 num, const char* name, const int64 value, struct reg_db *ref);
 bool set_reg_str(struct script_state* st, map_session_data* sd, int64 num, const char* name, const char* value, struct reg_db* ref);
@@ -0,0 +1,705 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include <config/core.hpp>
+
+#ifdef MAP_SIMULATOR
+
+#include "simulator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include <common/malloc.hpp>
+#include <common/mmo.hpp>
+#include <common/packets_inter.hpp>
+#include <common/profiler.hpp>
+#include <common/random.hpp>
+#include <common/showmsg.hpp>
+#include <common/socket.hpp>
+#include <common/strlib.hpp>
+#include <common/timer.hpp>
+#include <common/utils.hpp>
+
+#include "chrif.hpp"
+#include "clif.hpp"
+#include "map.hpp"
+#include "mob.hpp"
+#include "pc.hpp"
+#include "skill.hpp"
+#include "status.hpp"
+#include "unit.hpp"
+
+using namespace rathena;
+
+// Ids used for the simulated characters, kept away from the ranges handed out by the char-server
+#define SIM_START_ACCOUNT_ID 1900000
+#define SIM_START_CHAR_ID 1900000
+// Amount of timer functions listed in the report
+#define SIM_REPORT_TIMER_FUNCS 15
+
+static const char* simulator_scenario_names[SIM_SCENARIO_MAX] = {
+	"farm",
+	"clash",
+	"crowd",
+};
+
+// Maps used when no map was given on the command line
+static const char* simulator_scenario_maps[SIM_SCENARIO_MAX] = {
+	"prt_fild08",
+	"guild_vs1",
+	"prontera",
+};
+
+static struct s_simulator_options {
+	e_simulator_scenario scenario = SIM_SCENARIO_FARM;
+	int32 players = 100;
+	int32 mobs = 200;
+	int32 mob_id = 1002;
+	int32 ticks = 3000;
+	int32 tick_interval = 20;
+	int32 think_interval = 200;
+	int32 area = 15;
+	uint64 seed = 1;
+	std::string map;
+	std::string report;
+} sim_options;
+
+enum e_simulator_section : uint8 {
+	SIM_SECTION_TIMERS = 0,
+	SIM_SECTION_SCENARIO,
+	SIM_SECTION_SPAWN,
+	SIM_SECTION_NETWORK,
+	SIM_SECTION_MAX
+};
+
+static const char* simulator_section_names[SIM_SECTION_MAX] = {
+	"timers",
+	"scenario",
+	"spawn",
+	"network",
+};
+
+static struct s_simulator_stats {
+	std::chrono::steady_clock::duration time[SIM_SECTION_MAX];
+	uint64 client_bytes;
+	uint64 charserver_bytes;
+	uint64 logins;
+	uint64 mobs_spawned;
+	uint64 revives;
+	uint64 attacks;
+	uint64 skills;
+	uint64 walks;
+	uint64 emotes;
+	uint64 chats;
+} sim_stats;
+
+struct s_simulator_player {
+	int32 fd;
+	uint32 account_id;
+	uint32 char_id;
+	t_tick next_think;
+};
+
+static std::vector<s_simulator_player> sim_players;
+static int32 sim_charserver_fd = -1;
+static int16 sim_m = -1;
+static int16 sim_x, sim_y;
+
+/**
+ * Read the simulator options specified in command line
+ * Recognized options are cleared, so that the default option parser does not complain about them.
+ * @param argc: Argument count
+ * @param argv: Argument values
+ * @return 1 or Exit on failure.
+ */
+int32 simulator_get_options(int32 argc, char** argv) {
+	for (int32 i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if (arg == nullptr || strncmp(arg, "--sim-", 6) != 0)
+			continue;
+
+		arg += 6;
+
+		if (i + 1 >= argc || argv[i + 1] == nullptr) {
+			ShowError("Missing value for option '--sim-%s'.\n", arg);
+			exit(1);
+		}
+
+		const char* value = argv[i + 1];
+
+		if (strcmp(arg, "scenario") == 0) {
+			int32 scenario;
+
+			for (scenario = 0; scenario < SIM_SCENARIO_MAX; scenario++) {
+				if (strcmp(value, simulator_scenario_names[scenario]) == 0)
+					break;
+			}
+
+			if (scenario == SIM_SCENARIO_MAX) {
+				ShowError("Unknown simulator scenario '%s', use one of farm, clash or crowd.\n", value);
+				exit(1);
+			}
+
+			sim_options.scenario = static_cast<e_simulator_scenario>(scenario);
+		} else if (strcmp(arg, "players") == 0) {
+			sim_options.players = cap_value(atoi(value), 0, MAXCONN / 2);
+		} else if (strcmp(arg, "mobs") == 0) {
+			sim_options.mobs = i32max(atoi(value), 0);
+		} else if (strcmp(arg, "mob-id") == 0) {
+			sim_options.mob_id = atoi(value);
+		} else if (strcmp(arg, "ticks") == 0) {
+			sim_options.ticks = i32max(atoi(value), 1);
+		} else if (strcmp(arg, "tick-interval") == 0) {
+			sim_options.tick_interval = i32max(atoi(value), 1);
+		} else if (strcmp(arg, "think-interval") == 0) {
+			sim_options.think_interval = i32max(atoi(value), 1);
+		} else if (strcmp(arg, "area") == 0) {
+			sim_options.area = i32max(atoi(value), 1);
+		} else if (strcmp(arg, "seed") == 0) {
+			sim_options.seed = strtoull(value, nullptr, 10);
+		} else if (strcmp(arg, "map") == 0) {
+			sim_options.map = value;
+		} else if (strcmp(arg, "report") == 0) {
+			sim_options.report = value;
+		} else {
+			ShowError("Unknown simulator option '--sim-%s'.\n", arg);
+			exit(1);
+		}
+
+		// clear option and its value
+		argv[i] = nullptr;
+		argv[++i] = nullptr;
+	}
+
+	return 1;
+}
+
+/// Discards everything the map-server sends to a simulated client
+static int32 simulator_client_send(int32 fd) {
+	sim_stats.client_bytes += session[fd]->wdata_size;
+	session[fd]->wdata_size = 0;
+	return 0;
+}
+
+/// Handles the disconnection of a simulated client, the same way clif_parse does
+static int32 simulator_client_parse(int32 fd) {
+	if (!session[fd]->flag.eof)
+		return 0;
+
+	map_session_data* sd = (map_session_data*)session[fd]->session_data;
+
+	if (sd != nullptr)
+		map_quit(sd);
+
+	do_close(fd);
+	return 0;
+}
+
+/// Discards everything the map-server sends to the char-server, replies are fed by the simulator itself
+static int32 simulator_charserver_send(int32 fd) {
+	sim_stats.charserver_bytes += session[fd]->wdata_size;
+	session[fd]->wdata_size = 0;
+	return 0;
+}
+
+/**
+ * Feeds a reply into the char-server link and lets the regular chrif/intif handlers process it
+ * @param buf: Packet data
+ * @param len: Packet length
+ */
+static void simulator_charserver_reply(const uint8* buf, size_t len) {
+	int32 fd = sim_charserver_fd;
+
+	if (RFIFOSPACE(fd) < len)
+		realloc_fifo(fd, static_cast<uint32>(session[fd]->rdata_size + len), static_cast<uint32>(session[fd]->max_wdata));
+
+	memcpy(session[fd]->rdata + session[fd]->rdata_size, buf, len);
+	session[fd]->rdata_size += len;
+
+	chrif_parse(fd);
+	RFIFOFLUSH(fd);
+}
+
+/**
+ * Disconnects a simulated client right away.
+ * Local sessions lie above fd_max, so the socket loop never parses them and the parse function is run here.
+ * @param fd: Local session of the client
+ */
+static void simulator_disconnect(int32 fd) {
+	if (session[fd] == nullptr)
+		return;
+
+	set_eof(fd);
+	session[fd]->func_parse(fd);
+}
+
+/**
+ * Finds a walkable cell around the given position
+ * @return true if a cell was found
+ */
+static bool simulator_freecell(int16 x, int16 y, int16 range, int16& out_x, int16& out_y) {
+	out_x = x;
+	out_y = y;
+
+	return map_search_freecell(nullptr, sim_m, &out_x, &out_y, range, range, 1) != 0;
+}
+
+/**
+ * Logs in a simulated character, going through the same steps a client and the char-server would
+ * @param index: Index of the character
+ * @return true on success
+ */
+static bool simulator_login(int32 index) {
+	uint32 account_id = SIM_START_ACCOUNT_ID + index;
+	uint32 char_id = SIM_START_CHAR_ID + index;
+	int16 x, y;
+
+	switch (sim_options.scenario) {
+		case SIM_SCENARIO_CLASH:
+			// Both teams start on opposite sides of the area
+			if (!simulator_freecell(sim_x + (index % 2 ? sim_options.area : -sim_options.area) / 2, sim_y, sim_options.area / 2, x, y))
+				return false;
+			break;
+		default:
+			if (!simulator_freecell(sim_x, sim_y, sim_options.area, x, y))
+				return false;
+			break;
+	}
+
+	int32 fd = make_local_session(simulator_client_send, simulator_client_parse);
+
+	if (fd < 0)
+		return false;
+
+	// Client connection (see clif_parse_WantToConnection)
+	map_session_data* sd;
+
+	CREATE(sd, TBL_PC, 1);
+	new(sd) map_session_data();
+	sd->fd = fd;
+	session[fd]->session_data = sd;
+
+	pc_setnewpc(sd, account_id, char_id, index, gettick(), SEX_MALE, fd);
+	chrif_authreq(sd, false);
+
+	// Character data from the char-server
+	struct mmo_charstatus* status;
+
+	CREATE(status, struct mmo_charstatus, 1);
+	status->account_id = account_id;
+	status->char_id = char_id;
+	status->sex = SEX_MALE;
+	status->class_ = JOB_KNIGHT;
+	status->base_level = 99;
+	status->job_level = 50;
+	status->str = status->agi = status->vit = status->int_ = status->dex = status->luk = 80;
+	status->hp = status->max_hp = 40;
+	status->sp = status->max_sp = 11;
+	status->hair = 1;
+	safesnprintf(status->name, sizeof(status->name), "Sim%d", index);
+	mapindex_getmapname_ext(map_getmapdata(sim_m)->name, status->last_point.map);
+	status->last_point.x = x;
+	status->last_point.y = y;
+	memcpy(&status->save_point, &status->last_point, sizeof(status->save_point));
+
+	uint16 skill_idx = skill_get_index(SM_MAGNUM);
+
+	status->skill[skill_idx].id = SM_MAGNUM;
+	status->skill[skill_idx].lv = 10;
+	status->skill[skill_idx].flag = SKILL_FLAG_PERMANENT;
+
+	struct PACKET_WZ_AUTH_OK* auth;
+
+	CREATE(auth, struct PACKET_WZ_AUTH_OK, 1);
+	inter_packet_auth_ok(*auth, account_id, sd->login_id1, 0, 0, 0, false, false, *status);
+	simulator_charserver_reply((uint8*)auth, auth->packetLength);
+	aFree(auth);
+	aFree(status);
+
+	if (map_id2sd(account_id) != sd) {
+		// Frees the character, unless the failed authentication already did
+		chrif_auth_delete(account_id, char_id, ST_LOGIN);
+		simulator_disconnect(fd);
+		return false;
+	}
+
+	// Empty registries, the last packet of a registry carries its type
+	for (uint8 type = 1; type <= 3; type++) {
+		uint8 reg[INTER_PACKET_REGISTRY_HEADER];
+
+		inter_packet_registry_header(reg, account_id, char_id, false);
+		WBUFB(reg, 12) = type;
+		simulator_charserver_reply(reg, sizeof(reg));
+	}
+
+	// Empty inventory, cart and storage
+	struct PACKET_IZ_STORAGE_DATA* storage;
+
+	CREATE(storage, struct PACKET_IZ_STORAGE_DATA, 1);
+
+	for (uint8 type : { TABLE_STORAGE, TABLE_CART, TABLE_INVENTORY }) {
+		inter_packet_storage_data(*storage, type, account_id, true);
+		simulator_charserver_reply((uint8*)storage, storage->packetLength);
+	}
+
+	aFree(storage);
+
+	// No status changes
+	uint8 scdata[INTER_PACKET_SCDATA_HEADER];
+
+	simulator_charserver_reply(scdata, inter_packet_scdata_header(scdata, account_id, char_id, 0));
+
+	// Client finished loading the map
+	clif_parse_LoadEndAck(fd, sd);
+
+	status_percent_heal(sd, 100, 100);
+
+	s_simulator_player player = {};
+
+	player.fd = fd;
+	player.account_id = account_id;
+	player.char_id = char_id;
+	// Spread the decisions of the players over the think interval
+	player.next_think = gettick() + rnd_bounded(sim_options.think_interval);
+
+	sim_players.push_back(player);
+	sim_stats.logins++;
+
+	return true;
+}
+
+/**
+ * Logs out a simulated character, going through the same steps a disconnecting client and the char-server would
+ * @param player: Simulated player
+ */
+static void simulator_logout(const s_simulator_player& player) {
+	if (!session_isActive(player.fd))
+		return;
+
+	simulator_disconnect(player.fd);
+
+	// The char-server acknowledges the final save, which frees the character
+	uint8 ack[10];
+
+	WBUFW(ack, 0) = 0x2b21;
+	WBUFL(ack, 2) = player.account_id;
+	WBUFL(ack, 6) = player.char_id;
+	simulator_charserver_reply(ack, sizeof(ack));
+}
+
+/// Keeps the amount of monsters on the map at the configured level
+static void simulator_spawn() {
+	int32 alive = map_foreachinmap([](block_list* bl, va_list ap) -> int32 {
+		return status_isdead(*bl) ? 0 : 1;
+	}, sim_m, BL_MOB);
+
+	for (; alive < sim_options.mobs; alive++) {
+		int16 x, y;
+
+		if (!simulator_freecell(sim_x, sim_y, sim_options.area, x, y))
+			break;
+
+		if (mob_once_spawn(nullptr, sim_m, x, y, "--ja--", sim_options.mob_id, 1, "", SZ_SMALL, AI_NONE) == 0)
+			break;
+
+		sim_stats.mobs_spawned++;
+	}
+}
+
+/**
+ * Looks for the closest living unit of the given type
+ * @param sd: Player looking for a target
+ * @param type: Block list type of the target
+ * @param range: Search range
+ * @param found_distance: Distance to the found target
+ * @return closest target or nullptr
+ */
+static block_list* simulator_closest(map_session_data* sd, int32 type, int16 range, int32& found_distance) {
+	block_list* target = nullptr;
+
+	found_distance = range + 1;
+
+	map_foreachinallrange([](block_list* bl, va_list ap) -> int32 {
+		map_session_data* sd = va_arg(ap, map_session_data*);
+		block_list** target = va_arg(ap, block_list**);
+		int32* best = va_arg(ap, int32*);
+
+		if (bl == sd || status_isdead(*bl))
+			return 0;
+
+		// Players only fight members of the other team
+		if (bl->type == BL_PC && (bl->id % 2) == (sd->id % 2))
+			return 0;
+
+		int32 d = distance_bl(sd, bl);
+
+		// Tie break on the id, so the choice does not depend on the block order
+		if (d < *best || (d == *best && *target != nullptr && bl->id < (*target)->id)) {
+			*target = bl;
+			*best = d;
+		}
+
+		return 1;
+	}, sd, range, type, sd, &target, &found_distance);
+
+	return target;
+}
+
+/// Player clearing monsters with Magnum Break and normal attacks
+static void simulator_think_farm(map_session_data* sd, t_tick tick) {
+	int32 distance;
+	block_list* target = simulator_closest(sd, BL_MOB, sim_options.area, distance);
+
+	if (target == nullptr)
+		return;
+
+	if (distance <= 2 && sd->battle_status.sp >= static_cast<uint32>(skill_get_sp(SM_MAGNUM, 10))) {
+		if (unit_skilluse_id(sd, sd->id, SM_MAGNUM, 10))
+			sim_stats.skills++;
+	} else if (sd->ud.target != target->id) {
+		unit_attack(sd, target->id, 1);
+		sim_stats.attacks++;
+	}
+
+	if (sd->battle_status.sp < sd->battle_status.max_sp / 4)
+		status_percent_heal(sd, 0, 100);
+}
+
+/// Two teams fighting each other
+static void simulator_think_clash(map_session_data* sd, t_tick tick) {
+	int32 distance;
+	block_list* target = simulator_closest(sd, BL_PC, sim_options.area * 2, distance);
+
+	if (target == nullptr)
+		return;
+
+	if (distance <= 2 && sd->battle_status.sp >= static_cast<uint32>(skill_get_sp(SM_MAGNUM, 10)) && rnd_chance(1, 3)) {
+		if (unit_skilluse_id(sd, sd->id, SM_MAGNUM, 10))
+			sim_stats.skills++;
+	} else if (sd->ud.target != target->id) {
+		unit_attack(sd, target->id, 1);
+		sim_stats.attacks++;
+	}
+
+	if (sd->battle_status.sp < sd->battle_status.max_sp / 4)
+		status_percent_heal(sd, 0, 100);
+}
+
+/// Players walking around town, chatting and emoting
+static void simulator_think_crowd(map_session_data* sd, t_tick tick) {
+	int32 action = rnd_bounded(100);
+
+	if (action < 5) {
+		clif_emotion(*sd, static_cast<emotion_type>(rnd_bounded(ET_MAX)));
+		sim_stats.emotes++;
+	} else if (action < 10) {
+		char message[CHAT_SIZE_MAX];
+
+		safesnprintf(message, sizeof(message), "%s : simulated chat %d", sd->status.name, rnd_bounded(1000));
+		clif_GlobalMessage(*sd, message, AREA_CHAT_WOC);
+		sim_stats.chats++;
+	} else if (action < 60 && !unit_is_walking(sd)) {
+		int16 x, y;
+
+		if (simulator_freecell(sd->x, sd->y, 10, x, y) && unit_walktoxy(sd, x, y, 4))
+			sim_stats.walks++;
+	}
+}
+
+/// Runs the decisions of all simulated players that are due
+static void simulator_think(t_tick tick) {
+	for (s_simulator_player& player : sim_players) {
+		if (DIFF_TICK(tick, player.next_think) < 0)
+			continue;
+
+		player.next_think = tick + sim_options.think_interval;
+
+		map_session_data* sd = map_id2sd(player.account_id);
+
+		if (sd == nullptr || sd->prev == nullptr)
+			continue;
+
+		if (pc_isdead(sd)) {
+			if (status_revive(sd, 100, 100))
+				sim_stats.revives++;
+			continue;
+		}
+
+		switch (sim_options.scenario) {
+			case SIM_SCENARIO_FARM:
+				simulator_think_farm(sd, tick);
+				break;
+			case SIM_SCENARIO_CLASH:
+				simulator_think_clash(sd, tick);
+				break;
+			case SIM_SCENARIO_CROWD:
+				simulator_think_crowd(sd, tick);
+				break;
+		}
+	}
+}
+
+/// Prints the report and writes it to the report file, if one was configured
+static void simulator_report(std::chrono::steady_clock::duration total) {
+	std::vector<std::string> lines;
+	char line[256];
+
+	safesnprintf(line, sizeof(line), "scenario: %s", simulator_scenario_names[sim_options.scenario]);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "map: %s", map_getmapdata(sim_m)->name);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "seed: %" PRIu64, sim_options.seed);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "ticks: %d x %d ms", sim_options.ticks, sim_options.tick_interval);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "players: %" PRIu64 " / %d", sim_stats.logins, sim_options.players);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "mobs spawned: %" PRIu64, sim_stats.mobs_spawned);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "actions: %" PRIu64 " attacks, %" PRIu64 " skills, %" PRIu64 " walks, %" PRIu64 " emotes, %" PRIu64 " chats, %" PRIu64 " revives",
+		sim_stats.attacks, sim_stats.skills, sim_stats.walks, sim_stats.emotes, sim_stats.chats, sim_stats.revives);
+	lines.push_back(line);
+	safesnprintf(line, sizeof(line), "traffic: %" PRIu64 " bytes to clients, %" PRIu64 " bytes to char-server", sim_stats.client_bytes, sim_stats.charserver_bytes);
+	lines.push_back(line);
+
+	double total_ms = std::chrono::duration<double, std::milli>(total).count();
+
+	for (int32 i = 0; i < SIM_SECTION_MAX; i++) {
+		double ms = std::chrono::duration<double, std::milli>(sim_stats.time[i]).count();
+
+		safesnprintf(line, sizeof(line), "%-10s %12.3f ms %10.3f us/tick %6.2f %%", simulator_section_names[i], ms, ms * 1000 / sim_options.ticks, total_ms > 0 ? ms * 100 / total_ms : 0.);
+		lines.push_back(line);
+	}
+
+	safesnprintf(line, sizeof(line), "%-10s %12.3f ms %10.3f us/tick", "total", total_ms, total_ms * 1000 / sim_options.ticks);
+	lines.push_back(line);
+
+	// Breakdown of the timers section
+	std::vector<std::string> timers;
+
+	profiler_report(PROFILE_TIMER, SIM_REPORT_TIMER_FUNCS, timers);
+
+	for (const std::string& entry : timers)
+		lines.push_back("timer " + entry);
+
+	for (const std::string& entry : lines)
+		ShowInfo("Simulator %s\n", entry.c_str());
+
+	if (sim_options.report.empty())
+		return;
+
+	FILE* fp = fopen(sim_options.report.c_str(), "w");
+
+	if (fp == nullptr) {
+		ShowError("Could not open simulator report file '%s'.\n", sim_options.report.c_str());
+		return;
+	}
+
+	for (const std::string& entry : lines)
+		fprintf(fp, "%s\n", entry.c_str());
+
+	fclose(fp);
+	ShowStatus("Simulator report written to '" CL_WHITE "%s" CL_RESET "'.\n", sim_options.report.c_str());
+}
+
+/**
+ * Runs the configured scenario on a virtual clock and reports the time spent per subsystem
+ */
+void simulator_run() {
+	const char* mapname = sim_options.map.empty() ? simulator_scenario_maps[sim_options.scenario] : sim_options.map.c_str();
+
+	sim_m = map_mapname2mapid(mapname);
+
+	if (sim_m < 0) {
+		ShowError("simulator_run: Map '%s' is not loaded.\n", mapname);
+		return;
+	}
+
+	struct map_data* mapdata = map_getmapdata(sim_m);
+
+	sim_x = mapdata->xs / 2;
+	sim_y = mapdata->ys / 2;
+
+	if (sim_options.scenario == SIM_SCENARIO_CLASH)
+		map_setmapflag(sim_m, MF_PVP, true);
+
+	sim_charserver_fd = make_local_session(simulator_charserver_send, chrif_parse);
+
+	if (sim_charserver_fd < 0)
+		return;
+
+	chrif_local_link(sim_charserver_fd);
+
+	rnd_seed(sim_options.seed);
+	timer_virtual_clock(gettick());
+
+	ShowStatus("Simulating scenario '" CL_WHITE "%s" CL_RESET "' on '" CL_WHITE "%s" CL_RESET "' with %d players and %d monsters for %d ticks...\n",
+		simulator_scenario_names[sim_options.scenario], mapdata->name, sim_options.players, sim_options.mobs, sim_options.ticks);
+
+	for (int32 i = 0; i < sim_options.players; i++) {
+		if (!simulator_login(i)) {
+			ShowWarning("simulator_run: Failed to log in simulated player %d.\n", i);
+			break;
+		}
+	}
+
+	send_shortlist_do_sends();
+	memset(&sim_stats.time, 0, sizeof(sim_stats.time));
+
+	// Times the timer functions, only the simulated ticks are reported
+	bool profiling = profiler_enabled;
+
+	profiler_enabled = true;
+	profiler_reset();
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int32 i = 0; i < sim_options.ticks; i++) {
+		timer_virtual_advance(sim_options.tick_interval);
+
+		t_tick tick = gettick();
+		auto begin = std::chrono::steady_clock::now();
+
+		simulator_spawn();
+
+		auto spawned = std::chrono::steady_clock::now();
+
+		simulator_think(tick);
+
+		auto thought = std::chrono::steady_clock::now();
+
+		do_timer(tick);
+
+		auto timers = std::chrono::steady_clock::now();
+
+		send_shortlist_do_sends();
+
+		auto end = std::chrono::steady_clock::now();
+
+		sim_stats.time[SIM_SECTION_SPAWN] += spawned - begin;
+		sim_stats.time[SIM_SECTION_SCENARIO] += thought - spawned;
+		sim_stats.time[SIM_SECTION_TIMERS] += timers - thought;
+		sim_stats.time[SIM_SECTION_NETWORK] += end - timers;
+
+		profiler_tick_end();
+	}
+
+	simulator_report(std::chrono::steady_clock::now() - start);
+
+	profiler_enabled = profiling;
+
+	// Log everyone out again, so the regular shutdown does not have to deal with them
+	for (const s_simulator_player& player : sim_players)
+		simulator_logout(player);
+
+	send_shortlist_do_sends();
+	sim_players.clear();
+}
+
+#endif // ifdef MAP_SIMULATOR
@@ -0,0 +1,22 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <config/core.hpp>
+
+#ifdef MAP_SIMULATOR
+#include <common/cbasetypes.hpp>
+
+enum e_simulator_scenario : uint8 {
+	SIM_SCENARIO_FARM = 0,	// AoE farming, players clearing packs of monsters with Magnum Break
+	SIM_SCENARIO_CLASH,		// WoE clash, two teams fighting each other on a PvP map
+	SIM_SCENARIO_CROWD,		// Town crowd, players walking around, chatting and emoting
+	SIM_SCENARIO_MAX
+};
+
+int32 simulator_get_options(int32 argc, char** argv);
+void simulator_run();
+#endif // ifdef MAP_SIMULATOR
+#endif /* SIMULATOR_HPP */
@@ -3978,10 +3978,10 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			if(sd->inventory_data[index]->script && (pc_has_permission(sd,PC_PERM_USE_ALL_EQUIPMENT) || !itemdb_isNoEquip(sd->inventory_data[index],sd->m))) {
 				if (wd == &sd->left_weapon) {
 					sd->state.lr_flag = LR_FLAG_WEAPON;
-					run_script(sd->inventory_data[index]->script,0,sd->id,0);
+					run_bonus_script(sd->inventory_data[index]->script, sd);
 					sd->state.lr_flag = LR_FLAG_NONE;
 				} else
-					run_script(sd->inventory_data[index]->script,0,sd->id,0);
+					run_bonus_script(sd->inventory_data[index]->script, sd);
 				if (!calculating) // Abort, run_script retriggered this. [Skotlex]
 					return 1;
 			}
@@ -4012,7 +4012,7 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			if(sd->inventory_data[index]->script && (pc_has_permission(sd,PC_PERM_USE_ALL_EQUIPMENT) || !itemdb_isNoEquip(sd->inventory_data[index],sd->m))) {
 				if( i == EQI_HAND_L ) // Shield
 					sd->state.lr_flag = LR_FLAG_SHIELD;
-				run_script(sd->inventory_data[index]->script,0,sd->id,0);
+				run_bonus_script(sd->inventory_data[index]->script, sd);
 				if( i == EQI_HAND_L ) // Shield
 					sd->state.lr_flag = LR_FLAG_NONE;
 				if (!calculating) // Abort, run_script retriggered this. [Skotlex]
@@ -4020,7 +4020,7 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			}
 		} else if( sd->inventory_data[index]->type == IT_SHADOWGEAR ) { // Shadow System
 			if (sd->inventory_data[index]->script && (pc_has_permission(sd,PC_PERM_USE_ALL_EQUIPMENT) || !itemdb_isNoEquip(sd->inventory_data[index],sd->m))) {
-				run_script(sd->inventory_data[index]->script,0,sd->id,0);
+				run_bonus_script(sd->inventory_data[index]->script, sd);
 				if( !calculating )
 					return 1;
 			}
@@ -4033,7 +4033,7 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			sd->bonus.arrow_atk += sd->inventory_data[index]->atk;
 			sd->state.lr_flag = LR_FLAG_ARROW;
 			if( !itemdb_group.item_exists(IG_THROWABLE, sd->inventory_data[index]->nameid) ) // Don't run scripts on throwable items
-				run_script(sd->inventory_data[index]->script,0,sd->id,0);
+				run_bonus_script(sd->inventory_data[index]->script, sd);
 			sd->state.lr_flag = LR_FLAG_NONE;
 			if (!calculating) // Abort, run_script retriggered status_calc_pc. [Skotlex]
 				return 1;
@@ -4070,7 +4070,7 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			if (no_run)
 				continue;
 
-			run_script(combo->bonus, 0, sd->id, 0);
+			run_bonus_script(combo->bonus, sd);
 
 			if (!calculating) // Abort, run_script retriggered this
 				return 1;
@@ -4121,10 +4121,10 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 					continue;
 				if(i == EQI_HAND_L && sd->inventory.u.items_inventory[index].equip == EQP_HAND_L) { // Left hand status.
 					sd->state.lr_flag = LR_FLAG_WEAPON;
-					run_script(data->script,0,sd->id,0);
+					run_bonus_script(data->script, sd);
 					sd->state.lr_flag = LR_FLAG_NONE;
 				} else
-					run_script(data->script,0,sd->id,0);
+					run_bonus_script(data->script, sd);
 				if (!calculating) // Abort, run_script his function. [Skotlex]
 					return 1;
 			}
@@ -4161,11 +4161,11 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 					continue;
 				if (i == EQI_HAND_L && sd->inventory.u.items_inventory[index].equip == EQP_HAND_L) { // Left hand status.
 					sd->state.lr_flag = LR_FLAG_WEAPON;
-					run_script(data->script, 0, sd->id, 0);
+					run_bonus_script(data->script, sd);
 					sd->state.lr_flag = LR_FLAG_NONE;
 				}
 				else
-					run_script(data->script, 0, sd->id, 0);
+					run_bonus_script(data->script, sd);
 				if (!calculating)
 					return 1;
 			}
@@ -4178,12 +4178,12 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 			std::shared_ptr<item_data> data = item_db.find(sc->getSCE(SC_ITEMSCRIPT)->val1);
 
 			if (data && data->script)
-				run_script(data->script, 0, sd->id, 0);
+				run_bonus_script(data->script, sd);
 		}
 
 		for( const auto& it : *sc ){
 			if( std::shared_ptr<s_status_change_db> scdb = status_db.find( it.first ); scdb != nullptr && scdb->script != nullptr ){
-				run_script( scdb->script, 0, sd->id, 0 );
+				run_bonus_script( scdb->script, sd );
 			}
 		}
 	}
@@ -4195,7 +4195,7 @@ int32 status_calc_pc_sub(map_session_data* sd, uint8 opt)
 		std::shared_ptr<s_pet_db> pet_db_ptr = pd->get_pet_db();
 
 		if (pet_db_ptr != nullptr && pet_db_ptr->pet_bonus_script)
-			run_script(pet_db_ptr->pet_bonus_script,0,sd->id,0);
+			run_bonus_script(pet_db_ptr->pet_bonus_script, sd);
 		if (pet_db_ptr != nullptr && pd->pet.intimate > 0 && (!battle_config.pet_equip_required || pd->pet.equip > 0) && pd->state.skillbonus == 1 && pd->bonus)
 			pc_bonus(sd,pd->bonus->type, pd->bonus->val);
 	}
@@ -9238,15 +9238,17 @@ int32 status_get_emblem_id(block_list *bl)
  * @param bl: Object whose race2 to get [MOB|PET]
  * @return race2
  */
-std::vector<e_race2> status_get_race2(block_list *bl)
+const std::vector<e_race2>& status_get_race2(block_list *bl)
 {
-	nullpo_retr(std::vector<e_race2>(),bl);
+	static const std::vector<e_race2> none;
+
+	nullpo_retr(none,bl);
 
 	if (bl->type == BL_MOB)
 		return ((mob_data *)bl)->db->race2;
 	if (bl->type == BL_PET)
 		return ((pet_data *)bl)->db->race2;
-	return std::vector<e_race2>();
+	return none;
 }
 
 /**
@@ -9846,7 +9848,7 @@ t_tick status_get_sc_def(block_list *src, block_list *bl, sc_type type, int32 ra
 			break;
 		default:
 			// Effect that cannot be reduced? Likely a buff.
-			if (!(rnd()%10000 < rate))
+			if (!(rnd_bounded(10000, RND_STREAM_SKILL) < rate))
 				return 0;
 			return tick ? tick : 1;
 	}
@@ -9936,7 +9938,7 @@ t_tick status_get_sc_def(block_list *src, block_list *bl, sc_type type, int32 ra
 	// Cap minimum rate
 	rate = max(rate, scdb->min_rate);
 
-	if (rate < 10000 && (rate <= 0 || !(rnd()%10000 < rate)))
+	if (rate < 10000 && (rate <= 0 || !(rnd_bounded(10000, RND_STREAM_SKILL) < rate)))
 		return 0;
 
 	// Duration cannot be reduced
@@ -16346,7 +16348,7 @@ uint64 StatusDatabase::parseBodyNode(const ryml::NodeRef& node) {
 			status->script = nullptr;
 		}
 
-		status->script = parse_script( script.c_str(), this->getCurrentFile().c_str(), this->getLineNumber(node["Script"]), SCRIPT_IGNORE_EXTERNAL_BRACKETS );
+		status->script = parse_script( script.c_str(), this->getCurrentFile().c_str(), this->getLineNumber(node["Script"]), SCRIPT_IGNORE_EXTERNAL_BRACKETS|SCRIPT_BONUS );
 	}else{
 		if( !exists ){
 			status->script = nullptr;
@@ -3631,7 +3631,7 @@ unsigned char status_calc_attack_element(block_list *bl, status_change *sc, int3
 int32 status_get_party_id(block_list *bl);
 int32 status_get_guild_id(block_list *bl);
 int32 status_get_emblem_id(block_list *bl);
-std::vector<e_race2> status_get_race2(block_list *bl);
+const std::vector<e_race2>& status_get_race2(block_list *bl);
 
 struct view_data *status_get_viewdata(block_list *bl);
 void status_set_viewdata(block_list *bl, int32 class_);
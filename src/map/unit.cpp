@@ -5,6 +5,8 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <unordered_map>
+#include <vector>
 
 #include <common/db.hpp>
 #include <common/ers.hpp>  // ers_destroy
@@ -73,8 +75,80 @@ const int16 diry[DIR_MAX]={1,1,0,-1,-1,-1,0,1}; ///lookup to know where will mov
 //early declaration
 static TIMER_FUNC(unit_attack_timer);
 static TIMER_FUNC(unit_walktoxy_timer);
+static TIMER_FUNC(unit_walk_batch_timer);
 int32 unit_unattackable(block_list *bl);
 
+/// Steps finishing at the same tick share one timer: tick -> (unit id, step token)
+static std::unordered_map<t_tick, std::vector<std::pair<int32, int32>>> unit_walk_steps;
+/// Last handed out step token, stored in unit_data::walktimer while walking
+static int32 unit_walk_token = 0;
+
+/**
+ * Schedules the end of a unit's current step
+ * All units finishing a step on the same tick are processed by a single timer
+ * @param bl: Walking unit
+ * @param ud: Unit data of bl
+ * @param tick: Tick at which the step finishes
+ * @param speed: Duration of the step
+ * @return Step token to be stored in ud.walktimer
+ */
+static int32 unit_walk_schedule(block_list& bl, unit_data& ud, t_tick tick, int32 speed)
+{
+	std::vector<std::pair<int32, int32>>& steps = unit_walk_steps[tick];
+
+	if (steps.empty())
+		add_timer(tick, unit_walk_batch_timer, 0, static_cast<intptr_t>(tick));
+
+	// Tokens stay positive, so they never collide with INVALID_TIMER or CLIF_WALK_TIMER
+	if (unit_walk_token == INT32_MAX)
+		unit_walk_token = 1;
+	else
+		unit_walk_token++;
+
+	steps.emplace_back(bl.id, unit_walk_token);
+	ud.walk_tick = tick;
+	ud.walk_speed = speed;
+
+	return unit_walk_token;
+}
+
+/**
+ * Finishes the steps of all units scheduled for a tick
+ * Steps that were cancelled or rescheduled in the meantime are skipped
+ * @param tid: Timer ID
+ * @param tick: Current tick
+ * @param id: Unused
+ * @param data: Tick the steps were scheduled for
+ * @return 0
+ */
+static TIMER_FUNC(unit_walk_batch_timer)
+{
+	auto it = unit_walk_steps.find(static_cast<t_tick>(data));
+
+	if (it == unit_walk_steps.end())
+		return 0;
+
+	std::vector<std::pair<int32, int32>> steps = std::move(it->second);
+
+	unit_walk_steps.erase(it);
+
+	for (const auto& step : steps) {
+		block_list* bl = map_id2bl(step.first);
+
+		if (bl == nullptr)
+			continue;
+
+		unit_data* ud = unit_bl2ud(bl);
+
+		if (ud == nullptr || ud->walktimer != step.second)
+			continue;
+
+		unit_walktoxy_timer(step.second, tick, step.first, ud->walk_speed);
+	}
+
+	return 0;
+}
+
 /**
  * Get the unit_data related to the bl
  * @param bl : Object to get the unit_data from
@@ -226,12 +300,8 @@ bool unit_walktoxy_nextcell(block_list& bl, bool sendMove, t_tick tick) {
 	else
 		speed = status_get_speed(&bl);
 
-	// Make sure there is no active walktimer
-	if (ud->walktimer != INVALID_TIMER) {
-		delete_timer(ud->walktimer, unit_walktoxy_timer);
-		ud->walktimer = INVALID_TIMER;
-	}
-	ud->walktimer = add_timer(tick + speed, unit_walktoxy_timer, bl.id, speed);
+	// Replaces any active step, the old one is skipped by unit_walk_batch_timer
+	ud->walktimer = unit_walk_schedule(bl, *ud, tick + speed, speed);
 
 	// Resend move packet when unit was damaged recently
 	if (sendMove || DIFF_TICK(tick, ud->dmg_tick) < MOVE_REFRESH_TIME) {
@@ -530,7 +600,8 @@ int32 unit_walktoxy_ontouch(block_list *bl, va_list ap)
 /**
  * Defines when to refresh the walking character to object and restart the timer if applicable
  * Also checks for speed update, target location, and slave teleport timers
- * @param tid: Timer ID
+ * Called by unit_walk_batch_timer when the current step finishes
+ * @param tid: Step token, see unit_walk_schedule
  * @param tick: Current tick to decide next timer update
  * @param data: Data used in timer calls
  * @return 0 or unit_walktoxy_sub() or unit_walktoxy()
@@ -1546,16 +1617,11 @@ void unit_data::update_pos(t_tick tick)
 	if (this->walkpath.path_pos >= this->walkpath.path_len)
 		return;
 
-	if (this->walktimer == INVALID_TIMER)
+	if (this->walktimer == INVALID_TIMER || this->walktimer == CLIF_WALK_TIMER || this->walk_speed <= 0)
 		return;
 
-	const TimerData* td = get_timer(this->walktimer);
-
-	if (td == nullptr)
-		return;
-
-	// Get how much percent we traversed on the timer
-	double cell_percent = 1.0 - ((double)DIFF_TICK(td->tick, tick) / (double)td->data);
+	// Get how much percent we traversed on the step
+	double cell_percent = 1.0 - ((double)DIFF_TICK(this->walk_tick, tick) / (double)this->walk_speed);
 
 	if (cell_percent > 0.0 && cell_percent < 1.0) {
 		// Set subcell coordinates according to timer
@@ -1689,7 +1755,6 @@ void unit_stop_walking_soon(block_list& bl, t_tick tick)
  * @return Success(true); Failed(false);
  */
 bool unit_stop_walking( block_list* bl, int32 type, t_tick canmove_delay ){
-	const struct TimerData* td = nullptr;
 	t_tick tick;
 
 	if( bl == nullptr ){
@@ -1707,19 +1772,15 @@ bool unit_stop_walking( block_list* bl, int32 type, t_tick canmove_delay ){
 	if (!(type&USW_FORCE_STOP) && ud->walktimer == INVALID_TIMER)
 		return false;
 
-	// NOTE: We are using timer data after deleting it because we know the
-	// delete_timer function does not mess with it. If the function's
-	// behaviour changes in the future, this code could break!
-	if (ud->walktimer != INVALID_TIMER) {
-		td = get_timer(ud->walktimer);
-		delete_timer(ud->walktimer, unit_walktoxy_timer);
-		ud->walktimer = INVALID_TIMER;
-	}
+	// The pending step is skipped by unit_walk_batch_timer once the token is reset
+	bool stepping = ud->walktimer != INVALID_TIMER && ud->walktimer != CLIF_WALK_TIMER;
+
+	ud->walktimer = INVALID_TIMER;
 	ud->state.change_walk_target = 0;
 	tick = gettick();
 
 	if( (type&USW_MOVE_ONCE && !ud->walkpath.path_pos) // Force moving at least one cell.
-	||  (type&USW_MOVE_FULL_CELL && td && DIFF_TICK(td->tick, tick) <= td->data/2) // Enough time has passed to cover half-cell
+	||  (type&USW_MOVE_FULL_CELL && stepping && DIFF_TICK(ud->walk_tick, tick) <= ud->walk_speed/2) // Enough time has passed to cover half-cell
 	) {
 		ud->walkpath.path_len = ud->walkpath.path_pos+1;
 		unit_walktoxy_timer(INVALID_TIMER, tick, bl->id, ud->walkpath.path_pos);
@@ -4279,7 +4340,7 @@ void unit_addshadowscar(unit_data &ud, int32 interval) {
  */
 void do_init_unit(void){
 	add_timer_func_list(unit_attack_timer,  "unit_attack_timer");
-	add_timer_func_list(unit_walktoxy_timer,"unit_walktoxy_timer");
+	add_timer_func_list(unit_walk_batch_timer,"unit_walk_batch_timer");
 	add_timer_func_list(unit_walktobl_sub, "unit_walktobl_sub");
 	add_timer_func_list(unit_delay_walktoxy_timer,"unit_delay_walktoxy_timer");
 	add_timer_func_list(unit_delay_walktobl_timer,"unit_delay_walktobl_timer");
@@ -4294,5 +4355,5 @@ void do_init_unit(void){
  * @return 0
  */
 void do_final_unit(void){
-	// Nothing to do
+	unit_walk_steps.clear();
 }
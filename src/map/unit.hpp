@@ -35,7 +35,9 @@ struct unit_data {
 	int32 target;
 	int32 target_to;
 	int32 attacktimer;
-	int32 walktimer;
+	int32 walktimer; ///< Step token of the current step, see unit_walk_schedule
+	t_tick walk_tick; ///< Tick at which the current step finishes
+	int32 walk_speed; ///< Duration of the current step
 	int32 chaserange;
 	bool stepaction; //Action should be executed on step [Playtester]
 	int32 steptimer; //Timer that triggers the action [Playtester]
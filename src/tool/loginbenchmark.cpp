@@ -0,0 +1,214 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <common/core.hpp>
+#include <common/metrics.hpp>
+#include <common/showmsg.hpp>
+#include <common/strlib.hpp>
+#include <common/timer.hpp>
+
+#include "../login/accountdb/AccountDbSql.hpp"
+
+using namespace rathena::server_core;
+
+namespace rathena::tool_loginbenchmark {
+class LoginBenchmarkTool : public Core{
+	protected:
+		bool initialize( int32 argc, char* argv[] ) override;
+
+	public:
+		LoginBenchmarkTool() : Core( e_core_type::TOOL ){
+
+		}
+};
+}
+
+using namespace rathena::tool_loginbenchmark;
+
+std::string conf_name = "conf/inter_athena.conf";
+std::string prefix = "bench";
+std::string cache_ttl;
+int32 accounts = 1000;
+int32 rounds = 3;
+bool keep = false;
+
+// Processes command-line arguments
+void process_args( int32 argc, char* argv[] ){
+	for( int32 i = 1; i < argc; i++ ){
+		if( i + 1 >= argc ){
+			ShowError( "Option '%s' requires a value.\n", argv[i] );
+			break;
+		}
+
+		if( strcmp( argv[i], "-conf" ) == 0 ){
+			conf_name = argv[++i];
+		}else if( strcmp( argv[i], "-prefix" ) == 0 ){
+			prefix = argv[++i];
+		}else if( strcmp( argv[i], "-accounts" ) == 0 ){
+			accounts = std::max( 1, atoi( argv[++i] ) );
+		}else if( strcmp( argv[i], "-rounds" ) == 0 ){
+			rounds = std::max( 1, atoi( argv[++i] ) );
+		}else if( strcmp( argv[i], "-ttl" ) == 0 ){
+			cache_ttl = argv[++i];
+		}else if( strcmp( argv[i], "-keep" ) == 0 ){
+			keep = config_switch( argv[++i] ) != 0;
+		}else{
+			ShowWarning( "Unknown option '%s'.\n", argv[i] );
+		}
+	}
+}
+
+/// Passes the login database settings of a configuration file and its imports to the account engine
+static bool config_read( AccountDb& db, const char* name ){
+	FILE* fp = fopen( name, "r" );
+
+	if( fp == nullptr ){
+		ShowError( "Configuration file (%s) not found.\n", name );
+		return false;
+	}
+
+	char line[1024], w1[1024], w2[1024];
+
+	while( fgets( line, sizeof( line ), fp ) ){
+		if( line[0] == '/' && line[1] == '/' )
+			continue;
+
+		if( sscanf( line, "%1023[^:]: %1023[^\r\n]", w1, w2 ) < 2 )
+			continue;
+
+		if( strcmpi( w1, "import" ) == 0 ){
+			config_read( db, w2 );
+		}else if( strcmpi( w1, "login_account_cache_ttl" ) == 0 ){
+			// Applied once the accounts were prepared
+			if( cache_ttl.empty() ){
+				cache_ttl = w2;
+			}
+		}else if( strncmp( w1, "login_", 6 ) == 0 ){
+			db.setProperty( w1, w2 );
+		}
+	}
+
+	fclose( fp );
+
+	return true;
+}
+
+static uint64 sql_queries(){
+	for( const Metric* metric : metrics_registry() ){
+		if( strcmp( metric->getName(), "rathena_sql_queries_total" ) == 0 ){
+			return metric->value();
+		}
+	}
+
+	return 0;
+}
+
+bool LoginBenchmarkTool::initialize( int32 argc, char* argv[] ){
+	// Links the full core for the database, but must not enter its main loop
+	this->set_run_once( true );
+	process_args( argc, argv );
+
+	AccountDbSql db;
+
+	if( !config_read( db, conf_name.c_str() ) ){
+		return false;
+	}
+
+	if( !db.init() ){
+		return false;
+	}
+
+	std::vector<std::string> userids;
+
+	ShowStatus( "Preparing %d accounts with the prefix '%s'...\n", accounts, prefix.c_str() );
+
+	for( int32 i = 0; i < accounts; i++ ){
+		std::string userid = prefix + std::to_string( i );
+		MmoAccount acc = {};
+
+		if( !db.loadFromUsername( acc, userid.c_str() ) ){
+			acc.account_id = static_cast<uint32>( -1 );
+			safestrncpy( acc.userid, userid.c_str(), sizeof( acc.userid ) );
+			safestrncpy( acc.pass, "benchmark", sizeof( acc.pass ) );
+			acc.sex = 'M';
+			safestrncpy( acc.email, "a@a.com", sizeof( acc.email ) );
+			safestrncpy( acc.last_ip, "127.0.0.1", sizeof( acc.last_ip ) );
+			acc.char_slots = MIN_CHARS;
+
+			if( !db.create( acc ) ){
+				ShowError( "Failed to create the account '%s'.\n", userid.c_str() );
+				return false;
+			}
+		}
+
+		userids.push_back( userid );
+	}
+
+	// Starts with an empty cache
+	db.setProperty( "login_account_cache_ttl", cache_ttl.empty() ? "0" : cache_ttl );
+
+	ShowStatus( "Replaying %d rounds of %d logins...\n", rounds, accounts );
+
+	for( int32 round = 1; round <= rounds; round++ ){
+		std::vector<uint64> latencies;
+		uint64 queries = sql_queries();
+		auto start = std::chrono::steady_clock::now();
+
+		for( const std::string& userid : userids ){
+			auto login_start = std::chrono::steady_clock::now();
+			MmoAccount acc;
+
+			// What the login-server does for one login: authenticate and save, then the char-server
+			// requests the authentication, the account data and the account registries
+			if( !db.loadFromUsername( acc, userid.c_str() ) ){
+				ShowError( "Account '%s' was not found.\n", userid.c_str() );
+				return false;
+			}
+
+			timestamp2string( acc.lastlogin, sizeof( acc.lastlogin ), time( nullptr ), "%Y-%m-%d %H:%M:%S" );
+			acc.logincount++;
+			db.save( acc );
+
+			db.loadFromAccountId( acc, acc.account_id );
+			db.loadFromAccountId( acc, acc.account_id );
+
+			std::vector<AccountRegVesselNum> num_regs;
+			std::vector<AccountRegVesselStr> str_regs;
+
+			db.loadGlobalAccReg( acc.account_id, num_regs, str_regs );
+
+			latencies.push_back( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - login_start ).count() );
+		}
+
+		double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+		std::sort( latencies.begin(), latencies.end() );
+
+		ShowInfo( "Round %d: %.1f logins/sec, %.2f queries per login, p50 %.2fms, p99 %.2fms\n", round, accounts / seconds,
+			static_cast<double>( sql_queries() - queries ) / accounts,
+			latencies[latencies.size() / 2] / 1000.0, latencies[std::min( latencies.size() - 1, latencies.size() * 99 / 100 )] / 1000.0 );
+	}
+
+	if( !keep ){
+		for( const std::string& userid : userids ){
+			MmoAccount acc;
+
+			if( db.loadFromUsername( acc, userid.c_str() ) ){
+				db.remove( acc.account_id );
+			}
+		}
+	}
+
+	return true;
+}
+
+int32 main( int32 argc, char *argv[] ){
+	return main_core<LoginBenchmarkTool>( argc, argv );
+}
@@ -0,0 +1,286 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <httplib.h>
+
+#include <common/core.hpp>
+#include <common/random.hpp>
+#include <common/showmsg.hpp>
+
+#include "../web/partybooking_index.hpp"
+
+using namespace rathena::server_core;
+
+namespace rathena::tool_webbenchmark {
+class WebBenchmarkTool : public Core{
+	protected:
+		bool initialize( int32 argc, char* argv[] ) override;
+
+	public:
+		WebBenchmarkTool() : Core( e_core_type::TOOL ){
+
+		}
+};
+}
+
+using namespace rathena::tool_webbenchmark;
+
+std::string host = "127.0.0.1";
+int32 port = 8888;
+std::string path = "/userconfig/load";
+int32 threads = 16;
+int32 requests = 10000;
+int32 account_id = 2000000;
+int32 char_id = 150000;
+int32 guild_id = 0;
+std::string token;
+std::string world_name = "rAthena";
+int32 bookings = 0;
+
+// Processes command-line arguments
+void process_args( int32 argc, char* argv[] ){
+	for( int32 i = 1; i < argc; i++ ){
+		if( i + 1 >= argc ){
+			ShowError( "Option '%s' requires a value.\n", argv[i] );
+			break;
+		}
+
+		if( strcmp( argv[i], "-host" ) == 0 ){
+			host = argv[++i];
+		}else if( strcmp( argv[i], "-port" ) == 0 ){
+			port = atoi( argv[++i] );
+		}else if( strcmp( argv[i], "-path" ) == 0 ){
+			path = argv[++i];
+		}else if( strcmp( argv[i], "-threads" ) == 0 ){
+			threads = std::max( 1, atoi( argv[++i] ) );
+		}else if( strcmp( argv[i], "-requests" ) == 0 ){
+			requests = std::max( 1, atoi( argv[++i] ) );
+		}else if( strcmp( argv[i], "-aid" ) == 0 ){
+			account_id = atoi( argv[++i] );
+		}else if( strcmp( argv[i], "-gid" ) == 0 ){
+			char_id = atoi( argv[++i] );
+		}else if( strcmp( argv[i], "-gdid" ) == 0 ){
+			guild_id = atoi( argv[++i] );
+		}else if( strcmp( argv[i], "-token" ) == 0 ){
+			token = argv[++i];
+		}else if( strcmp( argv[i], "-world" ) == 0 ){
+			world_name = argv[++i];
+		}else if( strcmp( argv[i], "-bookings" ) == 0 ){
+			bookings = std::max( 0, atoi( argv[++i] ) );
+		}else{
+			ShowWarning( "Unknown option '%s'.\n", argv[i] );
+		}
+	}
+}
+
+/// Creates a booking with one of the level ranges and role combinations the client offers
+static s_party_booking_entry booking_random( xoshiro256ss& engine, uint32 account_id ){
+	static const uint16 levels[][2] = { { 1, 99 }, { 50, 99 }, { 99, 175 }, { 150, 200 }, { 175, 200 }, { 200, 250 } };
+	const auto& range = levels[rnd_range32( engine, ARRAYLENGTH( levels ) )];
+	uint32 roles = rnd_range32( engine, 15 ) + 1;
+	s_party_booking_entry entry;
+
+	entry.account_id = account_id;
+	entry.char_id = account_id;
+	entry.char_name = "Booking" + std::to_string( account_id );
+	entry.purpose = static_cast<uint16>( rnd_range32( engine, BOOKING_PURPOSE_MAX - 1 ) + 1 );
+	entry.assist = ( roles & 1 ) != 0;
+	entry.damagedealer = ( roles & 2 ) != 0;
+	entry.healer = ( roles & 4 ) != 0;
+	entry.tanker = ( roles & 8 ) != 0;
+	entry.minimum_level = range[0];
+	entry.maximum_level = range[1];
+	entry.comment = ( rnd_range32( engine, 4 ) == 0 ? "Looking for a healer, voice chat" : "Grinding, all welcome" );
+
+	return entry;
+}
+
+/**
+ * Measures the party booking index with the given amount of bookings.
+ * Every thread sends list and search requests, while one more thread keeps adding and removing bookings.
+ */
+static void benchmark_partybooking(){
+	PartyBookingIndex index;
+	xoshiro256ss engine( 1 );
+
+	for( int32 i = 0; i < bookings; i++ ){
+		index.add( world_name, booking_random( engine, 2000000 + i ) );
+	}
+
+	ShowStatus( "Sending %d list and search requests to %d party bookings from %d threads...\n", requests, bookings, threads );
+
+	std::atomic<int32> next{ 0 };
+	std::atomic<bool> running{ true };
+	std::atomic<size_t> results{ 0 };
+	std::atomic<int32> writes{ 0 };
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+
+	// Players opening and closing bookings at the same time
+	std::thread writer( [&](){
+		xoshiro256ss writer_engine( 2 );
+
+		while( running ){
+			uint32 account_id = 2000000 + rnd_range32( writer_engine, bookings );
+
+			index.removeAccount( world_name, account_id );
+			index.add( world_name, booking_random( writer_engine, account_id ) );
+			writes++;
+		}
+	} );
+
+	for( int32 i = 0; i < threads; i++ ){
+		workers.emplace_back( [&, i](){
+			xoshiro256ss thread_engine( 3 + i );
+			std::vector<s_party_booking_entry> page;
+
+			while( next.fetch_add( 1 ) < requests ){
+				page.clear();
+
+				if( rnd_range32( thread_engine, 4 ) == 0 ){
+					index.list( world_name, rnd_range32( thread_engine, 10 ) * 10, 10, page );
+				}else{
+					s_party_booking_entry sample = booking_random( thread_engine, 0 );
+					s_party_booking_filter filter = {};
+
+					filter.purpose = ( rnd_range32( thread_engine, 2 ) == 0 ? BOOKING_PURPOSE_ALL : sample.purpose );
+					filter.healer = true;
+					filter.minimum_level = sample.minimum_level;
+					filter.maximum_level = sample.maximum_level;
+
+					if( rnd_range32( thread_engine, 4 ) == 0 ){
+						filter.comment = "voice";
+					}
+
+					index.search( world_name, filter, 0, 10, page );
+				}
+
+				results += page.size();
+			}
+		} );
+	}
+
+	for( std::thread& worker : workers ){
+		worker.join();
+	}
+
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	running = false;
+	writer.join();
+
+	ShowInfo( "Requests:     %d in %.3fs, %" PRIuPTR " bookings returned\n", requests, seconds, results.load() );
+	ShowInfo( "Throughput:   %.1f requests/sec\n", requests / seconds );
+	ShowInfo( "Writes:       %d bookings replaced meanwhile\n", writes.load() );
+}
+
+bool WebBenchmarkTool::initialize( int32 argc, char* argv[] ){
+	process_args( argc, argv );
+
+	if( bookings > 0 ){
+		benchmark_partybooking();
+		return true;
+	}
+
+	// The same form the client sends, the web-server ignores the fields a handler does not need
+	httplib::MultipartFormDataItems form = {
+		{ "AID", std::to_string( account_id ), "", "" },
+		{ "AuthToken", token, "", "" },
+		{ "WorldName", world_name, "", "" },
+		{ "GID", std::to_string( char_id ), "", "" },
+		{ "GDID", std::to_string( guild_id ), "", "" },
+		{ "Version", "0", "", "" },
+	};
+
+	std::atomic<int32> next{ 0 };
+	std::mutex mutex;
+	std::vector<uint64> latencies;
+	std::map<int32, int32> statuses;
+	int32 failures = 0;
+
+	latencies.reserve( requests );
+
+	ShowStatus( "Sending %d requests to http://%s:%d%s from %d threads...\n", requests, host.c_str(), port, path.c_str(), threads );
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+
+	for( int32 i = 0; i < threads; i++ ){
+		workers.emplace_back( [&](){
+			// Every thread keeps its connection alive, like a client would
+			httplib::Client client( host, port );
+			std::vector<uint64> local_latencies;
+			std::map<int32, int32> local_statuses;
+			int32 local_failures = 0;
+
+			client.set_keep_alive( true );
+
+			while( next.fetch_add( 1 ) < requests ){
+				auto request_start = std::chrono::steady_clock::now();
+				auto result = client.Post( path, form );
+
+				local_latencies.push_back( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - request_start ).count() );
+
+				if( result ){
+					local_statuses[result->status]++;
+				}else{
+					local_failures++;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock( mutex );
+
+			latencies.insert( latencies.end(), local_latencies.begin(), local_latencies.end() );
+			failures += local_failures;
+
+			for( const auto& status : local_statuses ){
+				statuses[status.first] += status.second;
+			}
+		} );
+	}
+
+	for( std::thread& worker : workers ){
+		worker.join();
+	}
+
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	std::sort( latencies.begin(), latencies.end() );
+
+	auto percentile = [&latencies]( double p ) -> double {
+		if( latencies.empty() ){
+			return 0;
+		}
+
+		return latencies[std::min( latencies.size() - 1, static_cast<size_t>( latencies.size() * p ) )] / 1000.0;
+	};
+
+	ShowInfo( "Requests:     %d in %.2fs\n", requests, seconds );
+	ShowInfo( "Throughput:   %.1f requests/sec\n", requests / seconds );
+	ShowInfo( "Latency:      p50 %.2fms, p90 %.2fms, p99 %.2fms, max %.2fms\n", percentile( 0.5 ), percentile( 0.9 ), percentile( 0.99 ), percentile( 1.0 ) );
+
+	for( const auto& status : statuses ){
+		ShowInfo( "Status %d:   %d\n", status.first, status.second );
+	}
+
+	if( failures > 0 ){
+		ShowWarning( "Failed:       %d requests got no response\n", failures );
+	}
+
+	return true;
+}
+
+int32 main( int32 argc, char *argv[] ){
+	return main_core<WebBenchmarkTool>( argc, argv );
+}
@@ -13,7 +13,9 @@
 #include "web.hpp"
 
 
-bool isAuthorized(const Request &request, bool checkGuildLeader) {
+bool isAuthorized(const Request &request, bool checkGuildLeader, e_http_status& status) {
+	status = HTTP_BAD_REQUEST;
+
 	if (!request.has_file("AuthToken") || !request.has_file("AID"))
 		return false;
 
@@ -29,6 +31,10 @@ bool isAuthorized(const Request &request, bool checkGuildLeader) {
 	loginlock.lock();
 
 	auto handle = loginlock.getHandle();
+	if (handle == nullptr) {
+		status = HTTP_SERVICE_UNAVAILABLE;
+		return false;
+	}
 
 	SqlStmt stmt{ *handle };
 
@@ -61,6 +67,10 @@ bool isAuthorized(const Request &request, bool checkGuildLeader) {
 	SQLLock charlock(CHAR_SQL_LOCK);
 	charlock.lock();
 	handle = charlock.getHandle();
+	if (handle == nullptr) {
+		status = HTTP_SERVICE_UNAVAILABLE;
+		return false;
+	}
 	SqlStmt stmt2{ *handle };
 
 	if (SQL_SUCCESS != stmt2.Prepare(
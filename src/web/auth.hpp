@@ -5,7 +5,16 @@
 #define AUTH_HPP
 
 #include "http.hpp"
+#include "web.hpp"
 
-bool isAuthorized(const Request &request, bool checkGuildLeader=false);
+/**
+ * Checks the web auth token of a request
+ * @param request: Request with AID, AuthToken and, for guild leaders, GDID
+ * @param checkGuildLeader: The account must also lead the guild GDID
+ * @param status: Set to the status to answer with if the request is not authorized,
+ *  HTTP_SERVICE_UNAVAILABLE if no database connection was available
+ * @return true if the request is authorized
+ */
+bool isAuthorized(const Request &request, bool checkGuildLeader, e_http_status& status);
 
 #endif
@@ -14,14 +14,17 @@
 #include "http.hpp"
 #include "sqllock.hpp"
 #include "web.hpp"
+#include "webcache.hpp"
 
 // Max size is 50kb for gif
 #define MAX_EMBLEM_SIZE 50000
 #define START_VERSION 1
 
 HANDLER_FUNC(emblem_download) {
-	if (!isAuthorized(req, false)) {
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if (!isAuthorized(req, false, status)) {
+		res.status = status;
 		res.set_content("Error", "text/plain");
 		return;
 	}
@@ -44,10 +47,24 @@ HANDLER_FUNC(emblem_download) {
 	auto world_name_str = req.get_file_value("WorldName").content;
 	auto world_name = world_name_str.c_str();
 	auto guild_id = std::stoi(req.get_file_value("GDID").content);
+	auto cache_key = std::to_string(guild_id) + ":" + world_name_str;
+	auto cached = emblem_cache.get(cache_key);
+
+	if (cached != nullptr) {
+		web_cache_respond(req, res, *cached);
+		return;
+	}
+
+	auto generation = emblem_cache.getGeneration();
 
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `version`, `file_type`, `file_data` FROM `%s` WHERE (`guild_id` = ? AND `world_name` = ?)",
@@ -109,14 +126,18 @@ HANDLER_FUNC(emblem_download) {
 		return;
 	}
 
-	res.body.assign(blob, emblem_size);
-	res.set_header("Content-Type", content_type);
+	// The version is increased by every upload
+	auto etag = "\"" + std::to_string(guild_id) + "-" + std::to_string(version) + "\"";
+
+	web_cache_respond(req, res, *emblem_cache.put(cache_key, generation, std::string(blob, emblem_size), content_type, etag));
 }
 
 
 HANDLER_FUNC(emblem_upload) {
-	if (!isAuthorized(req, true)) {
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if (!isAuthorized(req, true, status)) {
+		res.status = status;
 		res.set_content("Error", "text/plain");
 		return;
 	}
@@ -223,6 +244,11 @@ HANDLER_FUNC(emblem_upload) {
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `version` FROM `%s` WHERE (`guild_id` = ? AND `world_name` = ?)",
@@ -273,6 +299,8 @@ HANDLER_FUNC(emblem_upload) {
 
 	sl.unlock();
 
+	emblem_cache.invalidate(std::to_string(guild_id) + ":" + world_name_str);
+
 	std::ostringstream stream;
 	stream << "{\"Type\":1,\"version\":" << version << "}";
 	res.set_content(stream.str(), "application/json");
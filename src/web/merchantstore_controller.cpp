@@ -14,10 +14,13 @@
 #include "sqllock.hpp"
 #include "webutils.hpp"
 #include "web.hpp"
+#include "webcache.hpp"
 
 HANDLER_FUNC(merchantstore_save) {
-	if (!isAuthorized(req, false)) {
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if (!isAuthorized(req, false, status)) {
+		res.status = status;
 		res.set_content("Error", "text/plain");
 		return;
 	}
@@ -36,6 +39,11 @@ HANDLER_FUNC(merchantstore_save) {
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `account_id` FROM `%s` WHERE (`account_id` = ? AND `char_id` = ? AND `world_name` = ? AND `store_type` = ?) LIMIT 1",
@@ -91,6 +99,9 @@ HANDLER_FUNC(merchantstore_save) {
 	}
 
 	sl.unlock();
+
+	config_cache.invalidate("merchant:" + std::to_string(account_id) + ":" + std::to_string(char_id) + ":" + std::to_string(store_type) + ":" + world_name_str);
+
 	res.set_content(data, "application/json");
 }
 
@@ -114,9 +125,24 @@ HANDLER_FUNC(merchantstore_load) {
 	auto world_name = world_name_str.c_str();
 	auto store_type = std::stoi(req.get_file_value("Type").content);
 
+	auto cache_key = "merchant:" + std::to_string(account_id) + ":" + std::to_string(char_id) + ":" + std::to_string(store_type) + ":" + world_name_str;
+	auto cached = config_cache.get(cache_key);
+
+	if (cached != nullptr) {
+		web_cache_respond(req, res, *cached);
+		return;
+	}
+
+	auto generation = config_cache.getGeneration();
+
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `data` FROM `%s` WHERE (`account_id` = ? AND `char_id` = ? AND `world_name` = ? AND `store_type` = ?) LIMIT 1",
@@ -137,7 +163,10 @@ HANDLER_FUNC(merchantstore_load) {
 	if (stmt.NumRows() <= 0) {
 		ShowDebug("[AccountID: %d, World: \"%s\"] Not found in table, sending new info.\n", account_id, world_name);
 		sl.unlock();
-		res.set_content("{\"Type\": 1}", "application/json");
+
+		std::string data = "{\"Type\": 1}";
+
+		web_cache_respond(req, res, *config_cache.put(cache_key, generation, data, "application/json", web_cache_etag(data)));
 		return;
 	}
 
@@ -158,5 +187,8 @@ HANDLER_FUNC(merchantstore_load) {
 	databuf[sizeof(databuf) - 1] = 0;
 	auto response = nlohmann::json::parse(databuf);
 	response["Type"] = 1;
-	res.set_content(response.dump(), "application/json");
+
+	auto body = response.dump();
+
+	web_cache_respond(req, res, *config_cache.put(cache_key, generation, body, "application/json", web_cache_etag(body)));
 }
@@ -3,7 +3,9 @@
 
 #include "partybooking_controller.hpp"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <common/showmsg.hpp>
 #include <common/sql.hpp>
@@ -11,39 +13,17 @@
 
 #include "http.hpp"
 #include "auth.hpp"
+#include "partybooking_index.hpp"
 #include "sqllock.hpp"
 #include "web.hpp"
 
 const size_t WORLD_NAME_LENGTH = 32;
 const size_t COMMENT_LENGTH = 255;
 
-enum e_booking_purpose : uint16{
-	BOOKING_PURPOSE_ALL = 0,
-	BOOKING_PURPOSE_QUEST,
-	BOOKING_PURPOSE_FIELD,
-	BOOKING_PURPOSE_DUNGEON,
-	BOOKING_PURPOSE_MD,
-	BOOKING_PURPOSE_PARADISE,
-	BOOKING_PURPOSE_OTHER,
-	BOOKING_PURPOSE_MAX
-};
-
-struct s_party_booking_entry{
-	uint32 account_id;
-	uint32 char_id;
-	std::string char_name;
-	uint16 purpose;
-	bool assist;
-	bool damagedealer;
-	bool healer;
-	bool tanker;
-	uint16 minimum_level;
-	uint16 maximum_level;
-	std::string comment;
-
-public:
-	std::string to_json( std::string& world_name );
-};
+// Bookings per page, if the client asks for a page
+const size_t PAGE_SIZE = 10;
+
+PartyBookingIndex party_booking_index;
 
 std::string s_party_booking_entry::to_json( std::string& world_name ){
 	return
@@ -62,55 +42,118 @@ std::string s_party_booking_entry::to_json( std::string& world_name ){
 		"}";
 }
 
-bool party_booking_read( std::string& world_name, std::vector<s_party_booking_entry>& output, const std::string& condition, const std::string& order ){
+/**
+ * Loads the bookings of all worlds into the index.
+ * The web-server is the only writer of the table, afterwards the index is kept up to date by the handlers.
+ * @return true on success
+ */
+bool partybooking_index_load(){
 	SQLLock sl(MAP_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if( handle == nullptr ){
+		return false;
+	}
 	SqlStmt stmt{ *handle };
 	s_party_booking_entry entry;
-	char world_name_escaped[WORLD_NAME_LENGTH * 2 + 1];
+	char world_name[WORLD_NAME_LENGTH + 1];
 	char char_name[NAME_LENGTH ];
 	char comment[COMMENT_LENGTH + 1];
 
-	Sql_EscapeString( nullptr, world_name_escaped, world_name.c_str() );
-
-	std::string query = "SELECT `account_id`, `char_id`, `char_name`, `purpose`, `assist`, `damagedealer`, `healer`, `tanker`, `minimum_level`, `maximum_level`, `comment` FROM `" + std::string( partybookings_table ) + "` WHERE `world_name` = ? AND " + condition + order;
-
-	if( SQL_SUCCESS != stmt.Prepare( query.c_str() )
-		|| SQL_SUCCESS != stmt.BindParam( 0, SQLDT_STRING, (void*)world_name_escaped, strlen( world_name_escaped ) )
+	if( SQL_SUCCESS != stmt.Prepare( "SELECT `world_name`, `account_id`, `char_id`, `char_name`, `purpose`, `assist`, `damagedealer`, `healer`, `tanker`, `minimum_level`, `maximum_level`, `comment` FROM `%s` ORDER BY `created`", partybookings_table )
 		|| SQL_SUCCESS != stmt.Execute()
-		|| SQL_SUCCESS != stmt.BindColumn( 0, SQLDT_UINT32, &entry.account_id )
-		|| SQL_SUCCESS != stmt.BindColumn( 1, SQLDT_UINT32, &entry.char_id )
-		|| SQL_SUCCESS != stmt.BindColumn( 2, SQLDT_STRING, (void*)char_name, sizeof( char_name ) )
-		|| SQL_SUCCESS != stmt.BindColumn( 3, SQLDT_UINT16, &entry.purpose )
-		|| SQL_SUCCESS != stmt.BindColumn( 4, SQLDT_UINT8, &entry.assist )
-		|| SQL_SUCCESS != stmt.BindColumn( 5, SQLDT_UINT8, &entry.damagedealer )
-		|| SQL_SUCCESS != stmt.BindColumn( 6, SQLDT_UINT8, &entry.healer )
-		|| SQL_SUCCESS != stmt.BindColumn( 7, SQLDT_UINT8, &entry.tanker )
-		|| SQL_SUCCESS != stmt.BindColumn( 8, SQLDT_UINT16, &entry.minimum_level )
-		|| SQL_SUCCESS != stmt.BindColumn( 9, SQLDT_UINT16, &entry.maximum_level )
-		|| SQL_SUCCESS != stmt.BindColumn( 10, SQLDT_STRING, (void*)comment, sizeof( comment ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 0, SQLDT_STRING, (void*)world_name, sizeof( world_name ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 1, SQLDT_UINT32, &entry.account_id )
+		|| SQL_SUCCESS != stmt.BindColumn( 2, SQLDT_UINT32, &entry.char_id )
+		|| SQL_SUCCESS != stmt.BindColumn( 3, SQLDT_STRING, (void*)char_name, sizeof( char_name ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 4, SQLDT_UINT16, &entry.purpose )
+		|| SQL_SUCCESS != stmt.BindColumn( 5, SQLDT_UINT8, &entry.assist )
+		|| SQL_SUCCESS != stmt.BindColumn( 6, SQLDT_UINT8, &entry.damagedealer )
+		|| SQL_SUCCESS != stmt.BindColumn( 7, SQLDT_UINT8, &entry.healer )
+		|| SQL_SUCCESS != stmt.BindColumn( 8, SQLDT_UINT8, &entry.tanker )
+		|| SQL_SUCCESS != stmt.BindColumn( 9, SQLDT_UINT16, &entry.minimum_level )
+		|| SQL_SUCCESS != stmt.BindColumn( 10, SQLDT_UINT16, &entry.maximum_level )
+		|| SQL_SUCCESS != stmt.BindColumn( 11, SQLDT_STRING, (void*)comment, sizeof( comment ) )
 	){
 		SqlStmt_ShowDebug( stmt );
 		sl.unlock();
 		return false;
 	}
 
+	party_booking_index.clear();
+
 	while( SQL_SUCCESS == stmt.NextRow() ){
 		entry.char_name = char_name;
 		entry.comment = comment;
 
-		output.push_back( entry );
+		party_booking_index.add( world_name, entry );
 	}
 
 	sl.unlock();
 
+	ShowStatus( "Loaded '" CL_WHITE "%" PRIuPTR CL_RESET "' party bookings.\n", party_booking_index.size() );
+
+	return true;
+}
+
+/**
+ * Reads the optional page of a list or search request
+ * @param req: Request
+ * @param offset: First booking of the page
+ * @param limit: Size of the page
+ * @return true if a page was requested, otherwise all bookings are returned
+ */
+static bool partybooking_page( const Request& req, size_t& offset, size_t& limit ){
+	offset = 0;
+	limit = SIZE_MAX;
+
+	if( !req.has_file( "Page" ) ){
+		return false;
+	}
+
+	int32 page = std::max( 1, std::stoi( req.get_file_value( "Page" ).content ) );
+
+	offset = ( page - 1 ) * PAGE_SIZE;
+	limit = PAGE_SIZE;
+
 	return true;
 }
 
+/**
+ * Creates the response of a list or search request
+ * @param world_name: World of the bookings
+ * @param bookings: Bookings of the page
+ * @param total: Amount of bookings on all pages
+ * @param paged: Whether a page was requested
+ * @return response
+ */
+static std::string partybooking_list_response( std::string& world_name, std::vector<s_party_booking_entry>& bookings, size_t total, bool paged ){
+	std::string response;
+
+	response = "{ \"Type\": 1, \"totalPage\": ";
+	response += std::to_string( paged ? ( total + PAGE_SIZE - 1 ) / PAGE_SIZE : total );
+	response += ", \"data\": [";
+
+	for( size_t i = 0, max = bookings.size(); i < max; i++ ){
+		s_party_booking_entry& booking = bookings.at( i );
+
+		response += booking.to_json( world_name );
+
+		if( i < ( max - 1 ) ){
+			response += ", ";
+		}
+	}
+
+	response += "] }";
+
+	return response;
+}
+
 HANDLER_FUNC(partybooking_add){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
@@ -121,6 +164,11 @@ HANDLER_FUNC(partybooking_add){
 	SQLLock csl( CHAR_SQL_LOCK );
 	csl.lock();
 	auto chandle = csl.getHandle();
+	if( chandle == nullptr ){
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
 	SqlStmt stmt{ *chandle };
 	if( SQL_SUCCESS != stmt.Prepare( "SELECT 1 FROM `%s` WHERE `leader_id` = ? AND `leader_char` = ?", party_table, aid, cid )
 		|| SQL_SUCCESS != stmt.BindParam( 0, SQLDT_UINT32, &aid, sizeof( aid ) )
@@ -219,6 +267,11 @@ HANDLER_FUNC(partybooking_add){
 	SQLLock msl( MAP_SQL_LOCK );
 	msl.lock();
 	auto mhandle = msl.getHandle();
+	if( mhandle == nullptr ){
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
 
 	if( SQL_ERROR == Sql_QueryStr( mhandle, StringBuf_Value( &buf ) ) ){
 		Sql_ShowDebug( mhandle );
@@ -232,12 +285,16 @@ HANDLER_FUNC(partybooking_add){
 
 	msl.unlock();
 
+	party_booking_index.add( world_name, entry );
+
 	res.set_content( "{ \"Type\": 1 }", "application/json" );
 }
 
 HANDLER_FUNC(partybooking_delete){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
@@ -259,6 +316,11 @@ HANDLER_FUNC(partybooking_delete){
 	SQLLock sl( MAP_SQL_LOCK );
 	sl.lock();
 	auto handle = sl.getHandle();
+	if( handle == nullptr ){
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
 
 	if( SQL_ERROR == Sql_Query( handle, "DELETE FROM `%s` WHERE `world_name` = '%s' AND `account_id` = '%d'", partybookings_table, world_name_escaped, account_id ) ){
 		Sql_ShowDebug( handle );
@@ -272,12 +334,16 @@ HANDLER_FUNC(partybooking_delete){
 
 	sl.unlock();
 
+	party_booking_index.removeAccount( world_name, account_id );
+
 	res.set_content( "{ \"Type\": 1 }", "application/json" );
 }
 
 HANDLER_FUNC(partybooking_get){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
@@ -292,29 +358,23 @@ HANDLER_FUNC(partybooking_get){
 		return;
 	}
 
-	std::vector<s_party_booking_entry> bookings;
-
-	if( !party_booking_read( world_name, bookings, "`account_id` = '" + std::to_string( account_id ) + "'", "" ) ){
-		res.status = HTTP_BAD_REQUEST;
-		res.set_content( "Error", "text/plain" );
-
-		return;
-	}
-
+	s_party_booking_entry booking;
 	std::string response;
 
-	if( bookings.empty() ){
+	if( !party_booking_index.get( world_name, account_id, booking ) ){
 		response = "{ \"Type\": 1 }";
 	}else{
-		response = "{ \"Type\": 1, data: " + bookings.at( 0 ).to_json( world_name ) + " }";
+		response = "{ \"Type\": 1, data: " + booking.to_json( world_name ) + " }";
 	}
 
 	res.set_content( response, "application/json" );
 }
 
 HANDLER_FUNC(partybooking_info){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
@@ -329,35 +389,27 @@ HANDLER_FUNC(partybooking_info){
 		return;
 	}
 
-	std::vector<s_party_booking_entry> bookings;
-
-	if( !party_booking_read( world_name, bookings, "`account_id` = '" + std::to_string( account_id ) + "'", "" ) ){
-		res.status = HTTP_BAD_REQUEST;
-		res.set_content( "Error", "text/plain" );
-
-		return;
-	}
-
+	s_party_booking_entry booking;
 	std::string response;
 
-	if( bookings.empty() ){
+	if( !party_booking_index.get( world_name, account_id, booking ) ){
 		response = "{ \"Type\": 1 }";
 	}else{
-		response = "{ \"Type\": 1, \"data\": [" + bookings.at( 0 ).to_json( world_name ) + "] }";
+		response = "{ \"Type\": 1, \"data\": [" + booking.to_json( world_name ) + "] }";
 	}
 
 	res.set_content( response, "application/json" );
 }
 
 HANDLER_FUNC(partybooking_list){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
 
-	static const std::string condition( "1=1" );
-
 	auto world_name = req.get_file_value( "WorldName" ).content;
 
 	if( world_name.length() > WORLD_NAME_LENGTH ){
@@ -368,38 +420,18 @@ HANDLER_FUNC(partybooking_list){
 	}
 
 	std::vector<s_party_booking_entry> bookings;
+	size_t offset, limit;
+	bool paged = partybooking_page( req, offset, limit );
+	size_t total = party_booking_index.list( world_name, offset, limit, bookings );
 
-	if( !party_booking_read( world_name, bookings, condition, " ORDER BY `created` DESC" ) ){
-		res.status = HTTP_BAD_REQUEST;
-		res.set_content( "Error", "text/plain" );
-
-		return;
-	}
-
-	std::string response;
-
-	response = "{ \"Type\": 1, \"totalPage\": ";
-	response += std::to_string( bookings.size() );
-	response += ", \"data\": [";
-
-	for( size_t i = 0, max = bookings.size(); i < max; i++ ){
-		s_party_booking_entry& booking = bookings.at( i );
-
-		response += booking.to_json( world_name );
-
-		if( i < ( max - 1 ) ){
-			response += ", ";
-		}
-	}
-
-	response += "] }";
-
-	res.set_content( response, "application/json" );
+	res.set_content( partybooking_list_response( world_name, bookings, total, paged ), "application/json" );
 }
 
 HANDLER_FUNC(partybooking_search){
-	if( !isAuthorized( req, false ) ){
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if( !isAuthorized( req, false, status ) ){
+		res.status = status;
 		res.set_content( "Error", "text/plain" );
 		return;
 	}
@@ -413,154 +445,67 @@ HANDLER_FUNC(partybooking_search){
 		return;
 	}
 
-	s_party_booking_entry entry;
+	s_party_booking_filter filter;
 
 	// Unconditional
-	entry.minimum_level = std::stoi( req.get_file_value( "MinLV" ).content );
-	entry.maximum_level = std::stoi( req.get_file_value( "MaxLV" ).content );
+	filter.minimum_level = std::stoi( req.get_file_value( "MinLV" ).content );
+	filter.maximum_level = std::stoi( req.get_file_value( "MaxLV" ).content );
 
 	// Conditional
 	if( req.files.find( "Type" ) != req.files.end() ){
-		entry.purpose = std::stoi( req.get_file_value( "Type" ).content );
+		filter.purpose = std::stoi( req.get_file_value( "Type" ).content );
 
-		if( entry.purpose >= BOOKING_PURPOSE_MAX ){
+		if( filter.purpose >= BOOKING_PURPOSE_MAX ){
 			res.status = HTTP_BAD_REQUEST;
 			res.set_content( "Error", "text/plain" );
 
 			return;
 		}
 	}else{
-		entry.purpose = BOOKING_PURPOSE_ALL;
+		filter.purpose = BOOKING_PURPOSE_ALL;
 	}
 
 	if( req.files.find( "Assist" ) != req.files.end() ){
-		entry.assist = std::stoi( req.get_file_value( "Assist" ).content ) != 0;
+		filter.assist = std::stoi( req.get_file_value( "Assist" ).content ) != 0;
 	}else{
-		entry.assist = false;
+		filter.assist = false;
 	}
 
 	if( req.files.find( "Dealer" ) != req.files.end() ){
-		entry.damagedealer = std::stoi( req.get_file_value( "Dealer" ).content ) != 0;
+		filter.damagedealer = std::stoi( req.get_file_value( "Dealer" ).content ) != 0;
 	}else{
-		entry.damagedealer = false;
+		filter.damagedealer = false;
 	}
 
 	if( req.files.find( "Healer" ) != req.files.end() ){
-		entry.healer = std::stoi( req.get_file_value( "Healer" ).content ) != 0;
+		filter.healer = std::stoi( req.get_file_value( "Healer" ).content ) != 0;
 	}else{
-		entry.healer = false;
+		filter.healer = false;
 	}
 
 	if( req.files.find( "Tanker" ) != req.files.end() ){
-		entry.tanker = std::stoi( req.get_file_value( "Tanker" ).content ) != 0;
+		filter.tanker = std::stoi( req.get_file_value( "Tanker" ).content ) != 0;
 	}else{
-		entry.tanker = false;
+		filter.tanker = false;
 	}
 
 	if( req.files.find( "Memo" ) != req.files.end() ){
-		entry.comment = req.get_file_value( "Memo" ).content;
+		filter.comment = req.get_file_value( "Memo" ).content;
 	}else{
-		entry.comment = "";
-	}
-
-	std::string condition;
-
-	condition = "`minimum_level` = '" + std::to_string( entry.minimum_level ) + "'";
-	condition += " AND `maximum_level` = '" + std::to_string( entry.maximum_level ) + "'";
-
-	if( entry.purpose != BOOKING_PURPOSE_ALL ){
-		condition += " AND `purpose` = '" + std::to_string( entry.purpose ) + "'";
-	}
-
-	if( entry.assist || entry.damagedealer || entry.healer || entry.tanker ){
-		bool or_required = false;
-
-		condition += "AND ( ";
-
-		if( entry.assist ){
-			if( or_required ){
-				condition += " OR ";
-			}else{
-				or_required = true;
-			}
-
-			condition += "`assist` = '1'";
-		}
-
-		if( entry.damagedealer ){
-			if( or_required ){
-				condition += " OR ";
-			}else{
-				or_required = true;
-			}
-
-			condition += "`damagedealer` = '1'";
-		}
-
-		if( entry.healer ){
-			if( or_required ){
-				condition += " OR ";
-			}else{
-				or_required = true;
-			}
-
-			condition += "`healer` = '1'";
-		}
-
-		if( entry.tanker ){
-			if( or_required ){
-				condition += " OR ";
-			}else{
-				or_required = true;
-			}
-
-			condition += "`tanker` = '1'";
-		}
-
-		condition += " )";
+		filter.comment = "";
 	}
 
-	if( !entry.comment.empty() ){
-		if( entry.comment.length() > COMMENT_LENGTH ){
-			res.status = HTTP_BAD_REQUEST;
-			res.set_content( "Error", "text/plain" );
-
-			return;
-		}
-
-		char escaped_comment[COMMENT_LENGTH * 2 + 1];
-
-		Sql_EscapeString( nullptr, escaped_comment, entry.comment.c_str() );
-
-		condition += " AND `comment` like '%" + std::string( escaped_comment ) + "%'";
-	}
-
-	std::vector<s_party_booking_entry> bookings;
-
-	if( !party_booking_read( world_name, bookings, condition, " ORDER BY `created` DESC" ) ){
+	if( filter.comment.length() > COMMENT_LENGTH ){
 		res.status = HTTP_BAD_REQUEST;
 		res.set_content( "Error", "text/plain" );
 
 		return;
 	}
 
-	std::string response;
-
-	response = "{ \"Type\": 1, \"totalPage\": ";
-	response += std::to_string( bookings.size() );
-	response += ", \"data\": [";
-
-	for( size_t i = 0, max = bookings.size(); i < max; i++ ){
-		s_party_booking_entry& booking = bookings.at( i );
-
-		response += booking.to_json( world_name );
-
-		if( i < ( max - 1 ) ){
-			response += ", ";
-		}
-	}
-
-	response += "] }";
+	std::vector<s_party_booking_entry> bookings;
+	size_t offset, limit;
+	bool paged = partybooking_page( req, offset, limit );
+	size_t total = party_booking_index.search( world_name, filter, offset, limit, bookings );
 
-	res.set_content( response, "application/json" );
+	res.set_content( partybooking_list_response( world_name, bookings, total, paged ), "application/json" );
 }
@@ -6,6 +6,8 @@
 
 #include "http.hpp"
 
+bool partybooking_index_load();
+
 HANDLER_FUNC(partybooking_add);
 HANDLER_FUNC(partybooking_delete);
 HANDLER_FUNC(partybooking_get);
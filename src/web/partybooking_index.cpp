@@ -0,0 +1,291 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "partybooking_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <queue>
+
+// Bits of the roles of a booking
+#define BOOKING_ROLE_ASSIST 0x1
+#define BOOKING_ROLE_DEALER 0x2
+#define BOOKING_ROLE_HEALER 0x4
+#define BOOKING_ROLE_TANKER 0x8
+#define BOOKING_ROLE_ALL 0xF
+
+uint64 PartyBookingIndex::group_key( uint16 minimum_level, uint16 maximum_level, uint16 purpose, uint8 roles ){
+	return ( static_cast<uint64>( minimum_level ) << 40 ) | ( static_cast<uint64>( maximum_level ) << 24 ) | ( static_cast<uint64>( purpose ) << 8 ) | roles;
+}
+
+uint8 PartyBookingIndex::roles( const s_party_booking_entry& entry ){
+	return ( entry.assist ? BOOKING_ROLE_ASSIST : 0 ) | ( entry.damagedealer ? BOOKING_ROLE_DEALER : 0 ) | ( entry.healer ? BOOKING_ROLE_HEALER : 0 ) | ( entry.tanker ? BOOKING_ROLE_TANKER : 0 );
+}
+
+/// Checks the comment, which is not covered by the groups
+bool PartyBookingIndex::matches( const s_party_booking_entry& entry, const s_party_booking_filter& filter ){
+	if( filter.comment.empty() ){
+		return true;
+	}
+
+	// Case insensitive, like the LIKE comparison of the table's collation
+	auto it = std::search( entry.comment.begin(), entry.comment.end(), filter.comment.begin(), filter.comment.end(), []( char a, char b ){
+		return std::tolower( static_cast<unsigned char>( a ) ) == std::tolower( static_cast<unsigned char>( b ) );
+	} );
+
+	return it != entry.comment.end();
+}
+
+void PartyBookingIndex::remove( s_world& world, std::map<uint64, s_party_booking_entry>::iterator it ){
+	const s_party_booking_entry& entry = it->second;
+	uint64 order = it->first;
+
+	auto account = world.accounts.find( entry.account_id );
+
+	if( account != world.accounts.end() ){
+		account->second.erase( order );
+
+		if( account->second.empty() ){
+			world.accounts.erase( account );
+		}
+	}
+
+	auto group = world.groups.find( group_key( entry.minimum_level, entry.maximum_level, entry.purpose, roles( entry ) ) );
+
+	if( group != world.groups.end() ){
+		group->second.erase( order );
+
+		if( group->second.empty() ){
+			world.groups.erase( group );
+		}
+	}
+
+	world.entries.erase( it );
+}
+
+/**
+ * Adds a booking as the newest one, replacing a booking of the same character
+ * @param world_name: World the booking belongs to
+ * @param entry: Booking
+ */
+void PartyBookingIndex::add( const std::string& world_name, const s_party_booking_entry& entry ){
+	std::unique_lock<std::shared_mutex> lock( this->mutex );
+
+	s_world& world = this->worlds[world_name];
+	auto account = world.accounts.find( entry.account_id );
+
+	if( account != world.accounts.end() ){
+		for( const auto& booking : account->second ){
+			if( booking.second->char_id == entry.char_id ){
+				this->remove( world, world.entries.find( booking.first ) );
+				break;
+			}
+		}
+	}
+
+	uint64 order = this->next_order++;
+	const s_party_booking_entry* stored = &world.entries.emplace( order, entry ).first->second;
+
+	world.accounts[entry.account_id].emplace( order, stored );
+	world.groups[group_key( entry.minimum_level, entry.maximum_level, entry.purpose, roles( entry ) )].emplace( order, stored );
+}
+
+/**
+ * Removes all bookings of an account
+ * @param world_name: World of the bookings
+ * @param account_id: Account ID
+ */
+void PartyBookingIndex::removeAccount( const std::string& world_name, uint32 account_id ){
+	std::unique_lock<std::shared_mutex> lock( this->mutex );
+
+	auto world = this->worlds.find( world_name );
+
+	if( world == this->worlds.end() ){
+		return;
+	}
+
+	auto account = world->second.accounts.find( account_id );
+
+	if( account == world->second.accounts.end() ){
+		return;
+	}
+
+	// Removing the last booking erases the account's group
+	std::vector<uint64> orders;
+
+	for( const auto& booking : account->second ){
+		orders.push_back( booking.first );
+	}
+
+	for( uint64 order : orders ){
+		this->remove( world->second, world->second.entries.find( order ) );
+	}
+}
+
+/**
+ * Looks up the newest booking of an account
+ * @param world_name: World of the booking
+ * @param account_id: Account ID
+ * @param output: Booking
+ * @return true if the account has a booking
+ */
+bool PartyBookingIndex::get( const std::string& world_name, uint32 account_id, s_party_booking_entry& output ){
+	std::shared_lock<std::shared_mutex> lock( this->mutex );
+
+	auto world = this->worlds.find( world_name );
+
+	if( world == this->worlds.end() ){
+		return false;
+	}
+
+	auto account = world->second.accounts.find( account_id );
+
+	if( account == world->second.accounts.end() ){
+		return false;
+	}
+
+	output = *account->second.begin()->second;
+
+	return true;
+}
+
+/**
+ * Returns a page of all bookings of a world, newest first
+ * @param world_name: World of the bookings
+ * @param offset: Amount of bookings to skip
+ * @param limit: Maximum amount of bookings to return
+ * @param output: Bookings are appended here
+ * @return total amount of bookings of the world
+ */
+size_t PartyBookingIndex::list( const std::string& world_name, size_t offset, size_t limit, std::vector<s_party_booking_entry>& output ){
+	std::shared_lock<std::shared_mutex> lock( this->mutex );
+
+	auto world = this->worlds.find( world_name );
+
+	if( world == this->worlds.end() ){
+		return 0;
+	}
+
+	const auto& entries = world->second.entries;
+
+	if( offset < entries.size() ){
+		auto it = entries.rbegin();
+
+		std::advance( it, offset );
+
+		for( ; it != entries.rend() && limit > 0; it++, limit-- ){
+			output.push_back( it->second );
+		}
+	}
+
+	return entries.size();
+}
+
+/**
+ * Returns a page of the bookings of a world that match a filter, newest first
+ * @param world_name: World of the bookings
+ * @param filter: Conditions
+ * @param offset: Amount of matching bookings to skip
+ * @param limit: Maximum amount of bookings to return
+ * @param output: Bookings are appended here
+ * @return total amount of matching bookings
+ */
+size_t PartyBookingIndex::search( const std::string& world_name, const s_party_booking_filter& filter, size_t offset, size_t limit, std::vector<s_party_booking_entry>& output ){
+	std::shared_lock<std::shared_mutex> lock( this->mutex );
+
+	auto world = this->worlds.find( world_name );
+
+	if( world == this->worlds.end() ){
+		return 0;
+	}
+
+	uint8 requested_roles = ( filter.assist ? BOOKING_ROLE_ASSIST : 0 ) | ( filter.damagedealer ? BOOKING_ROLE_DEALER : 0 ) | ( filter.healer ? BOOKING_ROLE_HEALER : 0 ) | ( filter.tanker ? BOOKING_ROLE_TANKER : 0 );
+	typedef std::pair<t_newest_first::const_iterator, t_newest_first::const_iterator> t_cursor;
+	auto older = []( const t_cursor& a, const t_cursor& b ){
+		return a.first->first < b.first->first;
+	};
+	std::priority_queue<t_cursor, std::vector<t_cursor>, decltype( older )> cursors( older );
+	size_t total = 0;
+
+	// Collect the groups with the level range, one of the purposes and one of the roles
+	for( uint16 purpose = 0; purpose < BOOKING_PURPOSE_MAX; purpose++ ){
+		if( filter.purpose != BOOKING_PURPOSE_ALL && purpose != filter.purpose ){
+			continue;
+		}
+
+		for( uint8 roles = 0; roles <= BOOKING_ROLE_ALL; roles++ ){
+			if( requested_roles != 0 && ( roles & requested_roles ) == 0 ){
+				continue;
+			}
+
+			auto group = world->second.groups.find( group_key( filter.minimum_level, filter.maximum_level, purpose, roles ) );
+
+			if( group == world->second.groups.end() ){
+				continue;
+			}
+
+			cursors.emplace( group->second.begin(), group->second.end() );
+			total += group->second.size();
+		}
+	}
+
+	// Without a comment all bookings of the groups match, so only the requested page has to be merged
+	if( filter.comment.empty() ){
+		for( size_t position = 0; !cursors.empty() && position < offset + limit; position++ ){
+			t_cursor cursor = cursors.top();
+
+			cursors.pop();
+
+			if( position >= offset ){
+				output.push_back( *cursor.first->second );
+			}
+
+			if( ++cursor.first != cursor.second ){
+				cursors.push( cursor );
+			}
+		}
+
+		return total;
+	}
+
+	total = 0;
+
+	while( !cursors.empty() ){
+		t_cursor cursor = cursors.top();
+
+		cursors.pop();
+
+		if( matches( *cursor.first->second, filter ) ){
+			if( total >= offset && total - offset < limit ){
+				output.push_back( *cursor.first->second );
+			}
+
+			total++;
+		}
+
+		if( ++cursor.first != cursor.second ){
+			cursors.push( cursor );
+		}
+	}
+
+	return total;
+}
+
+/// Returns the amount of bookings of all worlds
+size_t PartyBookingIndex::size(){
+	std::shared_lock<std::shared_mutex> lock( this->mutex );
+	size_t size = 0;
+
+	for( const auto& world : this->worlds ){
+		size += world.second.entries.size();
+	}
+
+	return size;
+}
+
+void PartyBookingIndex::clear(){
+	std::unique_lock<std::shared_mutex> lock( this->mutex );
+
+	this->worlds.clear();
+}
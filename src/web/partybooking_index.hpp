@@ -0,0 +1,94 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef PARTYBOOKING_INDEX_HPP
+#define PARTYBOOKING_INDEX_HPP
+
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common/cbasetypes.hpp>
+
+enum e_booking_purpose : uint16{
+	BOOKING_PURPOSE_ALL = 0,
+	BOOKING_PURPOSE_QUEST,
+	BOOKING_PURPOSE_FIELD,
+	BOOKING_PURPOSE_DUNGEON,
+	BOOKING_PURPOSE_MD,
+	BOOKING_PURPOSE_PARADISE,
+	BOOKING_PURPOSE_OTHER,
+	BOOKING_PURPOSE_MAX
+};
+
+struct s_party_booking_entry{
+	uint32 account_id;
+	uint32 char_id;
+	std::string char_name;
+	uint16 purpose;
+	bool assist;
+	bool damagedealer;
+	bool healer;
+	bool tanker;
+	uint16 minimum_level;
+	uint16 maximum_level;
+	std::string comment;
+
+public:
+	std::string to_json( std::string& world_name );
+};
+
+/// Conditions of a party booking search, an entry matches if it has one of the requested roles
+struct s_party_booking_filter{
+	uint16 purpose;
+	bool assist;
+	bool damagedealer;
+	bool healer;
+	bool tanker;
+	uint16 minimum_level;
+	uint16 maximum_level;
+	std::string comment;
+};
+
+/*
+ * In-memory copy of the party booking table, which only the web-server writes.
+ * Entries are ordered by their creation. They are additionally grouped by account and
+ * by their level range, purpose and roles, so a search only merges the groups it asks for
+ * and counts the results without looking at them, unless it filters by comment.
+ * Any number of threads may read at the same time, writers are exclusive.
+ */
+class PartyBookingIndex{
+private:
+	typedef std::map<uint64, const s_party_booking_entry*, std::greater<uint64>> t_newest_first;
+
+	struct s_world{
+		std::map<uint64, s_party_booking_entry> entries; // by creation order
+		std::unordered_map<uint32, t_newest_first> accounts;
+		std::unordered_map<uint64, t_newest_first> groups; // by level range, purpose and roles
+	};
+
+	std::shared_mutex mutex;
+	std::unordered_map<std::string, s_world> worlds;
+	uint64 next_order;
+
+	static uint64 group_key( uint16 minimum_level, uint16 maximum_level, uint16 purpose, uint8 roles );
+	static uint8 roles( const s_party_booking_entry& entry );
+	static bool matches( const s_party_booking_entry& entry, const s_party_booking_filter& filter );
+	void remove( s_world& world, std::map<uint64, s_party_booking_entry>::iterator it );
+
+public:
+	PartyBookingIndex() : next_order( 0 ){}
+
+	void add( const std::string& world_name, const s_party_booking_entry& entry );
+	void removeAccount( const std::string& world_name, uint32 account_id );
+	bool get( const std::string& world_name, uint32 account_id, s_party_booking_entry& output );
+	size_t list( const std::string& world_name, size_t offset, size_t limit, std::vector<s_party_booking_entry>& output );
+	size_t search( const std::string& world_name, const s_party_booking_filter& filter, size_t offset, size_t limit, std::vector<s_party_booking_entry>& output );
+	size_t size();
+	void clear();
+};
+
+#endif /* PARTYBOOKING_INDEX_HPP */
@@ -3,79 +3,38 @@
 
 #include "sqllock.hpp"
 
-#include <mutex>
+#include "web.hpp"
 
-#include <common/showmsg.hpp>
-
-std::mutex dbmutex;
-
-extern Sql * login_handle;
-extern Sql * char_handle;
-extern Sql * map_handle;
-extern Sql * web_handle;
-
-
-SQLLock::SQLLock(locktype lt) : ulock(dbmutex, std::defer_lock), lt(lt) {
-	switch(lt) {
-		case LOGIN_SQL_LOCK:
-			handle = login_handle;
-			break;
-		case CHAR_SQL_LOCK:
-			handle = char_handle;
-			break;
-		case MAP_SQL_LOCK:
-			handle = map_handle;
-			break;
-		case WEB_SQL_LOCK:
-			handle = web_handle;
-			break;
-	}
+SQLLock::SQLLock(locktype lt) : pool(web_sql_pool(lt)), handle(nullptr), locked(false) {
 }
 
+/**
+ * Takes a connection out of the pool.
+ * If none becomes available within sql_pool_timeout, getHandle returns nullptr.
+ */
 void SQLLock::lock() {
-	// switch(lt) {
-	//     case LOGIN_SQL_LOCK:
-	//         ShowDebug("Locking login sql\n");
-	//         break;
-	//     case CHAR_SQL_LOCK:
-	//         ShowDebug("Locking char sql\n");
-	//         break;
-	//     case MAP_SQL_LOCK:
-	//         ShowDebug("Locking map sql\n");
-	//         break;
-	//     case WEB_SQL_LOCK:
-	//         ShowDebug("Locking web sql\n");
-	//         break;
-	// }
-	ulock.lock();
+	if (handle == nullptr)
+		handle = pool.acquire(web_config.sql_pool_timeout);
+	locked = handle != nullptr;
 }
 
+/**
+ * Ends the use of the connection.
+ * It only goes back to the pool when the lock is destroyed, because statements
+ * that were prepared on it are closed afterwards and still talk to the server.
+ */
 void SQLLock::unlock() {
-	ulock.unlock();
-	// switch(lt) {
-	//     case LOGIN_SQL_LOCK:
-	//         ShowDebug("Unlocked login sql\n");
-	//         break;
-	//     case CHAR_SQL_LOCK:
-	//         ShowDebug("Unlocked char sql\n");
-	//         break;
-	//     case MAP_SQL_LOCK:
-	//         ShowDebug("Unlocked map sql\n");
-	//         break;
-	//     case WEB_SQL_LOCK:
-	//         ShowDebug("Unlocked web sql\n");
-	//         break;
-	// }
-
+	locked = false;
 }
 
 
 // can only get handle if locked
 Sql * SQLLock::getHandle() {
-	if (!ulock.owns_lock())
+	if (!locked)
 		return nullptr;
 	return handle;
 }
 
 SQLLock::~SQLLock() {
+	pool.release(handle);
 }
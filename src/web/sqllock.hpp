@@ -4,8 +4,6 @@
 #ifndef SQLLOCK_HPP
 #define SQLLOCK_HPP
 
-#include <mutex>
-
 #include <common/sql.hpp>
 
 enum locktype {
@@ -15,11 +13,12 @@ enum locktype {
 	WEB_SQL_LOCK
 };
 
+/// Connection of one of the databases, taken from its pool for the lifetime of the lock
 class SQLLock {
 private:
-	std::unique_lock<std::mutex> ulock;
+	SqlPool& pool;
 	Sql * handle;
-	locktype lt;
+	bool locked;
 
 public:
 	SQLLock(locktype);
@@ -29,5 +28,6 @@ public:
 	Sql * getHandle();
 };
 
+SqlPool& web_sql_pool(locktype lt);
 
 #endif
@@ -0,0 +1,244 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "stats_controller.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <common/metrics.hpp>
+#include <common/showmsg.hpp>
+#include <common/sql.hpp>
+#include <common/strlib.hpp>
+
+#include "http.hpp"
+#include "sqllock.hpp"
+#include "web.hpp"
+
+/// The statistics are only meant for the server owner, so they are not served to remote addresses
+static bool stats_is_local( const Request& req ){
+	return req.remote_addr == "127.0.0.1" || req.remote_addr == "::1";
+}
+
+/**
+ * Appends the packet statistics that were written by one kind of server
+ * @param lt: Database of the server
+ * @param server: Prefix of the server names, "map-server" or "char-server"
+ * @param packets: Statistics are appended here
+ * @return HTTP_OK on success, HTTP_SERVICE_UNAVAILABLE if no database connection is available or HTTP_BAD_REQUEST if the query failed
+ */
+static e_http_status stats_packets_load( locktype lt, const char* server, nlohmann::json& packets ){
+	std::string pattern = std::string( server ) + ":%";
+	char server_name[33], link[9];
+	uint16 packet_id;
+	uint64 recv_count, recv_bytes, parse_time, send_count, send_bytes, broadcasts;
+
+	SQLLock sl( lt );
+	sl.lock();
+	auto handle = sl.getHandle();
+	if( handle == nullptr ){
+		return HTTP_SERVICE_UNAVAILABLE;
+	}
+	SqlStmt stmt{ *handle };
+
+	if( SQL_SUCCESS != stmt.Prepare(
+			"SELECT `server`, `link`, `packet_id`, `recv_count`, `recv_bytes`, `parse_time`, `send_count`, `send_bytes`, `broadcasts` FROM `%s` WHERE `server` LIKE ? ORDER BY `recv_bytes` + `send_bytes` DESC",
+			packet_stats_table )
+		|| SQL_SUCCESS != stmt.BindParam( 0, SQLDT_STRING, (void*)pattern.c_str(), pattern.length() )
+		|| SQL_SUCCESS != stmt.Execute()
+		|| SQL_SUCCESS != stmt.BindColumn( 0, SQLDT_STRING, &server_name, sizeof( server_name ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 1, SQLDT_STRING, &link, sizeof( link ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 2, SQLDT_UINT16, &packet_id, sizeof( packet_id ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 3, SQLDT_UINT64, &recv_count, sizeof( recv_count ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 4, SQLDT_UINT64, &recv_bytes, sizeof( recv_bytes ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 5, SQLDT_UINT64, &parse_time, sizeof( parse_time ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 6, SQLDT_UINT64, &send_count, sizeof( send_count ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 7, SQLDT_UINT64, &send_bytes, sizeof( send_bytes ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 8, SQLDT_UINT64, &broadcasts, sizeof( broadcasts ) )
+	){
+		SqlStmt_ShowDebug( stmt );
+		sl.unlock();
+		return HTTP_BAD_REQUEST;
+	}
+
+	while( SQL_SUCCESS == stmt.NextRow() ){
+		char id[7];
+
+		safesnprintf( id, sizeof( id ), "0x%04x", packet_id );
+
+		nlohmann::json packet = {
+			{ "server", server_name },
+			{ "link", link },
+			{ "packet", id },
+			{ "recv_count", recv_count },
+			{ "recv_bytes", recv_bytes },
+			{ "parse_time_us", parse_time },
+			{ "send_count", send_count },
+			{ "send_bytes", send_bytes },
+		};
+
+		// Average amount of sessions a broadcasted packet was sent to
+		if( broadcasts > 0 ){
+			packet["fanout"] = static_cast<double>( send_count ) / broadcasts;
+		}
+
+		packets.push_back( packet );
+	}
+
+	sl.unlock();
+
+	return HTTP_OK;
+}
+
+HANDLER_FUNC(stats_packets) {
+	if( !stats_is_local( req ) ){
+		res.status = HTTP_FORBIDDEN;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
+
+	auto packets = nlohmann::json::array();
+
+	e_http_status status = stats_packets_load( MAP_SQL_LOCK, "map-server", packets );
+
+	if( status == HTTP_OK ){
+		status = stats_packets_load( CHAR_SQL_LOCK, "char-server", packets );
+	}
+
+	if( status != HTTP_OK ){
+		res.status = status;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
+
+	res.set_content( packets.dump(), "application/json" );
+}
+
+struct s_metric_family {
+	std::string help;
+	std::string type;
+	std::vector<std::pair<std::string, int64>> samples; // server name, value
+};
+
+/**
+ * Appends the metrics that were written by one kind of server
+ * @param lt: Database of the server
+ * @param server: Prefix of the server names, "login-server", "char-server" or "map-server"
+ * @param families: Metrics are appended here, grouped by name
+ * @return HTTP_OK on success, HTTP_SERVICE_UNAVAILABLE if no database connection is available or HTTP_BAD_REQUEST if the query failed
+ */
+static e_http_status stats_metrics_load( locktype lt, const char* server, std::map<std::string, s_metric_family>& families ){
+	std::string pattern = std::string( server ) + ":%";
+	// Same fallback as the web-server's own metrics timer
+	int32 stale = METRICS_STALE_INTERVALS * ( metrics_interval > 0 ? metrics_interval : 5 );
+	char server_name[33], name[65], type[9], help[256];
+	int64 value;
+
+	SQLLock sl( lt );
+	sl.lock();
+	auto handle = sl.getHandle();
+	if( handle == nullptr ){
+		return HTTP_SERVICE_UNAVAILABLE;
+	}
+	SqlStmt stmt{ *handle };
+
+	if( SQL_SUCCESS != stmt.Prepare( "SELECT `server`, `name`, `type`, `help`, `value` FROM `%s` WHERE `server` LIKE ? AND `updated` >= NOW() - INTERVAL ? SECOND", metrics_table )
+		|| SQL_SUCCESS != stmt.BindParam( 0, SQLDT_STRING, (void*)pattern.c_str(), pattern.length() )
+		|| SQL_SUCCESS != stmt.BindParam( 1, SQLDT_INT32, &stale, sizeof( stale ) )
+		|| SQL_SUCCESS != stmt.Execute()
+		|| SQL_SUCCESS != stmt.BindColumn( 0, SQLDT_STRING, &server_name, sizeof( server_name ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 1, SQLDT_STRING, &name, sizeof( name ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 2, SQLDT_STRING, &type, sizeof( type ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 3, SQLDT_STRING, &help, sizeof( help ) )
+		|| SQL_SUCCESS != stmt.BindColumn( 4, SQLDT_INT64, &value, sizeof( value ) )
+	){
+		SqlStmt_ShowDebug( stmt );
+		sl.unlock();
+		return HTTP_BAD_REQUEST;
+	}
+
+	while( SQL_SUCCESS == stmt.NextRow() ){
+		s_metric_family& family = families[name];
+
+		family.help = help;
+		family.type = type;
+		family.samples.emplace_back( server_name, value );
+	}
+
+	sl.unlock();
+
+	return HTTP_OK;
+}
+
+/// Escapes a help text for the Prometheus text format
+static std::string stats_metrics_escape( const std::string& text ){
+	std::string escaped;
+
+	for( char c : text ){
+		switch( c ){
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			default:
+				escaped += c;
+				break;
+		}
+	}
+
+	return escaped;
+}
+
+HANDLER_FUNC(stats_metrics) {
+	if( !stats_is_local( req ) ){
+		res.status = HTTP_FORBIDDEN;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
+
+	std::map<std::string, s_metric_family> families;
+
+	e_http_status status = stats_metrics_load( LOGIN_SQL_LOCK, "login-server", families );
+
+	if( status == HTTP_OK ){
+		status = stats_metrics_load( CHAR_SQL_LOCK, "char-server", families );
+	}
+
+	if( status == HTTP_OK ){
+		status = stats_metrics_load( MAP_SQL_LOCK, "map-server", families );
+	}
+
+	if( status != HTTP_OK ){
+		res.status = status;
+		res.set_content( "Error", "text/plain" );
+		return;
+	}
+
+	// The web-server's own metrics are read directly, the gauges are updated by web_metrics_timer
+	std::string web_server = "web-server:" + std::to_string( web_config.web_port );
+
+	for( const Metric* metric : metrics_registry() ){
+		s_metric_family& family = families[metric->getName()];
+
+		family.help = metric->getHelp();
+		family.type = metrics_type_name( metric->getType() );
+		family.samples.emplace_back( web_server, metric->value() );
+	}
+
+	std::string body;
+
+	for( const auto& it : families ){
+		body += "# HELP " + it.first + " " + stats_metrics_escape( it.second.help ) + "\n";
+		body += "# TYPE " + it.first + " " + it.second.type + "\n";
+
+		for( const auto& sample : it.second.samples ){
+			body += it.first + "{server=\"" + sample.first + "\"} " + std::to_string( sample.second ) + "\n";
+		}
+	}
+
+	res.set_content( body, "text/plain; version=0.0.4" );
+}
@@ -0,0 +1,12 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef STATS_CONTROLLER_HPP
+#define STATS_CONTROLLER_HPP
+
+#include "http.hpp"
+
+HANDLER_FUNC(stats_metrics);
+HANDLER_FUNC(stats_packets);
+
+#endif
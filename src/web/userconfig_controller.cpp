@@ -14,10 +14,13 @@
 #include "sqllock.hpp"
 #include "webutils.hpp"
 #include "web.hpp"
+#include "webcache.hpp"
 
 HANDLER_FUNC(userconfig_save) {
-	if (!isAuthorized(req, false)) {
-		res.status = HTTP_BAD_REQUEST;
+	e_http_status status;
+
+	if (!isAuthorized(req, false, status)) {
+		res.status = status;
 		res.set_content("Error", "text/plain");
 		return;
 	}
@@ -33,6 +36,11 @@ HANDLER_FUNC(userconfig_save) {
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `data` FROM `%s` WHERE (`account_id` = ? AND `world_name` = ?) LIMIT 1",
@@ -84,6 +92,9 @@ HANDLER_FUNC(userconfig_save) {
 	}
 
 	sl.unlock();
+
+	config_cache.invalidate("user:" + std::to_string(account_id) + ":" + world_name);
+
 	res.set_content(data_str, "application/json");
 }
 
@@ -105,9 +116,24 @@ HANDLER_FUNC(userconfig_load) {
 	auto world_name_str = req.get_file_value("WorldName").content;
 	auto world_name = world_name_str.c_str();
 
+	auto cache_key = "user:" + std::to_string(account_id) + ":" + world_name_str;
+	auto cached = config_cache.get(cache_key);
+
+	if (cached != nullptr) {
+		web_cache_respond(req, res, *cached);
+		return;
+	}
+
+	auto generation = config_cache.getGeneration();
+
 	SQLLock sl(WEB_SQL_LOCK);
 	sl.lock();
 	auto handle = sl.getHandle();
+	if (handle == nullptr) {
+		res.status = HTTP_SERVICE_UNAVAILABLE;
+		res.set_content("Error", "text/plain");
+		return;
+	}
 	SqlStmt stmt{ *handle };
 	if (SQL_SUCCESS != stmt.Prepare(
 			"SELECT `data` FROM `%s` WHERE (`account_id` = ? AND `world_name` = ?) LIMIT 1",
@@ -139,7 +165,7 @@ HANDLER_FUNC(userconfig_load) {
 		}
 
 		sl.unlock();
-		res.set_content( data, "application/json" );
+		web_cache_respond( req, res, *config_cache.put( cache_key, generation, data, "application/json", web_cache_etag( data ) ) );
 		return;
 	}
 
@@ -160,5 +186,8 @@ HANDLER_FUNC(userconfig_load) {
 	databuf[sizeof(databuf) - 1] = 0;
 	auto response = nlohmann::json::parse(databuf);
 	response["Type"] = 1;
-	res.set_content(response.dump(), "application/json");
+
+	auto body = response.dump();
+
+	web_cache_respond(req, res, *config_cache.put(cache_key, generation, body, "application/json", web_cache_etag(body)));
 }
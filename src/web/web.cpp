@@ -13,6 +13,7 @@
 #include <common/core.hpp>
 #include <common/malloc.hpp>
 #include <common/md5calc.hpp>
+#include <common/metrics.hpp>
 #include <common/mmo.hpp>
 #include <common/msg_conf.hpp>
 #include <common/random.hpp>
@@ -30,6 +31,8 @@
 #include "http.hpp"
 #include "merchantstore_controller.hpp"
 #include "partybooking_controller.hpp"
+#include "sqllock.hpp"
+#include "stats_controller.hpp"
 #include "userconfig_controller.hpp"
 
 
@@ -70,10 +73,10 @@ std::string web_server_db = "ragnarok";
 
 std::string default_codepage = "";
 
-Sql * login_handle = nullptr;
-Sql * char_handle = nullptr;
-Sql * map_handle = nullptr;
-Sql * web_handle = nullptr;
+SqlPool login_pool( "Login" );
+SqlPool char_pool( "Char" );
+SqlPool map_pool( "Map" );
+SqlPool web_pool( "Web" );
 
 char login_table[32] = "login";
 char guild_emblems_table[32] = "guild_emblems";
@@ -84,6 +87,7 @@ char party_table[32] = "party";
 char partybookings_table[32] = "party_bookings";
 char guild_db_table[32] = "guild";
 char char_db_table[32] = "char";
+char packet_stats_table[32] = "packet_stats";
 
 int32 parse_console(const char * buf) {
 	return 1;
@@ -142,16 +146,22 @@ bool web_config_read(const char* cfgName, bool normal) {
 			if (msg_silent) /* only bother if we have actually this enabled */
 				ShowInfo("Console Silent Setting: %d\n", msg_silent);
 		}
-		else if (!strcmpi(w1, "console_msg_log"))
-			console_msg_log = atoi(w2);
-		else if (!strcmpi(w1, "console_log_filepath"))
-			safestrncpy(console_log_filepath, w2, sizeof(console_log_filepath));
+		else if (showmsg_config_read(w1, w2))
+			continue;
 		else if (!strcmpi(w1, "print_req_res"))
 			web_config.print_req_res = config_switch(w2);
 		else if (!strcmpi(w1, "import"))
 			web_config_read(w2, normal);
 		else if (!strcmpi(w1, "allow_gifs"))
 			web_config.allow_gifs = config_switch(w2) == 1;
+		else if (!strcmpi(w1, "sql_pool_size"))
+			web_config.sql_pool_size = cap_value(atoi(w2), 1, 64);
+		else if (!strcmpi(w1, "sql_pool_timeout"))
+			web_config.sql_pool_timeout = cap_value(atoi(w2), 0, 60000);
+		else if (!strcmpi(w1, "cache_size"))
+			web_config.cache_size = cap_value(atoi(w2), 0, 1048576);
+		else if (!strcmpi(w1, "cache_gzip"))
+			web_config.cache_gzip = config_switch(w2) == 1;
 	}
 	fclose(fp);
 	ShowInfo("Finished reading %s.\n", cfgName);
@@ -245,6 +255,10 @@ int32 inter_config_read(const char* cfgName)
 			safestrncpy(guild_db_table, w2, sizeof(guild_db_table));
 		else if (!strcmpi(w1, "char_db"))
 			safestrncpy(char_db_table, w2, sizeof(char_db_table));
+		else if (!strcmpi(w1, "packet_stats_table"))
+			safestrncpy(packet_stats_table, w2, sizeof(packet_stats_table));
+		else if (metrics_config_read(w1, w2))
+			continue;
 		else if(!strcmpi(w1,"import"))
 			inter_config_read(w2);
 	}
@@ -262,6 +276,10 @@ void web_set_defaults() {
 	safestrncpy(web_config.webconf_name, "conf/web_athena.conf", sizeof(web_config.webconf_name));
 	safestrncpy(web_config.msgconf_name, "conf/msg_conf/web_msg.conf", sizeof(web_config.msgconf_name));
 	web_config.print_req_res = false;
+	web_config.sql_pool_size = 8;
+	web_config.sql_pool_timeout = 3000;
+	web_config.cache_size = 32768;
+	web_config.cache_gzip = true;
 
 	inter_config.emblem_transparency_limit = 100;
 	inter_config.emblem_woe_change = true;
@@ -270,76 +288,27 @@ void web_set_defaults() {
 
 /// Constructor destructor and signal handlers
 
-int32 web_sql_init(void) {
-	// login db connection
-	login_handle = Sql_Malloc();
-	ShowInfo("Connecting to the Login DB server.....\n");
-
-	if (SQL_ERROR == Sql_Connect(login_handle, login_server_id.c_str(), login_server_pw.c_str(), login_server_ip.c_str(), login_server_port, login_server_db.c_str())) {
-		ShowError("Couldn't connect with uname='%s',host='%s',port='%hu',database='%s'\n",
-			login_server_id.c_str(), login_server_ip.c_str(), login_server_port, login_server_db.c_str());
-		Sql_ShowDebug(login_handle);
-		Sql_Free(login_handle);
-		exit(EXIT_FAILURE);
-	}
-	ShowStatus("Connect success! (Login Server Connection)\n");
-
-	if (!default_codepage.empty()) {
-		if (SQL_ERROR == Sql_SetEncoding(login_handle, default_codepage.c_str()))
-			Sql_ShowDebug(login_handle);
-	}
-
-	char_handle = Sql_Malloc();
-	ShowInfo("Connecting to the Char DB server.....\n");
-
-	if (SQL_ERROR == Sql_Connect(char_handle, char_server_id.c_str(), char_server_pw.c_str(), char_server_ip.c_str(), char_server_port, char_server_db.c_str())) {
-		ShowError("Couldn't connect with uname='%s',host='%s',port='%hu',database='%s'\n",
-			char_server_id.c_str(), char_server_ip.c_str(), char_server_port, char_server_db.c_str());
-		Sql_ShowDebug(char_handle);
-		Sql_Free(char_handle);
-		exit(EXIT_FAILURE);
-	}
-	ShowStatus("Connect success! (Char Server Connection)\n");
-
-	if (!default_codepage.empty()) {
-		if (SQL_ERROR == Sql_SetEncoding(char_handle, default_codepage.c_str()))
-			Sql_ShowDebug(char_handle);
-	}
-
-	map_handle = Sql_Malloc();
-	ShowInfo("Connecting to the Map DB server.....\n");
-
-	if (SQL_ERROR == Sql_Connect(map_handle, map_server_id.c_str(), map_server_pw.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str())) {
-		ShowError("Couldn't connect with uname='%s',host='%s',port='%hu',database='%s'\n",
-			map_server_id.c_str(), map_server_ip.c_str(), map_server_port, map_server_db.c_str());
-		Sql_ShowDebug(map_handle);
-		Sql_Free(map_handle);
-		exit(EXIT_FAILURE);
-	}
-	ShowStatus("Connect success! (Map Server Connection)\n");
-
-	if (!default_codepage.empty()) {
-		if (SQL_ERROR == Sql_SetEncoding(map_handle, default_codepage.c_str()))
-			Sql_ShowDebug(map_handle);
-	}
-
-	web_handle = Sql_Malloc();
-	ShowInfo("Connecting to the Web DB server.....\n");
+/**
+ * Opens the connections of a database pool
+ * @param pool: Pool to fill
+ * @param name: Name of the database, for the messages
+ */
+static void web_sql_connect(SqlPool& pool, const char* name, const std::string& id, const std::string& pw, const std::string& ip, uint16 port, const std::string& db) {
+	ShowInfo("Connecting to the %s DB server.....\n", name);
 
-	if (SQL_ERROR == Sql_Connect(web_handle, web_server_id.c_str(), web_server_pw.c_str(), web_server_ip.c_str(), web_server_port, web_server_db.c_str())) {
+	if (SQL_ERROR == pool.initialize(web_config.sql_pool_size, id.c_str(), pw.c_str(), ip.c_str(), port, db.c_str(), default_codepage.c_str())) {
 		ShowError("Couldn't connect with uname='%s',host='%s',port='%hu',database='%s'\n",
-			web_server_id.c_str(), web_server_ip.c_str(), web_server_port, web_server_db.c_str());
-		Sql_ShowDebug(web_handle);
-		Sql_Free(web_handle);
+			id.c_str(), ip.c_str(), port, db.c_str());
 		exit(EXIT_FAILURE);
 	}
-	ShowStatus("Connect success! (Web Server Connection)\n");
-
-	if (!default_codepage.empty()) {
-		if (SQL_ERROR == Sql_SetEncoding(web_handle, default_codepage.c_str()))
-			Sql_ShowDebug(web_handle);
-	}
+	ShowStatus("Connect success! (%s Server Connection, %" PRIuPTR " connections)\n", name, pool.size());
+}
 
+int32 web_sql_init(void) {
+	web_sql_connect(login_pool, "Login", login_server_id, login_server_pw, login_server_ip, login_server_port, login_server_db);
+	web_sql_connect(char_pool, "Char", char_server_id, char_server_pw, char_server_ip, char_server_port, char_server_db);
+	web_sql_connect(map_pool, "Map", map_server_id, map_server_pw, map_server_ip, map_server_port, map_server_db);
+	web_sql_connect(web_pool, "Web", web_server_id, web_server_pw, web_server_ip, web_server_port, web_server_db);
 
 	return 0;
 }
@@ -347,17 +316,37 @@ int32 web_sql_init(void) {
 int32 web_sql_close(void)
 {
 	ShowStatus("Close Login DB Connection....\n");
-	Sql_Free(login_handle);
-	login_handle = nullptr;
+	login_pool.finalize();
 	ShowStatus("Close Char DB Connection....\n");
-	Sql_Free(char_handle);
-	char_handle = nullptr;
+	char_pool.finalize();
 	ShowStatus("Close Map DB Connection....\n");
-	Sql_Free(map_handle);
-	map_handle = nullptr;
+	map_pool.finalize();
 	ShowStatus("Close Web DB Connection....\n");
-	Sql_Free(web_handle);
-	web_handle = nullptr;
+	web_pool.finalize();
+
+	return 0;
+}
+
+/// Returns the connection pool of a database
+SqlPool& web_sql_pool(locktype lt) {
+	switch (lt) {
+		case LOGIN_SQL_LOCK:
+			return login_pool;
+		case CHAR_SQL_LOCK:
+			return char_pool;
+		case MAP_SQL_LOCK:
+			return map_pool;
+		default:
+			return web_pool;
+	}
+}
+
+/// Pings the connections that were not used by any request for a while
+static TIMER_FUNC(web_sql_keepalive_timer){
+	login_pool.keepalive();
+	char_pool.keepalive();
+	map_pool.keepalive();
+	web_pool.keepalive();
 
 	return 0;
 }
@@ -399,8 +388,23 @@ void display_helpscreen(bool do_exit)
 		exit(EXIT_SUCCESS);
 }
 
+static Metric metric_http_requests( "rathena_http_requests_total", "HTTP requests that were answered", METRIC_COUNTER );
+static Metric metric_http_errors( "rathena_http_errors_total", "HTTP requests that were answered with an error status", METRIC_COUNTER );
+
+/// Updates the gauges of the web-server on the main thread, the HTTP threads only read them
+static TIMER_FUNC(web_metrics_timer){
+	metrics_collect();
+
+	return 0;
+}
+
 // called just before sending repsonse
 void logger(const Request & req, const Response & res) {
+	metric_http_requests.add();
+
+	if (res.status >= 400)
+		metric_http_errors.add();
+
 	// make this a config
 	if (web_config.print_req_res) {
 		ShowDebug("Incoming Headers are:\n");
@@ -443,6 +447,16 @@ bool WebServer::initialize( int32 argc, char* argv[] ){
 
 	web_sql_init();
 
+	if (!partybooking_index_load()) {
+		ShowError("Failed to load the party bookings, stopping.\n");
+		return false;
+	}
+
+	add_timer_func_list(web_metrics_timer, "web_metrics_timer");
+	add_timer_func_list(web_sql_keepalive_timer, "web_sql_keepalive_timer");
+	add_timer_interval(gettick() + 60000, web_sql_keepalive_timer, 0, 0, 60000);
+	add_timer_interval(gettick() + 1000, web_metrics_timer, 0, 0, ( metrics_interval > 0 ? metrics_interval : 5 ) * 1000);
+
 	ShowStatus("Starting server...\n");
 
 	http_server = std::make_shared<httplib::Server>();
@@ -459,6 +473,8 @@ bool WebServer::initialize( int32 argc, char* argv[] ){
 	http_server->Post("/party/info", partybooking_info);
 	http_server->Post("/party/list", partybooking_list);
 	http_server->Post("/party/search", partybooking_search);
+	http_server->Get("/metrics", stats_metrics);
+	http_server->Get("/stats/packets", stats_packets);
 	http_server->Post("/userconfig/load", userconfig_load);
 	http_server->Post("/userconfig/save", userconfig_save);
 
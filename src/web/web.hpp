@@ -42,6 +42,10 @@ struct Web_Config {
 	char webconf_name[256];						/// name of main config file
 	char msgconf_name[256];							/// name of msg_conf config file
 	bool allow_gifs;
+	uint16 sql_pool_size;							// connections per database
+	uint32 sql_pool_timeout;						// milliseconds a request waits for a connection
+	uint32 cache_size;								// KB of responses kept per cache, 0 disables caching
+	bool cache_gzip;								// keep a gzip compressed copy of cached responses
 };
 
 struct Inter_Config {
@@ -50,8 +54,12 @@ struct Inter_Config {
 };
 
 enum e_http_status{
+	HTTP_OK = 200,
+	HTTP_NOT_MODIFIED = 304,
 	HTTP_BAD_REQUEST = 400,
+	HTTP_FORBIDDEN = 403,
 	HTTP_NOT_FOUND = 404,
+	HTTP_SERVICE_UNAVAILABLE = 503,
 };
 
 extern struct Web_Config web_config;
@@ -66,6 +74,7 @@ extern char char_db_table[32];
 extern char merchant_configs_table[32];
 extern char party_table[32];
 extern char partybookings_table[32];
+extern char packet_stats_table[32];
 
 #define msg_config_read(cfgName) web_msg_config_read(cfgName)
 #define msg_txt(msg_number) web_msg_txt(msg_number)
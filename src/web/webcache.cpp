@@ -0,0 +1,220 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#include "webcache.hpp"
+
+#include <cstring>
+
+#include <zlib.h>
+
+#include <common/metrics.hpp>
+#include <common/strlib.hpp>
+
+#include "web.hpp"
+
+// Bodies smaller than this are sent as they are
+#define WEB_CACHE_GZIP_MIN_SIZE 256
+
+WebCache emblem_cache;
+WebCache config_cache;
+
+static Metric metric_web_cache_hits( "rathena_web_cache_hits_total", "Responses that were served from the web-server cache", METRIC_COUNTER );
+static Metric metric_web_cache_misses( "rathena_web_cache_misses_total", "Responses that had to be loaded from the database", METRIC_COUNTER );
+static Metric metric_web_cache_not_modified( "rathena_web_cache_not_modified_total", "Responses that were answered with 304 Not Modified", METRIC_COUNTER );
+static Metric metric_web_cache_bytes( "rathena_web_cache_bytes", "Size of the responses in the web-server cache", METRIC_GAUGE );
+
+/**
+ * Compresses a body with gzip
+ * @param body: Data to compress
+ * @param out: Compressed data
+ * @return true if the compressed data is smaller
+ */
+static bool web_cache_gzip(const std::string& body, std::string& out) {
+	z_stream stream = {};
+
+	// 15 window bits + 16 for a gzip header
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	out.resize(deflateBound(&stream, static_cast<uLong>(body.length())));
+
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+	stream.avail_in = static_cast<uInt>(body.length());
+	stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+	stream.avail_out = static_cast<uInt>(out.length());
+
+	int32 result = deflate(&stream, Z_FINISH);
+
+	out.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return result == Z_STREAM_END && out.length() < body.length();
+}
+
+void WebCache::remove(t_entries::iterator it) {
+	size_t bytes = it->second->body.length() + it->second->gzip_body.length();
+
+	this->size -= bytes;
+	metric_web_cache_bytes.add(-static_cast<int64>(bytes));
+	this->index.erase(it->first);
+	this->entries.erase(it);
+}
+
+/**
+ * Looks up a response and marks it as recently used
+ * @param key: Key of the response
+ * @return response or nullptr if it has to be loaded
+ */
+std::shared_ptr<const s_web_cache_entry> WebCache::get(const std::string& key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	auto it = this->index.find(key);
+
+	if (it == this->index.end()) {
+		metric_web_cache_misses.add();
+		return nullptr;
+	}
+
+	this->entries.splice(this->entries.begin(), this->entries, it->second);
+	metric_web_cache_hits.add();
+
+	return it->second->second;
+}
+
+/**
+ * Returns the current generation of the cache.
+ * Has to be read before the database is queried and passed to put, so a response
+ * that was loaded while the same data was saved is not cached.
+ */
+uint64 WebCache::getGeneration() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	return this->generation;
+}
+
+/**
+ * Creates a response and caches it, evicting the least recently used responses if the cache is full
+ * @param key: Key of the response
+ * @param generation: Value of getGeneration before the body was loaded
+ * @param body: Response body
+ * @param content_type: Content type of the body
+ * @param etag: Entity tag of the body, including the quotes
+ * @return response, which is also valid if it could not be cached
+ */
+std::shared_ptr<const s_web_cache_entry> WebCache::put(const std::string& key, uint64 generation, const std::string& body, const char* content_type, const std::string& etag) {
+	auto entry = std::make_shared<s_web_cache_entry>();
+
+	entry->body = body;
+	entry->content_type = content_type;
+	entry->etag = etag;
+
+	size_t limit = web_config.cache_size * 1024;
+
+	if (limit == 0)
+		return entry;
+
+	if (web_config.cache_gzip && body.length() >= WEB_CACHE_GZIP_MIN_SIZE && !web_cache_gzip(body, entry->gzip_body))
+		entry->gzip_body.clear();
+
+	size_t bytes = entry->body.length() + entry->gzip_body.length();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (generation != this->generation || bytes > limit)
+		return entry;
+
+	auto it = this->index.find(key);
+
+	if (it != this->index.end())
+		this->remove(it->second);
+
+	while (!this->entries.empty() && this->size + bytes > limit)
+		this->remove(std::prev(this->entries.end()));
+
+	this->entries.emplace_front(key, entry);
+	this->index[key] = this->entries.begin();
+	this->size += bytes;
+	metric_web_cache_bytes.add(bytes);
+
+	return entry;
+}
+
+/**
+ * Removes a response after its data was changed
+ * @param key: Key of the response
+ */
+void WebCache::invalidate(const std::string& key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->generation++;
+
+	auto it = this->index.find(key);
+
+	if (it != this->index.end())
+		this->remove(it->second);
+}
+
+void WebCache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->generation++;
+
+	while (!this->entries.empty())
+		this->remove(this->entries.begin());
+}
+
+/**
+ * Creates an entity tag from the content of a body
+ * @param body: Response body
+ * @return entity tag, including the quotes
+ */
+std::string web_cache_etag(const std::string& body) {
+	// 64-bit FNV-1a
+	uint64 hash = 0xcbf29ce484222325ULL;
+
+	for (unsigned char c : body) {
+		hash ^= c;
+		hash *= 0x100000001b3ULL;
+	}
+
+	char etag[19];
+
+	safesnprintf(etag, sizeof(etag), "\"%016" PRIx64 "\"", hash);
+
+	return etag;
+}
+
+/// Returns true if the header contains the entity tag, or is the wildcard
+static bool web_cache_etag_matches(const std::string& header, const std::string& etag) {
+	return header == "*" || header.find(etag) != std::string::npos;
+}
+
+/**
+ * Sends a cached response.
+ * Answers with 304 Not Modified if the client already has it and
+ * sends the compressed body if the client accepts gzip.
+ * @param req: Request
+ * @param res: Response
+ * @param entry: Cached response
+ */
+void web_cache_respond(const Request& req, Response& res, const s_web_cache_entry& entry) {
+	res.set_header("ETag", entry.etag);
+
+	if (req.has_header("If-None-Match") && web_cache_etag_matches(req.get_header_value("If-None-Match"), entry.etag)) {
+		metric_web_cache_not_modified.add();
+		res.status = HTTP_NOT_MODIFIED;
+		return;
+	}
+
+	if (!entry.gzip_body.empty()) {
+		res.set_header("Vary", "Accept-Encoding");
+
+		if (req.get_header_value("Accept-Encoding").find("gzip") != std::string::npos) {
+			res.set_header("Content-Encoding", "gzip");
+			res.set_content(entry.gzip_body, entry.content_type.c_str());
+			return;
+		}
+	}
+
+	res.set_content(entry.body, entry.content_type.c_str());
+}
@@ -0,0 +1,59 @@
+// Copyright (c) rAthena Dev Teams - Licensed under GNU GPL
+// For more information, see LICENCE in the main folder
+
+#ifndef WEB_CACHE_HPP
+#define WEB_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <common/cbasetypes.hpp>
+
+#include "http.hpp"
+
+/// Response that is kept in memory, it is never changed once it is cached
+struct s_web_cache_entry {
+	std::string body;
+	std::string gzip_body; // empty if compression is disabled or did not pay off
+	std::string content_type;
+	std::string etag;
+};
+
+/*
+ * LRU cache of responses that are loaded from the database.
+ * The web-server is the only writer of the cached tables, so the save handlers
+ * invalidate the entries they change and nothing expires on its own.
+ */
+class WebCache {
+private:
+	typedef std::list<std::pair<std::string, std::shared_ptr<const s_web_cache_entry>>> t_entries;
+
+	std::mutex mutex;
+	t_entries entries; // most recently used first
+	std::unordered_map<std::string, t_entries::iterator> index;
+	size_t size; // bytes of all bodies
+	uint64 generation; // increased by every invalidation
+
+	void remove(t_entries::iterator it);
+
+public:
+	WebCache() : size(0), generation(0) {}
+
+	std::shared_ptr<const s_web_cache_entry> get(const std::string& key);
+	uint64 getGeneration();
+	std::shared_ptr<const s_web_cache_entry> put(const std::string& key, uint64 generation, const std::string& body, const char* content_type, const std::string& etag);
+	void invalidate(const std::string& key);
+	void clear();
+};
+
+extern WebCache emblem_cache;
+extern WebCache config_cache;
+
+std::string web_cache_etag(const std::string& body);
+void web_cache_respond(const Request& req, Response& res, const s_web_cache_entry& entry);
+
+#endif /* WEB_CACHE_HPP */
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <common/metrics.hpp>
+
+static Metric test_counter( "test_counter_total", "Counter used by the tests", METRIC_COUNTER );
+static Metric test_gauge( "test_gauge", "Gauge used by the tests", METRIC_GAUGE );
+
+TEST(MetricsTest, Registry) {
+  const std::vector<Metric*>& metrics = metrics_registry();
+
+  EXPECT_NE(std::find(metrics.begin(), metrics.end(), &test_counter), metrics.end());
+  EXPECT_NE(std::find(metrics.begin(), metrics.end(), &test_gauge), metrics.end());
+  EXPECT_STREQ(metrics_type_name(test_counter.getType()), "counter");
+  EXPECT_STREQ(metrics_type_name(test_gauge.getType()), "gauge");
+}
+
+TEST(MetricsTest, CounterSumsAllThreads) {
+  const int64 before = test_counter.value();
+  const int32 threads = METRICS_MAX_THREADS + 4; // more threads than slots share slots
+  const int32 adds = 10000;
+  std::vector<std::thread> workers;
+
+  for (int32 i = 0; i < threads; i++) {
+    workers.emplace_back([adds]() {
+      for (int32 j = 0; j < adds; j++) {
+        test_counter.add();
+      }
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(test_counter.value() - before, static_cast<int64>(threads) * adds);
+}
+
+TEST(MetricsTest, GaugeSetOverwrites) {
+  std::thread worker([]() {
+    test_gauge.add(5);
+  });
+  worker.join();
+
+  test_gauge.add(3);
+  EXPECT_EQ(test_gauge.value(), 8);
+
+  test_gauge.set(42);
+  EXPECT_EQ(test_gauge.value(), 42);
+
+  test_gauge.add(-2);
+  EXPECT_EQ(test_gauge.value(), 40);
+}
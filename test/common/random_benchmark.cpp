@@ -0,0 +1,57 @@
+// Measures the random number functions, it is not run with the tests
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <common/random.hpp>
+
+static constexpr int32 ITERATIONS = 10000000;
+
+template <typename F>
+static void measure( const char* name, F func ){
+	auto start = std::chrono::steady_clock::now();
+	uint64 sink = 0;
+
+	for( int32 i = 0; i < ITERATIONS; i++ ){
+		sink += func();
+	}
+
+	double ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	// The sink is printed so the draws are not optimized out
+	std::cout << name << ": " << ms << " ms for " << ITERATIONS << " draws (" << ( sink & 1 ) << ")" << std::endl;
+}
+
+static void bounded_draws(){
+	std::mt19937 mt( 42 );
+	std::uniform_int_distribution<int32> dist( 0, 9999 );
+
+	rnd_seed( 42 );
+
+	measure( "mt19937 uniform_int_distribution", [&]() { return dist( mt ); } );
+	measure( "rnd()%10000", []() { return rnd() % 10000; } );
+	measure( "rnd_bounded(10000)", []() { return rnd_bounded( 10000 ); } );
+	measure( "rnd_value(0, 9999)", []() { return rnd_value( 0, 9999 ); } );
+	measure( "rnd_chance(25, 100)", []() { return rnd_chance( 25, 100 ) ? 1 : 0; } );
+}
+
+static void bulk_fill(){
+	std::vector<uint32> buffer( ITERATIONS );
+
+	rnd_seed( 42 );
+
+	auto start = std::chrono::steady_clock::now();
+	rnd_fill( buffer.data(), buffer.size() );
+	double ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	std::cout << "rnd_fill: " << ms << " ms for " << ITERATIONS << " values (" << ( ( buffer.front() ^ buffer.back() ) & 1 ) << ")" << std::endl;
+}
+
+int main( int argc, char* argv[] ){
+	bounded_draws();
+	bulk_fill();
+
+	return 0;
+}
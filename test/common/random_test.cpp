@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+#include <common/random.hpp>
+
+// Upper tail of the chi-square distribution at p = 0.001
+static constexpr double CHI_SQUARE_9 = 27.877;
+static constexpr double CHI_SQUARE_255 = 330.52;
+
+template <size_t N>
+static double chi_square( const std::array<uint64, N>& buckets, uint64 total ){
+	double expected = static_cast<double>( total ) / N;
+	double sum = 0;
+
+	for( uint64 observed : buckets ){
+		double diff = static_cast<double>( observed ) - expected;
+
+		sum += diff * diff / expected;
+	}
+
+	return sum;
+}
+
+TEST(RandomTest, ReferenceSequence) {
+	// Reference output of xoshiro256** for the state { 1, 2, 3, 4 }
+	xoshiro256ss engine( 1, 2, 3, 4 );
+
+	EXPECT_EQ(11520ULL, engine());
+	EXPECT_EQ(0ULL, engine());
+	EXPECT_EQ(1509978240ULL, engine());
+	EXPECT_EQ(1215971899390074240ULL, engine());
+}
+
+TEST(RandomTest, SeedIsReproducible) {
+	rnd_seed( 42 );
+	std::vector<int32> first;
+
+	for( int32 i = 0; i < 100; i++ ){
+		first.push_back( rnd() );
+	}
+
+	rnd_seed( 42 );
+
+	for( int32 i = 0; i < 100; i++ ){
+		EXPECT_EQ(first[i], rnd());
+	}
+}
+
+TEST(RandomTest, StreamsAreIndependent) {
+	rnd_seed( 42 );
+	std::vector<int32> drops;
+
+	for( int32 i = 0; i < 100; i++ ){
+		drops.push_back( rnd( RND_STREAM_DROP ) );
+	}
+
+	// Draws on another stream must not shift the drop sequence
+	rnd_seed( 42 );
+
+	for( int32 i = 0; i < 100; i++ ){
+		rnd( RND_STREAM_AI );
+		rnd_value( 1, 100, RND_STREAM_SKILL );
+		EXPECT_EQ(drops[i], rnd( RND_STREAM_DROP ));
+	}
+
+	rnd_seed( 42 );
+	int32 equal = 0;
+
+	for( int32 i = 0; i < 100; i++ ){
+		if( drops[i] == rnd( RND_STREAM_DEFAULT ) ){
+			equal++;
+		}
+	}
+
+	EXPECT_LT(equal, 2);
+}
+
+TEST(RandomTest, Bounds) {
+	rnd_seed( 1 );
+
+	for( int32 i = 0; i < 100000; i++ ){
+		int32 value = rnd();
+		EXPECT_GE(value, 0);
+		EXPECT_LE(value, SINT32_MAX);
+
+		value = rnd_value( -5, 5 );
+		EXPECT_GE(value, -5);
+		EXPECT_LE(value, 5);
+
+		value = rnd_bounded( 7 );
+		EXPECT_GE(value, 0);
+		EXPECT_LT(value, 7);
+
+		uint16 small = rnd_value<uint16>( 65535, 0 );
+		EXPECT_LE(small, 65535);
+
+		int64 big = rnd_value<int64>( -10000000000LL, 10000000000LL );
+		EXPECT_GE(big, -10000000000LL);
+		EXPECT_LE(big, 10000000000LL);
+	}
+
+	EXPECT_EQ(3, rnd_value( 3, 3 ));
+	EXPECT_EQ(0, rnd_bounded( 1 ));
+	EXPECT_EQ(0, rnd_bounded( 0 ));
+	EXPECT_EQ(0, rnd_bounded( -1 ));
+	EXPECT_FALSE(rnd_chance( 0, 100 ));
+	EXPECT_TRUE(rnd_chance( 100, 100 ));
+}
+
+TEST(RandomTest, FullRange) {
+	rnd_seed( 2 );
+	bool negative = false, positive = false;
+
+	for( int32 i = 0; i < 1000; i++ ){
+		int32 value = rnd_value( INT32_MIN, INT32_MAX );
+
+		negative |= value < 0;
+		positive |= value > 0;
+	}
+
+	EXPECT_TRUE(negative);
+	EXPECT_TRUE(positive);
+}
+
+TEST(RandomTest, UniformValue) {
+	rnd_seed( 3 );
+	std::array<uint64, 10> buckets = {};
+	const uint64 total = 1000000;
+
+	for( uint64 i = 0; i < total; i++ ){
+		buckets[rnd_value( 0, 9 )]++;
+	}
+
+	EXPECT_LT(chi_square( buckets, total ), CHI_SQUARE_9);
+}
+
+TEST(RandomTest, UniformBytes) {
+	rnd_seed( 4 );
+	std::array<uint64, 256> low = {}, high = {};
+	std::vector<uint32> buffer( 100001 );
+
+	rnd_fill( buffer.data(), buffer.size() );
+
+	for( uint32 value : buffer ){
+		low[value & 0xFF]++;
+		high[value >> 24]++;
+	}
+
+	EXPECT_LT(chi_square( low, buffer.size() ), CHI_SQUARE_255);
+	EXPECT_LT(chi_square( high, buffer.size() ), CHI_SQUARE_255);
+}
+
+TEST(RandomTest, ChanceRate) {
+	rnd_seed( 5 );
+	const int32 total = 1000000;
+	int32 hits = 0;
+
+	for( int32 i = 0; i < total; i++ ){
+		if( rnd_chance( 25, 100 ) ){
+			hits++;
+		}
+	}
+
+	// Standard deviation is about 433, allow five of them
+	EXPECT_NEAR(250000, hits, 2200);
+}
+
+TEST(RandomTest, Shuffle) {
+	rnd_seed( 6 );
+	std::vector<int32> vec = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	std::vector<int32> original = vec;
+
+	rnd_vector_order( vec );
+
+	EXPECT_TRUE(std::is_permutation( vec.begin(), vec.end(), original.begin() ));
+	EXPECT_NE(original, vec);
+}
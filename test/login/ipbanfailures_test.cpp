@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <login/ipbanfailures.hpp>
+
+static constexpr uint32 IP_A = 0x7F000001;
+static constexpr uint32 IP_B = 0x7F000002;
+static constexpr time_t WINDOW = 300;
+
+TEST(IpbanFailuresTest, CountsFailuresWithinWindow) {
+	IpbanFailures failures;
+
+	EXPECT_EQ(failures.add(IP_A, 1000, WINDOW), 1);
+	EXPECT_EQ(failures.add(IP_A, 1100, WINDOW), 2);
+	EXPECT_EQ(failures.add(IP_A, 1200, WINDOW), 3);
+	// 1000 left the window
+	EXPECT_EQ(failures.add(IP_A, 1300, WINDOW), 3);
+	EXPECT_EQ(failures.add(IP_B, 1300, WINDOW), 1);
+	EXPECT_EQ(failures.size(), 2);
+}
+
+TEST(IpbanFailuresTest, EmptyWindowForgetsAddress) {
+	IpbanFailures failures;
+
+	// A failure never counts within an empty window
+	EXPECT_EQ(failures.add(IP_A, 1000, 0), 0);
+	EXPECT_EQ(failures.add(IP_A, 1000, 0), 0);
+	EXPECT_EQ(failures.size(), 0);
+
+	failures.prune(1000, 0);
+	EXPECT_EQ(failures.size(), 0);
+}
+
+TEST(IpbanFailuresTest, PruneForgetsOldAddresses) {
+	IpbanFailures failures;
+
+	failures.add(IP_A, 1000, WINDOW);
+	failures.add(IP_B, 1200, WINDOW);
+
+	failures.prune(1300, WINDOW);
+	EXPECT_EQ(failures.size(), 1);
+
+	failures.prune(1500, WINDOW);
+	EXPECT_EQ(failures.size(), 0);
+
+	// Starts counting from scratch
+	EXPECT_EQ(failures.add(IP_A, 1500, WINDOW), 1);
+}
+
+TEST(IpbanFailuresTest, ForgetResetsAddress) {
+	IpbanFailures failures;
+
+	failures.add(IP_A, 1000, WINDOW);
+	failures.add(IP_A, 1001, WINDOW);
+	failures.add(IP_B, 1001, WINDOW);
+	failures.forget(IP_A);
+
+	EXPECT_EQ(failures.size(), 1);
+	EXPECT_EQ(failures.add(IP_A, 1002, WINDOW), 1);
+}